@@ -3,12 +3,15 @@
  ***************************************************************************/
 
 #include <iostream> //  TODO: remove It
+#include <cstdlib>
 
 #include "persistence_private.hpp"
 #include "persistence_utility.hpp"
 #include "persistence_io.hpp"
 #include "persistence_ast.hpp"
+#include "persistence_code.hpp"
 #include "persistence_parser.hpp"
+#include "persistence_tape.hpp"
 #include "persistence_emitter.hpp"
 #include "persistence_string.hpp"
 #include "persistence.hpp"
@@ -37,6 +40,16 @@ namespace exception
             ), POS_ARGS_
         );
     }
+    inline static void failed_to_expand(const char * msg, POS_TYPE_)
+    {
+        error(0,
+            ( Soss<char, 512>()
+                * "failed to parse a lazy node, hint: "
+                | fmt<256>(msg)
+                | '.'
+            ), POS_ARGS_
+        );
+    }
     inline static void failed_to_open(const char * filename, POS_TYPE_)
     {
         error(0,
@@ -159,45 +172,121 @@ namespace experimental
         typedef value_type       & reference;
         typedef value_type const * const_pointer;
         typedef value_type const & const_reference;
-        typedef ast::Pool        allocator_t;
+        typedef ast::ArenaPool   allocator_t;
+        typedef parser::json::LazyTree LazyTree;
 
-    public:
-        reference     node_;
-        allocator_t & pool_;
+        static const size_t NONE = static_cast<size_t>(-1);
+        static const size_t LAZY = NONE - 1U;
 
     public:
-        explicit Impl(reference node, allocator_t & alloc)
-            : node_(node)
-            , pool_(alloc)
-        {}
+        static inline FileNode make
+            (reference node, allocator_t & pool, size_t item = NONE)
+        {
+            FileNode rv;
+            rv.node = &node;
+            rv.pool = &pool;
+            rv.item = item;
+            return rv;
+        }
+        /* a node of a tape has no pool, and `item` is the index of word */
+        static inline FileNode make(tape::Cursor const & cursor)
+        {
+            FileNode rv;
+            rv.node = const_cast<tape::Document *>(cursor.document());
+            rv.pool = NULL;
+            rv.item = cursor.index();
+            return rv;
+        }
+        static inline bool is_tape(FileNode const & self)
+        {
+            return self.node != NULL && self.pool == NULL;
+        }
+        static inline tape::Cursor cursor(FileNode const & self)
+        {
+            return tape::Cursor(
+                *static_cast<tape::Document const *>(self.node), self.item);
+        }
+        /* a container of a lazy tree, `node` is the item and `pool` is
+         * the tree. It is parsed on first visit, elements are visited in
+         * the form of other nodes, and the ones left as text are lazy. */
+        static inline FileNode make(LazyTree & tree, LazyTree::Item & item)
+        {
+            FileNode rv;
+            rv.node = &item;
+            rv.pool = &tree;
+            rv.item = LAZY;
+            return rv;
+        }
+        static inline bool is_lazy(FileNode const & self)
+        {
+            return self.item == LAZY;
+        }
+        static inline FileNode expand(FileNode const & self)
+        {
+            LazyTree       & tree = *static_cast<LazyTree       *>(self.pool);
+            LazyTree::Item & item = *static_cast<LazyTree::Item *>(self.node);
+            pointer node = tree.expand(item);
+            if (node == NULL)
+                exception::failed_to_expand(tree.message(), POS_);
+            return make(*node, tree.pool(item));
+        }
+        static inline FileNode child(FileNode const & self, FileNode elem)
+        {
+            LazyTree       & tree = *static_cast<LazyTree       *>(self.pool);
+            LazyTree::Item & item = *static_cast<LazyTree::Item *>(self.node);
+            LazyTree::Item * kid  = elem.item == NONE
+                ? tree.child(item, *static_cast<const_pointer>(elem.node))
+                : NULL;
+            return kid == NULL ? elem : make(tree, *kid);
+        }
+        static inline reference node(FileNode const & self)
+        {
+            if (self.empty())
+                exception::invalid_filenode(POS_);
+            return *static_cast<pointer>(self.node);
+        }
+        static inline allocator_t & pool(FileNode const & self)
+        {
+            return *static_cast<allocator_t *>(self.pool);
+        }
+
+        /* an element of a packed sequence is I64 or DBL */
+        static inline ast::Tag type(FileNode const & self)
+        {
+            using namespace ast;
+            Tag tag = node(self).type();
+            if (self.item == NONE)
+                return tag;
+            return tag == I64_ARR ? I64 : DBL;
+        }
+        static inline int64_t i64(FileNode const & self)
+        {
+            using namespace ast;
+            const_reference node = Impl::node(self);
+            return self.item == NONE
+                ? node.val<I64>()
+                : node.raw<I64_ARR>()[self.item];
+        }
+        static inline double dbl(FileNode const & self)
+        {
+            using namespace ast;
+            const_reference node = Impl::node(self);
+            return self.item == NONE
+                ? node.val<DBL>()
+                : node.raw<DBL_ARR>()[self.item];
+        }
     };
 
     /************************************************************************
-     * FileNode::constructor\destructor\copier
+     * FileNode::constructor
      ***********************************************************************/
 
     FileNode::FileNode()
-        : impl(NULL)
-    {}
-
-    FileNode::~FileNode()
-    {
-        delete impl;
-    }
-
-    FileNode::FileNode(const FileNode & rhs)
-        : impl(rhs.impl == NULL ? NULL : new Impl(*rhs.impl))
+        : node(NULL)
+        , pool(NULL)
+        , item(Impl::NONE)
     {}
 
-    FileNode & FileNode::operator=(const FileNode & rhs)
-    {
-        if (this != &rhs) {
-            delete this->impl;
-            this->impl = (rhs.impl == NULL ? NULL : new Impl(*rhs.impl));
-        }
-        return *this;
-    }
-
     /************************************************************************
      * FileNode::methods
      ***********************************************************************/
@@ -206,20 +295,30 @@ namespace experimental
     {
         using namespace ast;
 
-        if (empty())
-            exception::invalid_filenode(POS_);
-
-        Impl::reference node = impl->node_;
-        if (node.type() != SEQ)
-            exception::type_not_match(SEQ, node.type(), POS_);
+        if (Impl::is_tape(*this))
+            return Impl::make(Impl::cursor(*this)[index]);
+        if (Impl::is_lazy(*this))
+            return Impl::child(*this, Impl::expand(*this)[index]);
+
+        Impl::reference node = Impl::node(*this);
+        Tag             type = Impl::type(*this);
+        if (type == I64_ARR || type == DBL_ARR) {
+            size_t size = type == I64_ARR
+                ? node.size<I64_ARR>()
+                : node.size<DBL_ARR>();
+            if (index >= size)
+                exception::index_out_of_range(index, POS_);
+
+            return Impl::make(node, Impl::pool(*this), index);
+        }
+        if (type != SEQ)
+            exception::type_not_match(SEQ, type, POS_);
 
         Impl::pointer child = node.at<SEQ>(static_cast<uint32_t>(index));
         if (child == NULL)
             exception::index_out_of_range(index, POS_);
 
-        FileNode rv;
-        rv.impl = new Impl(*child, impl->pool_);
-        return rv;
+        return Impl::make(*child, Impl::pool(*this));
     }
 
     FileNode FileNode::operator[](const char * key) const
@@ -228,64 +327,70 @@ namespace experimental
 
         if (key == NULL)
             exception::null_argument("const char * key", POS_);
-        if (empty())
-            exception::invalid_filenode(POS_);
 
-        Impl::reference node = impl->node_;
-        if (node.type() != MAP)
-            exception::type_not_match(MAP, node.type(), POS_);
+        if (Impl::is_tape(*this))
+            return Impl::make(Impl::cursor(*this)[key]);
+        if (Impl::is_lazy(*this))
+            return Impl::child(*this, Impl::expand(*this)[key]);
 
-        size_t len = chars::strlen(key);
-        Impl::value_type key_node;
-        key_node.construct(impl->pool_);
-        key_node.set<STR>(key, key + len, impl->pool_);
+        Impl::reference node = Impl::node(*this);
+        if (Impl::type(*this) != MAP)
+            exception::type_not_match(MAP, Impl::type(*this), POS_);
 
-        Impl::value_type::Pair * child = node.find<MAP>(key_node);
-        if (child == NULL)
+        /* maps are indexed when built, a search does not write them */
+        uint32_t len = static_cast<uint32_t>(chars::strlen(key));
+        Impl::const_reference view = node;
+        Impl::value_type::Pair const * found = view.find<MAP>(key, len);
+        if (found == view.end<MAP>())
             exception::invalid_key(key, POS_);
 
-        FileNode rv;
-        rv.impl = new Impl((*child)[1], impl->pool_);
-        return rv;
+        Impl::value_type::Pair * child
+            = const_cast<Impl::value_type::Pair *>(found);
+        return Impl::make((*child)[1], Impl::pool(*this));
     }
 
     FileNode::operator int() const
     {
         using namespace ast;
 
-        if (empty())
-            exception::invalid_filenode(POS_);
+        if (Impl::is_tape(*this))
+            return Impl::cursor(*this);
+        if (Impl::is_lazy(*this))
+            return Impl::expand(*this);
 
-        Impl::reference node = impl->node_;
-        if (node.type() != I64)
-            exception::type_not_match(I64, node.type(), POS_);
+        if (Impl::type(*this) != I64)
+            exception::type_not_match(I64, Impl::type(*this), POS_);
 
-        return static_cast<int>(node.val<I64>());
+        return static_cast<int>(Impl::i64(*this));
     }
 
     FileNode::operator double() const
     {
         using namespace ast;
 
-        if (empty())
-            exception::invalid_filenode(POS_);
+        if (Impl::is_tape(*this))
+            return Impl::cursor(*this);
+        if (Impl::is_lazy(*this))
+            return Impl::expand(*this);
 
-        Impl::reference node = impl->node_;
-        if (node.type() != DBL)
-            exception::type_not_match(DBL, node.type(), POS_);
+        if (Impl::type(*this) != DBL)
+            exception::type_not_match(DBL, Impl::type(*this), POS_);
 
-        return node.val<DBL>();
+        return Impl::dbl(*this);
     }
 
     FileNode::operator const char *() const
     {
         using namespace ast;
-        if (empty())
-            exception::invalid_filenode(POS_);
 
-        Impl::reference node = impl->node_;
-        if (node.type() != STR)
-            exception::type_not_match(STR, node.type(), POS_);
+        if (Impl::is_tape(*this))
+            return Impl::cursor(*this);
+        if (Impl::is_lazy(*this))
+            return Impl::expand(*this);
+
+        Impl::reference node = Impl::node(*this);
+        if (Impl::type(*this) != STR)
+            exception::type_not_match(STR, Impl::type(*this), POS_);
 
         return node.raw<STR>();
     }
@@ -293,10 +398,52 @@ namespace experimental
     bool FileNode::empty() const
     {
         using namespace ast;
-        return impl == NULL
-            || impl->node_.type() == NIL
+        if (Impl::is_tape(*this))
+            return Impl::cursor(*this).empty();
+        if (Impl::is_lazy(*this))
+            return false;
+
+        return node == NULL
+            || (item == Impl::NONE
+            && static_cast<Impl::const_pointer>(node)->type() == NIL)
             ;
     }
+
+    const int64_t * FileNode::raw_i64(size_t & size) const
+    {
+        using namespace ast;
+
+        size = 0U;
+        if (Impl::is_lazy(*this))
+            return Impl::expand(*this).raw_i64(size);
+        if (node == NULL || pool == NULL || item != Impl::NONE)
+            return NULL;
+
+        Impl::const_pointer self = static_cast<Impl::const_pointer>(node);
+        if (self->type() != I64_ARR)
+            return NULL;
+
+        size = self->size<I64_ARR>();
+        return self->raw<I64_ARR>();
+    }
+
+    const double * FileNode::raw_dbl(size_t & size) const
+    {
+        using namespace ast;
+
+        size = 0U;
+        if (Impl::is_lazy(*this))
+            return Impl::expand(*this).raw_dbl(size);
+        if (node == NULL || pool == NULL || item != Impl::NONE)
+            return NULL;
+
+        Impl::const_pointer self = static_cast<Impl::const_pointer>(node);
+        if (self->type() != DBL_ARR)
+            return NULL;
+
+        size = self->size<DBL_ARR>();
+        return self->raw<DBL_ARR>();
+    }
 }
 
 /****************************************************************************
@@ -318,6 +465,12 @@ namespace experimental
             , format(FileStorage::AUTO)
             , enable_memory(false)
             , enable_base64(false)
+            , enable_insitu(false)
+            , enable_records(false)
+            , enable_tape(false)
+            , enable_lazy(false)
+            , parallel_threads(1U)
+            , parallel_depth(0U)
         {}
 
         String filename;
@@ -326,6 +479,12 @@ namespace experimental
         int      format;
         bool     enable_memory;
         bool     enable_base64;
+        bool     enable_insitu;
+        bool     enable_records;
+        bool     enable_tape;
+        bool     enable_lazy;
+        size_t   parallel_threads;
+        size_t   parallel_depth;
     };
 
     static inline void
@@ -345,6 +504,12 @@ namespace experimental
         static const char YAML_SUFFIX       []= ".yaml";
         static const char JSON_SUFFIX       []= ".json";
         static const char OPT_ENABLE_BASE64 []= "base64";
+        static const char OPT_ENABLE_INSITU []= "insitu";
+        static const char OPT_ENABLE_RECORDS[]= "records";
+        static const char OPT_ENABLE_TAPE   []= "tape";
+        static const char OPT_ENABLE_LAZY   []= "lazy";
+        static const char OPT_THREADS       []= "threads";
+        static const char OPT_DEPTH         []= "depth";
 
         /* [0]create a copy of `query` */
         String string;
@@ -382,6 +547,7 @@ namespace experimental
                 buffer[1024] = flag;
 
             settings.enable_memory = true;
+            settings.enable_insitu = true; /* copied once into a view */
             settings.data.push_back(buffer, chars::strlen(buffer));
             settings.data.push_back(0);
             return;
@@ -408,6 +574,26 @@ namespace experimental
 
                     if (!*val && !chars::strcmp(key, OPT_ENABLE_BASE64)) {
                         settings.enable_base64 = true;
+                    } else if
+                        (!*val && !chars::strcmp(key, OPT_ENABLE_INSITU)) {
+                        settings.enable_insitu = true;
+                    } else if
+                        (!*val && !chars::strcmp(key, OPT_ENABLE_RECORDS)) {
+                        settings.enable_records = true;
+                    } else if
+                        (!*val && !chars::strcmp(key, OPT_ENABLE_TAPE)) {
+                        settings.enable_tape = true;
+                    } else if
+                        (!*val && !chars::strcmp(key, OPT_ENABLE_LAZY)) {
+                        settings.enable_lazy = true;
+                    } else if
+                        (*val && !chars::strcmp(key, OPT_THREADS)) {
+                        settings.parallel_threads = static_cast<size_t>(
+                            std::strtoul(val, NULL, 10));
+                    } else if
+                        (*val && !chars::strcmp(key, OPT_DEPTH)) {
+                        settings.parallel_depth = static_cast<size_t>(
+                            std::strtoul(val, NULL, 10));
                     } /* else if (key == "...") { } */ else {
                         ;// TODO: warning
                     }
@@ -442,10 +628,19 @@ namespace experimental
     class FileStorage::Impl
     {
     public:
-        Impl() : ast_(), fsm_() {}
+        Impl()
+            : ast_(), tape_(), src_(), fsm_(), rec_(), lazy_(), name_()
+            , base64_(false)
+        {}
 
-        ast::Tree<char>    ast_;
+        ast::Tree<char, ast::ArenaPool> ast_; /* read only */
+        tape::Document     tape_; /* instead of `ast_`, read only */
+        io::Stream       * src_; /* strings of `ast_` may refer to it */
         emitter::Handler * fsm_; // unique_ptr
+        parser::json::RecordReader * rec_; /* reads `src_` on demand */
+        parser::json::LazyTree   * lazy_; /* parses `src_` on demand */
+        String             name_; /* of `src_`, for messages of `rec_` */
+        bool               base64_; /* arrays are written as blocks */
     };
 
     /************************************************************************
@@ -504,14 +699,6 @@ namespace experimental
         io::Stream * stream = NULL;
         const char * data     = NULL;
         {
-            stream = io::Stream::build(
-                ( settings.enable_memory )
-                ? io::STRING
-                : io::FILE
-            );
-            if (stream == NULL)
-                exception::failed_to_build_stream(POS_);
-
             /* map `settings.mode` to `stream_mode` */
             io::Mode stream_mode = io::READ;
             switch (settings.mode)
@@ -528,15 +715,35 @@ namespace experimental
                 : settings.filename
                 );
 
-            if (stream->open(data, stream_mode) == false)
+            /* reading a file, try to map it into memory first */
+            if (!settings.enable_memory && stream_mode == io::READ) {
+                stream = io::Stream::build(io::MMAP);
+                if (stream != NULL && stream->open(data, stream_mode)==false) {
+                    delete stream;
+                    stream = NULL;
+                }
+            }
+
+            if (stream == NULL) {
+                stream = io::Stream::build(
+                    ( settings.enable_memory )
+                    ? io::STRING
+                    : io::FILE
+                );
+                if (stream == NULL)
+                    exception::failed_to_build_stream(POS_);
+            }
+
+            if (stream->is_open() == false &&
+                stream->open(data, stream_mode) == false)
                 exception::failed_to_open(data, POS_);
         }
 
         /* [2] R or W */
         if (settings.mode == io::READ)
         {
-            ast::Tree<char> & tree =  impl->ast_;
-            parser::ParseFuncion parse = NULL;
+            ast::Tree<char, ast::ArenaPool> & tree =  impl->ast_;
+            parser::ArenaParseFuncion parse = NULL;
             switch (settings.format)
             {
             //case XML : { parse = parser:: xml::parse; break; }
@@ -545,10 +752,51 @@ namespace experimental
             default: exception::invalid_format(settings.format, POS_); break;
             }
 
+            parser::Settings options; {
+                options.enable_insitu    = settings.enable_insitu;
+                options.parallel_threads = settings.parallel_threads;
+                options.parallel_depth   = settings.parallel_depth;
+                options.enable_packed_array  = true; /* see `FileNode` */
+                options.enable_key_interning = true;
+                options.enable_base64        = true; /* blocks if any */
+            }
+
+            /* JSON lines, records are read on demand by `root(index)` */
+            if (settings.enable_records && settings.format == JSON) {
+                impl->src_ = stream;
+                impl->rec_ = new parser::json::RecordReader(*stream, options);
+                impl->name_.push_back(data, chars::strlen(data));
+                impl->name_.push_back(0);
+                impl->rec_->next();
+                if (impl->rec_->message().empty() == false)
+                    exception::failed_to_parse(
+                        data, impl->rec_->message(), POS_);
+                return isOpen();
+            }
+
+            /* containers are parsed on first visit, see `FileNode::Impl` */
+            if (settings.enable_lazy && settings.format == JSON) {
+                impl->src_  = stream;
+                impl->lazy_ = new parser::json::LazyTree(*stream, options);
+                if (impl->lazy_->expand(impl->lazy_->root()) == NULL)
+                    exception::failed_to_parse(
+                        data, impl->lazy_->message(), POS_);
+                return isOpen();
+            }
+
+            /* a tape keeps copies of strings, the stream is not needed */
+            if (settings.enable_tape && settings.format == JSON) {
+                parser::Message message;
+                if (!parser::json::parse(*stream, impl->tape_, message, options))
+                    exception::failed_to_parse(data, message, POS_);
+                delete stream;
+                return isOpen();
+            }
+
             parser::Message message;
             bool status
                 = parse != NULL
-                ? parse(*stream, tree, message, parser::Settings())
+                ? parse(*stream, tree, message, options)
                 : false
                 ;
 
@@ -558,12 +806,17 @@ namespace experimental
                 // TODO: warnings
                 ;
             }
-            delete stream;
+
+            if (settings.enable_insitu)
+                impl->src_ = stream;
+            else
+                delete stream;
         }
         else if (settings.mode == io::WRITE)
         {
             emitter::Handler * & fsm =  impl->fsm_;
             fsm = new emitter::JsonFSM(stream);
+            impl->base64_ = settings.enable_base64;
         }
 
         return isOpen();
@@ -576,7 +829,10 @@ namespace experimental
 
         return impl != NULL
             &&  (  impl->ast_.empty() == false
+                || impl->tape_.empty() == false
                 || impl->fsm_ != NULL
+                || impl->rec_ != NULL
+                || impl->lazy_ != NULL
                 )
             ;
     }
@@ -586,24 +842,63 @@ namespace experimental
         if (impl->ast_.empty() == false) {
             //impl->ast_.pool().allocator<char>().report();
             //impl->ast_.pool().allocator<ast::Node<char>>().report();
+            //impl->ast_.keys().report();
             impl->ast_.clear();
             //impl->ast_.pool().allocator<char>().report();
             //impl->ast_.pool().allocator<ast::Node<char>>().report();
         }
+        if (impl->tape_.empty() == false)
+            impl->tape_.clear();
+        if (impl->rec_ != NULL) {
+            delete (impl->rec_);
+            impl->rec_ = NULL;
+            impl->name_.clear();
+        }
+        if (impl->lazy_ != NULL) {
+            delete (impl->lazy_);
+            impl->lazy_ = NULL;
+        }
+        if (impl->src_ != NULL) {
+            delete (impl->src_);
+            impl->src_ = NULL;
+        }
         if (impl->fsm_ != NULL) {
             delete (impl->fsm_);
             impl->fsm_ = NULL;
         }
+        impl->base64_ = false;
     }
 
-    FileNode FileStorage::root(int /* streamidx*/ ) const
+    FileNode FileStorage::root(int streamidx) const
     {
         if (impl == NULL)
             exception::invalid_filestorage(POS_);
 
-        FileNode rv;
-        rv.impl = new FileNode::Impl(impl->ast_.root(), impl->ast_.pool());
-        return rv;
+        if (impl->tape_.empty() == false)
+            return FileNode::Impl::make(impl->tape_.root());
+        if (impl->lazy_ != NULL)
+            return FileNode::Impl::make(*impl->lazy_, impl->lazy_->root());
+        if (impl->rec_ == NULL)
+            return FileNode::Impl::make(impl->ast_.root(), impl->ast_.pool());
+
+        /* records are read forward, and the last one is invalidated */
+        parser::json::RecordReader & rec = *(impl->rec_);
+        size_t index = static_cast<size_t>(streamidx);
+        if (streamidx < 0)
+            exception::index_out_of_range(index, POS_);
+
+        while (rec.done() == false && rec.index() < index)
+            rec.next();
+
+        if (rec.done()) {
+            if (rec.message().empty() == false)
+                exception::failed_to_parse(impl->name_, rec.message(), POS_);
+            return FileNode(); /* no more records */
+        }
+        if (rec.index() != index)
+            exception::index_out_of_range(index, POS_);
+
+        return FileNode::Impl::make(rec.record(), rec.pool());
     }
 
     static inline void tab(size_t level)
@@ -615,9 +910,8 @@ namespace experimental
     {
         switch (ch)
         {
-        case '\\': return "\\";
-        case '\'': return "'";
-        case '\"': return "\"";
+        case '\\': return "\\\\";
+        case '\"': return "\\\"";
         case '\n': return "\\n";
         case '\r': return "\\r";
         case '\t': return "\\t";
@@ -685,6 +979,28 @@ namespace experimental
             std::cout << '}';
             break;
         }
+        case I64_ARR:
+        {
+            std::cout << '[';
+            typedef int64_t const * const_iter;
+            const_iter iter_beg = node.begin<I64_ARR>();
+            const_iter iter_end = node.  end<I64_ARR>();
+            for (const_iter iter = iter_beg; iter != iter_end; ++iter)
+                std::cout << (iter == iter_beg ? "" : ", ") << *iter;
+            std::cout << ']';
+            break;
+        }
+        case DBL_ARR:
+        {
+            std::cout << '[';
+            typedef double const * const_iter;
+            const_iter iter_beg = node.begin<DBL_ARR>();
+            const_iter iter_end = node.  end<DBL_ARR>();
+            for (const_iter iter = iter_beg; iter != iter_end; ++iter)
+                std::cout << (iter == iter_beg ? "" : ", ") << *iter;
+            std::cout << ']';
+            break;
+        }
         default: { std::cout << "UNEXPECTED NODE!"; return; }
         }
     }
@@ -756,4 +1072,53 @@ namespace experimental
             *(impl->fsm_) << event;
         }
     }
+
+    /* numbers as a sequence, or as a block of `code::block` */
+    template<emitter::EventTag OUT, typename ValueType> static inline void
+        write_array(emitter::Handler & fsm, ValueType const * val, size_t cnt,
+                    bool base64)
+    {
+        if (base64) {
+            if (cnt > 0xffffffffU) /* `count` of the header */
+                exception::size_not_allowed(cnt, POS_);
+
+            String block;
+            block.resize(code::block::encode_size(cnt));
+            emitter::Event<emitter::OUT_STR> event; {
+                event.val = block;
+                event.len = code::block::encode(val, cnt, block);
+            }
+            fsm << event;
+            return;
+        }
+
+        fsm << emitter::Event<emitter::BEG_SEQ>();
+        for (size_t i = 0; i < cnt; ++i) {
+            emitter::Event<OUT> event; {
+                event.val = val[i];
+            }
+            fsm << event;
+        }
+        fsm << emitter::Event<emitter::END_SEQ>();
+    }
+
+    void FileStorage::write(const int64_t * val, size_t cnt)
+    {
+        if (impl == NULL || impl->fsm_ == NULL)
+            exception::invalid_filestorage(POS_);
+        if (val == NULL && cnt != 0)
+            exception::null_argument("const int64_t * val", POS_);
+
+        write_array<emitter::OUT_INT>(*(impl->fsm_), val, cnt, impl->base64_);
+    }
+
+    void FileStorage::write(const double * val, size_t cnt)
+    {
+        if (impl == NULL || impl->fsm_ == NULL)
+            exception::invalid_filestorage(POS_);
+        if (val == NULL && cnt != 0)
+            exception::null_argument("const double * val", POS_);
+
+        write_array<emitter::OUT_DBL>(*(impl->fsm_), val, cnt, impl->base64_);
+    }
 }
@@ -5,6 +5,8 @@
 #ifndef __PERSISTENCE_HPP__
 #define __PERSISTENCE_HPP__
 
+#include <stdint.h>
+
 namespace experimental
 {
     /************************************************************************
@@ -21,11 +23,7 @@ namespace experimental
     class FileNode
     {
     public:
-         FileNode();
-        ~FileNode();
-
-        FileNode              (const FileNode & rhs);
-        FileNode & operator = (const FileNode & rhs);
+        FileNode(); /* a handle, copy it by value */
 
     public:
         FileNode operator [] (      size_t index) const;
@@ -38,12 +36,20 @@ namespace experimental
     public:
         bool empty() const;
 
+        /* values of a sequence that is packed into numbers of one type,
+         * NULL if it is not; `size` is the number of values */
+        const int64_t * raw_i64(size_t & size) const;
+        const double  * raw_dbl(size_t & size) const;
+
     private:
         friend class FileStorage;
 
     private:
         class Impl;
-        Impl* impl; // std::unique_ptr<Impl> impl;
+        void * node; /* ast::Node<char>, tape::Document or LazyTree::Item */
+        void * pool; /* ast::ArenaPool, NULL for a tape, or LazyTree      */
+        size_t item; /* of a packed sequence in `node`, or -1; of the
+                      * word in a tape; -2 for a lazy one                 */
     };
 
     /************************************************************************
@@ -96,6 +102,13 @@ namespace experimental
         void release();
         // TODO: string releaseAndGetString();
 
+        /* with "file.json?records", `streamidx` is the index of a record
+         * of JSON lines. Records are read forward, a record is valid until
+         * the next one is read, and an empty node is after the last one.
+         * With "file.json?tape", the file is read into a tape instead of
+         * a tree, see `tape::Document`. With "file.json?lazy", large
+         * containers are parsed when they are visited first, and errors
+         * in them are found then, see `parser::json::LazyTree`. */
         FileNode root(int streamidx = 0) const;
 
         void test_dump() const;
@@ -105,6 +118,12 @@ namespace experimental
         void write(double val);
         void write(const char * val, size_t len = 0);
 
+        /* a sequence of numbers, which is one base64 string with
+         * "file.json?base64", see `code::block`. It is read back as
+         * a packed sequence, see `FileNode::raw_i64`. */
+        void write(const int64_t * val, size_t cnt);
+        void write(const double  * val, size_t cnt);
+
     private:
         FileStorage              (const FileStorage & rhs) /* = delete */;
         FileStorage & operator = (const FileStorage & rhs) /* = delete */;
@@ -30,6 +30,14 @@ namespace ast
         //cv::allocator
     > Pool;
 
+    /* for trees that are built once and then only read */
+    typedef storage::Pool<
+        typename utility::tl::MakeList<
+            Node<char>, char
+        >::type,
+        storage::Arena
+    > ArenaPool;
+
     static inline const char * to_string(Tag tag)
     {
         switch (tag)
@@ -40,77 +48,304 @@ namespace ast
         case STR: return "string";
         case SEQ: return "sequence";
         case MAP: return "map";
+        case I64_ARR: return "int64 array";
+        case DBL_ARR: return "double array";
         default:  return "error type";
         }
     }
 
     /***********************************************************************
-     * declaration Tree
+     * declaration Interner
+     ***********************************************************************/
+
+    /* a table of long strings, e.g. keys of maps. Equal strings share one
+     * immutable copy that nodes refer to, see `Node::refer`. */
+    template<typename CharType>
+    class Interner
+    {
+    public:
+        /* shorter strings are small strings of nodes anyway */
+        static const size_t MIN_LENGTH = 14U / sizeof(CharType);
+
+    public:
+        Interner();
+
+    public:
+        /* the shared copy of [str, str + len), which ends with '\0'.
+         * NULL if `len` is less than `MIN_LENGTH`. */
+        inline CharType * intern(CharType const * str, size_t len);
+
+        inline void clear();
+        inline void splice(Interner & other); /* strings of other live on */
+
+        inline size_t size () const; /* of shared copies          */
+        inline size_t saved() const; /* bytes of copies not made  */
+        inline void  report() const;
+
+    private:
+        Interner            (Interner const &);
+        Interner & operator=(Interner const &);
+
+    private:
+        struct Entry
+        {
+            CharType * str;
+            uint32_t   len;
+            uint32_t   hsh;
+        };
+
+        static const size_t MIN_SLOTS = 256U;
+
+        static inline uint32_t hash(CharType const * str, size_t len);
+        inline void rehash(size_t slots);
+
+    private:
+        typedef chars::Buffer<Entry, 1U, std::allocator> Table;
+
+        storage::Arena<CharType> arena_;
+        Table                    table_; /* open addressing */
+        size_t                   count_;
+        size_t                   bytes_; /* of shared copies */
+        size_t                   saved_;
+    };
+
+    /***********************************************************************
+     * implementation Interner
      ***********************************************************************/
 
     template<typename CharType>
+    inline Interner<CharType>::Interner()
+        : arena_()
+        , table_()
+        , count_(0U)
+        , bytes_(0U)
+        , saved_(0U)
+    {}
+
+    template<typename CharType>
+    inline CharType * Interner<CharType>::
+        intern(CharType const * str, size_t len)
+    {
+        if (len < MIN_LENGTH)
+            return NULL;
+        if ((count_ + 1U) * 2U > table_.size())
+            rehash(table_.empty() ? MIN_SLOTS : table_.size() * 2U);
+
+        uint32_t hsh = hash(str, len);
+        size_t   msk = table_.size() - 1U;
+        size_t   pos = hsh & msk;
+        for (; table_[pos].str != NULL; pos = (pos + 1U) & msk) {
+            Entry const & entry = table_[pos];
+            if (entry.hsh == hsh && entry.len == len &&
+                ::memcmp(entry.str, str, len * sizeof(CharType)) == 0) {
+                saved_ += (len + 1U) * sizeof(CharType);
+                return entry.str;
+            }
+        }
+
+        CharType * copy = arena_.allocate(len + 1U);
+        ::memcpy(copy, str, len * sizeof(CharType));
+        copy[len] = CharType();
+
+        Entry & entry = table_[pos];
+        entry.str = copy;
+        entry.len = static_cast<uint32_t>(len);
+        entry.hsh = hsh;
+        count_ += 1U;
+        bytes_ += (len + 1U) * sizeof(CharType);
+        return copy;
+    }
+
+    template<typename CharType>
+    inline void Interner<CharType>::clear()
+    {
+        arena_.release();
+        table_.clear();
+        count_ = 0U;
+        bytes_ = 0U;
+        saved_ = 0U;
+    }
+
+    template<typename CharType>
+    inline void Interner<CharType>::splice(Interner & other)
+    {
+        /* only memory is taken over, strings of `other` are not shared */
+        arena_.splice(other.arena_);
+        saved_ += other.saved_;
+        other.clear();
+    }
+
+    template<typename CharType>
+    inline size_t Interner<CharType>::size() const
+    {
+        return count_;
+    }
+
+    template<typename CharType>
+    inline size_t Interner<CharType>::saved() const
+    {
+        return saved_;
+    }
+
+    template<typename CharType>
+    inline void Interner<CharType>::report() const
+    {
+        ::printf("=== report begin ===\n");
+        ::printf
+            ( "total %d interned: %f MB, saved: %f MB\n"
+            , static_cast<int>(count_)
+            , bytes_ / 1024.0 / 1024.0
+            , saved_ / 1024.0 / 1024.0
+            );
+        ::printf("=== report end ===\n");
+    }
+
+    template<typename CharType>
+    inline uint32_t Interner<CharType>::
+        hash(CharType const * str, size_t len)
+    {
+        /* FNV-1a */
+        uint32_t h = uint32_t(2166136261U);
+        for (CharType const * end = str + len; str != end; ++str) {
+            h ^= static_cast<uint32_t>(*str);
+            h *= uint32_t(16777619U);
+        }
+        return h;
+    }
+
+    template<typename CharType>
+    inline void Interner<CharType>::rehash(size_t slots)
+    {
+        Table old(table_);
+        table_.clear();
+        table_.resize(slots);
+        ::memset(table_.begin(), 0, slots * sizeof(Entry));
+
+        size_t msk = slots - 1U;
+        for (Entry const * it = old.begin(); it != old.end(); ++it) {
+            if (it->str == NULL)
+                continue;
+            size_t pos = it->hsh & msk;
+            while (table_[pos].str != NULL)
+                pos = (pos + 1U) & msk;
+            table_[pos] = *it;
+        }
+    }
+
+    /***********************************************************************
+     * declaration Tree
+     ***********************************************************************/
+
+    template<typename CharType, typename PoolType = Pool>
     class Tree
     {
     public:
-        typedef Node<CharType> Node;
+        typedef Node<CharType>     Node;
+        typedef PoolType           Pool;
+        typedef Interner<CharType> Keys;
 
     public:
         Tree();
 
     public:
         inline void clear();
+        inline void reset(); /* clear, but keep memory of the pool and keys */
         inline bool empty() const;
         inline Node const & root() const;
         inline Node & root();
         inline Pool & pool();
+        inline Keys & keys(); /* long keys shared by maps, optional */
+
+    private:
+        template<typename NodeType, bool IsReleasable> struct Teardown;
 
     private:
         Node root_;
         Pool pool_;
+        Keys keys_;
     };
 
     /***********************************************************************
      * implementation Tree
      ***********************************************************************/
 
-    template<typename CharType>
-    inline Tree<CharType>::Tree()
+    template<typename CharType, typename PoolType>
+    template<typename NodeType, bool IsReleasable>
+    struct Tree<CharType, PoolType>::Teardown
+    {
+        /* visit and deallocate every node */
+        static inline void apply(NodeType & root, PoolType & pool)
+        {
+            root.destruct(pool);
+        }
+    };
+
+    template<typename CharType, typename PoolType>
+    template<typename NodeType>
+    struct Tree<CharType, PoolType>::Teardown<NodeType, true>
+    {
+        /* pool owns all memory, drop it at once */
+        static inline void apply(NodeType & root, PoolType & pool)
+        {
+            root.construct(pool); /* memory of `root` is gone */
+            pool.release();
+        }
+    };
+
+    template<typename CharType, typename PoolType>
+    inline Tree<CharType, PoolType>::Tree()
         : root_()
         , pool_()
+        , keys_()
     {
         root_.construct(pool_);
     }
 
-    template<typename CharType>
-    inline bool Tree<CharType>::empty() const
+    template<typename CharType, typename PoolType>
+    inline bool Tree<CharType, PoolType>::empty() const
     {
         return (root_.type() == NIL);
     }
 
-    template<typename CharType>
-    inline void Tree<CharType>::clear()
+    template<typename CharType, typename PoolType>
+    inline void Tree<CharType, PoolType>::clear()
     {
-        root_. destruct(pool_);
+        Teardown<Node, PoolType::releasable != 0>::apply(root_, pool_);
         root_.construct(pool_);
+        keys_.clear();
     }
 
-    template<typename CharType>
-    inline Node<CharType> const & Tree<CharType>::root() const
+    template<typename CharType, typename PoolType>
+    inline void Tree<CharType, PoolType>::reset()
+    {
+        /* pool owns all memory, only for pools with `reset` */
+        root_.construct(pool_);
+        pool_.reset();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline Node<CharType> const & Tree<CharType, PoolType>::root() const
     {
         return root_;
     }
 
-    template<typename CharType>
-    inline Node<CharType> & Tree<CharType>::root()
+    template<typename CharType, typename PoolType>
+    inline Node<CharType> & Tree<CharType, PoolType>::root()
     {
         return root_;
     }
 
-    template<typename CharType>
-    inline Pool & Tree<CharType>::pool()
+    template<typename CharType, typename PoolType>
+    inline PoolType & Tree<CharType, PoolType>::pool()
     {
         return pool_;
     }
+
+    template<typename CharType, typename PoolType>
+    inline Interner<CharType> & Tree<CharType, PoolType>::keys()
+    {
+        return keys_;
+    }
 }
 
 CV_FS_PRIVATE_END
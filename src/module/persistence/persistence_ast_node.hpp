@@ -61,7 +61,10 @@ namespace ast
         DBL,     //!< double   [scalar]
         STR,     //!< string   [container]
         SEQ,     //!< sequence [container]
-        MAP      //!< map      [container]
+        MAP,     //!< map      [container]
+
+        I64_ARR, //!< packed int64  [container]
+        DBL_ARR  //!< packed double [container]
     };
 
     /************************************************************************
@@ -72,13 +75,18 @@ namespace ast
     programming easier.
     */
     template<typename NodeType, Tag TAG> struct Traits;
+
+    /** @brief Traits shared by packed arrays, `I64_ARR` and `DBL_ARR`.
+    */
+    template<typename CharType, typename ValueType, Tag TAG>
+    struct PackedTraits;
 }
 
 namespace ast
 {
     /** @brief `Node` is the node type of an abstract syntax tree,
     something like variant. It can be null, int64_t, double, string,
-    sequence, map.
+    sequence, map, or a packed array of int64_t or double.
 
     Some features:
      - always 16 bytes in x86 and x64,
@@ -115,6 +123,7 @@ namespace ast
         /** @brief Make Traits `friend`.
         */
         template<typename, Tag> friend struct Traits;
+        template<typename, typename, Tag> friend struct PackedTraits;
 
     public:
 
@@ -204,6 +213,19 @@ namespace ast
             PoolType & pool
         );
 
+        /** @brief Set a string that refers to [beg, end) instead of a copy.
+
+        Destruct and refer. The string is not in pool and is never
+        deallocated; it is copied on the first growth.
+        [STR only, short strings are still copied]
+        @param beg  Beginning of chars, `*end` must be '\0'.
+        @param end  End of chars. Must live as long as the node.
+        @param pool A collection of allocators. See class `Pool`.
+        */
+        template<typename PoolType> inline
+        void
+        refer(CharType * beg, CharType * end, PoolType & pool);
+
         /** @brief Get `int64_t` or `double` value of node.
 
         [Need to specify the TAG]
@@ -339,6 +361,30 @@ namespace ast
         typename Traits<Node, TAG>::Container::void_type
         clear(PoolType & pool);
 
+        /** @brief Reserve capacity of built-in container, so that adding
+        elements up to `cap` won't reallocate.
+
+        [Need to specify the TAG]
+        [May throw an exception if TAG does not match]
+        @param cap   Number of elements.
+        @param pool  A collection of allocators. See class `Pool`.
+        */
+        template<Tag TAG, typename PoolType> inline
+        typename Traits<Node, TAG>::Container::void_type
+        reserve(size_type cap, PoolType & pool);
+
+        /** @brief Resize built-in container, new elements are default
+        values, e.g. to be filled through `begin<TAG>()`.
+
+        [Need to specify the TAG]
+        [May throw an exception if TAG does not match]
+        @param siz   Number of elements.
+        @param pool  A collection of allocators. See class `Pool`.
+        */
+        template<Tag TAG, typename PoolType> inline
+        typename Traits<Node, TAG>::Container::void_type
+        resize(size_type siz, PoolType & pool);
+
         /** @brief Get first element of built-in container.
 
         [Need to specify the TAG]
@@ -456,6 +502,56 @@ namespace ast
         find
         (typename Traits<Node, TAG>::Container::key_const_reference key);
 
+        /** @overload
+
+        Large containers get a hash index lazily, so that following searches
+        are O(1) on average. The index lives in the pool and keeps track of
+        appended elements. Note: do not modify keys in place once indexed.
+        It writes the node, see `index` for trees that are shared.
+
+        @param key  Key to search. Usually it is the first element of a pair.
+        @param pool A collection of allocators. See class `Pool`.
+        @return Iterator of the element.
+        */
+        template<Tag TAG, typename PoolType> inline
+        typename Traits<Node, TAG>::Container::iterator
+        find
+        (
+            typename Traits<Node, TAG>::Container::key_const_reference key,
+            PoolType & pool
+        );
+
+        /** @overload
+
+        Search by a raw string key, without building a temporary node.
+        [Only MAP is supported]
+        @param key String to search, not necessarily ends with '\0'.
+        @param len Length of `key`.
+        @return Const iterator of the element.
+        */
+        template<Tag TAG> inline
+        typename Traits<Node, TAG>::Container::const_iterator
+        find(CharType const * key, size_type len) const;
+
+        /** @overload
+        @param key  String to search, not necessarily ends with '\0'.
+        @param len  Length of `key`.
+        @param pool A collection of allocators. See class `Pool`.
+        @return Iterator of the element.
+        */
+        template<Tag TAG, typename PoolType> inline
+        typename Traits<Node, TAG>::Container::iterator
+        find(CharType const * key, size_type len, PoolType & pool);
+
+        /**
+        Build or update the hash index of a large container at once, so
+        that searches without a pool are O(1) and never write the node.
+        [Only MAP is supported]
+        @param pool A collection of allocators. See class `Pool`.
+        */
+        template<Tag TAG, typename PoolType> inline
+        void index(PoolType & pool);
+
     private:
 
         typename Traits<Node, NIL>::Layout nil; //!< Memory layout of NIL
@@ -464,6 +560,8 @@ namespace ast
         typename Traits<Node, STR>::Layout str; //!< Memory layout of STR
         typename Traits<Node, SEQ>::Layout seq; //!< Memory layout of SEQ
         typename Traits<Node, MAP>::Layout map; //!< Memory layout of MAP
+        typename Traits<Node, I64_ARR>::Layout
+                                           arr; //!< Memory layout of arrays
     };
 
 }
@@ -720,7 +818,7 @@ namespace ast
                 CharType raw[14 / sizeof(CharType)];
             } sht;
 
-            /* normal(long) string */
+            /* normal(long) string, pad[2] is flags */
             struct
             {
                 uint8_t  pad[3];
@@ -737,6 +835,9 @@ namespace ast
     private:
         static const uint8_t LONG = uint8_t(~uint8_t());
 
+        /* flags of long string */
+        static const uint8_t REF  = uint8_t(1); /* not in pool, see refer */
+
     private:
         static inline
         bool
@@ -745,6 +846,12 @@ namespace ast
             return node.str.sht.siz != LONG;
         }
         static inline
+        bool
+        is_reference(Node const & node)
+        {
+            return (node.str.lng.pad[2] & REF) != 0;
+        }
+        static inline
         void
         update(Node & node, size_type siz)
         {
@@ -771,7 +878,7 @@ namespace ast
         destruct(Node & node, PoolType & pool)
         {
             typedef typename Container::pointer pointer;
-            if (is_smallstring(node) == false) {
+            if (is_smallstring(node) == false && !is_reference(node)) {
                 pointer   mem = raw(node);
                 size_type cap = capacity(node) + size_type(1);
                 pool.deallocate(mem, cap);
@@ -803,6 +910,8 @@ namespace ast
         {
             if (size(lhs) != size(rhs))
                 return false;
+            if (raw(lhs) == raw(rhs))
+                return true; /* e.g. both refer to an interned key */
 
             typedef typename Container::value_type value_type;
             size_type mem_siz = (size(lhs) + 1) * sizeof(value_type);
@@ -828,6 +937,8 @@ namespace ast
             return static_cast<size_type>
                 ( is_smallstring(node)
                 ? (14 / sizeof(CharType))
+                : is_reference(node)
+                ? node.str.lng.siz
                 : Node::Cap::at(node.str.lng.exp)
                 )
                 -
@@ -875,11 +986,12 @@ namespace ast
             ::memcpy(mem, old, mem_siz);
 
             /* release old space */
-            if (is_smallstring(node) == false)
+            if (is_smallstring(node) == false && !is_reference(node))
                 pool.deallocate(old, capacity(node) + size_type(1));
 
             /* update */
             node.str.sht.siz = LONG;
+            node.str.lng.pad[2]  = 0;
             node.str.lng.siz     = siz;
             node.str.lng.exp     = exp;
             node.str.lng.raw.ptr = mem;
@@ -908,6 +1020,26 @@ namespace ast
             siz += 1; /* '\0' at end */
             update(node, siz);
         }
+        static inline
+        void
+        refer(Node & node, CharType * str, size_type siz)
+        {
+            typedef typename Container::value_type value_type;
+
+            node.str.tag = TAG;
+            if (siz < 14 / sizeof(CharType)) {
+                ::memcpy(node.str.sht.raw, str, siz * sizeof(value_type));
+                node.str.sht.raw[siz] = CharType();
+                node.str.sht.siz = static_cast<uint8_t>(siz + 1);
+                return;
+            }
+
+            node.str.sht.siz     = LONG;
+            node.str.lng.pad[2]  = REF;
+            node.str.lng.exp     = 0;
+            node.str.lng.siz     = siz + 1; /* '\0' at end */
+            node.str.lng.raw.ptr = str;
+        }
     };
 
     /************************************************************************
@@ -1176,7 +1308,8 @@ namespace ast
         struct Layout
         {
             uint8_t  tag;
-            uint8_t  pad[2];
+            uint8_t  flg;
+            uint8_t  pad;
             uint8_t  exp;
             uint32_t siz;
             union
@@ -1186,6 +1319,193 @@ namespace ast
             }        raw;
         };
 
+        /* maps of at least this size get a hash index on `find` */
+        static const size_type INDEX_THRESHOLD = 16U;
+
+    private:
+        static const uint8_t INDEXED = uint8_t(1);
+
+        /* hash index, stored in an extra node in front of pairs */
+        struct Index
+        {
+            uint32_t * tab; /* open addressing, `1 + index of pair`      */
+            uint32_t   msk; /* size of `tab` - 1, size is a power of 2   */
+            uint32_t   cnt; /* pairs in [0, cnt) are indexed             */
+        };
+
+        static const uint32_t MIN_SLOTS = INDEX_THRESHOLD * 4U;
+
+    private:
+        static inline
+        bool
+        is_indexed(Node const & node)
+        {
+            return (node.map.flg & INDEXED) != 0;
+        }
+        static inline
+        Index &
+        index_of(Node const & node)
+        {
+            return *reinterpret_cast<Index *>
+                (reinterpret_cast<Node *>(node.map.raw.ptr) - 1);
+        }
+        static inline
+        Node *
+        block(Node const & node)
+        {
+            return reinterpret_cast<Node *>(node.map.raw.ptr)
+                - (is_indexed(node) ? 1 : 0);
+        }
+        static inline
+        size_type
+        block_size(Node const & node)
+        {
+            return (capacity(node) << 1) + (is_indexed(node) ? 1 : 0);
+        }
+        static inline
+        size_type
+        table_size(uint32_t slots)
+        {
+            /* table is allocated as nodes */
+            return static_cast<size_type>
+                (slots * sizeof(uint32_t) / sizeof(Node));
+        }
+        static inline
+        uint32_t
+        mix(uint64_t x)
+        {
+            x ^= x >> 33;
+            x *= uint64_t(0xFF51AFD7ED558CCDULL);
+            x ^= x >> 33;
+            return static_cast<uint32_t>(x);
+        }
+        static inline
+        void
+        insert(Index & idx, typename Container::const_pointer pairs,
+               uint32_t pos)
+        {
+            Node const & key = pairs[pos][0];
+            uint32_t i = hash(key) & idx.msk;
+            for (uint32_t cur; (cur = idx.tab[i]) != 0; i = (i+1) & idx.msk)
+                if (Container::equal(pairs[cur - 1], key))
+                    return; /* keep the first one */
+            idx.tab[i] = pos + 1;
+        }
+
+        /* a key of raw string, compared without building a node */
+        struct StrKey
+        {
+            CharType const * str;
+            size_type        len;
+        };
+        static inline
+        bool
+        match(typename Container::const_reference pair, Node const & key)
+        {
+            return Container::equal(pair, key);
+        }
+        static inline
+        bool
+        match(typename Container::const_reference pair, StrKey const & key)
+        {
+            Node const & lhs = pair[0];
+            return lhs.type() == STR
+                && lhs.template size<STR>() == key.len
+                && (lhs.template raw<STR>() == key.str ||
+                    ::memcmp(lhs.template raw<STR>(), key.str,
+                             key.len * sizeof(CharType)) == 0)
+                ;
+        }
+        static inline
+        uint32_t
+        hash(StrKey const & key)
+        {
+            return hash(key.str, key.len);
+        }
+        template<typename KeyType>
+        static inline
+        typename Container::const_iterator
+        search(Node const & node, KeyType const & key)
+        {
+            typedef typename Container::const_pointer const_pointer;
+
+            const_pointer beg = raw(node);
+            const_pointer end = beg + size(node);
+            const_pointer cur = beg;
+
+            if (is_indexed(node)) {
+                Index const & idx = index_of(node);
+                uint32_t i = hash(key) & idx.msk;
+                for (uint32_t pos; (pos = idx.tab[i]) != 0; i = (i+1)&idx.msk)
+                    if (match(beg[pos - 1], key))
+                        return beg + (pos - 1);
+                cur = beg + idx.cnt;
+            }
+
+            for (; cur < end; ++cur)
+                if (match(*cur, key))
+                    return cur;
+            return end;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        rehash(Node & node, size_type need, PoolType & pool)
+        {
+            Index & idx = index_of(node);
+
+            uint32_t slots = MIN_SLOTS;
+            while (slots < (need << 1))
+                slots <<= 1;
+
+            Node * mem = pool.template allocate<Node>(table_size(slots));
+            ::memset(mem, 0, slots * sizeof(uint32_t));
+
+            if (idx.tab != NULL)
+                pool.deallocate(reinterpret_cast<Node *>(idx.tab),
+                                table_size(idx.msk + 1));
+
+            idx.tab = reinterpret_cast<uint32_t *>(mem);
+            idx.msk = slots - 1;
+            idx.cnt = 0;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        attach(Node & node, PoolType & pool)
+        {
+            typedef typename utility::Assert
+            <
+                sizeof(Index) <= sizeof(Node)
+            >::type index_must_fit_in_a_node_t;
+
+            /* move pairs to a block with a header in front of it */
+            size_type siz = capacity(node) << 1;
+            Node    * mem = pool.template allocate<Node>(siz + 1);
+            Node    * old = block(node);
+            ::memcpy(mem + 1, old, sizeof(Node) * (size(node) << 1));
+            if (old != NULL)
+                pool.deallocate(old, siz);
+
+            Index & idx = *reinterpret_cast<Index *>(mem);
+            idx.tab = NULL;
+            idx.msk = 0;
+            idx.cnt = 0;
+
+            node.map.raw.ptr = reinterpret_cast
+                <typename Container::pointer>(mem + 1);
+            node.map.flg    |= INDEXED;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        detach(Node & node, PoolType & pool)
+        {
+            Index & idx = index_of(node);
+            pool.deallocate(reinterpret_cast<Node *>(idx.tab),
+                            table_size(idx.msk + 1));
+        }
+
     public:
         template<typename PoolType>
         static inline
@@ -1195,6 +1515,7 @@ namespace ast
             node.map.raw.ptr = NULL;
             node.map.siz = 0;
             node.map.exp = 0;
+            node.map.flg = 0;
             node.map.tag = TAG;
         }
         template<typename PoolType>
@@ -1211,12 +1532,12 @@ namespace ast
                 (*cur)[1].destruct(pool);
             }
 
-            if (beg != NULL) {
-                Node *  mem = reinterpret_cast<Node *>(beg);
-                size_type siz = capacity(node) << 1;
-                pool.deallocate(mem, siz);
-            }
+            if (is_indexed(node))
+                detach(node, pool);
+            if (beg != NULL)
+                pool.deallocate(block(node), block_size(node));
 
+            node.map.flg = 0;
             node.map.tag = NIL;
         }
         template<typename PoolType>
@@ -1302,12 +1623,14 @@ namespace ast
 
             typedef typename Container::pointer pointer;
 
-            /* alloc new space */
-            uint8_t exp = Node::Cap::right(cap);
-                    cap = Node::Cap::at(exp);
-            pointer mem = reinterpret_cast<pointer>(
-                pool.template allocate<Node>(cap << 1)
-            );
+            /* alloc new space, keep the header of index if any */
+            size_type hdr = is_indexed(node) ? 1 : 0;
+            uint8_t   exp = Node::Cap::right(cap);
+                      cap = Node::Cap::at(exp);
+            Node    * blk = pool.template allocate<Node>((cap << 1) + hdr);
+            pointer   mem = reinterpret_cast<pointer>(blk + hdr);
+            if (hdr != 0)
+                ::memcpy(blk, block(node), sizeof(Node));
 
             /* move */
             pointer beg = raw(node);
@@ -1321,11 +1644,8 @@ namespace ast
             }
 
             /* release */
-            if (beg != NULL) {
-                Node *  old = reinterpret_cast<Node *>(beg);
-                size_type siz = capacity(node) << 1;
-                pool.deallocate(old, siz);
-            }
+            if (beg != NULL)
+                pool.deallocate(block(node), block_size(node));
 
             /* update */
             node.map.exp     = exp;
@@ -1353,10 +1673,288 @@ namespace ast
                 (*cur)[1]. destruct(pool);
             }
 
+            /* pairs may have been moved (erase), forget all of them */
+            if (end < beg && is_indexed(node)) {
+                Index & idx = index_of(node);
+                ::memset(idx.tab, 0, (idx.msk + 1) * sizeof(uint32_t));
+                idx.cnt = 0;
+            }
+
             node.map.siz = siz;
         }
+        static inline
+        uint32_t
+        hash(CharType const * str, size_type len)
+        {
+            /* FNV-1a */
+            uint32_t h = uint32_t(2166136261U) ^ uint32_t(STR);
+            for (CharType const * end = str + len; str != end; ++str) {
+                h ^= static_cast<uint32_t>(*str);
+                h *= uint32_t(16777619U);
+            }
+            return h;
+        }
+        static inline
+        uint32_t
+        hash(Node const & key)
+        {
+            switch (key.type())
+            {
+            case I64:
+            {
+                uint64_t bits = static_cast<uint64_t>(key.template val<I64>());
+                return mix(bits ^ uint64_t(I64));
+            }
+            case DBL:
+            {
+                double   val  = key.template val<DBL>();
+                uint64_t bits = 0;
+                if (val != 0.0) /* 0.0 == -0.0 */
+                    ::memcpy(&bits, &val, sizeof(bits));
+                return mix(bits ^ uint64_t(DBL));
+            }
+            case STR:
+                return hash(key.template raw<STR>(), key.template size<STR>());
+            case SEQ:
+                return mix(uint64_t(key.template size<SEQ>()) << 8 | SEQ);
+            case MAP:
+                return mix(uint64_t(key.template size<MAP>()) << 8 | MAP);
+            default:
+                return mix(uint64_t(key.type()));
+            }
+        }
+        static inline
+        typename Container::const_iterator
+        find(Node const & node, typename Container::key_const_reference key)
+        {
+            return search(node, key);
+        }
+        static inline
+        typename Container::const_iterator
+        find(Node const & node, CharType const * str, size_type len)
+        {
+            StrKey key = { str, len };
+            return search(node, key);
+        }
+        template<typename PoolType>
+        static inline
+        void
+        index(Node & node, PoolType & pool)
+        {
+            size_type siz = size(node);
+            if (siz < INDEX_THRESHOLD)
+                return;
+
+            if (is_indexed(node) == false)
+                attach(node, pool);
+
+            Index & idx = index_of(node);
+            if (idx.cnt == siz)
+                return;
+            if (idx.tab == NULL || (siz << 1) > idx.msk + 1)
+                rehash(node, siz, pool);
+
+            typename Container::const_pointer pairs = raw(node);
+            for (; idx.cnt < siz; ++idx.cnt)
+                insert(idx, pairs, idx.cnt);
+        }
+    };
+
+    /************************************************************************
+     * I64_ARR, DBL_ARR
+     ***********************************************************************/
+
+    /* layout of packed arrays, values are kept in a block of nodes */
+    template<typename CharType>
+    struct PackedLayout
+    {
+        uint8_t  tag;
+        uint8_t  pad[2];
+        uint8_t  exp;
+        uint32_t siz;
+        union
+        {
+            Node<CharType> * ptr;
+            uint64_t         pad;
+        }        raw;
+    };
+
+    template<typename CharType, typename ValueType, Tag PACKED>
+    struct PackedTraits
+    {
+    public:
+        static const Tag TAG = PACKED;
+
+    public:
+        typedef Node<CharType>           Node;
+        typedef typename Node::size_type size_type;
+
+        struct Container
+        {
+            typedef ValueType          value_type;
+            typedef value_type       *       pointer;
+            typedef value_type const * const_pointer;
+            typedef value_type       &       reference;
+            typedef value_type const & const_reference;
+            typedef       pointer                    iterator;
+            typedef const_pointer              const_iterator;
+            typedef       pointer            reverse_iterator; /* TODO: */
+            typedef const_pointer      const_reverse_iterator; /* TODO: */
+            typedef size_type          index_type;
+            typedef void               void_type;
+
+            template<typename PoolType>
+            static inline void copy
+            (reference lhs, const_reference rhs, PoolType & /*pool*/)
+            {
+                lhs = rhs;
+            }
+            template<typename PoolType>
+            static inline void move
+            (reference lhs, reference rhs, PoolType & /*pool*/)
+            {
+                lhs = rhs;
+            }
+        };
+
+    public:
+        typedef PackedLayout<CharType> Layout;
+
+    private:
+        static inline
+        size_type
+        blocks(size_type cap)
+        {
+            return static_cast<size_type>
+                ((cap * sizeof(ValueType) + sizeof(Node) - 1) / sizeof(Node));
+        }
+
+    public:
+        template<typename PoolType>
+        static inline
+        void
+        construct(Node & node, PoolType & /*pool*/)
+        {
+            node.arr.raw.ptr = NULL;
+            node.arr.siz = 0;
+            node.arr.exp = 0;
+            node.arr.tag = TAG;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        destruct(Node & node, PoolType & pool)
+        {
+            if (node.arr.raw.ptr != NULL)
+                pool.deallocate(node.arr.raw.ptr, blocks(capacity(node)));
+            node.arr.tag = NIL;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        copy(Node & lhs, Node const & rhs, PoolType & pool)
+        {
+            size_type siz = size(rhs);
+            destruct (lhs, pool);
+            construct(lhs, pool);
+            reserve  (lhs, siz, pool);
+
+            if (siz != 0)
+                ::memcpy(raw(lhs), raw(rhs), siz * sizeof(ValueType));
+            lhs.arr.siz = siz;
+        }
+        static inline
+        bool
+        equal(Node const & lhs, Node const & rhs)
+        {
+            if (size(lhs) != size(rhs))
+                return false;
+
+            typedef typename Container::const_pointer const_pointer;
+            const_pointer ilhs = raw(lhs);
+            const_pointer irhs = raw(rhs);
+            const_pointer iend = irhs + size(rhs);
+            for (; irhs != iend; ++ilhs, ++irhs)
+                if (!(*ilhs == *irhs))
+                    return false;
+
+            return true;
+        }
+        static inline
+        size_type
+        size(Node const & node)
+        {
+            return static_cast<size_type>(node.arr.siz);
+        }
+        static inline
+        size_type
+        capacity(Node const & node)
+        {
+            return static_cast<size_type>(Node::Cap::at(node.arr.exp));
+        }
+        static inline
+        typename Container::const_pointer
+        raw(Node const & node)
+        {
+            return reinterpret_cast<typename Container::const_pointer>
+                (node.arr.raw.ptr);
+        }
+        static inline
+        typename Container::pointer
+        raw(Node & node)
+        {
+            return const_cast<typename Container::pointer>
+                (raw(static_cast<Node const &>(node)));
+        }
+        template<typename PoolType>
+        static inline
+        void
+        reserve(Node & node, size_type cap, PoolType & pool)
+        {
+            if (cap <= capacity(node))
+                return;
+
+            /* alloc new space */
+            uint8_t exp = Node::Cap::right(cap);
+                    cap = Node::Cap::at(exp);
+            Node *  mem = pool.template allocate<Node>(blocks(cap));
+
+            /* move and release */
+            Node *  old = node.arr.raw.ptr;
+            if (old != NULL) {
+                ::memcpy(mem, old, size(node) * sizeof(ValueType));
+                pool.deallocate(old, blocks(capacity(node)));
+            }
+
+            /* update */
+            node.arr.exp     = exp;
+            node.arr.raw.ptr = mem;
+        }
+        template<typename PoolType>
+        static inline
+        void
+        resize(Node & node, size_type siz, PoolType & pool)
+        {
+            reserve(node, siz, pool);
+
+            typename Container::pointer beg = raw(node) + size(node);
+            typename Container::pointer end = raw(node) + siz;
+            for (typename Container::pointer cur = beg; cur < end; ++cur)
+                (*cur) = ValueType();
+
+            node.arr.siz = siz;
+        }
     };
 
+    template<typename CharType>
+    struct Traits<Node<CharType>, I64_ARR>
+        : public PackedTraits<CharType, int64_t, I64_ARR>
+    {};
+
+    template<typename CharType>
+    struct Traits<Node<CharType>, DBL_ARR>
+        : public PackedTraits<CharType, double, DBL_ARR>
+    {};
 }
 
 namespace ast
@@ -1383,6 +1981,8 @@ namespace ast
         case STR: { construct<STR>(pool); break; }
         case SEQ: { construct<SEQ>(pool); break; }
         case MAP: { construct<MAP>(pool); break; }
+        case I64_ARR: { construct<I64_ARR>(pool); break; }
+        case DBL_ARR: { construct<DBL_ARR>(pool); break; }
         default:  { exception::node_type_out_of_range(tag, POS_); break; }
         }
     }
@@ -1405,6 +2005,8 @@ namespace ast
         case STR: { Traits<Node, STR>::destruct(*this, pool); break; }
         case SEQ: { Traits<Node, SEQ>::destruct(*this, pool); break; }
         case MAP: { Traits<Node, MAP>::destruct(*this, pool); break; }
+        case I64_ARR: { Traits<Node, I64_ARR>::destruct(*this, pool); break; }
+        case DBL_ARR: { Traits<Node, DBL_ARR>::destruct(*this, pool); break; }
         default:  { exception::node_type_out_of_range(tag, POS_); break; }
         }
     }
@@ -1431,6 +2033,10 @@ namespace ast
             case STR: { Traits<Node, STR>::copy(lhs, rhs, pool); break; }
             case SEQ: { Traits<Node, SEQ>::copy(lhs, rhs, pool); break; }
             case MAP: { Traits<Node, MAP>::copy(lhs, rhs, pool); break; }
+            case I64_ARR:
+                { Traits<Node, I64_ARR>::copy(lhs, rhs, pool); break; }
+            case DBL_ARR:
+                { Traits<Node, DBL_ARR>::copy(lhs, rhs, pool); break; }
             default:  { exception::node_type_out_of_range(tag,POS_); break; }
             }
         }
@@ -1513,6 +2119,8 @@ namespace ast
         case STR: { return Traits<Node, STR>::equal(lhs, rhs); break; }
         case SEQ: { return Traits<Node, SEQ>::equal(lhs, rhs); break; }
         case MAP: { return Traits<Node, MAP>::equal(lhs, rhs); break; }
+        case I64_ARR: { return Traits<Node, I64_ARR>::equal(lhs, rhs); }
+        case DBL_ARR: { return Traits<Node, DBL_ARR>::equal(lhs, rhs); }
         default:  { exception::node_type_out_of_range(tag,POS_); break; }
         }
 
@@ -1572,6 +2180,15 @@ namespace ast
         }
     }
 
+    template<typename CharType> template<typename PoolType>
+    inline void Node<CharType>::
+    refer(CharType * ibeg, CharType * iend, PoolType & pool)
+    {
+        destruct(pool);
+        size_type len = static_cast<size_type>(iend - ibeg);
+        Traits<Node, STR>::refer(*this, ibeg, len);
+    }
+
     template<typename CharType> template<Tag TAG>
     inline typename Traits<Node<CharType>, TAG>::const_reference
     Node<CharType>::
@@ -1776,6 +2393,32 @@ namespace ast
         Traits<Node, TAG>::resize(*this, 0, pool);
     }
 
+    template<typename CharType> template<Tag TAG, typename PoolType>
+    inline typename Traits<Node<CharType>, TAG>::Container::
+    void_type Node<CharType>::
+    reserve(size_type cap, PoolType & pool)
+    {
+        if (type() == NIL)
+            Traits<Node, TAG>::construct(*this, pool);
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        Traits<Node, TAG>::reserve(*this, cap, pool);
+    }
+
+    template<typename CharType> template<Tag TAG, typename PoolType>
+    inline typename Traits<Node<CharType>, TAG>::Container::
+    void_type Node<CharType>::
+    resize(size_type siz, PoolType & pool)
+    {
+        if (type() == NIL)
+            Traits<Node, TAG>::construct(*this, pool);
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        Traits<Node, TAG>::resize(*this, siz, pool);
+    }
+
     template<typename CharType> template<Tag TAG>
     inline typename Traits<Node<CharType>, TAG>::Container::
     const_iterator Node<CharType>::
@@ -1899,16 +2542,7 @@ namespace ast
         if (type() != TAG)
             exception::node_type_not_match(type(), TAG, POS_);
 
-        typedef typename Traits<Node, TAG>::Container Container;
-        typedef typename Container::const_iterator      const_iterator;
-
-        const_iterator ibeg = begin<TAG>();
-        const_iterator iend = end  <TAG>();
-        for (const_iterator iter = ibeg; iter < iend; ++iter)
-            if (Container::equal((*iter), key))
-                return iter;
-
-        return iend;
+        return Traits<Node, TAG>::find(*this, key);
     }
 
     template<typename CharType> template<Tag TAG>
@@ -1919,6 +2553,58 @@ namespace ast
         return const_cast<typename Traits<Node, TAG>::Container::iterator>
             (static_cast<Node const &>(*this).find<TAG>(key));
     }
+
+    template<typename CharType> template<Tag TAG, typename PoolType>
+    inline typename Traits<Node<CharType>, TAG>::Container::
+    iterator Node<CharType>::
+    find
+    (
+        typename Traits<Node, TAG>::Container::key_const_reference key,
+        PoolType & pool
+    )
+    {
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        Traits<Node, TAG>::index(*this, pool);
+        return find<TAG>(key);
+    }
+
+    template<typename CharType> template<Tag TAG>
+    inline typename Traits<Node<CharType>, TAG>::Container::
+    const_iterator Node<CharType>::
+    find(CharType const * key, size_type len) const
+    {
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        return Traits<Node, TAG>::find(*this, key, len);
+    }
+
+    template<typename CharType> template<Tag TAG, typename PoolType>
+    inline typename Traits<Node<CharType>, TAG>::Container::
+    iterator Node<CharType>::
+    find(CharType const * key, size_type len, PoolType & pool)
+    {
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        typedef typename Traits<Node, TAG>::Container::iterator iterator;
+
+        Traits<Node, TAG>::index(*this, pool);
+        return const_cast<iterator>
+            (Traits<Node, TAG>::find(*this, key, len));
+    }
+
+    template<typename CharType> template<Tag TAG, typename PoolType>
+    inline void Node<CharType>::
+    index(PoolType & pool)
+    {
+        if (type() != TAG)
+            exception::node_type_not_match(type(), TAG, POS_);
+
+        Traits<Node, TAG>::index(*this, pool);
+    }
 }
 
 CV_FS_PRIVATE_END
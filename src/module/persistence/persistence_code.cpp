@@ -239,4 +239,132 @@ namespace code { namespace base64
     }
 }}
 
+/****************************************************************************
+ *  Block
+ ***************************************************************************/
+namespace code { namespace block
+{
+    /************************************************************************
+     * constant
+     ***********************************************************************/
+
+    char const PREFIX[] = "$base64$";
+
+    static size_t const HEADER_CHARS = 8U;   /* of `HEADER_SIZE` bytes */
+    static size_t const CHUNK_VALUES = 384U; /* bytes of them are 3 * n */
+
+    /************************************************************************
+     * helper
+     ***********************************************************************/
+
+    template<typename ValueType> static inline size_t
+        encode_values(ValueType const * src, size_t cnt, Type type, char * dst)
+    {
+        char * cur = dst;
+        std::memcpy(cur, PREFIX, PREFIX_SIZE);
+        cur += PREFIX_SIZE;
+
+        uint8_t head[HEADER_SIZE] = { static_cast<uint8_t>(type), 0U };
+        binarization::encode(static_cast<uint32_t>(cnt), head + 2);
+        cur += base64::encode(head, reinterpret_cast<uint8_t *>(cur),
+                              0U, HEADER_SIZE);
+
+        /* values in little endian, a chunk at a time */
+        uint8_t buf[CHUNK_VALUES * sizeof(ValueType)];
+        for (size_t i = 0; i < cnt; i += CHUNK_VALUES) {
+            size_t n = cnt - i < CHUNK_VALUES ? cnt - i : CHUNK_VALUES;
+            for (size_t k = 0; k < n; ++k)
+                binarization::encode(src[i + k], buf + k * sizeof(ValueType));
+            cur += base64::encode(buf, reinterpret_cast<uint8_t *>(cur),
+                                  0U, n * sizeof(ValueType));
+        }
+        return static_cast<size_t>(cur - dst);
+    }
+
+    template<typename ValueType> static inline void
+        decode_values(char const * src, size_t len, ValueType * dst)
+    {
+        uint8_t const * beg = reinterpret_cast<uint8_t const *>(src)
+                            + PREFIX_SIZE + HEADER_CHARS;
+        size_t chars = len - PREFIX_SIZE - HEADER_CHARS;
+        if (chars == 0U)
+            return;
+
+        size_t bytes = base64::decode_buffer_size(chars, beg, false);
+        size_t cnt   = bytes / sizeof(ValueType);
+
+        /* whole groups of 3 bytes in place, the rest through `tail` */
+        uint8_t * out  = reinterpret_cast<uint8_t *>(dst);
+        size_t    full = bytes / 3U;
+        base64::decode(beg, out, 0U, full * 4U);
+        if (bytes % 3U != 0U) {
+            uint8_t tail[3];
+            base64::decode(beg, tail, full * 4U, 4U);
+            std::memcpy(out + full * 3U, tail, bytes % 3U);
+        }
+
+        /* to the byte order of this machine */
+        for (size_t i = 0; i < cnt; ++i) {
+            ValueType val;
+            binarization::decode(out + i * sizeof(ValueType), val);
+            dst[i] = val;
+        }
+    }
+
+    /************************************************************************
+     * function
+     ***********************************************************************/
+
+    size_t encode_size(size_t cnt)
+    {
+        return PREFIX_SIZE + HEADER_CHARS
+             + base64::encode_buffer_size(cnt * sizeof(int64_t), false);
+    }
+
+    size_t encode(int64_t const * src, size_t cnt, char * dst)
+    {
+        return encode_values(src, cnt, I64, dst);
+    }
+
+    size_t encode(double const * src, size_t cnt, char * dst)
+    {
+        return encode_values(src, cnt, DBL, dst);
+    }
+
+    bool header(char const * src, size_t len, Type & type, size_t & cnt)
+    {
+        if (src == NULL || len < PREFIX_SIZE + HEADER_CHARS)
+            return false;
+        if (std::memcmp(src, PREFIX, PREFIX_SIZE) != 0)
+            return false;
+        if (!base64::is_valid(src, PREFIX_SIZE, len - PREFIX_SIZE))
+            return false;
+
+        uint8_t head[HEADER_SIZE];
+        base64::decode(reinterpret_cast<uint8_t const *>(src), head,
+                       PREFIX_SIZE, HEADER_CHARS);
+        if ((head[0] != I64 && head[0] != DBL) || head[1] != 0U)
+            return false;
+
+        uint32_t siz = 0U;
+        binarization::decode(head + 2, siz);
+        if (len != encode_size(siz))
+            return false;
+
+        type = static_cast<Type>(head[0]);
+        cnt  = siz;
+        return true;
+    }
+
+    void decode(char const * src, size_t len, int64_t * dst)
+    {
+        decode_values(src, len, dst);
+    }
+
+    void decode(char const * src, size_t len, double * dst)
+    {
+        decode_values(src, len, dst);
+    }
+}}
+
 CV_FS_PRIVATE_END
@@ -122,4 +122,43 @@ namespace code { namespace binarization
     }
 }}
 
+/****************************************************************************
+ *  Block
+ ***************************************************************************/
+namespace code { namespace block
+{
+    /* an array of numbers as one string, `PREFIX` followed by base64 of
+     * a header and values in little endian:
+     *
+     *     $base64$[dtype][0][count][values...]
+     *
+     * `dtype` is a char of `Type`, `count` is an `uint32_t`. The header is
+     * 6 bytes, 8 chars of base64, so values are decoded from a multiple
+     * of 4 chars and directly into a buffer. */
+    enum Type
+    {
+        I64 = 'l',
+        DBL = 'd'
+    };
+
+    extern char const   PREFIX[];
+    static size_t const PREFIX_SIZE = 8U;
+    static size_t const HEADER_SIZE = 6U;
+
+    /* chars of a block of `cnt` values, without '\0' */
+    extern size_t encode_size(size_t cnt);
+
+    /* returns chars written to `dst`, which has `encode_size(cnt)` */
+    extern size_t encode(int64_t const * src, size_t cnt, char * dst);
+    extern size_t encode(double  const * src, size_t cnt, char * dst);
+
+    /* reads the header, returns false if `src` is not a valid block */
+    extern bool header(char const * src, size_t len, Type & type,
+                       size_t & cnt);
+
+    /* values of a valid block, `dst` has `cnt` of them */
+    extern void decode(char const * src, size_t len, int64_t * dst);
+    extern void decode(char const * src, size_t len, double  * dst);
+}}
+
 CV_FS_PRIVATE_END
@@ -2,11 +2,14 @@
  *  license
  ***************************************************************************/
 
+#include <cstring>
 #include <iostream>
 #include "persistence_private.hpp"
 #include "persistence_utility.hpp"
 #include "persistence_io.hpp"
 #include "persistence_string.hpp"
+#include "persistence_simd.hpp"
+#include "persistence_number.hpp"
 #include "persistence_emitter.hpp"
 
 CV_FS_PRIVATE_BEGIN
@@ -62,6 +65,9 @@ namespace emitter
         : stack_()
         , stream_(stream)
         , is_container_empty_(true)
+        , buf_(new char[BUFFER_SIZE])
+        , len_(0)
+        , find_special_(simd::scanner().find_special)
     {
         stack_.push_back(NIL);
         stack_.push_back(VAL);
@@ -78,6 +84,9 @@ namespace emitter
             }
         }
 
+        flush();
+        delete [] buf_;
+
         stream_->close();
         delete stream_;
     }
@@ -92,14 +101,14 @@ namespace emitter
         if (is_container_empty_) {
             is_container_empty_ = false;
             if (top() == SEQ_VAL)
-                stream_->write("[", 1);
+                put("[", 1);
             else if (top() == MAP_KEY)
-                stream_->write("{", 1);
+                put("{", 1);
         } else {
             if (top() == MAP_KEY)
-                stream_->write(": ", 2);
+                put(": ", 2);
             else
-                stream_->write(",", 1);
+                put(",", 1);
         }
 
         stack_.push_back(state);
@@ -111,15 +120,15 @@ namespace emitter
         if (is_container_empty_) {
             is_container_empty_ = false;
             if (top() == SEQ_VAL)
-                stream_->write("[", 1);
+                put("[", 1);
             else if (top() == MAP_KEY)
-                stream_->write("{", 1);
+                put("{", 1);
         }
 
         if (top() == SEQ_VAL)
-            stream_->write("]", 1);
+            put("]", 1);
         else if (top() == MAP_KEY)
-            stream_->write("}", 1);
+            put("}", 1);
 
         stack_.pop_back();
     }
@@ -129,19 +138,17 @@ namespace emitter
         if (is_container_empty_) {
             is_container_empty_ = false;
             if (top() == SEQ_VAL)
-                stream_->write("[", 1);
+                put("[", 1);
             else if (top() == MAP_KEY)
-                stream_->write("{", 1);
+                put("{", 1);
         } else {
             if (top() == MAP_VAL)
-                stream_->write(": ", 2);
+                put(": ", 2);
             else
-                stream_->write(",", 1);
+                put(",", 1);
         }
 
-        char buffer[30];
-        chars::make_string(val, buffer);
-        stream_->write(buffer, chars::strlen(buffer));
+        len_ += number::format(val, room(number::MAX_FORMAT_LENGTH));
     }
 
     void JsonFSM::out(int64_t val)
@@ -149,28 +156,25 @@ namespace emitter
         if (is_container_empty_) {
             is_container_empty_ = false;
             if (top() == SEQ_VAL)
-                stream_->write("[", 1);
+                put("[", 1);
             else if (top() == MAP_KEY)
-                stream_->write("{", 1);
+                put("{", 1);
         } else {
             if (top() == MAP_VAL)
-                stream_->write(": ", 2);
+                put(": ", 2);
             else
-                stream_->write(",", 1);
+                put(",", 1);
         }
 
-        char buffer[30];
-        chars::make_string(val, buffer);
-        stream_->write(buffer, chars::strlen(buffer));
+        len_ += number::format(val, room(number::MAX_FORMAT_LENGTH));
     }
 
     inline char const * esc_to_chr(char ch)
     {
         switch (ch)
         {
-        case '\\': return "\\";
-        case '\'': return "'";
-        case '\"': return "\"";
+        case '\\': return "\\\\";
+        case '\"': return "\\\"";
         case '\n': return "\\n";
         case '\r': return "\\r";
         case '\t': return "\\t";
@@ -185,30 +189,67 @@ namespace emitter
         if (is_container_empty_) {
             is_container_empty_ = false;
             if (top() == SEQ_VAL)
-                stream_->write("[", 1);
+                put("[", 1);
             else if (top() == MAP_KEY)
-                stream_->write("{", 1);
+                put("{", 1);
         } else {
             if (top() == MAP_VAL)
-                stream_->write(": ", 2);
+                put(": ", 2);
             else
-                stream_->write(",", 1);
+                put(",", 1);
         }
 
-        stream_->write("\"", 1);
+        put("\"", 1);
 
+        /* copy runs of plain chars, escape the rest one by one */
         typedef char const * const_iter;
-        const_iter iter_beg = val;
         const_iter iter_end = val + len;
-        for (const_iter iter = iter_beg; iter != iter_end; ++iter) {
+        for (const_iter iter = val; iter != iter_end; ++iter) {
+            const_iter next = find_special_(iter, iter_end);
+            put(iter, static_cast<size_t>(next - iter));
+            if ((iter = next) == iter_end)
+                break;
+
             const char * cvt = esc_to_chr(*iter);
-            if (cvt == NULL)
-                stream_->write(iter, 1);
-            else
-                stream_->write(cvt, chars::strlen(cvt));
+            if (cvt != NULL) {
+                put(cvt, chars::strlen(cvt));
+            } else { /* other control chars, including DEL */
+                static const char hex[] = "0123456789abcdef";
+                char esc[] = "\\u00XX";
+                esc[4] = hex[(*iter >> 4) & 0xF];
+                esc[5] = hex[(*iter     ) & 0xF];
+                put(esc, 6);
+            }
         }
 
-        stream_->write("\"", 1);
+        put("\"", 1);
+    }
+
+    void JsonFSM::put(char const * str, size_t len)
+    {
+        if (len_ + len > BUFFER_SIZE) {
+            flush();
+            if (len >= BUFFER_SIZE) {
+                stream_->write(str, len);
+                return;
+            }
+        }
+        ::memcpy(buf_ + len_, str, len);
+        len_ += len;
+    }
+
+    char * JsonFSM::room(size_t len)
+    {
+        if (len_ + len > BUFFER_SIZE)
+            flush();
+        return buf_ + len_;
+    }
+
+    void JsonFSM::flush()
+    {
+        if (len_ != 0)
+            stream_->write(buf_, len_);
+        len_ = 0;
     }
 
     StateTag JsonFSM::top() const
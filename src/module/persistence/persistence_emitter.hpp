@@ -338,10 +338,25 @@ namespace emitter
         typedef chars::Buffer<StateTag, 128U, std::allocator> Stack;
         typedef chars::Buffer<StateTag, 128U, std::allocator> Strbuf;
 
+    private:
+        /* output is collected and written to stream in bulk */
+        void   put  (char const * str, size_t len);
+        char * room (size_t len); /* at least `len` free chars */
+        void   flush();
+
+    private:
+        static const size_t BUFFER_SIZE = 1U << 16;
+
+        typedef char const * (*Finder)(char const *, char const *);
+
     private:
         Stack        stack_;
         io::Stream * stream_;
         bool         is_container_empty_;
+
+        char *       buf_;
+        size_t       len_;
+        Finder       find_special_;
     };
 }
 
@@ -2,6 +2,11 @@
  *  license
  ***************************************************************************/
 
+/* 64-bit `off_t` for `fseeko` and `ftello` on 32-bit systems */
+#if (!defined _WIN32) && (!defined _FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include <cstdio>
 #include <cstring>
 #include <limits>
@@ -10,6 +15,21 @@
 #include "persistence_private.hpp"
 #include "persistence_utility.hpp"
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if (!defined MAP_ANONYMOUS) && (defined MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 CV_FS_PRIVATE_BEGIN
 
 namespace exception
@@ -43,6 +63,8 @@ namespace io
     public:
         StringStream()
             : stream()
+            , input()
+            , cursor(0)
             , is_writing(false)
         {
             stream.setstate(std::ios_base::badbit);
@@ -60,7 +82,7 @@ namespace io
             stream.clear();
             switch (mode)
             {
-            case READ:  { if(str) stream.str(str); is_writing = false;break;}
+            case READ:  { load(str);               is_writing = false;break;}
             case WRITE: {                          is_writing = true; break;}
             case APPEND:{ if(str) stream.str(str); is_writing = true; break;}
             default:    {                                             break;}
@@ -75,9 +97,24 @@ namespace io
         {
             stream.str();
             stream.setstate(std::ios_base::badbit);
+            input.clear();
+            cursor = 0;
         }
         virtual void seek(Pos offset, Seek origin)           /*override*/
         {
+            if (!is_writing) {
+                Pos pos = 0;
+                switch (origin)
+                {
+                case BEG: { pos = offset;                     break; }
+                case CUR: { pos = Pos(cursor) + offset;       break; }
+                case END: { pos = Pos(length()) + offset;     break; }
+                default:  { return; }
+                }
+                if (pos >= 0 && uint64_t(pos) <= length())
+                    cursor = static_cast<size_t>(pos);
+                return;
+            }
             switch (origin)
             {
             case BEG: { stream.seekp(offset, std::ios::beg); break; }
@@ -88,8 +125,7 @@ namespace io
         }
         virtual Pos tell() /* override */
         {
-            return static_cast<Pos>
-                (is_writing ? stream.tellp() : stream.tellg());
+            return is_writing ? static_cast<Pos>(stream.tellp()) : Pos(cursor);
         }
         virtual size_type write(ConstString buffer, size_type size)
             /* override */
@@ -100,17 +136,23 @@ namespace io
         virtual size_type read(String buffer, size_type size)
             /* override */
         {
-            typedef std::streamsize arg_t;
-            ASSERT
-            (uint64_t(size) <= uint64_t(std::numeric_limits<arg_t>::max()));
-
-            stream.read(buffer, static_cast<arg_t>(size));
-            ASSERT(stream.gcount() >= 0);
-
-            return static_cast<size_type>(stream.gcount());
+            size_t rest = length() - cursor;
+            size_t n = uint64_t(size) < uint64_t(rest)
+                     ? static_cast<size_t>(size)
+                     : rest;
+            ::memcpy(buffer, input.begin() + cursor, n * sizeof(CharType));
+            cursor += n;
+            return static_cast<size_type>(n);
         }
         virtual Buffer dump() /* override */
         {
+            if (is_writing) {
+                std::string str = stream.str();
+                Buffer buffer;
+                buffer.push_back(str.data(), str.size());
+                return buffer;
+            }
+
             Pos backup = tell();
             seek(0, END);
             Pos count  = tell() / sizeof(CharType);
@@ -121,13 +163,38 @@ namespace io
                 exception::file_too_large(count, POS_);
 
             Buffer buffer(static_cast<size_t>(count));
-            write(buffer, static_cast<size_type>(count));
+            size_type got = read(buffer, static_cast<size_type>(count));
+            buffer.resize(static_cast<size_t>(got));
             seek(backup, BEG);
             return buffer;
         }
+        virtual String view(size_type & size)                 /*override*/
+        {
+            if (is_writing || !is_open())
+                return NULL;
+            size = static_cast<size_type>(length());
+            return input;
+        }
+
+    private:
+        /* a copy of `str` for reading, which is also the view */
+        void load(ConstString str)
+        {
+            input.clear();
+            if (str)
+                input.push_back(str, chars::strlen(str));
+            input.push_back(CharType());
+            cursor = 0;
+        }
+        size_t length() const
+        {
+            return input.size() - size_t(1); /* '\0' at end */
+        }
 
     private:
         std::stringstream stream;
+        Buffer input;
+        size_t cursor;
         bool is_writing;
     };
 
@@ -153,9 +220,9 @@ namespace io
 
             switch (mode)
             {
-            case READ:  { fmode = "r"; break; }
-            case WRITE: { fmode = "w"; break; }
-            case APPEND:{ fmode = "a"; break; }
+            case READ:  { fmode = "rb"; break; }
+            case WRITE: { fmode = "wb"; break; }
+            case APPEND:{ fmode = "ab"; break; }
             default:    { return false; }
             }
 
@@ -187,14 +254,21 @@ namespace io
             default:  { is_valid = false; break; }
             }
 
-            ASSERT(Pos(offset) <= Pos(std::numeric_limits<long>::max()));
+            /* `long` of `fseek` may be 32-bit, so use the 64-bit ones */
             if (is_valid)
-                std::fseek(stream, static_cast<long>(offset), way);
+#ifdef _WIN32
+                ::_fseeki64(stream, static_cast<__int64>(offset), way);
+#else
+                ::fseeko(stream, static_cast<off_t>(offset), way);
+#endif
         }
         virtual Pos tell()                                     /*override*/
         {
-            /* warning: std::numeric_limits<long>::max() < 2.1G */
-            long result = std::ftell(stream);
+#ifdef _WIN32
+            __int64 result = ::_ftelli64(stream);
+#else
+            off_t   result = ::ftello(stream);
+#endif
             if (result < 0)
                 return Pos(-1);
             else
@@ -226,7 +300,8 @@ namespace io
                 exception::file_too_large(count, POS_);
 
             Buffer buffer(static_cast<size_t>(count));
-            write(buffer, static_cast<size_type>(count));
+            size_type got = read(buffer, static_cast<size_type>(count));
+            buffer.resize(static_cast<size_t>(got));
             seek(backup, BEG);
             return buffer;
         }
@@ -239,21 +314,322 @@ namespace io
         std::FILE * stream;
     };
 
+    /************************************************************************
+     * MappedStream
+    ************************************************************************/
+
+    /* maps the whole file into memory, so that parsers may work on it
+     * directly instead of reading it chunk by chunk. */
+    class MappedStream : public Stream
+    {
+    public:
+        MappedStream()
+            : base(NULL)
+            , length(0)
+            , cursor(0)
+            , is_mapped(false)
+#ifndef _WIN32
+            , reserved(0)
+#endif
+        {
+            empty[0] = '\0';
+        }
+        ~MappedStream()
+        {
+            if (is_open())
+                close();
+        }
+    public:
+        virtual bool open(const char * path, Mode mode)/*override*/
+        {
+            if (is_open())
+                close();
+            if (mode != READ || path == NULL)
+                return false;
+            return map(path);
+        }
+        virtual bool is_open() const                             /*override*/
+        {
+            return base != NULL;
+        }
+        virtual void close()                                     /*override*/
+        {
+            if (is_mapped)
+                unmap();
+            base      = NULL;
+            length    = 0;
+            cursor    = 0;
+            is_mapped = false;
+        }
+        virtual void seek(Pos offset, Seek origin)           /*override*/
+        {
+            Pos pos = 0;
+            switch (origin)
+            {
+            case BEG: { pos = offset;                     break; }
+            case CUR: { pos = Pos(cursor) + offset;       break; }
+            case END: { pos = Pos(length) + offset;       break; }
+            default:  { return; }
+            }
+            if (pos >= 0 && uint64_t(pos) <= length)
+                cursor = static_cast<size_type>(pos);
+        }
+        virtual Pos tell()                                     /*override*/
+        {
+            return is_open() ? static_cast<Pos>(cursor) : Pos(-1);
+        }
+        virtual size_type write(ConstString, size_type)   /*override*/
+        {
+            return 0;
+        }
+        virtual size_type read(String buffer, size_type size)
+            /* override */
+        {
+            size_type rest = length - cursor;
+            if (size > rest)
+                size = rest;
+            std::memcpy(buffer, base + cursor, static_cast<size_t>(size));
+            cursor += size;
+            return size;
+        }
+        virtual Buffer dump()                       /*override*/
+        {
+            Buffer buffer;
+            buffer.push_back(base, static_cast<size_t>(length));
+            return buffer;
+        }
+        virtual String view(size_type & size)      /*override*/
+        {
+            size = length;
+            return base;
+        }
+
+    private:
+#ifdef _WIN32
+        bool map(const char * path)
+        {
+            HANDLE file = ::CreateFileA(
+                path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size;
+            SYSTEM_INFO   info;
+            ::GetSystemInfo(&info);
+            if (::GetFileSizeEx(file, &size) == FALSE ||
+                uint64_t(size.QuadPart) >=
+                uint64_t(std::numeric_limits<size_t>::max())) {
+                ::CloseHandle(file);
+                return false;
+            }
+
+            length = static_cast<size_type>(size.QuadPart);
+            if (length == 0) {
+                ::CloseHandle(file);
+                base = empty;
+                return true;
+            }
+
+            /* a view cannot be padded on windows, if the file ends at a page
+             * boundary there is no room for '\0', let caller fall back. */
+            if (length % info.dwPageSize == 0) {
+                ::CloseHandle(file);
+                length = 0;
+                return false;
+            }
+
+            HANDLE mapping = ::CreateFileMappingA(
+                file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+            ::CloseHandle(file);
+            if (mapping == NULL) {
+                length = 0;
+                return false;
+            }
+
+            void * addr = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            ::CloseHandle(mapping);
+            if (addr == NULL) {
+                length = 0;
+                return false;
+            }
+
+            base      = static_cast<String>(addr);
+            is_mapped = true;
+            return true;
+        }
+
+        void unmap()
+        {
+            ::UnmapViewOfFile(base);
+        }
+#else
+        bool map(const char * path)
+        {
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+                uint64_t(st.st_size) >=
+                uint64_t(std::numeric_limits<size_t>::max()) / 2U) {
+                ::close(fd);
+                return false;
+            }
+
+            length = static_cast<size_type>(st.st_size);
+            if (length == 0) {
+                ::close(fd);
+                base = empty;
+                return true;
+            }
+
+            /* reserve at least one more page than the file, so that the
+             * view is always followed by zeros. */
+            size_t page  = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t bytes = static_cast<size_t>(length);
+            size_t total = (bytes / page + 1U) * page;
+
+            void * area = ::mmap(NULL, total, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (area == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+
+            void * addr = ::mmap(area, bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_FIXED, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED) {
+                ::munmap(area, total);
+                length = 0;
+                return false;
+            }
+
+            ::madvise(addr, bytes, MADV_SEQUENTIAL);
+
+            base      = static_cast<String>(addr);
+            reserved  = total;
+            is_mapped = true;
+            return true;
+        }
+
+        void unmap()
+        {
+            ::munmap(base, reserved);
+        }
+#endif
+
+    private:
+        MappedStream            (MappedStream const &);
+        MappedStream & operator=(MappedStream const &);
+
+    private:
+        String     base;
+        size_type  length;
+        size_type  cursor;
+        bool       is_mapped;
+        CharType   empty[1];
+#ifndef _WIN32
+        size_t     reserved;
+#endif
+    };
+
     /************************************************************************
      * Stream
     ************************************************************************/
 
     Stream::~Stream() {}
 
+    Stream::String Stream::view(size_type & size)
+    {
+        size = 0;
+        return NULL;
+    }
+
     Stream * Stream::build(StreamTarget type)
     {
         switch (type)
         {
         case FILE   : { return new   FileStream(); }
         case STRING : { return new StringStream(); }
+        case MMAP   : { return new MappedStream(); }
         default:      { return NULL; }
         }
     }
+    /************************************************************************
+     * Span
+    ************************************************************************/
+
+    Span::Span(String beg, String end)
+        : beg_(beg)
+        , end_(end)
+        , cur_(beg)
+    {}
+
+    bool Span::open(ConstString, Mode)
+    {
+        return false;
+    }
+
+    bool Span::is_open() const
+    {
+        return true;
+    }
+
+    void Span::close()
+    {
+        ;
+    }
+
+    void Span::seek(Pos offset, Seek origin)
+    {
+        String pos = NULL;
+        switch (origin)
+        {
+        case BEG: { pos = beg_ + offset; break; }
+        case CUR: { pos = cur_ + offset; break; }
+        case END: { pos = end_ + offset; break; }
+        default:  { return; }
+        }
+        if (pos >= beg_ && pos <= end_)
+            cur_ = pos;
+    }
+
+    Stream::Pos Span::tell()
+    {
+        return static_cast<Pos>(cur_ - beg_);
+    }
+
+    Stream::size_type Span::write(ConstString, size_type)
+    {
+        return 0;
+    }
+
+    Stream::size_type Span::read(String buffer, size_type size)
+    {
+        size_type rest = static_cast<size_type>(end_ - cur_);
+        if (size > rest)
+            size = rest;
+        std::memcpy(buffer, cur_, static_cast<size_t>(size));
+        cur_ += size;
+        return size;
+    }
+
+    Buffer Span::dump()
+    {
+        Buffer buffer;
+        buffer.push_back(beg_, static_cast<size_t>(end_ - beg_));
+        return buffer;
+    }
+
+    Stream::String Span::view(size_type & size)
+    {
+        size = static_cast<size_type>(end_ - beg_);
+        return beg_;
+    }
 }
 
 CV_FS_PRIVATE_END
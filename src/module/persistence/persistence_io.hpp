@@ -43,7 +43,8 @@ namespace io
     enum StreamTarget
     {
         FILE,
-        STRING
+        STRING,
+        MMAP     /* read only */
     };
 
     class Stream
@@ -70,9 +71,46 @@ namespace io
 
         virtual Buffer  dump()                                      = 0;
 
+        /* the whole content if it is resident in memory, otherwise NULL.
+         * a view is writable (copy on write, never flushed back) and is
+         * followed by at least one '\0'. */
+        virtual String  view(size_type & size);
+
     public:
         static Stream * build(StreamTarget type);
     };
+
+    /************************************************************************
+     * Span
+    ************************************************************************/
+
+    /* a read only stream over chars owned by others, used to parse a piece
+     * of text. Its view is [beg, end), and the char at `end` must end a
+     * value as the '\0' behind a whole view does, e.g. `,`, `]` or '\0'. */
+    class Span : public Stream
+    {
+    public:
+        Span(String beg, String end);
+
+    public:
+        virtual bool      open(ConstString path, Mode mode);
+        virtual bool   is_open() const;
+        virtual void     close();
+
+        virtual void      seek(Pos offset, Seek origin);
+        virtual Pos       tell();
+
+        virtual size_type write(ConstString buffer, size_type size);
+        virtual size_type read (     String buffer, size_type size);
+
+        virtual Buffer    dump();
+        virtual String    view(size_type & size);
+
+    private:
+        String beg_;
+        String end_;
+        String cur_;
+    };
 }
 
 CV_FS_PRIVATE_END
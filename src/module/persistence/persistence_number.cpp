@@ -0,0 +1,1378 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include "persistence_private.hpp"
+#include "persistence_number.hpp"
+
+/****************************************************************************
+ *  Compiler differences
+ ***************************************************************************/
+
+#if (defined _MSC_VER) && (defined _M_X64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#define NUMBER_UMUL128_
+#elif (defined __SIZEOF_INT128__)
+#define NUMBER_INT128_
+#endif
+
+#define U64_(x) uint64_t(x##ULL)
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  helper
+ ***************************************************************************/
+
+namespace number { namespace
+{
+    /* IEEE 754 binary64 */
+    static const int      MANTISSA_BITS    = 52;
+    static const int      MINIMUM_EXPONENT = -1023;
+    static const int32_t  INFINITE_POWER   = 0x7FF;
+    static const uint64_t MAX_EXACT_INT    = U64_(1) << 53;
+
+    /* 10^i, i in [0, 22], all of them are exact */
+    static const double POW10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+    static const int64_t MAX_POW10 = 22;
+
+    /* 5^q, q in [-342, 308], normalized and truncated to 128 bits */
+    static const int64_t SMALLEST_POWER = -342;
+    static const int64_t LARGEST_POWER  =  308;
+    static const uint64_t POW5_128[] =
+    {
+        U64_(0xEEF453D6923BD65A), U64_(0x113FAA2906A13B3F),
+        U64_(0x9558B4661B6565F8), U64_(0x4AC7CA59A424C507),
+        U64_(0xBAAEE17FA23EBF76), U64_(0x5D79BCF00D2DF649),
+        U64_(0xE95A99DF8ACE6F53), U64_(0xF4D82C2C107973DC),
+        U64_(0x91D8A02BB6C10594), U64_(0x79071B9B8A4BE869),
+        U64_(0xB64EC836A47146F9), U64_(0x9748E2826CDEE284),
+        U64_(0xE3E27A444D8D98B7), U64_(0xFD1B1B2308169B25),
+        U64_(0x8E6D8C6AB0787F72), U64_(0xFE30F0F5E50E20F7),
+        U64_(0xB208EF855C969F4F), U64_(0xBDBD2D335E51A935),
+        U64_(0xDE8B2B66B3BC4723), U64_(0xAD2C788035E61382),
+        U64_(0x8B16FB203055AC76), U64_(0x4C3BCB5021AFCC31),
+        U64_(0xADDCB9E83C6B1793), U64_(0xDF4ABE242A1BBF3D),
+        U64_(0xD953E8624B85DD78), U64_(0xD71D6DAD34A2AF0D),
+        U64_(0x87D4713D6F33AA6B), U64_(0x8672648C40E5AD68),
+        U64_(0xA9C98D8CCB009506), U64_(0x680EFDAF511F18C2),
+        U64_(0xD43BF0EFFDC0BA48), U64_(0x0212BD1B2566DEF2),
+        U64_(0x84A57695FE98746D), U64_(0x014BB630F7604B57),
+        U64_(0xA5CED43B7E3E9188), U64_(0x419EA3BD35385E2D),
+        U64_(0xCF42894A5DCE35EA), U64_(0x52064CAC828675B9),
+        U64_(0x818995CE7AA0E1B2), U64_(0x7343EFEBD1940993),
+        U64_(0xA1EBFB4219491A1F), U64_(0x1014EBE6C5F90BF8),
+        U64_(0xCA66FA129F9B60A6), U64_(0xD41A26E077774EF6),
+        U64_(0xFD00B897478238D0), U64_(0x8920B098955522B4),
+        U64_(0x9E20735E8CB16382), U64_(0x55B46E5F5D5535B0),
+        U64_(0xC5A890362FDDBC62), U64_(0xEB2189F734AA831D),
+        U64_(0xF712B443BBD52B7B), U64_(0xA5E9EC7501D523E4),
+        U64_(0x9A6BB0AA55653B2D), U64_(0x47B233C92125366E),
+        U64_(0xC1069CD4EABE89F8), U64_(0x999EC0BB696E840A),
+        U64_(0xF148440A256E2C76), U64_(0xC00670EA43CA250D),
+        U64_(0x96CD2A865764DBCA), U64_(0x380406926A5E5728),
+        U64_(0xBC807527ED3E12BC), U64_(0xC605083704F5ECF2),
+        U64_(0xEBA09271E88D976B), U64_(0xF7864A44C633682E),
+        U64_(0x93445B8731587EA3), U64_(0x7AB3EE6AFBE0211D),
+        U64_(0xB8157268FDAE9E4C), U64_(0x5960EA05BAD82964),
+        U64_(0xE61ACF033D1A45DF), U64_(0x6FB92487298E33BD),
+        U64_(0x8FD0C16206306BAB), U64_(0xA5D3B6D479F8E056),
+        U64_(0xB3C4F1BA87BC8696), U64_(0x8F48A4899877186C),
+        U64_(0xE0B62E2929ABA83C), U64_(0x331ACDABFE94DE87),
+        U64_(0x8C71DCD9BA0B4925), U64_(0x9FF0C08B7F1D0B14),
+        U64_(0xAF8E5410288E1B6F), U64_(0x07ECF0AE5EE44DD9),
+        U64_(0xDB71E91432B1A24A), U64_(0xC9E82CD9F69D6150),
+        U64_(0x892731AC9FAF056E), U64_(0xBE311C083A225CD2),
+        U64_(0xAB70FE17C79AC6CA), U64_(0x6DBD630A48AAF406),
+        U64_(0xD64D3D9DB981787D), U64_(0x092CBBCCDAD5B108),
+        U64_(0x85F0468293F0EB4E), U64_(0x25BBF56008C58EA5),
+        U64_(0xA76C582338ED2621), U64_(0xAF2AF2B80AF6F24E),
+        U64_(0xD1476E2C07286FAA), U64_(0x1AF5AF660DB4AEE1),
+        U64_(0x82CCA4DB847945CA), U64_(0x50D98D9FC890ED4D),
+        U64_(0xA37FCE126597973C), U64_(0xE50FF107BAB528A0),
+        U64_(0xCC5FC196FEFD7D0C), U64_(0x1E53ED49A96272C8),
+        U64_(0xFF77B1FCBEBCDC4F), U64_(0x25E8E89C13BB0F7A),
+        U64_(0x9FAACF3DF73609B1), U64_(0x77B191618C54E9AC),
+        U64_(0xC795830D75038C1D), U64_(0xD59DF5B9EF6A2417),
+        U64_(0xF97AE3D0D2446F25), U64_(0x4B0573286B44AD1D),
+        U64_(0x9BECCE62836AC577), U64_(0x4EE367F9430AEC32),
+        U64_(0xC2E801FB244576D5), U64_(0x229C41F793CDA73F),
+        U64_(0xF3A20279ED56D48A), U64_(0x6B43527578C1110F),
+        U64_(0x9845418C345644D6), U64_(0x830A13896B78AAA9),
+        U64_(0xBE5691EF416BD60C), U64_(0x23CC986BC656D553),
+        U64_(0xEDEC366B11C6CB8F), U64_(0x2CBFBE86B7EC8AA8),
+        U64_(0x94B3A202EB1C3F39), U64_(0x7BF7D71432F3D6A9),
+        U64_(0xB9E08A83A5E34F07), U64_(0xDAF5CCD93FB0CC53),
+        U64_(0xE858AD248F5C22C9), U64_(0xD1B3400F8F9CFF68),
+        U64_(0x91376C36D99995BE), U64_(0x23100809B9C21FA1),
+        U64_(0xB58547448FFFFB2D), U64_(0xABD40A0C2832A78A),
+        U64_(0xE2E69915B3FFF9F9), U64_(0x16C90C8F323F516C),
+        U64_(0x8DD01FAD907FFC3B), U64_(0xAE3DA7D97F6792E3),
+        U64_(0xB1442798F49FFB4A), U64_(0x99CD11CFDF41779C),
+        U64_(0xDD95317F31C7FA1D), U64_(0x40405643D711D583),
+        U64_(0x8A7D3EEF7F1CFC52), U64_(0x482835EA666B2572),
+        U64_(0xAD1C8EAB5EE43B66), U64_(0xDA3243650005EECF),
+        U64_(0xD863B256369D4A40), U64_(0x90BED43E40076A82),
+        U64_(0x873E4F75E2224E68), U64_(0x5A7744A6E804A291),
+        U64_(0xA90DE3535AAAE202), U64_(0x711515D0A205CB36),
+        U64_(0xD3515C2831559A83), U64_(0x0D5A5B44CA873E03),
+        U64_(0x8412D9991ED58091), U64_(0xE858790AFE9486C2),
+        U64_(0xA5178FFF668AE0B6), U64_(0x626E974DBE39A872),
+        U64_(0xCE5D73FF402D98E3), U64_(0xFB0A3D212DC8128F),
+        U64_(0x80FA687F881C7F8E), U64_(0x7CE66634BC9D0B99),
+        U64_(0xA139029F6A239F72), U64_(0x1C1FFFC1EBC44E80),
+        U64_(0xC987434744AC874E), U64_(0xA327FFB266B56220),
+        U64_(0xFBE9141915D7A922), U64_(0x4BF1FF9F0062BAA8),
+        U64_(0x9D71AC8FADA6C9B5), U64_(0x6F773FC3603DB4A9),
+        U64_(0xC4CE17B399107C22), U64_(0xCB550FB4384D21D3),
+        U64_(0xF6019DA07F549B2B), U64_(0x7E2A53A146606A48),
+        U64_(0x99C102844F94E0FB), U64_(0x2EDA7444CBFC426D),
+        U64_(0xC0314325637A1939), U64_(0xFA911155FEFB5308),
+        U64_(0xF03D93EEBC589F88), U64_(0x793555AB7EBA27CA),
+        U64_(0x96267C7535B763B5), U64_(0x4BC1558B2F3458DE),
+        U64_(0xBBB01B9283253CA2), U64_(0x9EB1AAEDFB016F16),
+        U64_(0xEA9C227723EE8BCB), U64_(0x465E15A979C1CADC),
+        U64_(0x92A1958A7675175F), U64_(0x0BFACD89EC191EC9),
+        U64_(0xB749FAED14125D36), U64_(0xCEF980EC671F667B),
+        U64_(0xE51C79A85916F484), U64_(0x82B7E12780E7401A),
+        U64_(0x8F31CC0937AE58D2), U64_(0xD1B2ECB8B0908810),
+        U64_(0xB2FE3F0B8599EF07), U64_(0x861FA7E6DCB4AA15),
+        U64_(0xDFBDCECE67006AC9), U64_(0x67A791E093E1D49A),
+        U64_(0x8BD6A141006042BD), U64_(0xE0C8BB2C5C6D24E0),
+        U64_(0xAECC49914078536D), U64_(0x58FAE9F773886E18),
+        U64_(0xDA7F5BF590966848), U64_(0xAF39A475506A899E),
+        U64_(0x888F99797A5E012D), U64_(0x6D8406C952429603),
+        U64_(0xAAB37FD7D8F58178), U64_(0xC8E5087BA6D33B83),
+        U64_(0xD5605FCDCF32E1D6), U64_(0xFB1E4A9A90880A64),
+        U64_(0x855C3BE0A17FCD26), U64_(0x5CF2EEA09A55067F),
+        U64_(0xA6B34AD8C9DFC06F), U64_(0xF42FAA48C0EA481E),
+        U64_(0xD0601D8EFC57B08B), U64_(0xF13B94DAF124DA26),
+        U64_(0x823C12795DB6CE57), U64_(0x76C53D08D6B70858),
+        U64_(0xA2CB1717B52481ED), U64_(0x54768C4B0C64CA6E),
+        U64_(0xCB7DDCDDA26DA268), U64_(0xA9942F5DCF7DFD09),
+        U64_(0xFE5D54150B090B02), U64_(0xD3F93B35435D7C4C),
+        U64_(0x9EFA548D26E5A6E1), U64_(0xC47BC5014A1A6DAF),
+        U64_(0xC6B8E9B0709F109A), U64_(0x359AB6419CA1091B),
+        U64_(0xF867241C8CC6D4C0), U64_(0xC30163D203C94B62),
+        U64_(0x9B407691D7FC44F8), U64_(0x79E0DE63425DCF1D),
+        U64_(0xC21094364DFB5636), U64_(0x985915FC12F542E4),
+        U64_(0xF294B943E17A2BC4), U64_(0x3E6F5B7B17B2939D),
+        U64_(0x979CF3CA6CEC5B5A), U64_(0xA705992CEECF9C42),
+        U64_(0xBD8430BD08277231), U64_(0x50C6FF782A838353),
+        U64_(0xECE53CEC4A314EBD), U64_(0xA4F8BF5635246428),
+        U64_(0x940F4613AE5ED136), U64_(0x871B7795E136BE99),
+        U64_(0xB913179899F68584), U64_(0x28E2557B59846E3F),
+        U64_(0xE757DD7EC07426E5), U64_(0x331AEADA2FE589CF),
+        U64_(0x9096EA6F3848984F), U64_(0x3FF0D2C85DEF7621),
+        U64_(0xB4BCA50B065ABE63), U64_(0x0FED077A756B53A9),
+        U64_(0xE1EBCE4DC7F16DFB), U64_(0xD3E8495912C62894),
+        U64_(0x8D3360F09CF6E4BD), U64_(0x64712DD7ABBBD95C),
+        U64_(0xB080392CC4349DEC), U64_(0xBD8D794D96AACFB3),
+        U64_(0xDCA04777F541C567), U64_(0xECF0D7A0FC5583A0),
+        U64_(0x89E42CAAF9491B60), U64_(0xF41686C49DB57244),
+        U64_(0xAC5D37D5B79B6239), U64_(0x311C2875C522CED5),
+        U64_(0xD77485CB25823AC7), U64_(0x7D633293366B828B),
+        U64_(0x86A8D39EF77164BC), U64_(0xAE5DFF9C02033197),
+        U64_(0xA8530886B54DBDEB), U64_(0xD9F57F830283FDFC),
+        U64_(0xD267CAA862A12D66), U64_(0xD072DF63C324FD7B),
+        U64_(0x8380DEA93DA4BC60), U64_(0x4247CB9E59F71E6D),
+        U64_(0xA46116538D0DEB78), U64_(0x52D9BE85F074E608),
+        U64_(0xCD795BE870516656), U64_(0x67902E276C921F8B),
+        U64_(0x806BD9714632DFF6), U64_(0x00BA1CD8A3DB53B6),
+        U64_(0xA086CFCD97BF97F3), U64_(0x80E8A40ECCD228A4),
+        U64_(0xC8A883C0FDAF7DF0), U64_(0x6122CD128006B2CD),
+        U64_(0xFAD2A4B13D1B5D6C), U64_(0x796B805720085F81),
+        U64_(0x9CC3A6EEC6311A63), U64_(0xCBE3303674053BB0),
+        U64_(0xC3F490AA77BD60FC), U64_(0xBEDBFC4411068A9C),
+        U64_(0xF4F1B4D515ACB93B), U64_(0xEE92FB5515482D44),
+        U64_(0x991711052D8BF3C5), U64_(0x751BDD152D4D1C4A),
+        U64_(0xBF5CD54678EEF0B6), U64_(0xD262D45A78A0635D),
+        U64_(0xEF340A98172AACE4), U64_(0x86FB897116C87C34),
+        U64_(0x9580869F0E7AAC0E), U64_(0xD45D35E6AE3D4DA0),
+        U64_(0xBAE0A846D2195712), U64_(0x8974836059CCA109),
+        U64_(0xE998D258869FACD7), U64_(0x2BD1A438703FC94B),
+        U64_(0x91FF83775423CC06), U64_(0x7B6306A34627DDCF),
+        U64_(0xB67F6455292CBF08), U64_(0x1A3BC84C17B1D542),
+        U64_(0xE41F3D6A7377EECA), U64_(0x20CABA5F1D9E4A93),
+        U64_(0x8E938662882AF53E), U64_(0x547EB47B7282EE9C),
+        U64_(0xB23867FB2A35B28D), U64_(0xE99E619A4F23AA43),
+        U64_(0xDEC681F9F4C31F31), U64_(0x6405FA00E2EC94D4),
+        U64_(0x8B3C113C38F9F37E), U64_(0xDE83BC408DD3DD04),
+        U64_(0xAE0B158B4738705E), U64_(0x9624AB50B148D445),
+        U64_(0xD98DDAEE19068C76), U64_(0x3BADD624DD9B0957),
+        U64_(0x87F8A8D4CFA417C9), U64_(0xE54CA5D70A80E5D6),
+        U64_(0xA9F6D30A038D1DBC), U64_(0x5E9FCF4CCD211F4C),
+        U64_(0xD47487CC8470652B), U64_(0x7647C3200069671F),
+        U64_(0x84C8D4DFD2C63F3B), U64_(0x29ECD9F40041E073),
+        U64_(0xA5FB0A17C777CF09), U64_(0xF468107100525890),
+        U64_(0xCF79CC9DB955C2CC), U64_(0x7182148D4066EEB4),
+        U64_(0x81AC1FE293D599BF), U64_(0xC6F14CD848405530),
+        U64_(0xA21727DB38CB002F), U64_(0xB8ADA00E5A506A7C),
+        U64_(0xCA9CF1D206FDC03B), U64_(0xA6D90811F0E4851C),
+        U64_(0xFD442E4688BD304A), U64_(0x908F4A166D1DA663),
+        U64_(0x9E4A9CEC15763E2E), U64_(0x9A598E4E043287FE),
+        U64_(0xC5DD44271AD3CDBA), U64_(0x40EFF1E1853F29FD),
+        U64_(0xF7549530E188C128), U64_(0xD12BEE59E68EF47C),
+        U64_(0x9A94DD3E8CF578B9), U64_(0x82BB74F8301958CE),
+        U64_(0xC13A148E3032D6E7), U64_(0xE36A52363C1FAF01),
+        U64_(0xF18899B1BC3F8CA1), U64_(0xDC44E6C3CB279AC1),
+        U64_(0x96F5600F15A7B7E5), U64_(0x29AB103A5EF8C0B9),
+        U64_(0xBCB2B812DB11A5DE), U64_(0x7415D448F6B6F0E7),
+        U64_(0xEBDF661791D60F56), U64_(0x111B495B3464AD21),
+        U64_(0x936B9FCEBB25C995), U64_(0xCAB10DD900BEEC34),
+        U64_(0xB84687C269EF3BFB), U64_(0x3D5D514F40EEA742),
+        U64_(0xE65829B3046B0AFA), U64_(0x0CB4A5A3112A5112),
+        U64_(0x8FF71A0FE2C2E6DC), U64_(0x47F0E785EABA72AB),
+        U64_(0xB3F4E093DB73A093), U64_(0x59ED216765690F56),
+        U64_(0xE0F218B8D25088B8), U64_(0x306869C13EC3532C),
+        U64_(0x8C974F7383725573), U64_(0x1E414218C73A13FB),
+        U64_(0xAFBD2350644EEACF), U64_(0xE5D1929EF90898FA),
+        U64_(0xDBAC6C247D62A583), U64_(0xDF45F746B74ABF39),
+        U64_(0x894BC396CE5DA772), U64_(0x6B8BBA8C328EB783),
+        U64_(0xAB9EB47C81F5114F), U64_(0x066EA92F3F326564),
+        U64_(0xD686619BA27255A2), U64_(0xC80A537B0EFEFEBD),
+        U64_(0x8613FD0145877585), U64_(0xBD06742CE95F5F36),
+        U64_(0xA798FC4196E952E7), U64_(0x2C48113823B73704),
+        U64_(0xD17F3B51FCA3A7A0), U64_(0xF75A15862CA504C5),
+        U64_(0x82EF85133DE648C4), U64_(0x9A984D73DBE722FB),
+        U64_(0xA3AB66580D5FDAF5), U64_(0xC13E60D0D2E0EBBA),
+        U64_(0xCC963FEE10B7D1B3), U64_(0x318DF905079926A8),
+        U64_(0xFFBBCFE994E5C61F), U64_(0xFDF17746497F7052),
+        U64_(0x9FD561F1FD0F9BD3), U64_(0xFEB6EA8BEDEFA633),
+        U64_(0xC7CABA6E7C5382C8), U64_(0xFE64A52EE96B8FC0),
+        U64_(0xF9BD690A1B68637B), U64_(0x3DFDCE7AA3C673B0),
+        U64_(0x9C1661A651213E2D), U64_(0x06BEA10CA65C084E),
+        U64_(0xC31BFA0FE5698DB8), U64_(0x486E494FCFF30A62),
+        U64_(0xF3E2F893DEC3F126), U64_(0x5A89DBA3C3EFCCFA),
+        U64_(0x986DDB5C6B3A76B7), U64_(0xF89629465A75E01C),
+        U64_(0xBE89523386091465), U64_(0xF6BBB397F1135823),
+        U64_(0xEE2BA6C0678B597F), U64_(0x746AA07DED582E2C),
+        U64_(0x94DB483840B717EF), U64_(0xA8C2A44EB4571CDC),
+        U64_(0xBA121A4650E4DDEB), U64_(0x92F34D62616CE413),
+        U64_(0xE896A0D7E51E1566), U64_(0x77B020BAF9C81D17),
+        U64_(0x915E2486EF32CD60), U64_(0x0ACE1474DC1D122E),
+        U64_(0xB5B5ADA8AAFF80B8), U64_(0x0D819992132456BA),
+        U64_(0xE3231912D5BF60E6), U64_(0x10E1FFF697ED6C69),
+        U64_(0x8DF5EFABC5979C8F), U64_(0xCA8D3FFA1EF463C1),
+        U64_(0xB1736B96B6FD83B3), U64_(0xBD308FF8A6B17CB2),
+        U64_(0xDDD0467C64BCE4A0), U64_(0xAC7CB3F6D05DDBDE),
+        U64_(0x8AA22C0DBEF60EE4), U64_(0x6BCDF07A423AA96B),
+        U64_(0xAD4AB7112EB3929D), U64_(0x86C16C98D2C953C6),
+        U64_(0xD89D64D57A607744), U64_(0xE871C7BF077BA8B7),
+        U64_(0x87625F056C7C4A8B), U64_(0x11471CD764AD4972),
+        U64_(0xA93AF6C6C79B5D2D), U64_(0xD598E40D3DD89BCF),
+        U64_(0xD389B47879823479), U64_(0x4AFF1D108D4EC2C3),
+        U64_(0x843610CB4BF160CB), U64_(0xCEDF722A585139BA),
+        U64_(0xA54394FE1EEDB8FE), U64_(0xC2974EB4EE658828),
+        U64_(0xCE947A3DA6A9273E), U64_(0x733D226229FEEA32),
+        U64_(0x811CCC668829B887), U64_(0x0806357D5A3F525F),
+        U64_(0xA163FF802A3426A8), U64_(0xCA07C2DCB0CF26F7),
+        U64_(0xC9BCFF6034C13052), U64_(0xFC89B393DD02F0B5),
+        U64_(0xFC2C3F3841F17C67), U64_(0xBBAC2078D443ACE2),
+        U64_(0x9D9BA7832936EDC0), U64_(0xD54B944B84AA4C0D),
+        U64_(0xC5029163F384A931), U64_(0x0A9E795E65D4DF11),
+        U64_(0xF64335BCF065D37D), U64_(0x4D4617B5FF4A16D5),
+        U64_(0x99EA0196163FA42E), U64_(0x504BCED1BF8E4E45),
+        U64_(0xC06481FB9BCF8D39), U64_(0xE45EC2862F71E1D6),
+        U64_(0xF07DA27A82C37088), U64_(0x5D767327BB4E5A4C),
+        U64_(0x964E858C91BA2655), U64_(0x3A6A07F8D510F86F),
+        U64_(0xBBE226EFB628AFEA), U64_(0x890489F70A55368B),
+        U64_(0xEADAB0ABA3B2DBE5), U64_(0x2B45AC74CCEA842E),
+        U64_(0x92C8AE6B464FC96F), U64_(0x3B0B8BC90012929D),
+        U64_(0xB77ADA0617E3BBCB), U64_(0x09CE6EBB40173744),
+        U64_(0xE55990879DDCAABD), U64_(0xCC420A6A101D0515),
+        U64_(0x8F57FA54C2A9EAB6), U64_(0x9FA946824A12232D),
+        U64_(0xB32DF8E9F3546564), U64_(0x47939822DC96ABF9),
+        U64_(0xDFF9772470297EBD), U64_(0x59787E2B93BC56F7),
+        U64_(0x8BFBEA76C619EF36), U64_(0x57EB4EDB3C55B65A),
+        U64_(0xAEFAE51477A06B03), U64_(0xEDE622920B6B23F1),
+        U64_(0xDAB99E59958885C4), U64_(0xE95FAB368E45ECED),
+        U64_(0x88B402F7FD75539B), U64_(0x11DBCB0218EBB414),
+        U64_(0xAAE103B5FCD2A881), U64_(0xD652BDC29F26A119),
+        U64_(0xD59944A37C0752A2), U64_(0x4BE76D3346F0495F),
+        U64_(0x857FCAE62D8493A5), U64_(0x6F70A4400C562DDB),
+        U64_(0xA6DFBD9FB8E5B88E), U64_(0xCB4CCD500F6BB952),
+        U64_(0xD097AD07A71F26B2), U64_(0x7E2000A41346A7A7),
+        U64_(0x825ECC24C873782F), U64_(0x8ED400668C0C28C8),
+        U64_(0xA2F67F2DFA90563B), U64_(0x728900802F0F32FA),
+        U64_(0xCBB41EF979346BCA), U64_(0x4F2B40A03AD2FFB9),
+        U64_(0xFEA126B7D78186BC), U64_(0xE2F610C84987BFA8),
+        U64_(0x9F24B832E6B0F436), U64_(0x0DD9CA7D2DF4D7C9),
+        U64_(0xC6EDE63FA05D3143), U64_(0x91503D1C79720DBB),
+        U64_(0xF8A95FCF88747D94), U64_(0x75A44C6397CE912A),
+        U64_(0x9B69DBE1B548CE7C), U64_(0xC986AFBE3EE11ABA),
+        U64_(0xC24452DA229B021B), U64_(0xFBE85BADCE996168),
+        U64_(0xF2D56790AB41C2A2), U64_(0xFAE27299423FB9C3),
+        U64_(0x97C560BA6B0919A5), U64_(0xDCCD879FC967D41A),
+        U64_(0xBDB6B8E905CB600F), U64_(0x5400E987BBC1C920),
+        U64_(0xED246723473E3813), U64_(0x290123E9AAB23B68),
+        U64_(0x9436C0760C86E30B), U64_(0xF9A0B6720AAF6521),
+        U64_(0xB94470938FA89BCE), U64_(0xF808E40E8D5B3E69),
+        U64_(0xE7958CB87392C2C2), U64_(0xB60B1D1230B20E04),
+        U64_(0x90BD77F3483BB9B9), U64_(0xB1C6F22B5E6F48C2),
+        U64_(0xB4ECD5F01A4AA828), U64_(0x1E38AEB6360B1AF3),
+        U64_(0xE2280B6C20DD5232), U64_(0x25C6DA63C38DE1B0),
+        U64_(0x8D590723948A535F), U64_(0x579C487E5A38AD0E),
+        U64_(0xB0AF48EC79ACE837), U64_(0x2D835A9DF0C6D851),
+        U64_(0xDCDB1B2798182244), U64_(0xF8E431456CF88E65),
+        U64_(0x8A08F0F8BF0F156B), U64_(0x1B8E9ECB641B58FF),
+        U64_(0xAC8B2D36EED2DAC5), U64_(0xE272467E3D222F3F),
+        U64_(0xD7ADF884AA879177), U64_(0x5B0ED81DCC6ABB0F),
+        U64_(0x86CCBB52EA94BAEA), U64_(0x98E947129FC2B4E9),
+        U64_(0xA87FEA27A539E9A5), U64_(0x3F2398D747B36224),
+        U64_(0xD29FE4B18E88640E), U64_(0x8EEC7F0D19A03AAD),
+        U64_(0x83A3EEEEF9153E89), U64_(0x1953CF68300424AC),
+        U64_(0xA48CEAAAB75A8E2B), U64_(0x5FA8C3423C052DD7),
+        U64_(0xCDB02555653131B6), U64_(0x3792F412CB06794D),
+        U64_(0x808E17555F3EBF11), U64_(0xE2BBD88BBEE40BD0),
+        U64_(0xA0B19D2AB70E6ED6), U64_(0x5B6ACEAEAE9D0EC4),
+        U64_(0xC8DE047564D20A8B), U64_(0xF245825A5A445275),
+        U64_(0xFB158592BE068D2E), U64_(0xEED6E2F0F0D56712),
+        U64_(0x9CED737BB6C4183D), U64_(0x55464DD69685606B),
+        U64_(0xC428D05AA4751E4C), U64_(0xAA97E14C3C26B886),
+        U64_(0xF53304714D9265DF), U64_(0xD53DD99F4B3066A8),
+        U64_(0x993FE2C6D07B7FAB), U64_(0xE546A8038EFE4029),
+        U64_(0xBF8FDB78849A5F96), U64_(0xDE98520472BDD033),
+        U64_(0xEF73D256A5C0F77C), U64_(0x963E66858F6D4440),
+        U64_(0x95A8637627989AAD), U64_(0xDDE7001379A44AA8),
+        U64_(0xBB127C53B17EC159), U64_(0x5560C018580D5D52),
+        U64_(0xE9D71B689DDE71AF), U64_(0xAAB8F01E6E10B4A6),
+        U64_(0x9226712162AB070D), U64_(0xCAB3961304CA70E8),
+        U64_(0xB6B00D69BB55C8D1), U64_(0x3D607B97C5FD0D22),
+        U64_(0xE45C10C42A2B3B05), U64_(0x8CB89A7DB77C506A),
+        U64_(0x8EB98A7A9A5B04E3), U64_(0x77F3608E92ADB242),
+        U64_(0xB267ED1940F1C61C), U64_(0x55F038B237591ED3),
+        U64_(0xDF01E85F912E37A3), U64_(0x6B6C46DEC52F6688),
+        U64_(0x8B61313BBABCE2C6), U64_(0x2323AC4B3B3DA015),
+        U64_(0xAE397D8AA96C1B77), U64_(0xABEC975E0A0D081A),
+        U64_(0xD9C7DCED53C72255), U64_(0x96E7BD358C904A21),
+        U64_(0x881CEA14545C7575), U64_(0x7E50D64177DA2E54),
+        U64_(0xAA242499697392D2), U64_(0xDDE50BD1D5D0B9E9),
+        U64_(0xD4AD2DBFC3D07787), U64_(0x955E4EC64B44E864),
+        U64_(0x84EC3C97DA624AB4), U64_(0xBD5AF13BEF0B113E),
+        U64_(0xA6274BBDD0FADD61), U64_(0xECB1AD8AEACDD58E),
+        U64_(0xCFB11EAD453994BA), U64_(0x67DE18EDA5814AF2),
+        U64_(0x81CEB32C4B43FCF4), U64_(0x80EACF948770CED7),
+        U64_(0xA2425FF75E14FC31), U64_(0xA1258379A94D028D),
+        U64_(0xCAD2F7F5359A3B3E), U64_(0x096EE45813A04330),
+        U64_(0xFD87B5F28300CA0D), U64_(0x8BCA9D6E188853FC),
+        U64_(0x9E74D1B791E07E48), U64_(0x775EA264CF55347E),
+        U64_(0xC612062576589DDA), U64_(0x95364AFE032A819E),
+        U64_(0xF79687AED3EEC551), U64_(0x3A83DDBD83F52205),
+        U64_(0x9ABE14CD44753B52), U64_(0xC4926A9672793543),
+        U64_(0xC16D9A0095928A27), U64_(0x75B7053C0F178294),
+        U64_(0xF1C90080BAF72CB1), U64_(0x5324C68B12DD6339),
+        U64_(0x971DA05074DA7BEE), U64_(0xD3F6FC16EBCA5E04),
+        U64_(0xBCE5086492111AEA), U64_(0x88F4BB1CA6BCF585),
+        U64_(0xEC1E4A7DB69561A5), U64_(0x2B31E9E3D06C32E6),
+        U64_(0x9392EE8E921D5D07), U64_(0x3AFF322E62439FD0),
+        U64_(0xB877AA3236A4B449), U64_(0x09BEFEB9FAD487C3),
+        U64_(0xE69594BEC44DE15B), U64_(0x4C2EBE687989A9B4),
+        U64_(0x901D7CF73AB0ACD9), U64_(0x0F9D37014BF60A11),
+        U64_(0xB424DC35095CD80F), U64_(0x538484C19EF38C95),
+        U64_(0xE12E13424BB40E13), U64_(0x2865A5F206B06FBA),
+        U64_(0x8CBCCC096F5088CB), U64_(0xF93F87B7442E45D4),
+        U64_(0xAFEBFF0BCB24AAFE), U64_(0xF78F69A51539D749),
+        U64_(0xDBE6FECEBDEDD5BE), U64_(0xB573440E5A884D1C),
+        U64_(0x89705F4136B4A597), U64_(0x31680A88F8953031),
+        U64_(0xABCC77118461CEFC), U64_(0xFDC20D2B36BA7C3E),
+        U64_(0xD6BF94D5E57A42BC), U64_(0x3D32907604691B4D),
+        U64_(0x8637BD05AF6C69B5), U64_(0xA63F9A49C2C1B110),
+        U64_(0xA7C5AC471B478423), U64_(0x0FCF80DC33721D54),
+        U64_(0xD1B71758E219652B), U64_(0xD3C36113404EA4A9),
+        U64_(0x83126E978D4FDF3B), U64_(0x645A1CAC083126EA),
+        U64_(0xA3D70A3D70A3D70A), U64_(0x3D70A3D70A3D70A4),
+        U64_(0xCCCCCCCCCCCCCCCC), U64_(0xCCCCCCCCCCCCCCCD),
+        U64_(0x8000000000000000), U64_(0x0000000000000000),
+        U64_(0xA000000000000000), U64_(0x0000000000000000),
+        U64_(0xC800000000000000), U64_(0x0000000000000000),
+        U64_(0xFA00000000000000), U64_(0x0000000000000000),
+        U64_(0x9C40000000000000), U64_(0x0000000000000000),
+        U64_(0xC350000000000000), U64_(0x0000000000000000),
+        U64_(0xF424000000000000), U64_(0x0000000000000000),
+        U64_(0x9896800000000000), U64_(0x0000000000000000),
+        U64_(0xBEBC200000000000), U64_(0x0000000000000000),
+        U64_(0xEE6B280000000000), U64_(0x0000000000000000),
+        U64_(0x9502F90000000000), U64_(0x0000000000000000),
+        U64_(0xBA43B74000000000), U64_(0x0000000000000000),
+        U64_(0xE8D4A51000000000), U64_(0x0000000000000000),
+        U64_(0x9184E72A00000000), U64_(0x0000000000000000),
+        U64_(0xB5E620F480000000), U64_(0x0000000000000000),
+        U64_(0xE35FA931A0000000), U64_(0x0000000000000000),
+        U64_(0x8E1BC9BF04000000), U64_(0x0000000000000000),
+        U64_(0xB1A2BC2EC5000000), U64_(0x0000000000000000),
+        U64_(0xDE0B6B3A76400000), U64_(0x0000000000000000),
+        U64_(0x8AC7230489E80000), U64_(0x0000000000000000),
+        U64_(0xAD78EBC5AC620000), U64_(0x0000000000000000),
+        U64_(0xD8D726B7177A8000), U64_(0x0000000000000000),
+        U64_(0x878678326EAC9000), U64_(0x0000000000000000),
+        U64_(0xA968163F0A57B400), U64_(0x0000000000000000),
+        U64_(0xD3C21BCECCEDA100), U64_(0x0000000000000000),
+        U64_(0x84595161401484A0), U64_(0x0000000000000000),
+        U64_(0xA56FA5B99019A5C8), U64_(0x0000000000000000),
+        U64_(0xCECB8F27F4200F3A), U64_(0x0000000000000000),
+        U64_(0x813F3978F8940984), U64_(0x4000000000000000),
+        U64_(0xA18F07D736B90BE5), U64_(0x5000000000000000),
+        U64_(0xC9F2C9CD04674EDE), U64_(0xA400000000000000),
+        U64_(0xFC6F7C4045812296), U64_(0x4D00000000000000),
+        U64_(0x9DC5ADA82B70B59D), U64_(0xF020000000000000),
+        U64_(0xC5371912364CE305), U64_(0x6C28000000000000),
+        U64_(0xF684DF56C3E01BC6), U64_(0xC732000000000000),
+        U64_(0x9A130B963A6C115C), U64_(0x3C7F400000000000),
+        U64_(0xC097CE7BC90715B3), U64_(0x4B9F100000000000),
+        U64_(0xF0BDC21ABB48DB20), U64_(0x1E86D40000000000),
+        U64_(0x96769950B50D88F4), U64_(0x1314448000000000),
+        U64_(0xBC143FA4E250EB31), U64_(0x17D955A000000000),
+        U64_(0xEB194F8E1AE525FD), U64_(0x5DCFAB0800000000),
+        U64_(0x92EFD1B8D0CF37BE), U64_(0x5AA1CAE500000000),
+        U64_(0xB7ABC627050305AD), U64_(0xF14A3D9E40000000),
+        U64_(0xE596B7B0C643C719), U64_(0x6D9CCD05D0000000),
+        U64_(0x8F7E32CE7BEA5C6F), U64_(0xE4820023A2000000),
+        U64_(0xB35DBF821AE4F38B), U64_(0xDDA2802C8A800000),
+        U64_(0xE0352F62A19E306E), U64_(0xD50B2037AD200000),
+        U64_(0x8C213D9DA502DE45), U64_(0x4526F422CC340000),
+        U64_(0xAF298D050E4395D6), U64_(0x9670B12B7F410000),
+        U64_(0xDAF3F04651D47B4C), U64_(0x3C0CDD765F114000),
+        U64_(0x88D8762BF324CD0F), U64_(0xA5880A69FB6AC800),
+        U64_(0xAB0E93B6EFEE0053), U64_(0x8EEA0D047A457A00),
+        U64_(0xD5D238A4ABE98068), U64_(0x72A4904598D6D880),
+        U64_(0x85A36366EB71F041), U64_(0x47A6DA2B7F864750),
+        U64_(0xA70C3C40A64E6C51), U64_(0x999090B65F67D924),
+        U64_(0xD0CF4B50CFE20765), U64_(0xFFF4B4E3F741CF6D),
+        U64_(0x82818F1281ED449F), U64_(0xBFF8F10E7A8921A4),
+        U64_(0xA321F2D7226895C7), U64_(0xAFF72D52192B6A0D),
+        U64_(0xCBEA6F8CEB02BB39), U64_(0x9BF4F8A69F764490),
+        U64_(0xFEE50B7025C36A08), U64_(0x02F236D04753D5B4),
+        U64_(0x9F4F2726179A2245), U64_(0x01D762422C946590),
+        U64_(0xC722F0EF9D80AAD6), U64_(0x424D3AD2B7B97EF5),
+        U64_(0xF8EBAD2B84E0D58B), U64_(0xD2E0898765A7DEB2),
+        U64_(0x9B934C3B330C8577), U64_(0x63CC55F49F88EB2F),
+        U64_(0xC2781F49FFCFA6D5), U64_(0x3CBF6B71C76B25FB),
+        U64_(0xF316271C7FC3908A), U64_(0x8BEF464E3945EF7A),
+        U64_(0x97EDD871CFDA3A56), U64_(0x97758BF0E3CBB5AC),
+        U64_(0xBDE94E8E43D0C8EC), U64_(0x3D52EEED1CBEA317),
+        U64_(0xED63A231D4C4FB27), U64_(0x4CA7AAA863EE4BDD),
+        U64_(0x945E455F24FB1CF8), U64_(0x8FE8CAA93E74EF6A),
+        U64_(0xB975D6B6EE39E436), U64_(0xB3E2FD538E122B44),
+        U64_(0xE7D34C64A9C85D44), U64_(0x60DBBCA87196B616),
+        U64_(0x90E40FBEEA1D3A4A), U64_(0xBC8955E946FE31CD),
+        U64_(0xB51D13AEA4A488DD), U64_(0x6BABAB6398BDBE41),
+        U64_(0xE264589A4DCDAB14), U64_(0xC696963C7EED2DD1),
+        U64_(0x8D7EB76070A08AEC), U64_(0xFC1E1DE5CF543CA2),
+        U64_(0xB0DE65388CC8ADA8), U64_(0x3B25A55F43294BCB),
+        U64_(0xDD15FE86AFFAD912), U64_(0x49EF0EB713F39EBE),
+        U64_(0x8A2DBF142DFCC7AB), U64_(0x6E3569326C784337),
+        U64_(0xACB92ED9397BF996), U64_(0x49C2C37F07965404),
+        U64_(0xD7E77A8F87DAF7FB), U64_(0xDC33745EC97BE906),
+        U64_(0x86F0AC99B4E8DAFD), U64_(0x69A028BB3DED71A3),
+        U64_(0xA8ACD7C0222311BC), U64_(0xC40832EA0D68CE0C),
+        U64_(0xD2D80DB02AABD62B), U64_(0xF50A3FA490C30190),
+        U64_(0x83C7088E1AAB65DB), U64_(0x792667C6DA79E0FA),
+        U64_(0xA4B8CAB1A1563F52), U64_(0x577001B891185938),
+        U64_(0xCDE6FD5E09ABCF26), U64_(0xED4C0226B55E6F86),
+        U64_(0x80B05E5AC60B6178), U64_(0x544F8158315B05B4),
+        U64_(0xA0DC75F1778E39D6), U64_(0x696361AE3DB1C721),
+        U64_(0xC913936DD571C84C), U64_(0x03BC3A19CD1E38E9),
+        U64_(0xFB5878494ACE3A5F), U64_(0x04AB48A04065C723),
+        U64_(0x9D174B2DCEC0E47B), U64_(0x62EB0D64283F9C76),
+        U64_(0xC45D1DF942711D9A), U64_(0x3BA5D0BD324F8394),
+        U64_(0xF5746577930D6500), U64_(0xCA8F44EC7EE36479),
+        U64_(0x9968BF6ABBE85F20), U64_(0x7E998B13CF4E1ECB),
+        U64_(0xBFC2EF456AE276E8), U64_(0x9E3FEDD8C321A67E),
+        U64_(0xEFB3AB16C59B14A2), U64_(0xC5CFE94EF3EA101E),
+        U64_(0x95D04AEE3B80ECE5), U64_(0xBBA1F1D158724A12),
+        U64_(0xBB445DA9CA61281F), U64_(0x2A8A6E45AE8EDC97),
+        U64_(0xEA1575143CF97226), U64_(0xF52D09D71A3293BD),
+        U64_(0x924D692CA61BE758), U64_(0x593C2626705F9C56),
+        U64_(0xB6E0C377CFA2E12E), U64_(0x6F8B2FB00C77836C),
+        U64_(0xE498F455C38B997A), U64_(0x0B6DFB9C0F956447),
+        U64_(0x8EDF98B59A373FEC), U64_(0x4724BD4189BD5EAC),
+        U64_(0xB2977EE300C50FE7), U64_(0x58EDEC91EC2CB657),
+        U64_(0xDF3D5E9BC0F653E1), U64_(0x2F2967B66737E3ED),
+        U64_(0x8B865B215899F46C), U64_(0xBD79E0D20082EE74),
+        U64_(0xAE67F1E9AEC07187), U64_(0xECD8590680A3AA11),
+        U64_(0xDA01EE641A708DE9), U64_(0xE80E6F4820CC9495),
+        U64_(0x884134FE908658B2), U64_(0x3109058D147FDCDD),
+        U64_(0xAA51823E34A7EEDE), U64_(0xBD4B46F0599FD415),
+        U64_(0xD4E5E2CDC1D1EA96), U64_(0x6C9E18AC7007C91A),
+        U64_(0x850FADC09923329E), U64_(0x03E2CF6BC604DDB0),
+        U64_(0xA6539930BF6BFF45), U64_(0x84DB8346B786151C),
+        U64_(0xCFE87F7CEF46FF16), U64_(0xE612641865679A63),
+        U64_(0x81F14FAE158C5F6E), U64_(0x4FCB7E8F3F60C07E),
+        U64_(0xA26DA3999AEF7749), U64_(0xE3BE5E330F38F09D),
+        U64_(0xCB090C8001AB551C), U64_(0x5CADF5BFD3072CC5),
+        U64_(0xFDCB4FA002162A63), U64_(0x73D9732FC7C8F7F6),
+        U64_(0x9E9F11C4014DDA7E), U64_(0x2867E7FDDCDD9AFA),
+        U64_(0xC646D63501A1511D), U64_(0xB281E1FD541501B8),
+        U64_(0xF7D88BC24209A565), U64_(0x1F225A7CA91A4226),
+        U64_(0x9AE757596946075F), U64_(0x3375788DE9B06958),
+        U64_(0xC1A12D2FC3978937), U64_(0x0052D6B1641C83AE),
+        U64_(0xF209787BB47D6B84), U64_(0xC0678C5DBD23A49A),
+        U64_(0x9745EB4D50CE6332), U64_(0xF840B7BA963646E0),
+        U64_(0xBD176620A501FBFF), U64_(0xB650E5A93BC3D898),
+        U64_(0xEC5D3FA8CE427AFF), U64_(0xA3E51F138AB4CEBE),
+        U64_(0x93BA47C980E98CDF), U64_(0xC66F336C36B10137),
+        U64_(0xB8A8D9BBE123F017), U64_(0xB80B0047445D4184),
+        U64_(0xE6D3102AD96CEC1D), U64_(0xA60DC059157491E5),
+        U64_(0x9043EA1AC7E41392), U64_(0x87C89837AD68DB2F),
+        U64_(0xB454E4A179DD1877), U64_(0x29BABE4598C311FB),
+        U64_(0xE16A1DC9D8545E94), U64_(0xF4296DD6FEF3D67A),
+        U64_(0x8CE2529E2734BB1D), U64_(0x1899E4A65F58660C),
+        U64_(0xB01AE745B101E9E4), U64_(0x5EC05DCFF72E7F8F),
+        U64_(0xDC21A1171D42645D), U64_(0x76707543F4FA1F73),
+        U64_(0x899504AE72497EBA), U64_(0x6A06494A791C53A8),
+        U64_(0xABFA45DA0EDBDE69), U64_(0x0487DB9D17636892),
+        U64_(0xD6F8D7509292D603), U64_(0x45A9D2845D3C42B6),
+        U64_(0x865B86925B9BC5C2), U64_(0x0B8A2392BA45A9B2),
+        U64_(0xA7F26836F282B732), U64_(0x8E6CAC7768D7141E),
+        U64_(0xD1EF0244AF2364FF), U64_(0x3207D795430CD926),
+        U64_(0x8335616AED761F1F), U64_(0x7F44E6BD49E807B8),
+        U64_(0xA402B9C5A8D3A6E7), U64_(0x5F16206C9C6209A6),
+        U64_(0xCD036837130890A1), U64_(0x36DBA887C37A8C0F),
+        U64_(0x802221226BE55A64), U64_(0xC2494954DA2C9789),
+        U64_(0xA02AA96B06DEB0FD), U64_(0xF2DB9BAA10B7BD6C),
+        U64_(0xC83553C5C8965D3D), U64_(0x6F92829494E5ACC7),
+        U64_(0xFA42A8B73ABBF48C), U64_(0xCB772339BA1F17F9),
+        U64_(0x9C69A97284B578D7), U64_(0xFF2A760414536EFB),
+        U64_(0xC38413CF25E2D70D), U64_(0xFEF5138519684ABA),
+        U64_(0xF46518C2EF5B8CD1), U64_(0x7EB258665FC25D69),
+        U64_(0x98BF2F79D5993802), U64_(0xEF2F773FFBD97A61),
+        U64_(0xBEEEFB584AFF8603), U64_(0xAAFB550FFACFD8FA),
+        U64_(0xEEAABA2E5DBF6784), U64_(0x95BA2A53F983CF38),
+        U64_(0x952AB45CFA97A0B2), U64_(0xDD945A747BF26183),
+        U64_(0xBA756174393D88DF), U64_(0x94F971119AEEF9E4),
+        U64_(0xE912B9D1478CEB17), U64_(0x7A37CD5601AAB85D),
+        U64_(0x91ABB422CCB812EE), U64_(0xAC62E055C10AB33A),
+        U64_(0xB616A12B7FE617AA), U64_(0x577B986B314D6009),
+        U64_(0xE39C49765FDF9D94), U64_(0xED5A7E85FDA0B80B),
+        U64_(0x8E41ADE9FBEBC27D), U64_(0x14588F13BE847307),
+        U64_(0xB1D219647AE6B31C), U64_(0x596EB2D8AE258FC8),
+        U64_(0xDE469FBD99A05FE3), U64_(0x6FCA5F8ED9AEF3BB),
+        U64_(0x8AEC23D680043BEE), U64_(0x25DE7BB9480D5854),
+        U64_(0xADA72CCC20054AE9), U64_(0xAF561AA79A10AE6A),
+        U64_(0xD910F7FF28069DA4), U64_(0x1B2BA1518094DA04),
+        U64_(0x87AA9AFF79042286), U64_(0x90FB44D2F05D0842),
+        U64_(0xA99541BF57452B28), U64_(0x353A1607AC744A53),
+        U64_(0xD3FA922F2D1675F2), U64_(0x42889B8997915CE8),
+        U64_(0x847C9B5D7C2E09B7), U64_(0x69956135FEBADA11),
+        U64_(0xA59BC234DB398C25), U64_(0x43FAB9837E699095),
+        U64_(0xCF02B2C21207EF2E), U64_(0x94F967E45E03F4BB),
+        U64_(0x8161AFB94B44F57D), U64_(0x1D1BE0EEBAC278F5),
+        U64_(0xA1BA1BA79E1632DC), U64_(0x6462D92A69731732),
+        U64_(0xCA28A291859BBF93), U64_(0x7D7B8F7503CFDCFE),
+        U64_(0xFCB2CB35E702AF78), U64_(0x5CDA735244C3D43E),
+        U64_(0x9DEFBF01B061ADAB), U64_(0x3A0888136AFA64A7),
+        U64_(0xC56BAEC21C7A1916), U64_(0x088AAA1845B8FDD0),
+        U64_(0xF6C69A72A3989F5B), U64_(0x8AAD549E57273D45),
+        U64_(0x9A3C2087A63F6399), U64_(0x36AC54E2F678864B),
+        U64_(0xC0CB28A98FCF3C7F), U64_(0x84576A1BB416A7DD),
+        U64_(0xF0FDF2D3F3C30B9F), U64_(0x656D44A2A11C51D5),
+        U64_(0x969EB7C47859E743), U64_(0x9F644AE5A4B1B325),
+        U64_(0xBC4665B596706114), U64_(0x873D5D9F0DDE1FEE),
+        U64_(0xEB57FF22FC0C7959), U64_(0xA90CB506D155A7EA),
+        U64_(0x9316FF75DD87CBD8), U64_(0x09A7F12442D588F2),
+        U64_(0xB7DCBF5354E9BECE), U64_(0x0C11ED6D538AEB2F),
+        U64_(0xE5D3EF282A242E81), U64_(0x8F1668C8A86DA5FA),
+        U64_(0x8FA475791A569D10), U64_(0xF96E017D694487BC),
+        U64_(0xB38D92D760EC4455), U64_(0x37C981DCC395A9AC),
+        U64_(0xE070F78D3927556A), U64_(0x85BBE253F47B1417),
+        U64_(0x8C469AB843B89562), U64_(0x93956D7478CCEC8E),
+        U64_(0xAF58416654A6BABB), U64_(0x387AC8D1970027B2),
+        U64_(0xDB2E51BFE9D0696A), U64_(0x06997B05FCC0319E),
+        U64_(0x88FCF317F22241E2), U64_(0x441FECE3BDF81F03),
+        U64_(0xAB3C2FDDEEAAD25A), U64_(0xD527E81CAD7626C3),
+        U64_(0xD60B3BD56A5586F1), U64_(0x8A71E223D8D3B074),
+        U64_(0x85C7056562757456), U64_(0xF6872D5667844E49),
+        U64_(0xA738C6BEBB12D16C), U64_(0xB428F8AC016561DB),
+        U64_(0xD106F86E69D785C7), U64_(0xE13336D701BEBA52),
+        U64_(0x82A45B450226B39C), U64_(0xECC0024661173473),
+        U64_(0xA34D721642B06084), U64_(0x27F002D7F95D0190),
+        U64_(0xCC20CE9BD35C78A5), U64_(0x31EC038DF7B441F4),
+        U64_(0xFF290242C83396CE), U64_(0x7E67047175A15271),
+        U64_(0x9F79A169BD203E41), U64_(0x0F0062C6E984D386),
+        U64_(0xC75809C42C684DD1), U64_(0x52C07B78A3E60868),
+        U64_(0xF92E0C3537826145), U64_(0xA7709A56CCDF8A82),
+        U64_(0x9BBCC7A142B17CCB), U64_(0x88A66076400BB691),
+        U64_(0xC2ABF989935DDBFE), U64_(0x6ACFF893D00EA435),
+        U64_(0xF356F7EBF83552FE), U64_(0x0583F6B8C4124D43),
+        U64_(0x98165AF37B2153DE), U64_(0xC3727A337A8B704A),
+        U64_(0xBE1BF1B059E9A8D6), U64_(0x744F18C0592E4C5C),
+        U64_(0xEDA2EE1C7064130C), U64_(0x1162DEF06F79DF73),
+        U64_(0x9485D4D1C63E8BE7), U64_(0x8ADDCB5645AC2BA8),
+        U64_(0xB9A74A0637CE2EE1), U64_(0x6D953E2BD7173692),
+        U64_(0xE8111C87C5C1BA99), U64_(0xC8FA8DB6CCDD0437),
+        U64_(0x910AB1D4DB9914A0), U64_(0x1D9C9892400A22A2),
+        U64_(0xB54D5E4A127F59C8), U64_(0x2503BEB6D00CAB4B),
+        U64_(0xE2A0B5DC971F303A), U64_(0x2E44AE64840FD61D),
+        U64_(0x8DA471A9DE737E24), U64_(0x5CEAECFED289E5D2),
+        U64_(0xB10D8E1456105DAD), U64_(0x7425A83E872C5F47),
+        U64_(0xDD50F1996B947518), U64_(0xD12F124E28F77719),
+        U64_(0x8A5296FFE33CC92F), U64_(0x82BD6B70D99AAA6F),
+        U64_(0xACE73CBFDC0BFB7B), U64_(0x636CC64D1001550B),
+        U64_(0xD8210BEFD30EFA5A), U64_(0x3C47F7E05401AA4E),
+        U64_(0x8714A775E3E95C78), U64_(0x65ACFAEC34810A71),
+        U64_(0xA8D9D1535CE3B396), U64_(0x7F1839A741A14D0D),
+        U64_(0xD31045A8341CA07C), U64_(0x1EDE48111209A050),
+        U64_(0x83EA2B892091E44D), U64_(0x934AED0AAB460432),
+        U64_(0xA4E4B66B68B65D60), U64_(0xF81DA84D5617853F),
+        U64_(0xCE1DE40642E3F4B9), U64_(0x36251260AB9D668E),
+        U64_(0x80D2AE83E9CE78F3), U64_(0xC1D72B7C6B426019),
+        U64_(0xA1075A24E4421730), U64_(0xB24CF65B8612F81F),
+        U64_(0xC94930AE1D529CFC), U64_(0xDEE033F26797B627),
+        U64_(0xFB9B7CD9A4A7443C), U64_(0x169840EF017DA3B1),
+        U64_(0x9D412E0806E88AA5), U64_(0x8E1F289560EE864E),
+        U64_(0xC491798A08A2AD4E), U64_(0xF1A6F2BAB92A27E2),
+        U64_(0xF5B5D7EC8ACB58A2), U64_(0xAE10AF696774B1DB),
+        U64_(0x9991A6F3D6BF1765), U64_(0xACCA6DA1E0A8EF29),
+        U64_(0xBFF610B0CC6EDD3F), U64_(0x17FD090A58D32AF3),
+        U64_(0xEFF394DCFF8A948E), U64_(0xDDFC4B4CEF07F5B0),
+        U64_(0x95F83D0A1FB69CD9), U64_(0x4ABDAF101564F98E),
+        U64_(0xBB764C4CA7A4440F), U64_(0x9D6D1AD41ABE37F1),
+        U64_(0xEA53DF5FD18D5513), U64_(0x84C86189216DC5ED),
+        U64_(0x92746B9BE2F8552C), U64_(0x32FD3CF5B4E49BB4),
+        U64_(0xB7118682DBB66A77), U64_(0x3FBC8C33221DC2A1),
+        U64_(0xE4D5E82392A40515), U64_(0x0FABAF3FEAA5334A),
+        U64_(0x8F05B1163BA6832D), U64_(0x29CB4D87F2A7400E),
+        U64_(0xB2C71D5BCA9023F8), U64_(0x743E20E9EF511012),
+        U64_(0xDF78E4B2BD342CF6), U64_(0x914DA9246B255416),
+        U64_(0x8BAB8EEFB6409C1A), U64_(0x1AD089B6C2F7548E),
+        U64_(0xAE9672ABA3D0C320), U64_(0xA184AC2473B529B1),
+        U64_(0xDA3C0F568CC4F3E8), U64_(0xC9E5D72D90A2741E),
+        U64_(0x8865899617FB1871), U64_(0x7E2FA67C7A658892),
+        U64_(0xAA7EEBFB9DF9DE8D), U64_(0xDDBB901B98FEEAB7),
+        U64_(0xD51EA6FA85785631), U64_(0x552A74227F3EA565),
+        U64_(0x8533285C936B35DE), U64_(0xD53A88958F87275F),
+        U64_(0xA67FF273B8460356), U64_(0x8A892ABAF368F137),
+        U64_(0xD01FEF10A657842C), U64_(0x2D2B7569B0432D85),
+        U64_(0x8213F56A67F6B29B), U64_(0x9C3B29620E29FC73),
+        U64_(0xA298F2C501F45F42), U64_(0x8349F3BA91B47B8F),
+        U64_(0xCB3F2F7642717713), U64_(0x241C70A936219A73),
+        U64_(0xFE0EFB53D30DD4D7), U64_(0xED238CD383AA0110),
+        U64_(0x9EC95D1463E8A506), U64_(0xF4363804324A40AA),
+        U64_(0xC67BB4597CE2CE48), U64_(0xB143C6053EDCD0D5),
+        U64_(0xF81AA16FDC1B81DA), U64_(0xDD94B7868E94050A),
+        U64_(0x9B10A4E5E9913128), U64_(0xCA7CF2B4191C8326),
+        U64_(0xC1D4CE1F63F57D72), U64_(0xFD1C2F611F63A3F0),
+        U64_(0xF24A01A73CF2DCCF), U64_(0xBC633B39673C8CEC),
+        U64_(0x976E41088617CA01), U64_(0xD5BE0503E085D813),
+        U64_(0xBD49D14AA79DBC82), U64_(0x4B2D8644D8A74E18),
+        U64_(0xEC9C459D51852BA2), U64_(0xDDF8E7D60ED1219E),
+        U64_(0x93E1AB8252F33B45), U64_(0xCABB90E5C942B503),
+        U64_(0xB8DA1662E7B00A17), U64_(0x3D6A751F3B936243),
+        U64_(0xE7109BFBA19C0C9D), U64_(0x0CC512670A783AD4),
+        U64_(0x906A617D450187E2), U64_(0x27FB2B80668B24C5),
+        U64_(0xB484F9DC9641E9DA), U64_(0xB1F9F660802DEDF6),
+        U64_(0xE1A63853BBD26451), U64_(0x5E7873F8A0396973),
+        U64_(0x8D07E33455637EB2), U64_(0xDB0B487B6423E1E8),
+        U64_(0xB049DC016ABC5E5F), U64_(0x91CE1A9A3D2CDA62),
+        U64_(0xDC5C5301C56B75F7), U64_(0x7641A140CC7810FB),
+        U64_(0x89B9B3E11B6329BA), U64_(0xA9E904C87FCB0A9D),
+        U64_(0xAC2820D9623BF429), U64_(0x546345FA9FBDCD44),
+        U64_(0xD732290FBACAF133), U64_(0xA97C177947AD4095),
+        U64_(0x867F59A9D4BED6C0), U64_(0x49ED8EABCCCC485D),
+        U64_(0xA81F301449EE8C70), U64_(0x5C68F256BFFF5A74),
+        U64_(0xD226FC195C6A2F8C), U64_(0x73832EEC6FFF3111),
+        U64_(0x83585D8FD9C25DB7), U64_(0xC831FD53C5FF7EAB),
+        U64_(0xA42E74F3D032F525), U64_(0xBA3E7CA8B77F5E55),
+        U64_(0xCD3A1230C43FB26F), U64_(0x28CE1BD2E55F35EB),
+        U64_(0x80444B5E7AA7CF85), U64_(0x7980D163CF5B81B3),
+        U64_(0xA0555E361951C366), U64_(0xD7E105BCC332621F),
+        U64_(0xC86AB5C39FA63440), U64_(0x8DD9472BF3FEFAA7),
+        U64_(0xFA856334878FC150), U64_(0xB14F98F6F0FEB951),
+        U64_(0x9C935E00D4B9D8D2), U64_(0x6ED1BF9A569F33D3),
+        U64_(0xC3B8358109E84F07), U64_(0x0A862F80EC4700C8),
+        U64_(0xF4A642E14C6262C8), U64_(0xCD27BB612758C0FA),
+        U64_(0x98E7E9CCCFBD7DBD), U64_(0x8038D51CB897789C),
+        U64_(0xBF21E44003ACDD2C), U64_(0xE0470A63E6BD56C3),
+        U64_(0xEEEA5D5004981478), U64_(0x1858CCFCE06CAC74),
+        U64_(0x95527A5202DF0CCB), U64_(0x0F37801E0C43EBC8),
+        U64_(0xBAA718E68396CFFD), U64_(0xD30560258F54E6BA),
+        U64_(0xE950DF20247C83FD), U64_(0x47C6B82EF32A2069),
+        U64_(0x91D28B7416CDD27E), U64_(0x4CDC331D57FA5441),
+        U64_(0xB6472E511C81471D), U64_(0xE0133FE4ADF8E952),
+        U64_(0xE3D8F9E563A198E5), U64_(0x58180FDDD97723A6),
+        U64_(0x8E679C2F5E44FF8F), U64_(0x570F09EAA7EA7648)
+    };
+
+    struct U128
+    {
+        uint64_t hi;
+        uint64_t lo;
+    };
+
+    inline U128 mul128(uint64_t a, uint64_t b)
+    {
+        U128 rv;
+#if   (defined NUMBER_UMUL128_)
+        rv.lo = _umul128(a, b, &rv.hi);
+#elif (defined NUMBER_INT128_)
+        unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        rv.hi = static_cast<uint64_t>(r >> 64);
+        rv.lo = static_cast<uint64_t>(r);
+#else
+        uint64_t a_lo = a & 0xFFFFFFFFU, a_hi = a >> 32;
+        uint64_t b_lo = b & 0xFFFFFFFFU, b_hi = b >> 32;
+        uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi;
+        uint64_t hl = a_hi * b_lo, hh = a_hi * b_hi;
+        uint64_t md = (ll >> 32) + (lh & 0xFFFFFFFFU) + (hl & 0xFFFFFFFFU);
+        rv.lo = (md << 32) | (ll & 0xFFFFFFFFU);
+        rv.hi = hh + (lh >> 32) + (hl >> 32) + (md >> 32);
+#endif
+        return rv;
+    }
+
+    inline int clz64(uint64_t x) /* x != 0 */
+    {
+        int n = 0;
+        if ((x & U64_(0xFFFFFFFF00000000)) == 0) { n += 32; x <<= 32; }
+        if ((x & U64_(0xFFFF000000000000)) == 0) { n += 16; x <<= 16; }
+        if ((x & U64_(0xFF00000000000000)) == 0) { n +=  8; x <<=  8; }
+        if ((x & U64_(0xF000000000000000)) == 0) { n +=  4; x <<=  4; }
+        if ((x & U64_(0xC000000000000000)) == 0) { n +=  2; x <<=  2; }
+        if ((x & U64_(0x8000000000000000)) == 0) { n +=  1; }
+        return n;
+    }
+
+    /* biased exponent and explicit mantissa of a double */
+    struct Float
+    {
+        uint64_t m;
+        int32_t  e;
+    };
+
+    inline bool operator == (Float const & lhs, Float const & rhs)
+    {
+        return lhs.m == rhs.m && lhs.e == rhs.e;
+    }
+
+    inline double to_double(Float const & f, bool negative)
+    {
+        uint64_t bits = f.m
+                      | (static_cast<uint64_t>(f.e) << MANTISSA_BITS)
+                      | (static_cast<uint64_t>(negative ? 1 : 0) << 63);
+        double rv;
+        ::memcpy(&rv, &bits, sizeof(rv));
+        return rv;
+    }
+
+    /* Eisel-Lemire, rounds `w * 10^q` to nearest */
+    inline Float eisel_lemire(int64_t q, uint64_t w)
+    {
+        Float rv = { 0, 0 };
+        if (w == 0 || q < SMALLEST_POWER)
+            return rv;
+        if (q > LARGEST_POWER) {
+            rv.e = INFINITE_POWER;
+            return rv;
+        }
+
+        int lz = clz64(w);
+        w <<= lz;
+
+        /* w * 5^q, with the second half of 5^q only if needed */
+        static const int      PRECISION = MANTISSA_BITS + 3;
+        static const uint64_t MASK      = ~uint64_t() >> PRECISION;
+        size_t index = static_cast<size_t>(q - SMALLEST_POWER) << 1;
+        U128 product = mul128(w, POW5_128[index]);
+        if ((product.hi & MASK) == MASK) {
+            U128 second = mul128(w, POW5_128[index + 1]);
+            product.lo += second.hi;
+            if (second.hi > product.lo)
+                ++product.hi;
+        }
+
+        int upper = static_cast<int>(product.hi >> 63);
+        int shift = upper + 64 - PRECISION;
+        rv.m = product.hi >> shift;
+        /* floor(log2(10^q)) + 63 */
+        int32_t power = static_cast<int32_t>(((152170 + 65536) * q) >> 16) + 63;
+        rv.e = power + upper - lz - MINIMUM_EXPONENT;
+
+        if (rv.e <= 0) { /* subnormal */
+            if (-rv.e + 1 >= 64) {
+                rv.m = 0;
+                rv.e = 0;
+                return rv;
+            }
+            rv.m >>= -rv.e + 1;
+            rv.m  += (rv.m & 1);
+            rv.m >>= 1;
+            rv.e   = (rv.m < (U64_(1) << MANTISSA_BITS)) ? 0 : 1;
+            return rv;
+        }
+
+        /* exactly halfway, round to even */
+        if (product.lo <= 1 && q >= -4 && q <= 23 && (rv.m & 3) == 1 &&
+            (rv.m << shift) == product.hi)
+            rv.m &= ~U64_(1);
+
+        rv.m  += (rv.m & 1);
+        rv.m >>= 1;
+        if (rv.m >= (U64_(2) << MANTISSA_BITS)) {
+            rv.m = (U64_(1) << MANTISSA_BITS);
+            rv.e++;
+        }
+        rv.m &= ~(U64_(1) << MANTISSA_BITS);
+        if (rv.e >= INFINITE_POWER) {
+            rv.e = INFINITE_POWER;
+            rv.m = 0;
+        }
+        return rv;
+    }
+
+    /* a fixed-size unsigned big integer, for the exact fallback */
+    class Bigint
+    {
+    public:
+        explicit Bigint(uint64_t val)
+            : len_(0)
+        {
+            for (; val != 0; val >>= 32)
+                dat_[len_++] = static_cast<uint32_t>(val);
+        }
+
+        void mul(uint32_t val)
+        {
+            uint64_t carry = 0;
+            for (size_t i = 0; i < len_; ++i) {
+                uint64_t cur = uint64_t(dat_[i]) * val + carry;
+                dat_[i] = static_cast<uint32_t>(cur);
+                carry   = cur >> 32;
+            }
+            push(carry);
+        }
+
+        void add(uint32_t val)
+        {
+            uint64_t carry = val;
+            for (size_t i = 0; i < len_ && carry != 0; ++i) {
+                uint64_t cur = uint64_t(dat_[i]) + carry;
+                dat_[i] = static_cast<uint32_t>(cur);
+                carry   = cur >> 32;
+            }
+            push(carry);
+        }
+
+        void mul_pow5(uint64_t n)
+        {
+            static const uint32_t POW5_13 = 1220703125U;
+            for (; n >= 13; n -= 13)
+                mul(POW5_13);
+            uint32_t rest = 1;
+            for (; n > 0; --n)
+                rest *= 5U;
+            mul(rest);
+        }
+
+        void shl(uint64_t n)
+        {
+            if (len_ == 0)
+                return;
+
+            size_t limbs = static_cast<size_t>(n >> 5);
+            int    bits  = static_cast<int>(n & 31);
+            ASSERT_DBG(len_ + limbs + 1 <= CAPACITY);
+
+            dat_[len_] = 0;
+            for (size_t i = len_ + 1; i-- > 0; ) {
+                uint32_t hi = dat_[i] << bits;
+                uint32_t lo = (bits == 0 || i == 0)
+                            ? 0 : (dat_[i - 1] >> (32 - bits));
+                dat_[i + limbs] = hi | lo;
+            }
+            for (size_t i = 0; i < limbs; ++i)
+                dat_[i] = 0;
+
+            len_ += limbs + 1;
+            while (len_ > 0 && dat_[len_ - 1] == 0)
+                --len_;
+        }
+
+        int compare(Bigint const & rhs) const
+        {
+            if (len_ != rhs.len_)
+                return len_ < rhs.len_ ? -1 : 1;
+            for (size_t i = len_; i-- > 0; )
+                if (dat_[i] != rhs.dat_[i])
+                    return dat_[i] < rhs.dat_[i] ? -1 : 1;
+            return 0;
+        }
+
+    private:
+        void push(uint64_t carry)
+        {
+            if (carry != 0) {
+                ASSERT_DBG(len_ < CAPACITY);
+                dat_[len_++] = static_cast<uint32_t>(carry);
+            }
+        }
+
+    private:
+        static const size_t CAPACITY = 136; /* 4352 bits */
+
+        uint32_t dat_[CAPACITY];
+        size_t   len_;
+    };
+
+    /* decides between `f` and its successor, by comparing the decimal with
+     * the halfway point of them exactly. */
+    inline Float fallback(Decimal const & dec, Float f)
+    {
+        /* digits */
+        Bigint lhs(dec.w);
+        for (size_t i = 0; i < dec.count; ) {
+            uint32_t chunk = 0, scale = 1;
+            for (size_t n = 0; n < 9 && i < dec.count; ++n, ++i) {
+                chunk  = chunk * 10U + static_cast<uint32_t>(dec.more[i] - '0');
+                scale *= 10U;
+            }
+            lhs.mul(scale);
+            lhs.add(chunk);
+        }
+
+        /* halfway = (2m + 1) * 2^(e2 - 1) */
+        uint64_t m  = f.m | (f.e != 0 ? (U64_(1) << MANTISSA_BITS) : 0);
+        int64_t  e2 = int64_t(f.e != 0 ? f.e : 1) + MINIMUM_EXPONENT
+                    - MANTISSA_BITS;
+        Bigint   rhs(2 * m + 1);
+
+        /* lhs * 10^exp <=> rhs * 2^(e2 - 1) */
+        int64_t exp  = dec.exp - static_cast<int64_t>(dec.count);
+        int64_t lhs2 = 0;
+        int64_t rhs2 = e2 - 1;
+        if (exp >= 0) {
+            lhs.mul_pow5(static_cast<uint64_t>(exp));
+            lhs2 += exp;
+        } else {
+            rhs.mul_pow5(static_cast<uint64_t>(-exp));
+            rhs2 -= exp;
+        }
+        if (lhs2 > rhs2)
+            lhs.shl(static_cast<uint64_t>(lhs2 - rhs2));
+        else
+            rhs.shl(static_cast<uint64_t>(rhs2 - lhs2));
+
+        int cmp = lhs.compare(rhs);
+        if (cmp > 0 || (cmp == 0 && (dec.sticky || (f.m & 1) != 0))) {
+            /* successor, carry into exponent is fine */
+            uint64_t bits = f.m | (static_cast<uint64_t>(f.e) << MANTISSA_BITS);
+            bits += 1;
+            f.m = bits & ((U64_(1) << MANTISSA_BITS) - 1);
+            f.e = static_cast<int32_t>(bits >> MANTISSA_BITS);
+        }
+        return f;
+    }
+}}
+
+/****************************************************************************
+ *  helper of format
+ ***************************************************************************/
+
+namespace number { namespace
+{
+    /* "00" ~ "99" */
+    static const char DIGITS_LUT[] =
+        "00010203040506070809" "10111213141516171819"
+        "20212223242526272829" "30313233343536373839"
+        "40414243444546474849" "50515253545556575859"
+        "60616263646566676869" "70717273747576777879"
+        "80818283848586878889" "90919293949596979899";
+
+    inline int count_digits(uint64_t val)
+    {
+        int n = 1;
+        for (;;) {
+            if (val < 10U)     return n;
+            if (val < 100U)    return n + 1;
+            if (val < 1000U)   return n + 2;
+            if (val < 10000U)  return n + 3;
+            val /= 10000U;
+            n   += 4;
+        }
+    }
+
+    /* writes exactly `count_digits(val)` chars */
+    inline char * write_digits(uint64_t val, char * dst)
+    {
+        char * end = dst + count_digits(val);
+        char * cur = end;
+        while (val >= 100U) {
+            size_t i = static_cast<size_t>(val % 100U) << 1;
+            val /= 100U;
+            *--cur = DIGITS_LUT[i + 1];
+            *--cur = DIGITS_LUT[i    ];
+        }
+        if (val >= 10U) {
+            size_t i = static_cast<size_t>(val) << 1;
+            *--cur = DIGITS_LUT[i + 1];
+            *--cur = DIGITS_LUT[i    ];
+        } else {
+            *--cur = static_cast<char>('0' + val);
+        }
+        return end;
+    }
+
+    /* a floating number `f * 2^e` without implicit bit */
+    struct DiyFp
+    {
+        uint64_t f;
+        int      e;
+    };
+
+    inline DiyFp make_diyfp(uint64_t f, int e)
+    {
+        DiyFp rv = { f, e };
+        return rv;
+    }
+
+    inline DiyFp operator - (DiyFp const & lhs, DiyFp const & rhs)
+    {
+        return make_diyfp(lhs.f - rhs.f, lhs.e);
+    }
+
+    inline DiyFp operator * (DiyFp const & lhs, DiyFp const & rhs)
+    {
+        U128 p = mul128(lhs.f, rhs.f);
+        return make_diyfp(p.hi + (p.lo >> 63), lhs.e + rhs.e + 64);
+    }
+
+    inline DiyFp normalize(DiyFp const & x)
+    {
+        int s = clz64(x.f);
+        return make_diyfp(x.f << s, x.e - s);
+    }
+
+    /* 10^k, k = -348 + 8i, rounded to 64 bits */
+    struct CachedPower
+    {
+        uint64_t f;
+        int16_t  e;
+    };
+
+    static const CachedPower CACHED_POWERS[] =
+    {
+        { U64_(0xFA8FD5A0081C0288), -1220 }, { U64_(0xBAAEE17FA23EBF76), -1193 },
+        { U64_(0x8B16FB203055AC76), -1166 }, { U64_(0xCF42894A5DCE35EA), -1140 },
+        { U64_(0x9A6BB0AA55653B2D), -1113 }, { U64_(0xE61ACF033D1A45DF), -1087 },
+        { U64_(0xAB70FE17C79AC6CA), -1060 }, { U64_(0xFF77B1FCBEBCDC4F), -1034 },
+        { U64_(0xBE5691EF416BD60C), -1007 }, { U64_(0x8DD01FAD907FFC3C),  -980 },
+        { U64_(0xD3515C2831559A83),  -954 }, { U64_(0x9D71AC8FADA6C9B5),  -927 },
+        { U64_(0xEA9C227723EE8BCB),  -901 }, { U64_(0xAECC49914078536D),  -874 },
+        { U64_(0x823C12795DB6CE57),  -847 }, { U64_(0xC21094364DFB5637),  -821 },
+        { U64_(0x9096EA6F3848984F),  -794 }, { U64_(0xD77485CB25823AC7),  -768 },
+        { U64_(0xA086CFCD97BF97F4),  -741 }, { U64_(0xEF340A98172AACE5),  -715 },
+        { U64_(0xB23867FB2A35B28E),  -688 }, { U64_(0x84C8D4DFD2C63F3B),  -661 },
+        { U64_(0xC5DD44271AD3CDBA),  -635 }, { U64_(0x936B9FCEBB25C996),  -608 },
+        { U64_(0xDBAC6C247D62A584),  -582 }, { U64_(0xA3AB66580D5FDAF6),  -555 },
+        { U64_(0xF3E2F893DEC3F126),  -529 }, { U64_(0xB5B5ADA8AAFF80B8),  -502 },
+        { U64_(0x87625F056C7C4A8B),  -475 }, { U64_(0xC9BCFF6034C13053),  -449 },
+        { U64_(0x964E858C91BA2655),  -422 }, { U64_(0xDFF9772470297EBD),  -396 },
+        { U64_(0xA6DFBD9FB8E5B88F),  -369 }, { U64_(0xF8A95FCF88747D94),  -343 },
+        { U64_(0xB94470938FA89BCF),  -316 }, { U64_(0x8A08F0F8BF0F156B),  -289 },
+        { U64_(0xCDB02555653131B6),  -263 }, { U64_(0x993FE2C6D07B7FAC),  -236 },
+        { U64_(0xE45C10C42A2B3B06),  -210 }, { U64_(0xAA242499697392D3),  -183 },
+        { U64_(0xFD87B5F28300CA0E),  -157 }, { U64_(0xBCE5086492111AEB),  -130 },
+        { U64_(0x8CBCCC096F5088CC),  -103 }, { U64_(0xD1B71758E219652C),   -77 },
+        { U64_(0x9C40000000000000),   -50 }, { U64_(0xE8D4A51000000000),   -24 },
+        { U64_(0xAD78EBC5AC620000),     3 }, { U64_(0x813F3978F8940984),    30 },
+        { U64_(0xC097CE7BC90715B3),    56 }, { U64_(0x8F7E32CE7BEA5C70),    83 },
+        { U64_(0xD5D238A4ABE98068),   109 }, { U64_(0x9F4F2726179A2245),   136 },
+        { U64_(0xED63A231D4C4FB27),   162 }, { U64_(0xB0DE65388CC8ADA8),   189 },
+        { U64_(0x83C7088E1AAB65DB),   216 }, { U64_(0xC45D1DF942711D9A),   242 },
+        { U64_(0x924D692CA61BE758),   269 }, { U64_(0xDA01EE641A708DEA),   295 },
+        { U64_(0xA26DA3999AEF774A),   322 }, { U64_(0xF209787BB47D6B85),   348 },
+        { U64_(0xB454E4A179DD1877),   375 }, { U64_(0x865B86925B9BC5C2),   402 },
+        { U64_(0xC83553C5C8965D3D),   428 }, { U64_(0x952AB45CFA97A0B3),   455 },
+        { U64_(0xDE469FBD99A05FE3),   481 }, { U64_(0xA59BC234DB398C25),   508 },
+        { U64_(0xF6C69A72A3989F5C),   534 }, { U64_(0xB7DCBF5354E9BECE),   561 },
+        { U64_(0x88FCF317F22241E2),   588 }, { U64_(0xCC20CE9BD35C78A5),   614 },
+        { U64_(0x98165AF37B2153DF),   641 }, { U64_(0xE2A0B5DC971F303A),   667 },
+        { U64_(0xA8D9D1535CE3B396),   694 }, { U64_(0xFB9B7CD9A4A7443C),   720 },
+        { U64_(0xBB764C4CA7A44410),   747 }, { U64_(0x8BAB8EEFB6409C1A),   774 },
+        { U64_(0xD01FEF10A657842C),   800 }, { U64_(0x9B10A4E5E9913129),   827 },
+        { U64_(0xE7109BFBA19C0C9D),   853 }, { U64_(0xAC2820D9623BF429),   880 },
+        { U64_(0x80444B5E7AA7CF85),   907 }, { U64_(0xBF21E44003ACDD2D),   933 },
+        { U64_(0x8E679C2F5E44FF8F),   960 }, { U64_(0xD433179D9C8CB841),   986 },
+        { U64_(0x9E19DB92B4E31BA9),  1013 }, { U64_(0xEB96BF6EBADF77D9),  1039 },
+        { U64_(0xAF87023B9BF0EE6B),  1066 }
+    };
+
+    static const uint64_t POW10_U64[] =
+    {
+        U64_(1),                   U64_(10),
+        U64_(100),                 U64_(1000),
+        U64_(10000),               U64_(100000),
+        U64_(1000000),             U64_(10000000),
+        U64_(100000000),           U64_(1000000000),
+        U64_(10000000000),         U64_(100000000000),
+        U64_(1000000000000),       U64_(10000000000000),
+        U64_(100000000000000),     U64_(1000000000000000),
+        U64_(10000000000000000),   U64_(100000000000000000),
+        U64_(1000000000000000000), U64_(10000000000000000000)
+    };
+
+    /* c = 10^-K, so that `w * c` has its exponent in [-60, -32] */
+    inline DiyFp cached_power(int e, int & K)
+    {
+        double dk = (-61 - e) * 0.30102999566398114 + 347;
+        int    k  = static_cast<int>(dk);
+        if (dk - k > 0.0)
+            k++;
+
+        size_t index = static_cast<size_t>((k >> 3) + 1);
+        K = -(-348 + static_cast<int>(index << 3));
+        return make_diyfp(CACHED_POWERS[index].f, CACHED_POWERS[index].e);
+    }
+
+    inline void grisu_round(char * buffer, int len, uint64_t delta,
+                            uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+    {
+        while (rest < wp_w && delta - rest >= ten_kappa &&
+               (rest + ten_kappa < wp_w ||
+                wp_w - rest > rest + ten_kappa - wp_w)) {
+            buffer[len - 1]--;
+            rest += ten_kappa;
+        }
+    }
+
+    inline void digit_gen(DiyFp const & W, DiyFp const & Mp, uint64_t delta,
+                          char * buffer, int & len, int & K)
+    {
+        DiyFp const one  = make_diyfp(U64_(1) << -Mp.e, Mp.e);
+        DiyFp const wp_w = Mp - W;
+
+        uint32_t p1    = static_cast<uint32_t>(Mp.f >> -one.e);
+        uint64_t p2    = Mp.f & (one.f - 1);
+        int      kappa = count_digits(p1);
+        len = 0;
+
+        /* integral part */
+        while (kappa > 0) {
+            uint32_t d = 0;
+            switch (kappa) /* constant divisors */
+            {
+            case  9: d = p1 /  100000000U; p1 %=  100000000U; break;
+            case  8: d = p1 /   10000000U; p1 %=   10000000U; break;
+            case  7: d = p1 /    1000000U; p1 %=    1000000U; break;
+            case  6: d = p1 /     100000U; p1 %=     100000U; break;
+            case  5: d = p1 /      10000U; p1 %=      10000U; break;
+            case  4: d = p1 /       1000U; p1 %=       1000U; break;
+            case  3: d = p1 /        100U; p1 %=        100U; break;
+            case  2: d = p1 /         10U; p1 %=         10U; break;
+            case  1: d = p1;               p1  =          0U; break;
+            default: break;
+            }
+            if (d != 0 || len != 0)
+                buffer[len++] = static_cast<char>('0' + d);
+            kappa--;
+
+            uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+            if (rest <= delta) {
+                K += kappa;
+                grisu_round(buffer, len, delta, rest,
+                            POW10_U64[kappa] << -one.e, wp_w.f);
+                return;
+            }
+        }
+
+        /* fractional part */
+        for (;;) {
+            p2    *= 10;
+            delta *= 10;
+            char d = static_cast<char>(p2 >> -one.e);
+            if (d != 0 || len != 0)
+                buffer[len++] = static_cast<char>('0' + d);
+            p2 &= one.f - 1;
+            kappa--;
+            if (p2 < delta) {
+                K += kappa;
+                int index = -kappa;
+                grisu_round(buffer, len, delta, p2, one.f,
+                            wp_w.f * (index < 20 ? POW10_U64[index] : 0));
+                return;
+            }
+        }
+    }
+
+    /* shortest digits in almost all cases, and always round-trip */
+    inline void grisu2(uint64_t bits, char * buffer, int & len, int & K)
+    {
+        static const uint64_t HIDDEN = U64_(1) << MANTISSA_BITS;
+
+        /* v = f * 2^e */
+        int      biased = static_cast<int>(bits >> MANTISSA_BITS) & 0x7FF;
+        uint64_t f      = bits & (HIDDEN - 1);
+        DiyFp    v      = biased != 0
+                        ? make_diyfp(f + HIDDEN, biased - 1075)
+                        : make_diyfp(f, -1074);
+
+        /* boundaries m+ and m-, with the same exponent */
+        DiyFp mp = make_diyfp((v.f << 1) + 1, v.e - 1);
+        while ((mp.f & (HIDDEN << 1)) == 0) {
+            mp.f <<= 1;
+            mp.e--;
+        }
+        mp.f <<= 64 - MANTISSA_BITS - 2;
+        mp.e  -= 64 - MANTISSA_BITS - 2;
+        DiyFp mm = (v.f == HIDDEN)
+                 ? make_diyfp((v.f << 2) - 1, v.e - 2)
+                 : make_diyfp((v.f << 1) - 1, v.e - 1);
+        mm.f <<= mm.e - mp.e;
+        mm.e   = mp.e;
+
+        DiyFp c  = cached_power(mp.e, K);
+        DiyFp W  = normalize(v) * c;
+        DiyFp Wp = mp * c;
+        DiyFp Wm = mm * c;
+        Wm.f++;
+        Wp.f--;
+        digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+    }
+
+    inline char * write_exponent(int K, char * dst)
+    {
+        if (K < 0) {
+            *dst++ = '-';
+            K = -K;
+        }
+        return write_digits(static_cast<uint64_t>(K), dst);
+    }
+
+    /* digits `buffer[0, length) * 10^k` in JSON, '.' or 'e' is always
+     * there, so that the value is read back as a double */
+    inline char * prettify(char * buffer, int length, int k)
+    {
+        int const kk = length + k; /* 10^(kk-1) <= v < 10^kk */
+
+        if (0 <= k && kk <= 21) {
+            /* 1234e7 -> 12340000000.0 */
+            for (int i = length; i < kk; i++)
+                buffer[i] = '0';
+            buffer[kk    ] = '.';
+            buffer[kk + 1] = '0';
+            return buffer + kk + 2;
+        } else if (0 < kk && kk <= 21) {
+            /* 1234e-2 -> 12.34 */
+            ::memmove(buffer + kk + 1, buffer + kk,
+                      static_cast<size_t>(length - kk));
+            buffer[kk] = '.';
+            return buffer + length + 1;
+        } else if (-6 < kk && kk <= 0) {
+            /* 1234e-6 -> 0.001234 */
+            int const offset = 2 - kk;
+            ::memmove(buffer + offset, buffer, static_cast<size_t>(length));
+            buffer[0] = '0';
+            buffer[1] = '.';
+            for (int i = 2; i < offset; i++)
+                buffer[i] = '0';
+            return buffer + length + offset;
+        } else if (length == 1) {
+            /* 1e30 */
+            buffer[1] = 'e';
+            return write_exponent(kk - 1, buffer + 2);
+        } else {
+            /* 1234e30 -> 1.234e33 */
+            ::memmove(buffer + 2, buffer + 1, static_cast<size_t>(length - 1));
+            buffer[1]          = '.';
+            buffer[length + 1] = 'e';
+            return write_exponent(kk - 1, buffer + length + 2);
+        }
+    }
+}}
+
+/****************************************************************************
+ *  number
+ ***************************************************************************/
+
+namespace number
+{
+    double to_double(Decimal const & dec)
+    {
+        /* Clinger, both `w` and 10^exp are exact */
+        if (dec.truncated == false && dec.w <= MAX_EXACT_INT &&
+            dec.exp >= -MAX_POW10 && dec.exp <= MAX_POW10 + 15) {
+            double val = static_cast<double>(dec.w);
+            if (dec.exp < 0) {
+                val /= POW10[-dec.exp];
+            } else if (dec.exp <= MAX_POW10) {
+                val *= POW10[dec.exp];
+            } else {
+                /* w * 10^(exp - 22) may still be exact */
+                uint64_t w = dec.w;
+                for (int64_t i = dec.exp - MAX_POW10; i > 0 && w != 0; --i)
+                    if ((w *= 10U) > MAX_EXACT_INT)
+                        break;
+                if (w <= MAX_EXACT_INT)
+                    val = static_cast<double>(w) * POW10[MAX_POW10];
+                else
+                    val = to_double(eisel_lemire(dec.exp, dec.w), false);
+            }
+            return dec.negative ? -val : val;
+        }
+
+        Float f = eisel_lemire(dec.exp, dec.w);
+        if (dec.truncated && f.e != INFINITE_POWER) {
+            /* the value is in [w, w + 1) * 10^exp */
+            Float g = eisel_lemire(dec.exp, dec.w + 1);
+            if (!(f == g))
+                f = fallback(dec, f);
+        }
+        return to_double(f, dec.negative);
+    }
+
+    size_t format(int64_t val, char * dst)
+    {
+        char * cur = dst;
+        uint64_t abs = static_cast<uint64_t>(val);
+        if (val < 0) {
+            *cur++ = '-';
+            abs = ~abs + 1; /* INT64_MIN as well */
+        }
+        return static_cast<size_t>(write_digits(abs, cur) - dst);
+    }
+
+    size_t format(double val, char * dst)
+    {
+        static const char  nan[] =  ".Nan";
+        static const char  inf[] =  ".Inf";
+        static const char ninf[] = "-.Inf";
+
+        uint64_t bits;
+        ::memcpy(&bits, &val, sizeof(bits));
+        bool negative = (bits >> 63) != 0;
+        bits &= ~(U64_(1) << 63);
+
+        char const * special = NULL;
+        if (bits > (static_cast<uint64_t>(INFINITE_POWER) << MANTISSA_BITS))
+            special = nan;
+        else if (bits == (static_cast<uint64_t>(INFINITE_POWER) << MANTISSA_BITS))
+            special = negative ? ninf : inf;
+        if (special != NULL) {
+            size_t len = ::strlen(special);
+            ::memcpy(dst, special, len);
+            return len;
+        }
+
+        char * cur = dst;
+        if (negative)
+            *cur++ = '-';
+        if (bits == 0) {
+            cur[0] = '0';
+            cur[1] = '.';
+            cur[2] = '0';
+            return static_cast<size_t>(cur + 3 - dst);
+        }
+
+        int length = 0, K = 0;
+        grisu2(bits, cur, length, K);
+        return static_cast<size_t>(prettify(cur, length, K) - dst);
+    }
+}
+
+CV_FS_PRIVATE_END
@@ -0,0 +1,92 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include <cstring>
+#include "persistence_private.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ * Declaration
+ ***************************************************************************/
+
+namespace number
+{
+    /* significant digits kept for the exact fallback, enough to tell any
+     * decimal from the halfway point of two adjacent doubles */
+    static const size_t MAX_DIGITS = 768U;
+
+    /* a decimal `[-] w * 10^exp`, split by the parser.
+     * If there are more than 19 significant digits, `w` holds the first 19
+     * and the remaining ones are in `more[0, count)` (`exp` is still the
+     * exponent of `w`). `sticky` is set if non-zero digits are dropped
+     * beyond `MAX_DIGITS`. */
+    struct Decimal
+    {
+        uint64_t     w;
+        int64_t      exp;
+        bool         negative;
+        bool         truncated;
+        bool         sticky;
+        size_t       count;
+        char const * more;
+    };
+
+    /* correctly rounded (to nearest, ties to even) conversion */
+    double to_double(Decimal const & dec);
+
+    /* enough for any output of `format` */
+    static const size_t MAX_FORMAT_LENGTH = 32U;
+
+    /* writes the shortest (Grisu2) digits that read back to the same
+     * double, always with '.' or 'e'; or `.Nan`, `.Inf` and `-.Inf`.
+     * No '\0' is appended. Returns the length. */
+    size_t format(double val, char * dst);
+
+    /* same as above, for integers */
+    size_t format(int64_t val, char * dst);
+
+    /* true if 8 bytes in `str` are all in ['0', '9'] */
+    inline bool is_eight_digits(char const * str);
+
+    /* value of 8 decimal digits in `str`, SWAR */
+    inline uint32_t parse_eight_digits(char const * str);
+}
+
+/****************************************************************************
+ * Implementation
+ ***************************************************************************/
+
+namespace number
+{
+    /* bytes are loaded as little-endian, as on all supported targets */
+
+    inline bool is_eight_digits(char const * str)
+    {
+        uint64_t val;
+        ::memcpy(&val, str, sizeof(val));
+        return ((( val + uint64_t(0x4646464646464646ULL))
+                 | (val - uint64_t(0x3030303030303030ULL)))
+                 & uint64_t(0x8080808080808080ULL)) == 0;
+    }
+
+    inline uint32_t parse_eight_digits(char const * str)
+    {
+        static const uint64_t MASK = uint64_t(0x000000FF000000FFULL);
+        static const uint64_t MUL1 = uint64_t(0x000F424000000064ULL);
+        static const uint64_t MUL2 = uint64_t(0x0000271000000001ULL);
+
+        uint64_t val;
+        ::memcpy(&val, str, sizeof(val));
+        val -= uint64_t(0x3030303030303030ULL);
+        val  = (val * 10) + (val >> 8); /* pairs   */
+        val  = (((val & MASK) * MUL1) + (((val >> 16) & MASK) * MUL2)) >> 32;
+        return static_cast<uint32_t>(val);
+    }
+}
+
+CV_FS_PRIVATE_END
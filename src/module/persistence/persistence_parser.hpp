@@ -16,6 +16,11 @@ CV_FS_PRIVATE_BEGIN
  *  Forward Declaration
  ***************************************************************************/
 
+namespace tape
+{
+    class Document;
+}
+
 namespace parser
 {
     using io::Stream;
@@ -39,6 +44,13 @@ namespace parser
             , warning_maximum(4U)
             , stream_buffer_size(8192U)
             , indent_width(4U)
+            , enable_insitu(false)
+            , parallel_threads(1U)
+            , parallel_depth(0U)
+            , enable_packed_array(false)
+            , enable_key_interning(false)
+            , enable_node_stack(true)
+            , enable_base64(false)
         {}
 
         bool   enable_json_comment;
@@ -47,6 +59,13 @@ namespace parser
         size_t warning_maximum;
         size_t stream_buffer_size;
         size_t indent_width;      /* '\t' == n' ' */
+        bool   enable_insitu;     /* strings may refer to a writable view */
+        size_t parallel_threads;  /* split a large array, 0 for all cores */
+        size_t parallel_depth;    /* depth of the array, 0 for the root   */
+        bool   enable_packed_array; /* see `ast::I64_ARR`, `ast::DBL_ARR` */
+        bool   enable_key_interning; /* see `ast::Tree::keys`            */
+        bool   enable_node_stack; /* containers are allocated when closed */
+        bool   enable_base64;     /* blocks of `code::block` are packed  */
     };
 
     typedef bool (*ParseFuncion) (
@@ -55,6 +74,14 @@ namespace parser
         Message        &,
         Settings const &
     );
+
+    /* parse into a tree with arena, see `ast::ArenaPool` */
+    typedef bool (*ArenaParseFuncion) (
+        Stream                     &,
+        Tree<char, ast::ArenaPool> &,
+        Message                    &,
+        Settings const             &
+    );
 }
 
 namespace parser { namespace xml
@@ -88,6 +115,153 @@ namespace parser { namespace json
         Message        & message,
         Settings const & settings = Settings()
     );
+
+    /* a large array may be parsed in parallel if the stream has a view,
+     * see `Settings::parallel_threads` */
+    extern bool parse
+    (
+        Stream                     & stream,
+        Tree<char, ast::ArenaPool> & result,
+        Message                    & message,
+        Settings const             & settings = Settings()
+    );
+
+    /* paths of values to build, as JSON Pointer (RFC 6901) with `*` for
+     * any key or index: "/features/1/id" is an id, and with `*` in place
+     * of `1` it is the id of every feature. "" is the whole value. */
+    class Query
+    {
+    public:
+        Query();
+
+    public:
+        /* returns false if `path` is neither "" nor starts with '/' */
+        bool add(char const * path);
+
+        size_t size () const;            /* of paths          */
+        size_t depth(size_t path) const; /* steps of a path   */
+
+        /* whether step `depth` of `path` is `key` or `*`, and for an
+         * element, is `index` in digits or `*` */
+        bool match(size_t path, size_t depth, char const * key,
+                   size_t len) const;
+        bool match(size_t path, size_t depth, size_t index) const;
+
+    private:
+        struct Step
+        {
+            size_t off; /* in `text_` */
+            size_t len;
+        };
+        typedef chars::Buffer<char,   128, std::allocator> Text;
+        typedef chars::Buffer<Step,    16, std::allocator> Steps;
+        typedef chars::Buffer<size_t,   8, std::allocator> Paths;
+
+        Text  text_;  /* unescaped steps        */
+        Steps steps_;
+        Paths paths_; /* first step of each one */
+    };
+
+    /* builds only values on paths of `query`, and containers on the way
+     * to them; other values are skipped without being built. Skipped
+     * elements of an array are NIL, so indices are kept, and skipped
+     * pairs of an object are dropped. Skipped values are not checked. */
+    extern bool parse
+    (
+        Stream                     & stream,
+        Tree<char, ast::ArenaPool> & result,
+        Query                const & query,
+        Message                    & message,
+        Settings             const & settings = Settings()
+    );
+
+    /* parse into a tape, which is read only and needs no pool, see
+     * `tape::Document`. `Settings::enable_insitu` is ignored. */
+    extern bool parse
+    (
+        Stream         & stream,
+        tape::Document & result,
+        Message        & message,
+        Settings const & settings = Settings()
+    );
+
+    /* reads JSON lines (NDJSON), one record at a time. A record is a value
+     * on a line of its own; lines of spaces or comments are skipped.
+     * Memory of a record is reused by the next ones, so a record is valid
+     * until the next `next()`. If `Settings::parallel_threads` is not 1
+     * and the stream has a view, lines are parsed by workers in batches,
+     * then a record must not span lines. */
+    class RecordReader
+    {
+    public:
+        typedef ast::Node<char> Node;
+
+    public:
+        RecordReader(Stream & stream, Settings const & settings = Settings());
+        ~RecordReader();
+
+    public:
+        /* read the next record. Returns false at the end of input, or on
+         * error that is kept in `message()`; then `done()` */
+        bool next();
+        bool done() const;
+
+        Node           & record();
+        ast::ArenaPool & pool();        /* memory of `record()`  */
+        size_t           index() const; /* of `record()`, from 0 */
+        Message const  & message() const;
+
+    private:
+        RecordReader            (RecordReader const &) /* = delete */;
+        RecordReader & operator=(RecordReader const &) /* = delete */;
+
+    private:
+        class Impl;
+        Impl * impl_;
+    };
+
+    /* a JSON value of which large containers are parsed when they are
+     * visited first. A container is expanded by one pass over its text
+     * to find its elements: the ones that are containers of `LAZY_SIZE`
+     * bytes or more are left as text, in place of which are NIL nodes,
+     * and the rest are parsed. Nothing in a container is checked before
+     * it is expanded. The text is the view of `stream`, which must live
+     * as long as this, or a copy of the stream. Not thread safe, as
+     * `expand` changes the tree. */
+    class LazyTree
+    {
+    public:
+        typedef ast::Node<char> Node;
+        class Item; /* a container, expanded or not */
+
+        static const size_t LAZY_SIZE = 1U << 12;
+
+    public:
+        LazyTree(Stream & stream, Settings const & settings = Settings());
+        ~LazyTree();
+
+    public:
+        Item & root();
+
+        /* parses elements of `item` if they are not, then returns its
+         * node, or NULL on error that is kept in `message()` */
+        Node * expand(Item & item);
+
+        /* the container left as text in place of `node`, which is an
+         * element of an expanded `item`, or NULL */
+        Item * child(Item & item, Node const & node);
+
+        ast::ArenaPool & pool(Item & item); /* memory of its node */
+        Message const  & message() const;
+
+    private:
+        LazyTree            (LazyTree const &) /* = delete */;
+        LazyTree & operator=(LazyTree const &) /* = delete */;
+
+    private:
+        class Impl;
+        Impl * impl_;
+    };
 }}
 
 CV_FS_PRIVATE_END
@@ -0,0 +1,659 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include "persistence_private.hpp"
+#include "persistence_string.hpp"
+#include "persistence_ast.hpp"
+#include "persistence_code.hpp"
+#include "persistence_parser.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  JSON ast builder
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * declaration NodeStack
+     ***********************************************************************/
+
+    /* a stack of nodes in chunks, nodes never move while it grows */
+    template<typename NodeType>
+    class NodeStack
+    {
+    public:
+        NodeStack();
+        ~NodeStack();
+
+    public:
+        inline NodeType * push(); /* a node that is not constructed */
+        inline NodeType & operator[](size_t index);
+        inline size_t     size() const;
+        inline void       shrink(size_t size);
+
+    private:
+        NodeStack            (NodeStack const &);
+        NodeStack & operator=(NodeStack const &);
+
+    private:
+        static const size_t CHUNK_SHIFT = 10U;
+        static const size_t CHUNK_SIZE  = size_t(1) << CHUNK_SHIFT;
+        static const size_t CHUNK_MASK  = CHUNK_SIZE - 1U;
+
+        typedef chars::Buffer<NodeType *, 16, std::allocator> Chunks;
+        typedef std::allocator<NodeType>                      Ator;
+
+        Chunks chunks_; /* kept till destructed */
+        size_t size_;
+    };
+
+    /************************************************************************
+     * declaration Builder
+     ***********************************************************************/
+
+    template<typename CharType, typename PoolType>
+    class Builder
+    {
+    public:
+        typedef ast::Tree<CharType, PoolType> Tree;
+        typedef ast::Node<CharType> Node;
+
+    public:
+        /* see `Settings::enable_packed_array`, `enable_key_interning`,
+         * `enable_node_stack` and `enable_base64`. The root of a `part` is
+         * a part of a larger sequence, it is never packed and gets elements
+         * one by one. */
+        Builder
+        (
+            Tree           & tree,
+            Settings const & settings = Settings(),
+            bool             part     = false
+        );
+
+    public:
+        /* start again from the root, e.g. after `tree.reset()` */
+        void reset();
+
+    public:
+        void map_beg();
+        void map_key();
+        void map_val();
+        void map_end();
+
+        void seq_beg();
+        void seq_val();
+        void seq_end();
+
+        void str_beg();
+        void str_end();
+        void str_val(CharType const * str, size_t len);
+        void str_ref(CharType       * str, size_t len);
+
+    public:
+        void on_nil();
+        void on_int(int64_t i);
+        void on_dbl(double  d);
+        void on_chr(CharType ch);
+        void on_str(CharType const * str, size_t len);
+
+    private:
+        /* the element on the top, unpacks numbers if it is one of them */
+        Node & top();
+        Node * unpack();
+
+        /* sets a string, or a key of map if it is expected */
+        void set_str(Node & node, CharType const * str, size_t len);
+
+        /* elements of `node` are on the stack till it is closed */
+        bool   stacked(Node const & node) const;
+
+        /* a new element, on the stack if any */
+        Node * append(Node & seq);
+
+        /* moves elements on the stack into the container at once */
+        void close(Node & node);
+
+    private:
+        enum status_t
+        {
+            MAP_STR,
+            MAP_OBJ,
+            SEQ_OBJ,
+            STR_CHR
+        };
+
+    private:
+        typedef chars::Buffer<status_t, 128, std::allocator> sstack_t;
+        typedef chars::Buffer<Node *, 128, std::allocator> nstack_t;
+        typedef chars::Buffer<  size_t, 128, std::allocator> Marks;
+        typedef chars::Buffer<  CharType, 128, std::allocator> Buffer;
+        typedef chars::Buffer<   int64_t, 128, std::allocator> I64Buffer;
+        typedef chars::Buffer<    double, 128, std::allocator> DBLBuffer;
+
+        Tree    & tree_;
+        nstack_t  nstack_;
+        sstack_t  sstack_;
+        Buffer  buffer_;
+
+        /* the next string is a key */
+        bool      intern_;
+        bool      key_;
+
+        /* root of a part, or NULL */
+        Node    * part_;
+
+        /* elements of open containers, from `marks_` of each */
+        bool            stack_on_;
+        NodeStack<Node> stack_;
+        Marks           marks_;
+
+        /* numbers of the innermost sequence, till one of another type.
+         * Its elements on `nstack_` are NULL. */
+        bool      pack_;
+        Node    * numbers_;
+        ast::Tag  kind_;
+        I64Buffer i64s_;
+        DBLBuffer dbls_;
+
+        /* strings of `code::block` are decoded into packed arrays */
+        bool      base64_;
+    };
+
+    /* packs a sequence of numbers of one type, returns false if the node
+     * is not such a sequence */
+    template<typename CharType, typename PoolType>
+    bool pack(ast::Node<CharType> & node, PoolType & pool);
+
+    /* sets a packed array from a block of `code::block`, returns false if
+     * the string is not one. Blocks are of `char` only. */
+    template<typename CharType, typename PoolType>
+    bool unblock(ast::Node<CharType> & node, CharType const * str,
+                 size_t len, PoolType & pool);
+    template<typename PoolType>
+    bool unblock(ast::Node<char> & node, char const * str,
+                 size_t len, PoolType & pool);
+
+    /************************************************************************
+     * implementation NodeStack
+     ***********************************************************************/
+
+    template<typename NodeType>
+    inline NodeStack<NodeType>::NodeStack()
+        : chunks_()
+        , size_(0U)
+    {}
+
+    template<typename NodeType>
+    inline NodeStack<NodeType>::~NodeStack()
+    {
+        Ator ator;
+        for (size_t i = 0; i < chunks_.size(); ++i)
+            ator.deallocate(chunks_[i], CHUNK_SIZE);
+    }
+
+    template<typename NodeType>
+    inline NodeType * NodeStack<NodeType>::push()
+    {
+        size_t chunk = size_ >> CHUNK_SHIFT;
+        if (chunk == chunks_.size())
+            chunks_.push_back(Ator().allocate(CHUNK_SIZE));
+        return chunks_[chunk] + (size_++ & CHUNK_MASK);
+    }
+
+    template<typename NodeType>
+    inline NodeType & NodeStack<NodeType>::operator[](size_t index)
+    {
+        return chunks_[index >> CHUNK_SHIFT][index & CHUNK_MASK];
+    }
+
+    template<typename NodeType>
+    inline size_t NodeStack<NodeType>::size() const
+    {
+        return size_;
+    }
+
+    template<typename NodeType>
+    inline void NodeStack<NodeType>::shrink(size_t size)
+    {
+        if (size < size_)
+            size_ = size;
+    }
+
+    /************************************************************************
+     * implementation Builder
+     ***********************************************************************/
+
+    template<typename CharType, typename PoolType>
+    inline Builder<CharType, PoolType>::
+        Builder(Tree & tree, Settings const & settings, bool part)
+        : tree_(tree)
+        , nstack_()
+        , sstack_()
+        , buffer_()
+        , intern_(settings.enable_key_interning)
+        , key_(false)
+        , part_(part ? &tree.root() : NULL)
+        , stack_on_(settings.enable_node_stack)
+        , stack_()
+        , marks_()
+        , pack_(settings.enable_packed_array)
+        , numbers_(NULL)
+        , kind_(ast::NIL)
+        , i64s_()
+        , dbls_()
+        , base64_(settings.enable_base64)
+    {
+        nstack_.push_back(&tree_.root());
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        reset()
+    {
+        nstack_.clear();
+        sstack_.clear();
+        buffer_.clear();
+        nstack_.push_back(&tree_.root());
+        numbers_ = NULL;
+        key_     = false;
+        stack_.shrink(0U);
+        marks_.clear();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        set_str(Node & node, CharType const * str, size_t len)
+    {
+        using namespace ast;
+        CharType * key = NULL;
+        if (key_ && intern_)
+            key = tree_.keys().intern(str, len);
+        else if (!key_ && base64_ && unblock(node, str, len, tree_.pool()))
+            return;
+        key_ = false;
+
+        if (key != NULL)
+            node.refer(key, key + len, tree_.pool());
+        else
+            node.template set<STR>(str, str + len, tree_.pool());
+    }
+
+    template<typename CharType, typename PoolType>
+    inline bool Builder<CharType, PoolType>::
+        stacked(Node const & node) const
+    {
+        return stack_on_ && &node != part_;
+    }
+
+    template<typename CharType, typename PoolType>
+    inline typename Builder<CharType, PoolType>::Node *
+        Builder<CharType, PoolType>::
+        append(Node & seq)
+    {
+        using namespace ast;
+        if (stacked(seq)) {
+            Node * node = stack_.push();
+            node->construct(tree_.pool());
+            return node;
+        }
+
+        Node dummy;
+        dummy.construct(tree_.pool());
+        seq.template move_back<SEQ>(dummy, tree_.pool());
+        return seq.template rbegin<SEQ>();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        close(Node & node)
+    {
+        using namespace ast;
+        typedef typename Node::Pair Pair;
+
+        size_t beg = marks_.back();
+        size_t end = stack_.size();
+        marks_.pop_back();
+
+        if (node.type() == SEQ) {
+            node.template reserve<SEQ>(
+                static_cast<typename Node::size_type>(end - beg),
+                tree_.pool());
+            for (size_t i = beg; i < end; ++i)
+                node.template move_back<SEQ>(stack_[i], tree_.pool());
+        } else if (node.type() == MAP) {
+            node.template reserve<MAP>(
+                static_cast<typename Node::size_type>((end - beg) >> 1),
+                tree_.pool());
+            for (size_t i = beg; i < end; i += 2) {
+                Pair pair;
+                pair[0] = stack_[i];
+                pair[1] = stack_[i + 1];
+                node.template move_back<MAP>(pair, tree_.pool());
+            }
+        }
+        stack_.shrink(beg);
+    }
+
+    template<typename CharType, typename PoolType>
+    inline typename Builder<CharType, PoolType>::Node &
+        Builder<CharType, PoolType>::
+        top()
+    {
+        Node * node = nstack_.back();
+        return node != NULL ? *node : *unpack();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline typename Builder<CharType, PoolType>::Node *
+        Builder<CharType, PoolType>::
+        unpack()
+    {
+        using namespace ast;
+        Node & seq = *numbers_;
+        numbers_ = NULL;
+
+        if (kind_ == I64) {
+            for (int64_t * i = i64s_.begin(); i != i64s_.end(); ++i)
+                append(seq)->template set<I64>(*i, tree_.pool());
+        } else if (kind_ == DBL) {
+            for (double * i = dbls_.begin(); i != dbls_.end(); ++i)
+                append(seq)->template set<DBL>(*i, tree_.pool());
+        }
+        i64s_.clear();
+        dbls_.clear();
+
+        /* and the element on the top */
+        return nstack_.back() = append(seq);
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        map_beg()
+    {
+        using namespace ast;
+        Node & top = this->top();
+        top.template construct<MAP>(tree_.pool());
+        if (stacked(top))
+            marks_.push_back(stack_.size());
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        map_key()
+    {
+        using namespace ast;
+        if (stacked(*nstack_.back())) {
+            Node * key = stack_.push();
+            Node * val = stack_.push();
+            key->construct(tree_.pool());
+            val->construct(tree_.pool());
+            nstack_.push_back(val);
+            nstack_.push_back(key);
+            key_ = true;
+            return;
+        }
+
+        typedef typename Node::Pair Pair;
+        Pair * pair = NULL;
+        {
+            Node & top = *nstack_.back();
+            Pair dummy;
+            dummy[0].construct(tree_.pool());
+            dummy[1].construct(tree_.pool());
+            top.template move_back<MAP>(dummy, tree_.pool());
+
+            pair = top.template rbegin<MAP>();
+        }
+        nstack_.push_back(&((*pair)[1]));
+        nstack_.push_back(&((*pair)[0]));
+        key_ = true;
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        map_val()
+    {
+        ;
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        map_end()
+    {
+        using namespace ast;
+        Node & top = *nstack_.back();
+        if (stacked(top))
+            close(top);
+
+        /* a large map is indexed now, so that reads never write it */
+        top.template index<MAP>(tree_.pool());
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        seq_beg()
+    {
+        using namespace ast;
+        Node & top = this->top();
+        top.template construct<SEQ>(tree_.pool());
+        if (stacked(top))
+            marks_.push_back(stack_.size());
+
+        if (pack_ && &top != part_) {
+            numbers_ = &top;
+            kind_    = NIL;
+            i64s_.clear();
+            dbls_.clear();
+        }
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        seq_val()
+    {
+        using namespace ast;
+        if (numbers_ != NULL) {
+            nstack_.push_back(NULL);
+            return;
+        }
+
+        nstack_.push_back(append(*nstack_.back()));
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        seq_end()
+    {
+        using namespace ast;
+        Node & top = *nstack_.back();
+        if (numbers_ == &top) {
+            numbers_ = NULL;
+            if (kind_ == I64)
+                top.template set<I64_ARR>
+                    (i64s_.begin(), i64s_.end(), tree_.pool());
+            else if (kind_ == DBL)
+                top.template set<DBL_ARR>
+                    (dbls_.begin(), dbls_.end(), tree_.pool());
+        }
+        if (stacked(top))
+            close(top);
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        str_beg()
+    {
+        buffer_.clear();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        str_end()
+    {
+        using namespace ast;
+        Node & top = this->top();
+        set_str(top, buffer_.begin(), buffer_.size());
+        buffer_.clear();
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        str_val(CharType const * str, size_t len)
+    {
+        using namespace ast;
+        Node & top = this->top();
+        set_str(top, str, len);
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        str_ref(CharType * str, size_t len)
+    {
+        Node & top = this->top();
+        if (key_ || !base64_ || !unblock(top, str, len, tree_.pool()))
+            top.refer(str, str + len, tree_.pool());
+        key_ = false;
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        on_int(int64_t val)
+    {
+        using namespace ast;
+        if (nstack_.back() == NULL && kind_ != DBL) {
+            kind_ = I64;
+            i64s_.push_back(val);
+            nstack_.pop_back();
+            return;
+        }
+
+        Node & top = this->top();
+        top.template set<I64>(val, tree_.pool());
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        on_dbl(double val)
+    {
+        using namespace ast;
+        if (nstack_.back() == NULL && kind_ != I64) {
+            kind_ = DBL;
+            dbls_.push_back(val);
+            nstack_.pop_back();
+            return;
+        }
+
+        Node & top = this->top();
+        top.template set<DBL>(val, tree_.pool());
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        on_nil()
+    {
+        top();
+        nstack_.pop_back();
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        on_chr(CharType ch)
+    {
+        buffer_.push_back(ch);
+    }
+
+    template<typename CharType, typename PoolType>
+    inline void Builder<CharType, PoolType>::
+        on_str(CharType const * str, size_t len)
+    {
+        buffer_.push_back(str, len);
+    }
+
+    /************************************************************************
+     * implementation pack
+     ***********************************************************************/
+
+    template<typename CharType, typename PoolType>
+    inline bool pack(ast::Node<CharType> & node, PoolType & pool)
+    {
+        using namespace ast;
+        typedef Node<CharType> Node;
+
+        if (node.type() != SEQ || node.template size<SEQ>() == 0)
+            return false;
+
+        Node const * beg = node.template begin<SEQ>();
+        Node const * end = node.template end  <SEQ>();
+        Tag kind = beg->type();
+        if (kind != I64 && kind != DBL)
+            return false;
+        for (Node const * cur = beg; cur != end; ++cur)
+            if (cur->type() != kind)
+                return false;
+
+        Node arr;
+        arr.construct(pool);
+        for (Node const * cur = beg; cur != end; ++cur)
+            if (kind == I64)
+                arr.template push_back<I64_ARR>(cur->template val<I64>(), pool);
+            else
+                arr.template push_back<DBL_ARR>(cur->template val<DBL>(), pool);
+
+        node.destruct(pool);
+        node.move(arr, pool);
+        return true;
+    }
+
+    /************************************************************************
+     * implementation unblock
+     ***********************************************************************/
+
+    template<typename CharType, typename PoolType>
+    inline bool unblock(ast::Node<CharType> &, CharType const *,
+                        size_t, PoolType &)
+    {
+        return false;
+    }
+
+    template<typename PoolType>
+    inline bool unblock(ast::Node<char> & node, char const * str,
+                        size_t len, PoolType & pool)
+    {
+        using namespace ast;
+        typedef Node<char>::size_type size_type;
+
+        /* most strings are not blocks, see the first char only */
+        code::block::Type type;
+        size_t            cnt = 0U;
+        if (len == 0U || *str != *code::block::PREFIX ||
+            !code::block::header(str, len, type, cnt))
+            return false;
+
+        /* values are decoded into the array */
+        if (type == code::block::I64) {
+            node.template construct<I64_ARR>(pool);
+            node.template resize<I64_ARR>(static_cast<size_type>(cnt), pool);
+            code::block::decode(str, len, node.template begin<I64_ARR>());
+        } else {
+            node.template construct<DBL_ARR>(pool);
+            node.template resize<DBL_ARR>(static_cast<size_type>(cnt), pool);
+            code::block::decode(str, len, node.template begin<DBL_ARR>());
+        }
+        return true;
+    }
+}}
+
+CV_FS_PRIVATE_END
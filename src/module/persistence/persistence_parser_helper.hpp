@@ -12,6 +12,7 @@
 #include "persistence_chars.hpp"
 #include "persistence_utility.hpp"
 #include "persistence_parser.hpp"
+#include "persistence_simd.hpp"
 
 CV_FS_PRIVATE_BEGIN
 
@@ -150,13 +151,14 @@ namespace parser
         );
 
     public:
-        inline size_t        line() const;
-        inline size_t        col () const;
-        inline size_t        pos () const;
+        inline uint64_t      line() const;
+        inline uint64_t      col () const;
+        inline uint64_t      pos () const;
 
         inline bool          eof () const;
         inline CharType      ch  () const;
         inline CharType const *data() const;
+        inline CharType *    insitu();
         inline size_t        size() const;
         inline size_t        capacity() const;
         inline bool          empty() const;
@@ -166,12 +168,24 @@ namespace parser
         inline This &   skip(CharType           ch,   bool expect=true);
         inline This &   skip(CharType const list[],   bool expect=true);
         inline This &   skip(bool (is_skip)(CharType),bool expect=true);
+        inline This &   skip_space();
+        inline This &   skip_plain(size_t n_chars_in_buffer);
+        inline This &   skip_text (size_t n_chars_in_buffer);
         inline bool          reload();
 
+        inline simd::Scanner const & get_scanner() const;
+
         inline size_t             count_warning();
         inline Settings const & get_settings() const;
 
+        /* go on counting from another reader, for a piece of its text */
+        inline void resume(uint64_t line, uint64_t col, size_t warnings);
+        inline void resume(uint64_t line, uint64_t col, size_t warnings,
+                           uint64_t pos);
+        inline size_t             warnings() const;
+
     private:
+        inline void init();
         inline void count_char(CharType ch);
 
     private:
@@ -186,12 +200,15 @@ namespace parser
         CharType *   buf_cur;
         CharType *   buf_end;
 
-        size_t     line_number;
-        size_t     column_number;
-        size_t     position;
+        uint64_t   line_number;   /* 64-bit, files may be larger than 4G */
+        uint64_t   column_number;
+        uint64_t   position;
+        bool       after_cr;      /* a LF next to it is the same line  */
 
         size_t     warning_counter;
         Settings settings;
+
+        simd::Scanner const & scanner;
     };
 
     /************************************************************************
@@ -206,26 +223,22 @@ namespace parser
         , buffer_size(
             utility::max(settings_ref.stream_buffer_size, MIN_BUFFER_SIZE)
         )
-        , buffer(new CharType[buffer_size + 4U])
-        , buf_beg(buffer)
+        , buffer(NULL)
+        , buf_beg(NULL)
         , buf_cur(buf_beg)
         , buf_end(buf_beg)
 
         , line_number(1U)
         , column_number(1U)
         , position(1U)
+        , after_cr(false)
 
         , warning_counter(0)
         , settings(settings_ref)
-    {
-        if (stream.is_open())
-            reload();
 
-        /* a mark of end of buffer */
-        buf_end[0] = CharType('.');
-        buf_end[1] = CharType('.');
-        buf_end[2] = CharType('.');
-        buf_end[3] = CharType('\0');
+        , scanner(simd::scanner())
+    {
+        init();
     }
 
     template<typename StreamType, typename ExtraDataType> template<typename T>
@@ -244,18 +257,53 @@ namespace parser
         , buffer_size(
             utility::max(settings_ref.stream_buffer_size, MIN_BUFFER_SIZE)
         )
-        , buffer(new CharType[buffer_size + 4U])
-        , buf_beg(buffer)
+        , buffer(NULL)
+        , buf_beg(NULL)
         , buf_cur(buf_beg)
         , buf_end(buf_beg)
 
         , line_number(1U)
         , column_number(1U)
         , position(1U)
+        , after_cr(false)
 
         , warning_counter(0)
         , settings(settings_ref)
+
+        , scanner(simd::scanner())
     {
+        init();
+    }
+
+    template<typename StreamType, typename ExtraDataType>
+    inline StreamHelper<StreamType, ExtraDataType>::
+    ~StreamHelper()
+    {
+        delete [] buffer;
+        buffer = NULL;
+    }
+
+    template<typename StreamType, typename ExtraDataType>
+    inline void StreamHelper<StreamType, ExtraDataType>::
+        init()
+    {
+        /* zero copy: use the whole content of stream directly, it is
+         * already terminated by '\0' so no mark is needed. */
+        typename Stream::size_type length = 0;
+        CharType * view = stream.is_open() ? stream.view(length) : NULL;
+        if (view != NULL) {
+            buffer_size = utility::max(static_cast<size_t>(length), buffer_size);
+            buf_beg = view;
+            buf_cur = view;
+            buf_end = view + static_cast<size_t>(length);
+            return;
+        }
+
+        buffer  = new CharType[buffer_size + 4U];
+        buf_beg = buffer;
+        buf_cur = buffer;
+        buf_end = buffer;
+
         if (stream.is_open())
             reload();
 
@@ -267,29 +315,21 @@ namespace parser
     }
 
     template<typename StreamType, typename ExtraDataType>
-    inline StreamHelper<StreamType, ExtraDataType>::
-    ~StreamHelper()
-    {
-        delete buffer;
-        buffer = NULL;
-    }
-
-    template<typename StreamType, typename ExtraDataType>
-    inline size_t StreamHelper<StreamType, ExtraDataType>::
+    inline uint64_t StreamHelper<StreamType, ExtraDataType>::
         line() const
     {
         return line_number;
     }
 
     template<typename StreamType, typename ExtraDataType>
-    inline size_t StreamHelper<StreamType, ExtraDataType>::
+    inline uint64_t StreamHelper<StreamType, ExtraDataType>::
         col() const
     {
         return column_number;
     }
 
     template<typename StreamType, typename ExtraDataType>
-    inline size_t StreamHelper<StreamType, ExtraDataType>::
+    inline uint64_t StreamHelper<StreamType, ExtraDataType>::
         pos() const
     {
         return position;
@@ -318,6 +358,16 @@ namespace parser
         return buf_cur;
     }
 
+    template<typename StreamType, typename ExtraDataType>
+    inline typename StreamHelper<StreamType, ExtraDataType>::CharType
+        * StreamHelper<StreamType, ExtraDataType>::
+        insitu()
+    {
+        /* the same as `data()` if chars are in a writable view of stream,
+         * which can be modified before current position. */
+        return buffer == NULL && buf_beg != NULL ? buf_cur : NULL;
+    }
+
     template<typename StreamType, typename ExtraDataType>
     inline size_t StreamHelper<StreamType, ExtraDataType>::
         size() const
@@ -346,7 +396,7 @@ namespace parser
     {
         /* note: make sure `empty() == eof()` */
         /* so always do `if (empty()) reload();` */
-        if (!eof()) {
+        if (!empty()) {
             count_char(*buf_cur++);
             if (empty())
                 reload();
@@ -415,15 +465,93 @@ namespace parser
         return *this;
     }
 
+    /* same as `skip(chars::isspace)`, but jumps over runs of JSON spaces */
+    template<typename StreamType, typename ExtraDataType>
+    inline typename StreamHelper<StreamType, ExtraDataType>::This &
+        StreamHelper<StreamType, ExtraDataType>::
+        skip_space()
+    {
+        while (!eof()) {
+            CharType const * end = scanner.find_nonspace(buf_cur, buf_end);
+
+            /* the run is in buffer, jump over it and count lines inside */
+            skip_text(static_cast<size_t>(end - buf_cur));
+            if (empty() && reload() == false)
+                break;
+
+            /* a new buffer, or the rest of `isspace`, e.g. '\v', '\f' */
+            if (!chars::isspace(*buf_cur))
+                break;
+            skip();
+        }
+        return *this;
+    }
+
+    /* skip n chars that are already in buffer and contain no control
+     * character, so line number is unchanged and column is simply added. */
+    template<typename StreamType, typename ExtraDataType>
+    inline typename StreamHelper<StreamType, ExtraDataType>::This &
+        StreamHelper<StreamType, ExtraDataType>::
+        skip_plain(size_t n)
+    {
+        ASSERT_DBG(n <= size());
+        buf_cur       += n;
+        position      += n;
+        column_number += n;
+        after_cr       = after_cr && n == 0;
+        if (empty())
+            reload();
+        return *this;
+    }
+
+    /* skip n chars that are already in buffer, which may be of several
+     * lines. Runs without control character are jumped over. */
+    template<typename StreamType, typename ExtraDataType>
+    inline typename StreamHelper<StreamType, ExtraDataType>::This &
+        StreamHelper<StreamType, ExtraDataType>::
+        skip_text(size_t n)
+    {
+        ASSERT_DBG(n <= size());
+        CharType * end = buf_cur + n;
+        while (buf_cur != end) {
+            CharType const * ctl = scanner.find_special(buf_cur, end);
+            size_t           len = static_cast<size_t>(ctl - buf_cur);
+            buf_cur       += len;
+            position      += len;
+            column_number += len;
+            after_cr       = after_cr && len == 0;
+            if (buf_cur != end)
+                count_char(*buf_cur++);
+        }
+        if (empty())
+            reload();
+        return *this;
+    }
+
+    template<typename StreamType, typename ExtraDataType>
+    inline simd::Scanner const & StreamHelper<StreamType, ExtraDataType>::
+        get_scanner() const
+    {
+        return scanner;
+    }
+
     template<typename StreamType, typename ExtraDataType>
     inline bool StreamHelper<StreamType, ExtraDataType>::
         reload()
     {
+        /* a view has no more data, and it is collapsed at the end so
+         * that `empty() == eof()` holds as it does for a buffer */
+        if (buffer == NULL) {
+            if (empty())
+                buf_beg = buf_cur = buf_end;
+            return false;
+        }
+
         size_t  rest = size();
         size_t total = capacity();
 
         if (buf_cur != buf_beg)
-            std::memcpy(buf_beg, buf_cur, rest);
+            std::memmove(buf_beg, buf_cur, rest);
 
         uint64_t read = stream.read(buf_beg + rest, total - rest);
 
@@ -447,6 +575,31 @@ namespace parser
         return settings;
     }
 
+    template<typename StreamType, typename ExtraDataType>
+    inline void StreamHelper<StreamType, ExtraDataType>::
+        resume(uint64_t line, uint64_t col, size_t warnings)
+    {
+        line_number     = line;
+        column_number   = col;
+        after_cr        = false;
+        warning_counter = warnings;
+    }
+
+    template<typename StreamType, typename ExtraDataType>
+    inline void StreamHelper<StreamType, ExtraDataType>::
+        resume(uint64_t line, uint64_t col, size_t warnings, uint64_t pos)
+    {
+        resume(line, col, warnings);
+        position        = pos;
+    }
+
+    template<typename StreamType, typename ExtraDataType>
+    inline size_t StreamHelper<StreamType, ExtraDataType>::
+        warnings() const
+    {
+        return warning_counter;
+    }
+
     template<typename StreamType, typename ExtraDataType>
     inline void StreamHelper<StreamType, ExtraDataType>::
         count_char(CharType c)
@@ -455,6 +608,10 @@ namespace parser
         static const CharType LF  = CharType(0xa); /* \n */
         static const CharType TAB = CharType(0x9); /* \t */
 
+        /* a CR is counted as a new line at once, and a LF right after
+         * it is not, so CR LF split by a reload is still one line */
+        bool cr  = after_cr;
+        after_cr = false;
         position += 1;
         switch (c)
         {
@@ -462,16 +619,18 @@ namespace parser
             column_number += settings.indent_width;
             break;
         case CR:
-            if (buf_cur + 1 == buf_end && reload() == false)
-                break;
-            if (buf_cur[1] == LF) /* CR LF */
-                break;
+            after_cr = true;
+            line_number   += uint64_t(1);
+            column_number  = uint64_t(1);
+            break;
         case LF:
-            line_number   += size_t(1);
-            column_number  = size_t(1);
+            if (cr) /* CR LF */
+                break;
+            line_number   += uint64_t(1);
+            column_number  = uint64_t(1);
             break;
         default:
-            column_number += size_t(1);
+            column_number += uint64_t(1);
             break;
         }
     }
@@ -2,542 +2,916 @@
  *  license
  ***************************************************************************/
 
-#include <cmath>
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <thread>
 
 #include "persistence_private.hpp"
 #include "persistence_chars.hpp"
 #include "persistence_string.hpp"
-#include "persistence_parser_helper.hpp"
-#include "persistence_parser.hpp"
+#include "persistence_parser_json.hpp"
+#include "persistence_parser_builder.hpp"
+#include "persistence_tape.hpp"
 
 CV_FS_PRIVATE_BEGIN
 
 /****************************************************************************
- *  Forward Declaration
+ *  JSON Keyword
  ***************************************************************************/
 
 namespace parser { namespace json
 {
-    template<typename CharType> class Builder;
-    typedef StreamHelper<Stream, Builder<char> > In;
+#ifdef DEFINE_KEYWORD
+#error "conflicts!"
+#else
+#define DEFINE_KEYWORD(type, name, value) \
+    template<> const Keyword<type> KeywordTable<type>::name = value
+
+    DEFINE_KEYWORD(char, COLON , ':');
+    DEFINE_KEYWORD(char, COMMA , ',');
+    DEFINE_KEYWORD(char, ESCAPE, '\\');
+    DEFINE_KEYWORD(char, HEX   , 'u');
+    DEFINE_KEYWORD(char, MINUS , '-');
+    DEFINE_KEYWORD(char, PLUS  , '+');
+    DEFINE_KEYWORD(char, ZERO  , '0');
+    DEFINE_KEYWORD(char, DOT   , '.');
+    DEFINE_KEYWORD(char, EXP_U , 'E');
+    DEFINE_KEYWORD(char, EXP_L , 'e');
+
+    DEFINE_KEYWORD(char, STR_BEG , '"');
+    DEFINE_KEYWORD(char, STR_END , '"');
+    DEFINE_KEYWORD(char, SEQ_BEG , '[');
+    DEFINE_KEYWORD(char, SEQ_END , ']');
+    DEFINE_KEYWORD(char, MAP_BEG , '{');
+    DEFINE_KEYWORD(char, MAP_END , '}');
+
+    DEFINE_KEYWORD(char, VAL_FALSE, "false");
+    DEFINE_KEYWORD(char, VAL_TRUE , "true" );
+    DEFINE_KEYWORD(char, VAL_NULL , "null" );
+
+    DEFINE_KEYWORD(char,   COMMENT_FIRST, '/');
+    DEFINE_KEYWORD(char, C_COMMENT_1_BEG, "/*");
+    DEFINE_KEYWORD(char, C_COMMENT_1_END, "*/");
+    DEFINE_KEYWORD(char, C_COMMENT_2_BEG, "//");
+    DEFINE_KEYWORD(char, C_COMMENT_2_END, '\n');
+
+#undef DEFINE_KEYWORD
+#endif
 }}
 
 /****************************************************************************
- *  exception
+ *  JSON ast builder
  ***************************************************************************/
 
-namespace exception
+namespace parser { namespace json
 {
-    using chars::Soss;
-    using chars::fmt;
-
-    inline static bool opt_error(
-        parser::json::In & in,
-        char const * option,
-        char const * status)
-    {
-        parser::raise_error(in,
-            ( Soss<char, 256>()
-                * "option `"
-                | fmt<96>(option)
-                | "` is `"
-                | fmt<32>(status)
-                | "`, but got `"
-                | fmt<16>(in.eof() ? "End Of File" : in.data())
-                | "`, at("
-                | fmt<32>(in.line())
-                | ", "
-                | fmt<32>(in.col())
-                | ')'
-            )
-        );
-        /* if not throw return false */
-        return false;
+    template<typename PoolType> static inline bool parse_tree(
+        Stream                   & stream,
+        Tree<char, PoolType>     & tree,
+        Message                  & message,
+        Settings const           & settings)
+    {
+        Builder<char, PoolType> builder(tree, settings);
+        return parse_events(stream, builder, message, settings);
     }
+}}
+
+/****************************************************************************
+ *  JSON parallel parsing
+ ***************************************************************************/
 
-    inline static bool expect(
-        parser::json::In & in,
-        char const * expected,
-        char const * hint)
-    {
-        parser::raise_error(in,
-            ( Soss<char, 256>()
-                * "expecting `"
-                | fmt<32>(expected)
-                | "` but got `"
-                | fmt<16>(in.eof() ? "End Of File" : in.data())
-                | "` ["
-                | fmt<96>(hint)
-                | "], at("
-                | fmt<32>(in.line())
-                | ", "
-                | fmt<32>(in.col())
-                | ')'
-            )
-        );
-        /* if not throw return false */
+namespace parser { namespace json
+{
+    /************************************************************************
+     * pre-scan
+     ***********************************************************************/
+
+    /* an array to parse in parallel, found by `scan_array` */
+    struct Split
+    {
+        typedef chars::Buffer<size_t, 16, std::allocator> Path;
+        typedef chars::Buffer<char *, 64, std::allocator> Cuts;
+
+        Split() : beg(NULL), end(NULL), path(), cuts() {}
+
+        char * beg;  /* `[` of the array                           */
+        char * end;  /* `]` of the array                           */
+        Path   path; /* index in each container from the root      */
+        Cuts   cuts; /* `,` between elements where parts are split */
+    };
+
+    /* find the first array at `settings.parallel_depth` in [beg, end) and
+     * cut it into parts of about `part` bytes. Only structural chars out of
+     * strings are visited, block by block, so the text is not validated
+     * here. Returns false if there is nothing to split or a comment may
+     * hide structural chars. */
+    static bool scan_array(
+        char           * beg,
+        char           * end,
+        size_t           part,
+        Settings const & settings,
+        Split          & split)
+    {
+        typedef KeywordTable<char> kwd;
+
+        simd::Scanner const & scanner = simd::scanner();
+        simd::Carry           carry   = { 0U, 0U };
+        simd::Masks           masks;
+
+        size_t const width = scanner.width;
+        size_t const depth = settings.parallel_depth;
+        size_t       level = 0;
+        char       * last  = NULL;
+        char const * slash = NULL;
+        char         tail[64];
+
+        if (settings.enable_json_comment)
+            slash = static_cast<char const *>(std::memchr(
+                beg, kwd::COMMENT_FIRST, static_cast<size_t>(end - beg)));
+
+        for (char * blk = beg; blk < end; blk += width) {
+            char const * src = blk;
+            if (static_cast<size_t>(end - blk) < width) {
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, blk, static_cast<size_t>(end - blk));
+                src = tail;
+            }
+            scanner.classify(src, masks);
+            uint32_t inside = simd::in_string(masks, width, carry);
+
+            /* a comment may hide structural chars */
+            for (; slash != NULL && slash < blk + width; slash =
+                static_cast<char const *>(std::memchr(slash + 1,
+                kwd::COMMENT_FIRST, static_cast<size_t>(end - slash - 1))))
+                if (((inside >> (slash - blk)) & 1U) == 0)
+                    return false;
+
+            uint32_t bits = masks.structural & ~inside;
+            for (; bits != 0; bits &= bits - 1U) {
+                char * pos = blk + simd::lowest_bit(bits);
+                char   ch  = *pos;
+                if (ch == kwd::MAP_BEG || ch == kwd::SEQ_BEG) {
+                    if (split.beg != NULL) {
+                        ;
+                    } else if (ch == kwd::SEQ_BEG && level == depth) {
+                        split.beg = pos;
+                        last      = pos;
+                    } else {
+                        split.path.push_back(0U);
+                    }
+                    ++level;
+                } else if (ch == kwd::MAP_END || ch == kwd::SEQ_END) {
+                    if (level == 0)
+                        return false;
+                    --level;
+                    if (split.beg == NULL) {
+                        split.path.pop_back();
+                    } else if (level == depth) {
+                        split.end = pos;
+                        return !split.cuts.empty();
+                    }
+                } else if (ch == kwd::COMMA) {
+                    if (split.beg == NULL) {
+                        if (level != 0)
+                            ++split.path.back();
+                    } else if (level == depth + 1 &&
+                        static_cast<size_t>(pos - last) >= part) {
+                        split.cuts.push_back(pos);
+                        last = pos;
+                    }
+                }
+            }
+        }
         return false;
     }
 
-    inline static bool warning(parser::json::In & in, char const * message)
+    /************************************************************************
+     * workers
+     ***********************************************************************/
+
+    /* a piece of text between two cuts, parsed into a tree of its own */
+    struct Part
     {
-        if (in.get_settings().enable_warning_message == false)
-            return true;
+        Part()
+            : beg(NULL), end(NULL), line(1U)
+            , tree(), message(), status(false), error()
+        {}
+
+        char                       * beg;
+        char                       * end;
+        uint64_t                     line; /* line number of `beg` */
+        Tree<char, ast::ArenaPool>   tree;
+        Message                      message;
+        bool                         status;
+        std::exception_ptr           error;
+    };
 
-        parser::raise_warning(in,
-            ( Soss<char, 256>()
-                * fmt<128>(message)
-                | ", at ("
-                | fmt<32>(in.line())
-                | ", "
-                | fmt<32>(in.col())
-                | ')'
-            )
-        );
-        return true;
+    typedef Builder<char, ast::ArenaPool>     PartBuilder;
+    typedef StreamHelper<Stream, PartBuilder> PartIn;
+    typedef bool (*PartGrammar)(PartIn &);
+
+    /* e.g. `parse_elements` for an array, `parse_lines` for records */
+    static inline bool parse_part(
+        Part           & part,
+        PartGrammar      grammar,
+        Settings const & settings)
+    {
+        io::Span    span(part.beg, part.end);
+        PartBuilder builder(part.tree, settings, true);
+        PartIn      in(span, settings, builder);
+        in.resume(part.line, 1U, 0U);
+
+        bool status = false;
+        try {
+            status = grammar(in);
+        } catch (exception::ParseError const & e) {
+            part.message.push_back(e.what(), chars::strlen(e.what()));
+        }
+        return status;
+    }
+
+    /* takes parts one by one until none is left */
+    class Worker
+    {
+    public:
+        Worker(
+            Part                * parts,
+            size_t                size,
+            std::atomic<size_t> & next,
+            PartGrammar           grammar,
+            Settings const      & settings)
+            : parts_(parts)
+            , size_(size)
+            , next_(&next)
+            , grammar_(grammar)
+            , settings_(&settings)
+        {}
+
+        void operator()() const
+        {
+            for (size_t i = (*next_)++; i < size_; i = (*next_)++) {
+                Part & part = parts_[i];
+                try {
+                    part.status = parse_part(part, grammar_, *settings_);
+                } catch (...) {
+                    part.error = std::current_exception();
+                }
+            }
+        }
+
+    private:
+        Part                * parts_;
+        size_t                size_;
+        std::atomic<size_t> * next_;
+        PartGrammar           grammar_;
+        Settings const      * settings_;
+    };
+
+    /* `Settings::parallel_threads`, 0 for all cores */
+    static inline size_t count_threads(Settings const & settings)
+    {
+        size_t threads = settings.parallel_threads;
+        if (threads == 0)
+            threads = utility::max(
+                static_cast<size_t>(std::thread::hardware_concurrency()),
+                static_cast<size_t>(1U));
+        return threads;
     }
-}
+
+    /************************************************************************
+     * parse_parallel
+     ***********************************************************************/
+
+    /* elements of `split` are parsed by workers, while the rest of text,
+     * in which the array is replaced by `[]`, is parsed by this thread.
+     * Then elements are moved into that `[]`, and memory of each part is
+     * spliced into `tree.pool()`. Positions in messages of a part are
+     * relative to the beginning of that part. */
+    static bool parse_parallel(
+        char                       * beg,
+        char                       * end,
+        Split                const & split,
+        size_t                       threads,
+        Tree<char, ast::ArenaPool> & tree,
+        Message                    & message,
+        Settings             const & settings)
+    {
+        typedef KeywordTable<char> kwd;
+        typedef Tree<char, ast::ArenaPool>::Node Node;
+
+        /* [0] parts */
+        size_t size  = split.cuts.size() + 1U;
+        Part * parts = new Part[size];
+        for (size_t i = 0; i < size; ++i) {
+            parts[i].beg = (i == 0        ? split.beg : split.cuts[i - 1]) + 1;
+            parts[i].end = (i == size - 1 ? split.end : split.cuts[i]);
+        }
+
+        /* [1] workers */
+        std::atomic<size_t> next(0U);
+        Worker worker(parts, size, next, parse_elements<PartIn>, settings);
+        std::thread * pool = new std::thread[threads - 1U];
+        for (size_t i = 0; i < threads - 1U; ++i)
+            pool[i] = std::thread(worker);
+
+        /* [2] the rest of text, strings must not refer to this copy */
+        bool status = false;
+        try {
+            io::Buffer text;
+            text.push_back(beg, static_cast<size_t>(split.beg - beg));
+            text.push_back(kwd::SEQ_BEG);
+            text.push_back(kwd::SEQ_END);
+            text.push_back(
+                split.end + 1, static_cast<size_t>(end - split.end - 1));
+            text.push_back('\0');
+
+            Settings rest(settings);
+            rest.enable_insitu = false;
+
+            io::Span span(text.begin(), text.end() - 1);
+            status = parse_tree(span, tree, message, rest);
+        } catch (...) {
+            next = size; /* stop workers */
+            for (size_t i = 0; i < threads - 1U; ++i)
+                pool[i].join();
+            delete [] pool;
+            delete [] parts;
+            throw;
+        }
+
+        /* [3] join */
+        worker();
+        for (size_t i = 0; i < threads - 1U; ++i)
+            pool[i].join();
+        delete [] pool;
+
+        /* [4] stitch */
+        for (size_t i = 0; i < size && status; ++i) {
+            Part & part = parts[i];
+            if (part.error) {
+                std::exception_ptr error = part.error;
+                delete [] parts;
+                std::rethrow_exception(error);
+            }
+            if (part.status == false) {
+                message.push_back(part.message.begin(), part.message.size());
+                status = false;
+            }
+        }
+
+        if (status) {
+            Node * node = &tree.root();
+            for (size_t i = 0; i < split.path.size(); ++i) {
+                node
+                    = node->type() == ast::SEQ
+                    ? node->at<ast::SEQ>(split.path[i])
+                    : &(*node->at<ast::MAP>(split.path[i]))[1];
+            }
+            ASSERT_DBG(node->type() == ast::SEQ);
+
+            for (size_t i = 0; i < size; ++i) {
+                Node & root = parts[i].tree.root();
+                Node * iter = root.begin<ast::SEQ>();
+                Node * last = root.end  <ast::SEQ>();
+                for (; iter != last; ++iter)
+                    node->move_back<ast::SEQ>(*iter, tree.pool());
+                tree.pool().splice(parts[i].tree.pool());
+                tree.keys().splice(parts[i].tree.keys());
+            }
+            if (settings.enable_packed_array)
+                pack(*node, tree.pool());
+        }
+
+        delete [] parts;
+        return status;
+    }
+}}
 
 /****************************************************************************
- *  JSON ast builder
+ *  JSON lines
  ***************************************************************************/
 
 namespace parser { namespace json
 {
     /************************************************************************
-     * declaration Builder
+     * RecordReader::Impl
      ***********************************************************************/
 
-    template<typename CharType>
-    class Builder
+    /* records are read by `in_` one by one into `tree_`; or, with a view
+     * and threads, lines are cut into parts and each part is parsed by
+     * `parse_lines` into a sequence of records. */
+    class RecordReader::Impl
     {
     public:
-        typedef ast::Tree<CharType> Tree;
-        typedef ast::Node<CharType> Node;
+        typedef Tree<char, ast::ArenaPool>    Record;
+        typedef Builder<char, ast::ArenaPool> Handler;
+        typedef StreamHelper<Stream, Handler> In;
 
-    public:
-        Builder(Tree & tree);
+        /* lines are cut into parts of about this size */
+        static const size_t PART_SIZE = 1U << 18;
 
     public:
-        void map_beg();
-        void map_key();
-        void map_val();
-        void map_end();
+        Impl(Stream & stream, Settings const & settings);
+        ~Impl();
 
-        void seq_beg();
-        void seq_val();
-        void seq_end();
+        bool next();
 
-        void str_beg();
-        void str_end();
+    private:
+        bool next_line();
+        bool next_part();
+        void parse_batch();
 
-    public:
-        void on_nil();
-        void on_int(int64_t i);
-        void on_dbl(double  d);
-        void on_chr(CharType ch);
+    private:
+        Impl            (Impl const &);
+        Impl & operator=(Impl const &);
 
     public:
+        Settings         settings_;
+        Node           * record_;
+        ast::ArenaPool * pool_;
+        size_t           index_;
+        Message          message_;
+        bool             done_;
 
     private:
-        enum status_t
-        {
-            MAP_STR,
-            MAP_OBJ,
-            SEQ_OBJ,
-            STR_CHR
-        };
-
-    private:
-        typedef chars::Buffer<status_t, 128, std::allocator> sstack_t;
-        typedef chars::Buffer<Node *, 128, std::allocator> nstack_t;
-        typedef chars::Buffer<  CharType, 128, std::allocator> Buffer;
-
-        Tree    & tree_;
-        nstack_t  nstack_;
-        sstack_t  sstack_;
-        Buffer  buffer_;
+        /* one by one */
+        Record           tree_;
+        Handler          builder_;
+        In             * in_;
+
+        /* in parallel */
+        size_t           threads_;
+        char           * cur_;   /* text that is not cut yet       */
+        char           * end_;
+        uint64_t         line_;  /* line number of `cur_`          */
+        Part           * parts_;
+        size_t           size_;  /* parts in this batch            */
+        size_t           good_;  /* index of the failed part       */
+        size_t           part_;  /* part of the next record        */
+        size_t           item_;  /* index of the next record in it */
     };
 
-    /************************************************************************
-     * implementation Builder
-     ***********************************************************************/
-
-    template<typename CharType> inline Builder<CharType>::
-        Builder(Tree & tree)
-        : tree_(tree)
-        , nstack_()
-        , sstack_()
-        , buffer_()
+    RecordReader::Impl::Impl(Stream & stream, Settings const & settings)
+        : settings_(settings)
+        , record_(NULL)
+        , pool_(NULL)
+        , index_(static_cast<size_t>(-1))
+        , message_()
+        , done_(false)
+        , tree_()
+        , builder_(tree_, settings)
+        , in_(NULL)
+        , threads_(count_threads(settings))
+        , cur_(NULL)
+        , end_(NULL)
+        , line_(1U)
+        , parts_(NULL)
+        , size_(0U)
+        , good_(0U)
+        , part_(0U)
+        , item_(0U)
     {
-        nstack_.push_back(&tree_.root());
+        Stream::size_type length = 0;
+        char * view
+            = threads_ > 1 && stream.is_open()
+            ? stream.view(length)
+            : NULL
+            ;
+
+        if (view != NULL) {
+            cur_   = view;
+            end_   = view + static_cast<size_t>(length);
+            parts_ = new Part[threads_ * 4U];
+        } else {
+            in_    = new In(stream, settings_, builder_);
+        }
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        map_beg()
+    RecordReader::Impl::~Impl()
     {
-        using namespace ast;
-        Node & top = *nstack_.back();
-        top.template construct<MAP>(tree_.pool());
+        delete    in_;
+        delete [] parts_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        map_key()
+    bool RecordReader::Impl::next()
     {
-        using namespace ast;
-        typedef typename Node::Pair Pair;
-        Pair * pair = NULL;
-        {
-            Node & top = *nstack_.back();
-            Pair dummy;
-            dummy[0].construct(tree_.pool());
-            dummy[1].construct(tree_.pool());
-            top.template move_back<MAP>(dummy, tree_.pool());
+        if (done_)
+            return false;
 
-            pair = top.template rbegin<MAP>();
-        }
-        nstack_.push_back(&((*pair)[1]));
-        nstack_.push_back(&((*pair)[0]));
+        bool status = in_ != NULL ? next_line() : next_part();
+        if (status)
+            ++index_;
+        else
+            done_ = true;
+        return status;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        map_val()
+    bool RecordReader::Impl::next_line()
     {
-        ;
-    }
+        In & in = *in_;
 
-    template<typename CharType> inline void Builder<CharType>::
-        map_end()
-    {
-        nstack_.pop_back();
+        record_ = NULL;
+        tree_.reset();
+        builder_.reset();
+
+        bool status = false;
+        try {
+            in.resume(in.line(), in.col(), 0U);
+            if (skip_comments(in.skip_space())) {
+                if (in.empty())
+                    return false;
+                status = parse_line(in);
+            }
+        } catch (exception::ParseError const & e) {
+            message_.push_back(e.what(), chars::strlen(e.what()));
+        }
+
+        if (status == false)
+            return false;
+
+        record_ = &tree_.root();
+        pool_   = &tree_.pool();
+        return true;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        seq_beg()
+    bool RecordReader::Impl::next_part()
     {
-        using namespace ast;
-        Node & top = *nstack_.back();
-        top.template construct<SEQ>(tree_.pool());
+        record_ = NULL;
+        for (;;) {
+            /* [0] records of parsed parts, and those before the error */
+            if (part_ <= good_ && part_ < size_) {
+                Node & root = parts_[part_].tree.root();
+                size_t last
+                    = root.type() != ast::SEQ ? 0U
+                    : part_ < good_ ? root.size<ast::SEQ>()
+                    : root.size<ast::SEQ>() - 1U /* the broken one */
+                    ;
+                if (item_ < last) {
+                    record_ = root.at<ast::SEQ>(static_cast<uint32_t>(item_));
+                    pool_   = &parts_[part_].tree.pool();
+                    ++item_;
+                    return true;
+                }
+                if (part_ < good_) {
+                    ++part_;
+                    item_ = 0;
+                    continue;
+                }
+            }
+
+            /* [1] then the error, if any */
+            if (good_ < size_) {
+                Message const & error = parts_[good_].message;
+                message_.push_back(error.begin(), error.size());
+                return false;
+            }
+
+            /* [2] or the next batch */
+            if (cur_ == end_)
+                return false;
+            parse_batch();
+        }
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        seq_val()
+    void RecordReader::Impl::parse_batch()
     {
-        using namespace ast;
-        Node * node = NULL;
-        {
-            Node & top = *nstack_.back();
-            Node dummy;
-            dummy.construct(tree_.pool());
-            top.template move_back<SEQ>(dummy, tree_.pool());
-            node = top.template rbegin<SEQ>();
+        static const char LF = '\n';
+
+        /* [0] cut lines into parts, memory of the last batch is reused */
+        size_ = 0;
+        while (size_ < threads_ * 4U && cur_ != end_) {
+            char * cut = end_;
+            if (static_cast<size_t>(end_ - cur_) > PART_SIZE) {
+                cut = static_cast<char *>(std::memchr(
+                    cur_ + PART_SIZE, LF,
+                    static_cast<size_t>(end_ - cur_) - PART_SIZE));
+                if (cut == NULL)
+                    cut = end_;
+            }
+
+            Part & part = parts_[size_++];
+            part.beg    = cur_;
+            part.end    = cut;
+            part.line   = line_;
+            part.status = false;
+            part.error  = std::exception_ptr();
+            part.message.clear();
+            part.tree.reset();
+
+            line_ += static_cast<uint64_t>(
+                std::count(cur_, cut, LF));
+            if (cut != end_) {
+                ++line_;
+                ++cut;
+            }
+            cur_ = cut;
+        }
+
+        /* [1] parse */
+        std::atomic<size_t> next(0U);
+        Worker worker(parts_, size_, next, parse_lines<PartIn>, settings_);
+        size_t extra = std::min(threads_, size_) - 1U;
+        std::thread * pool = new std::thread[extra];
+        for (size_t i = 0; i < extra; ++i)
+            pool[i] = std::thread(worker);
+        worker();
+        for (size_t i = 0; i < extra; ++i)
+            pool[i].join();
+        delete [] pool;
+
+        /* [2] records before the first error are still good */
+        good_ = size_;
+        part_ = 0;
+        item_ = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            if (parts_[i].error) {
+                done_ = true;
+                std::rethrow_exception(parts_[i].error);
+            }
+            if (parts_[i].status == false) {
+                good_ = i;
+                break;
+            }
         }
-        nstack_.push_back(node);
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        seq_end()
+    /************************************************************************
+     * RecordReader
+     ***********************************************************************/
+
+    RecordReader::RecordReader(Stream & stream, Settings const & settings)
+        : impl_(new Impl(stream, settings))
+    {}
+
+    RecordReader::~RecordReader()
     {
-        nstack_.pop_back();
+        delete impl_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        str_beg()
+    bool RecordReader::next()
     {
-        buffer_.clear();
+        return impl_->next();
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        str_end()
+    RecordReader::Node & RecordReader::record()
     {
-        using namespace ast;
-        Node & top = *nstack_.back();
-        top.template set<STR>(buffer_.begin(), buffer_.end(),tree_.pool());
-        buffer_.clear();
-        nstack_.pop_back();
+        ASSERT_DBG(impl_->record_ != NULL);
+        return *impl_->record_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        on_int(int64_t val)
+    ast::ArenaPool & RecordReader::pool()
     {
-        using namespace ast;
-        Node & top = *nstack_.back();
-        top.template set<I64>(val, tree_.pool());
-        nstack_.pop_back();
+        ASSERT_DBG(impl_->pool_ != NULL);
+        return *impl_->pool_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        on_dbl(double val)
+    bool RecordReader::done() const
     {
-        using namespace ast;
-        Node & top = *nstack_.back();
-        top.template set<DBL>(val, tree_.pool());
-        nstack_.pop_back();
+        return impl_->done_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        on_nil()
+    size_t RecordReader::index() const
     {
-        nstack_.pop_back();
+        return impl_->index_;
     }
 
-    template<typename CharType> inline void Builder<CharType>::
-        on_chr(CharType ch)
+    Message const & RecordReader::message() const
     {
-        buffer_.push_back(ch);
+        return impl_->message_;
     }
-
 }}
 
 /****************************************************************************
- *  JSON Keyword
+ *  query
  ***************************************************************************/
 
 namespace parser { namespace json
 {
-    template<typename CharType> struct KeywordTable
-    {
-        typedef CharType CharType;
-        typedef const Keyword<CharType> value_type;
-
-        static value_type COLON;
-        static value_type COMMA;
-        static value_type ESCAPE;
-        static value_type HEX;
-        static value_type MINUS;
-        static value_type PLUS;
-        static value_type ZERO;
-        static value_type DOT;
-        static value_type EXP_U;
-        static value_type EXP_L;
-
-        static value_type STR_BEG;
-        static value_type STR_END;
-        static value_type SEQ_BEG;
-        static value_type SEQ_END;
-        static value_type MAP_BEG;
-        static value_type MAP_END;
-
-        static value_type VAL_FALSE;
-        static value_type VAL_TRUE;
-        static value_type VAL_NULL;
-
-        /* first of {C_COMMENT_1_BEG, C_COMMENT_2_BEG} */
-        static value_type   COMMENT_FIRST;
-        static value_type C_COMMENT_1_BEG;
-        static value_type C_COMMENT_1_END;
-        static value_type C_COMMENT_2_BEG;
-        static value_type C_COMMENT_2_END;
-    };
+    /************************************************************************
+     * Query
+     ***********************************************************************/
 
-#ifdef DEFINE_KEYWORD
-#error "conflicts!"
-#else
-#define DEFINE_KEYWORD(type, name, value) \
-    template<> const Keyword<type> KeywordTable<type>::name = value
+    Query::Query()
+        : text_()
+        , steps_()
+        , paths_()
+    {}
 
-    DEFINE_KEYWORD(char, COLON , ':');
-    DEFINE_KEYWORD(char, COMMA , ',');
-    DEFINE_KEYWORD(char, ESCAPE, '\\');
-    DEFINE_KEYWORD(char, HEX   , 'u');
-    DEFINE_KEYWORD(char, MINUS , '-');
-    DEFINE_KEYWORD(char, PLUS  , '+');
-    DEFINE_KEYWORD(char, ZERO  , '0');
-    DEFINE_KEYWORD(char, DOT   , '.');
-    DEFINE_KEYWORD(char, EXP_U , 'E');
-    DEFINE_KEYWORD(char, EXP_L , 'e');
+    bool Query::add(char const * path)
+    {
+        static const char SEPARATOR = '/';
+        static const char TILDE     = '~';
 
-    DEFINE_KEYWORD(char, STR_BEG , '"');
-    DEFINE_KEYWORD(char, STR_END , '"');
-    DEFINE_KEYWORD(char, SEQ_BEG , '[');
-    DEFINE_KEYWORD(char, SEQ_END , ']');
-    DEFINE_KEYWORD(char, MAP_BEG , '{');
-    DEFINE_KEYWORD(char, MAP_END , '}');
+        if (path == NULL || (*path != '\0' && *path != SEPARATOR))
+            return false;
 
-    DEFINE_KEYWORD(char, VAL_FALSE, "false");
-    DEFINE_KEYWORD(char, VAL_TRUE , "true" );
-    DEFINE_KEYWORD(char, VAL_NULL , "null" );
+        /* "~1" is '/', "~0" is '~' */
+        paths_.push_back(steps_.size());
+        for (char const * cur = path; *cur != '\0'; ) {
+            Step step = { text_.size(), 0U };
+            for (++cur; *cur != '\0' && *cur != SEPARATOR; ++cur) {
+                char ch = *cur;
+                if (ch == TILDE && (cur[1] == '0' || cur[1] == '1'))
+                    ch = *++cur == '0' ? TILDE : SEPARATOR;
+                text_.push_back(ch);
+                ++step.len;
+            }
+            steps_.push_back(step);
+        }
+        return true;
+    }
 
-    DEFINE_KEYWORD(char,   COMMENT_FIRST, '/');
-    DEFINE_KEYWORD(char, C_COMMENT_1_BEG, "/*");
-    DEFINE_KEYWORD(char, C_COMMENT_1_END, "*/");
-    DEFINE_KEYWORD(char, C_COMMENT_2_BEG, "//");
-    DEFINE_KEYWORD(char, C_COMMENT_2_END, '\n');
+    size_t Query::size() const
+    {
+        return paths_.size();
+    }
 
-#undef DEFINE_KEYWORD
-#endif
-}}
+    size_t Query::depth(size_t path) const
+    {
+        size_t end = path + 1U < paths_.size() ? paths_[path + 1U]
+                                               : steps_.size();
+        return end - paths_[path];
+    }
 
-/****************************************************************************
- *  JSON parser
- ***************************************************************************/
+    bool Query::match(
+        size_t path, size_t depth, char const * key, size_t len) const
+    {
+        Step const & step = steps_[paths_[path] + depth];
+        char const * text = text_.begin() + step.off;
+        return (step.len == 1U && *text == '*')
+            || (step.len == len && std::memcmp(text, key, len) == 0);
+    }
 
-namespace parser { namespace json
-{
-    /************************************************************************
-     * helper
-     ***********************************************************************/
+    bool Query::match(size_t path, size_t depth, size_t index) const
+    {
+        static const size_t MAX_DIGITS = 19U;
 
-    template<typename CharType> inline CharType chr_to_esc(CharType);
+        Step const & step = steps_[paths_[path] + depth];
+        char const * text = text_.begin() + step.off;
+        if (step.len == 1U && *text == '*')
+            return true;
 
-    template<> inline char chr_to_esc(char ch)
-    {
-        switch (ch)
-        {
-        case '\\':
-        case '\'':
-        case '"' : return ch;
-        case 'n' : return '\n';
-        case 'r' : return '\r';
-        case 't' : return '\t';
-        case 'b' : return '\b';
-        case 'f' : return '\f';
-        default  : return '\0';
+        /* no leading zero */
+        if (step.len == 0 || step.len > MAX_DIGITS ||
+            (step.len > 1U && *text == '0'))
+            return false;
+
+        uint64_t val = 0;
+        for (size_t i = 0; i < step.len; ++i) {
+            if (! chars::isdigit(text[i]))
+                return false;
+            val = val * 10U + static_cast<uint64_t>(text[i] - '0');
         }
+        return val == static_cast<uint64_t>(index);
     }
-}}
 
-namespace parser { namespace json
-{
     /************************************************************************
-     * Declaration
+     * Filter
      ***********************************************************************/
 
-    /* references:
-     * 0. http://json.org/
-     * 1. https://tools.ietf.org/html/rfc7159
-     * 2. ECMA-404.pdf
-     */
-
-    /*
-     *  object
-     *      {}
-     *      { members }
-     *  members
-     *      pair
-     *      pair , members
-     *  pair
-     *      string : value
-     */
-    template<typename InType> inline bool parse_object(InType & in);
-
-    /*
-     *  array
-     *      []
-     *      [ elements ]
-     *  elements
-     *      value
-     *      value , elements
-     */
-    template<typename InType> inline bool parse_array(InType & in);
-
-    /*
-     *  value
-     *      string
-     *      number
-     *      object
-     *      array
-     *      keyword
-     */
-    template<typename InType> inline bool parse_value(InType & in);
-
-    /*
-     *  keyword
-     *      true
-     *      false
-     *      null
-     */
-    template<typename InType> inline bool parse_keyword(InType & in);
-
-    /*
-     *  string
-     *      ""
-     *      " chars "
-     *  chars
-     *      char
-     *      char chars
-     *  char
-     *      any-Unicode-character-except-"-or-\-or-control-character
-     *      \"
-     *      \\
-     *      \/
-     *      \b
-     *      \f
-     *      \n
-     *      \r
-     *      \t
-     *      \u four-hex-digits
-     */
-    template<typename InType> inline bool parse_string(InType & in);
-
-    /*
-     *  number
-     *      int
-     *      int frac
-     *      int exp
-     *      int frac exp
-     *  int
-     *      digit
-     *      digit1-9 digits
-     *      - digit
-     *      - digit1-9 digits
-     *  frac
-     *      . digits
-     *  exp
-     *      e digits
-     *  digits
-     *      digit
-     *      digit digits
-     *  e
-     *      e
-     *      e+
-     *      e-
-     *      E
-     *      E+
-     *      E-
-     */
-    template<typename InType> inline bool parse_number(InType & in);
-
-    /*
-     *  cpp style comments
-     *      / / any-character-except-newline-or-eof (newline | eof)
-     *      / * any-character-except-*-and-/ * /
-     */
-    template<typename InType> inline bool skip_comments(InType & in);
+    /* passes events to a handler, except that strings are kept in `key()`
+     * while capturing, so a key is known before its pair is built */
+    template<typename HandlerType> class Filter : public Handler<char>
+    {
+    public:
+        typedef chars::Buffer<char, 64, std::allocator> Key;
+
+    public:
+        explicit Filter(HandlerType & handler)
+            : handler_(handler)
+            , key_()
+            , capture_(false)
+        {}
+
+    public:
+        inline void capture()        { key_.clear(); capture_ = true; }
+        inline void release()        { capture_ = false; }
+        inline Key const & key() const { return key_; }
+
+    public:
+        inline void map_beg() { handler_.map_beg(); }
+        inline void map_key() { handler_.map_key(); }
+        inline void map_val() { handler_.map_val(); }
+        inline void map_end() { handler_.map_end(); }
+
+        inline void seq_beg() { handler_.seq_beg(); }
+        inline void seq_val() { handler_.seq_val(); }
+        inline void seq_end() { handler_.seq_end(); }
+
+        inline void str_beg()
+        {
+            if (! capture_)
+                handler_.str_beg();
+        }
+        inline void str_end()
+        {
+            if (! capture_)
+                handler_.str_end();
+        }
+        inline void str_val(char const * str, size_t len)
+        {
+            if (capture_)
+                key_.push_back(str, len);
+            else
+                handler_.str_val(str, len);
+        }
+        inline void str_ref(char * str, size_t len)
+        {
+            if (capture_)
+                key_.push_back(str, len);
+            else
+                handler_.str_ref(str, len);
+        }
+
+    public:
+        inline void on_nil()           { handler_.on_nil(); }
+        inline void on_int(int64_t val) { handler_.on_int(val); }
+        inline void on_dbl(double  val) { handler_.on_dbl(val); }
+        inline void on_chr(char    ch)
+        {
+            if (capture_)
+                key_.push_back(ch);
+            else
+                handler_.on_chr(ch);
+        }
+        inline void on_str(char const * str, size_t len)
+        {
+            if (capture_)
+                key_.push_back(str, len);
+            else
+                handler_.on_str(str, len);
+        }
+
+    private:
+        Filter            (Filter const &);
+        Filter & operator=(Filter const &);
+
+    private:
+        HandlerType & handler_;
+        Key           key_;
+        bool          capture_;
+    };
 
     /************************************************************************
-     * Implementation
+     * grammar
      ***********************************************************************/
 
-    /* note: each function must do `skip(chars::isspace)` at the end */
+    /* indices of paths that match the way from the root to a value, the
+     * ones of each level are pushed behind the ones of its parent */
+    typedef chars::Buffer<size_t, 32, std::allocator> Active;
+
+    template<typename InType> static bool query_value(
+        InType & in, Query const & query, Active & active,
+        size_t beg, size_t depth);
+
+    /* whether the value of paths [beg, end) of `active` is built: it is
+     * the end of one of them, or a container that they may go into */
+    template<typename InType> static inline bool query_keep(
+        InType & in, Query const & query, Active const & active,
+        size_t beg, size_t depth)
+    {
+        typedef KeywordTable<char> kwd;
+
+        for (size_t i = beg; i < active.size(); ++i)
+            if (query.depth(active[i]) == depth)
+                return true;
+        return beg != active.size()
+            && (in.ch() == kwd::MAP_BEG || in.ch() == kwd::SEQ_BEG);
+    }
 
-    template<typename InType> inline bool parse_object(InType & in)
+    template<typename InType> static bool query_object(
+        InType & in, Query const & query, Active & active,
+        size_t beg, size_t depth)
     {
-        typedef typename InType::CharType CharType;
-        typedef KeywordTable<CharType> kwd;
+        typedef KeywordTable<char> kwd;
 
         /* { */
         if (! match(in, kwd::MAP_BEG))
             return exception::expect(in, kwd::MAP_BEG, "JSON object");
 
-        if (! skip_comments(in.skip(chars::isspace)))
+        if (! skip_comments(in.skip_space()))
             return false;
 
-        Builder<CharType> & builder = in.get();
-        builder.map_beg();
+        typename InType::reference filter = in.get();
+        filter.map_beg();
 
         /* { } */
         if (match(in, kwd::MAP_END)) {
-            builder.map_end();
-            return skip_comments(in.skip(chars::isspace));
+            filter.map_end();
+            return skip_comments(in.skip_space());
         }
 
+        size_t const end = active.size();
         bool is_continue = false;
         do { /* { members } */
 
-            builder.map_key();
-            if (! parse_string(in))
+            /* the key is kept aside until it is known to be on a path */
+            filter.capture();
+            bool status = parse_string(in);
+            filter.release();
+            if (! status)
                 return false;
 
             if (! skip_comments(in))
@@ -546,11 +920,25 @@ namespace parser { namespace json
             if (! match(in, kwd::COLON))
                 return exception::expect(in, kwd::COLON, "JSON pair");
 
-            if (! skip_comments(in.skip(chars::isspace)))
+            if (! skip_comments(in.skip_space()))
                 return false;
 
-            builder.map_val();
-            if (! parse_value(in))
+            char const * key = filter.key().begin();
+            size_t       len = filter.key().size();
+            for (size_t i = beg; i < end; ++i)
+                if (query.match(active[i], depth, key, len))
+                    active.push_back(active[i]);
+
+            if (query_keep(in, query, active, end, depth + 1U)) {
+                filter.map_key();
+                filter.str_val(key, len);
+                filter.map_val();
+                status = query_value(in, query, active, end, depth + 1U);
+            } else {
+                status = skip_value(in);
+            }
+            active.resize(end);
+            if (! status)
                 return false;
 
             if (     match(in, kwd::COMMA))
@@ -560,40 +948,55 @@ namespace parser { namespace json
             else
                 return exception::expect(in, ",` or `}", "JSON object");
 
-            if (! skip_comments(in.skip(chars::isspace)))
+            if (! skip_comments(in.skip_space()))
                 return false;
         } while(is_continue);
 
-        builder.map_end();
+        filter.map_end();
         return true;
     }
 
-    template<typename InType> inline bool parse_array(InType & in)
+    template<typename InType> static bool query_array(
+        InType & in, Query const & query, Active & active,
+        size_t beg, size_t depth)
     {
-        typedef typename InType::CharType CharType;
-        typedef KeywordTable<CharType> kwd;
+        typedef KeywordTable<char> kwd;
 
         /* [ */
         if (! match(in, kwd::SEQ_BEG))
             return exception::expect(in, kwd::SEQ_BEG, "JSON array");
 
-        if (! skip_comments(in.skip(chars::isspace)))
+        if (! skip_comments(in.skip_space()))
             return false;
 
-        Builder<CharType> & builder = in.get();
-        builder.seq_beg();
+        typename InType::reference filter = in.get();
+        filter.seq_beg();
 
         /* [ ] */
         if (match(in, kwd::SEQ_END)) {
-            builder.seq_end();
-            return skip_comments(in.skip(chars::isspace));
+            filter.seq_end();
+            return skip_comments(in.skip_space());
         }
 
-        /* [ elements ] */
+        /* [ elements ], skipped ones are NIL */
+        size_t const end = active.size();
+        size_t index = 0;
         bool is_continue = false;
         do {
-            builder.seq_val();
-            if (! parse_value(in))
+            for (size_t i = beg; i < end; ++i)
+                if (query.match(active[i], depth, index))
+                    active.push_back(active[i]);
+
+            bool status = false;
+            filter.seq_val();
+            if (query_keep(in, query, active, end, depth + 1U)) {
+                status = query_value(in, query, active, end, depth + 1U);
+            } else {
+                filter.on_nil();
+                status = skip_value(in);
+            }
+            active.resize(end);
+            if (! status)
                 return false;
 
             if (! skip_comments(in))
@@ -606,283 +1009,375 @@ namespace parser { namespace json
             else
                 return exception::expect(in, ",` or `]", "JSON array");
 
-            if (! skip_comments(in.skip(chars::isspace)))
+            if (! skip_comments(in.skip_space()))
                 return false;
+            ++index;
         } while(is_continue);
 
-        builder.seq_end();
+        filter.seq_end();
         return true;
     }
 
-    template<typename InType> inline bool parse_value(InType & in)
+    /* the end of a path is built as a whole */
+    template<typename InType> static bool query_value(
+        InType & in, Query const & query, Active & active,
+        size_t beg, size_t depth)
     {
-        typedef typename InType::CharType   CharType;
-        typedef KeywordTable<CharType> kwd;
-
-        bool (* func)(InType &) = NULL;
-        CharType ch = in.ch();
-        if (       ch == kwd::STR_BEG) {
-            func = parse_string;
-        } else if (ch == kwd::MAP_BEG) {
-            func = parse_object;
-        } else if (ch == kwd::SEQ_BEG) {
-            func = parse_array;
-        } else if (chars::isdigit(ch) || ch == kwd::MINUS) {
-            func = parse_number;
-        } else if (chars::isalpha(ch)) {
-            func = parse_keyword;
-        } else {
-            return exception::expect(in, "value", "JSON value");
-        }
+        typedef KeywordTable<char> kwd;
 
-        if (! func(in))
-            return false;
+        for (size_t i = beg; i < active.size(); ++i)
+            if (query.depth(active[i]) == depth)
+                return parse_value(in);
 
-        return skip_comments(in.skip(chars::isspace));
+        return in.ch() == kwd::MAP_BEG
+            ? query_object(in, query, active, beg, depth)
+            : query_array (in, query, active, beg, depth)
+            ;
     }
 
-    template<typename InType> inline bool parse_keyword(InType & in)
+    /************************************************************************
+     * parse
+     ***********************************************************************/
+
+    extern bool parse(
+        Stream                     & stream,
+        Tree<char, ast::ArenaPool> & tree,
+        Query                const & query,
+        Message                    & message,
+        Settings             const & settings)
     {
-        typedef typename InType::CharType   CharType;
-        typedef KeywordTable<CharType> kwd;
-        using namespace ast;
+        typedef Builder<char, ast::ArenaPool> TreeBuilder;
+        typedef Filter<TreeBuilder>           QueryFilter;
+        typedef StreamHelper<Stream, QueryFilter> In;
 
-        typename kwd::value_type const * keyword = NULL;
-        CharType                                ch = in.ch();
-        Builder<CharType> &              builder = in.get();
+        TreeBuilder builder(tree, settings);
+        QueryFilter filter(builder);
+        In          in(stream, settings, filter);
 
-        if (     ch == kwd::VAL_TRUE)
-            keyword =& kwd::VAL_TRUE;
-        else if (ch == kwd::VAL_FALSE)
-            keyword =& kwd::VAL_FALSE;
-        else if (ch == kwd::VAL_NULL)
-            keyword =& kwd::VAL_NULL;
+        Active active;
+        for (size_t i = 0; i < query.size(); ++i)
+            active.push_back(i);
 
-        if (keyword != NULL && match(in, *keyword))
-        {
-            if (       ch == kwd::VAL_TRUE) {
-                exception::warning(in, "JSON value 'true' is not supported"
-                                       " and will be treated as int 1");
-                builder.on_int(int64_t(1));
-            } else if (ch == kwd::VAL_FALSE) {
-                exception::warning(in, "JSON value 'false' is not supported"
-                                       " and will be treated as int 0");
-                builder.on_int(int64_t(0));
-            } else if (ch == kwd::VAL_NULL) {
-                builder.on_nil();
-            } else {
-                keyword = NULL;
-            }
-            in.skip(chars::isspace);
+        bool status = false;
+        try {
+            status
+                = query_keep(in, query, active, 0U, 0U)
+                ? query_value(in, query, active, 0U, 0U)
+                : skip_value(in)
+                ;
+        } catch (exception::ParseError const & e) {
+            message.push_back(e.what(), chars::strlen(e.what()));
         }
+        return status;
+    }
+}}
+
+/****************************************************************************
+ *  lazy tree
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * scan_items
+     ***********************************************************************/
 
-        if (keyword == NULL)
-            return exception::expect(in, "KEYWORD", "JSON value");
+    /* a container element of an item, [beg, end) */
+    struct Cut
+    {
+        char * beg;
+        char * end;
+        size_t index; /* of the element, or of the pair */
+    };
 
+    typedef chars::Buffer<Cut, 16, std::allocator> Cuts;
+
+    /* find elements of the first container in [beg, end) that are
+     * containers of `size` bytes or more, as `scan_array` does. Returns
+     * false if a comment may hide structural chars, then `cuts` are of no
+     * use. */
+    static bool scan_items(
+        char           * beg,
+        char           * end,
+        size_t           size,
+        Settings const & settings,
+        Cuts           & cuts)
+    {
+        typedef KeywordTable<char> kwd;
+
+        simd::Scanner const & scanner = simd::scanner();
+        simd::Carry           carry   = { 0U, 0U };
+        simd::Masks           masks;
+
+        size_t const width = scanner.width;
+        size_t       level = 0;
+        size_t       index = 0;
+        char       * first = NULL;
+        char const * slash = NULL;
+        char         tail[64];
+
+        if (settings.enable_json_comment)
+            slash = static_cast<char const *>(std::memchr(
+                beg, kwd::COMMENT_FIRST, static_cast<size_t>(end - beg)));
+
+        for (char * blk = beg; blk < end; blk += width) {
+            char const * src = blk;
+            if (static_cast<size_t>(end - blk) < width) {
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, blk, static_cast<size_t>(end - blk));
+                src = tail;
+            }
+            scanner.classify(src, masks);
+            uint32_t inside = simd::in_string(masks, width, carry);
+
+            /* a comment may hide structural chars */
+            for (; slash != NULL && slash < blk + width; slash =
+                static_cast<char const *>(std::memchr(slash + 1,
+                kwd::COMMENT_FIRST, static_cast<size_t>(end - slash - 1))))
+                if (((inside >> (slash - blk)) & 1U) == 0)
+                    return false;
+
+            uint32_t bits = masks.structural & ~inside;
+            for (; bits != 0; bits &= bits - 1U) {
+                char * pos = blk + simd::lowest_bit(bits);
+                char   ch  = *pos;
+                if (ch == kwd::MAP_BEG || ch == kwd::SEQ_BEG) {
+                    if (level++ == 1)
+                        first = pos;
+                } else if (ch == kwd::MAP_END || ch == kwd::SEQ_END) {
+                    if (level == 0)
+                        return true;
+                    if (--level == 0)
+                        return true;
+                    if (level == 1 &&
+                        static_cast<size_t>(pos + 1 - first) >= size) {
+                        Cut cut = { first, pos + 1, index };
+                        cuts.push_back(cut);
+                    }
+                } else if (ch == kwd::COMMA) {
+                    if (level == 1)
+                        ++index;
+                }
+            }
+        }
         return true;
     }
 
-    template<typename InType> inline bool parse_string(InType & in)
+    /************************************************************************
+     * LazyTree::Item
+     ***********************************************************************/
+
+    class LazyTree::Item
     {
-        typedef typename InType::CharType   CharType;
-        typedef KeywordTable<CharType> kwd;
+    public:
+        typedef Tree<char, ast::ArenaPool> Part;
+
+        /* a container left as text, and the index of the NIL node in
+         * place of it. Nodes are found by index, as pairs of a map move
+         * when it is indexed by the first lookup of a key. */
+        struct Kid
+        {
+            size_t index; /* of the element, or of the pair */
+            Item * item;
+        };
+        typedef chars::Buffer<Kid, 4, std::allocator> Kids;
 
-        /* " */
-        if (! match(in, kwd::STR_BEG))
-            return exception::expect(in, kwd::STR_BEG, "JSON string");
+    public:
+        Item(char * beg, char * end)
+            : beg(beg), end(end), tree(), kids(), done(false), status(false)
+        {}
+        ~Item()
+        {
+            for (size_t i = 0; i < kids.size(); ++i)
+                delete kids[i].item;
+        }
 
-        Builder<CharType> & builder = in.get();
-        builder.str_beg();
+    public:
+        char * beg;    /* text of the value */
+        char * end;
+        Part   tree;
+        Kids   kids;   /* in order of text  */
+        bool   done;   /* expanded, or failed to */
+        bool   status;
 
-        bool is_char = true;
+    private:
+        Item            (Item const &);
+        Item & operator=(Item const &);
+    };
 
-        /* [ chars ] */
-        do {
-            if (in.ch() == kwd::ESCAPE) { /* escape */
-                in.skip();
-                CharType ch = chr_to_esc(in.ch());
-                if (ch != '\0') {
-                    builder.on_chr(ch);
-                } else if (in.ch() == kwd::HEX) {
-                    exception::warning(in, "`\\uXXXX` is not implemented and"
-                                           " will be preserved");
-                    builder.on_chr(kwd::ESCAPE);
-                    builder.on_chr(kwd::HEX);
-                    for (size_t i = 0U; i < 4U; i++) {
-                        ch = in.skip().ch();
-                        if (chars::ishexdigit(ch)) {
-                            builder.on_chr(ch);
-                        } else {
-                            return exception::expect
-                            (in, "DIGIT(HEX)", "\\uXXXX");
-                        }
-                    }
-                } else {
-                    return exception::expect
-                    (in, "ESCAPED CHARACTER", "JSON char");
-                }
-            } else if (in.ch() == kwd::STR_END) {
-                is_char = false;
-            } else { /* unescaped */
-                CharType ch = in.ch();
-                if (chars::iscntrl(ch))
-                    return exception::expect(in, "CHAR", "JSON char");
-                builder.on_chr(ch);
-            }
+    /************************************************************************
+     * LazyTree::Impl
+     ***********************************************************************/
 
-            in.skip();
-        } while(is_char);
+    class LazyTree::Impl
+    {
+    public:
+        Impl(Stream & stream, Settings const & settings);
+        ~Impl();
 
-        builder.str_end();
+        bool expand(Item & item);
 
-        in.skip(chars::isspace);
-        return true;
+    private:
+        Impl            (Impl const &);
+        Impl & operator=(Impl const &);
+
+    public:
+        Settings   settings_;
+        io::Buffer copy_;    /* of a stream that has no view */
+        Item     * root_;
+        Message    message_;
+    };
+
+    LazyTree::Impl::Impl(Stream & stream, Settings const & settings)
+        : settings_(settings)
+        , copy_()
+        , root_(NULL)
+        , message_()
+    {
+        /* strings never refer to the text, which is cut and copied */
+        settings_.enable_insitu = false;
+
+        Stream::size_type length = 0;
+        char * view = stream.is_open() ? stream.view(length) : NULL;
+        if (view == NULL && stream.is_open()) {
+            copy_ = stream.dump();
+            length = copy_.size();
+            copy_.push_back('\0');
+            view = copy_;
+        } else if (view == NULL) {
+            copy_.push_back('\0');
+            view = copy_;
+        }
+        root_ = new Item(view, view + static_cast<size_t>(length));
     }
 
-    template<typename InType> inline bool parse_number(InType & in)
+    LazyTree::Impl::~Impl()
     {
-        typedef typename InType::CharType CharType;
-        typedef KeywordTable<CharType> kwd;
-        using namespace ast;
+        delete root_;
+    }
 
-        Builder<CharType> & builder = in.get();
+    /* elements that are left as text are replaced by `null` in a copy of
+     * the text, which is parsed as usual, then the NIL nodes in place of
+     * them are found by their index. */
+    bool LazyTree::Impl::expand(Item & item)
+    {
+        typedef KeywordTable<char> kwd;
 
-        uint64_t    integral = 0,    integral_length = 0;
-        uint64_t  fractional = 0,  fractional_length = 0;
-        int      exponential = 0, exponential_length = 0;
+        if (item.done)
+            return item.status;
+        item.done = true;
 
-        /* - */
-        bool is_integral_negtive = false;
-        if (in.ch() == kwd::MINUS) {
-            is_integral_negtive = true;
-            in.skip();
-        }
+        Cuts cuts;
+        if (!scan_items(item.beg, item.end, LAZY_SIZE, settings_, cuts))
+            cuts.clear();
 
-        /* 0 or [1-9]* */
-        if (in.ch() == kwd::ZERO) {
-            in.skip();
-            integral_length ++;
-        } else if (chars::isdigit(in.ch())) {
-            integral *= uint64_t(10);
-            integral += static_cast<int>(in.ch() - kwd::ZERO);
-            integral_length ++;
-            while (chars::isdigit(in.skip().ch())) {
-                integral *= uint64_t(10);
-                integral += static_cast<int>(in.ch() - kwd::ZERO);
-                integral_length ++;
-            }
+        bool status = false;
+        if (cuts.empty()) {
+            io::Span span(item.beg, item.end);
+            status = parse_tree(span, item.tree, message_, settings_);
         } else {
-            return exception::expect(in, "DIGIT", "JSON number");
-        }
-
-        /* .[0-9]* */
-        if (in.ch() == kwd::DOT) {
-            while (chars::isdigit(in.skip().ch())) {
-                fractional *= uint64_t(10);
-                fractional += static_cast<int>(in.ch() - kwd::ZERO);
-                fractional_length ++;
+            io::Buffer text;
+            char * cur = item.beg;
+            for (size_t i = 0; i < cuts.size(); ++i) {
+                text.push_back(cur, static_cast<size_t>(cuts[i].beg - cur));
+                text.push_back(
+                    static_cast<char const *>(kwd::VAL_NULL),
+                    kwd::VAL_NULL.size());
+                cur = cuts[i].end;
             }
+            text.push_back(cur, static_cast<size_t>(item.end - cur));
+            text.push_back('\0');
+
+            io::Span span(text.begin(), text.end() - 1);
+            status = parse_tree(span, item.tree, message_, settings_);
         }
 
-        /* e[+-][0-9]* */
-        if (in.ch() == kwd::EXP_U || in.ch() == kwd::EXP_L) {
-            bool is_exponential_negtive = false;
-            in.skip();
-            if (in.ch() == kwd::MINUS || in.ch() == kwd::PLUS  ) {
-                is_exponential_negtive = (in.ch() == kwd::MINUS);
-                in.skip();
-            }
-            while (chars::isdigit(in.ch())) {
-                exponential *= uint64_t(10);
-                exponential += static_cast<int>(in.ch() - kwd::ZERO);
-                exponential_length ++;
-                in.skip();
-            }
-            if (is_exponential_negtive)
-                exponential = -exponential;
-            if (exponential_length == 0)
-                return exception::expect(in, "DIGIT", "JSON number");
+        Node & node = item.tree.root();
+        for (size_t i = 0; i < cuts.size() && status; ++i) {
+            Node * elem
+                = node.type() == ast::SEQ
+                ? node.at<ast::SEQ>(static_cast<uint32_t>(cuts[i].index))
+                : node.type() == ast::MAP
+                ? &(*node.at<ast::MAP>(static_cast<uint32_t>(cuts[i].index)))[1]
+                : NULL
+                ;
+            ASSERT_DBG(elem != NULL && elem->type() == ast::NIL);
+            (void)elem;
+
+            Item::Kid kid = { cuts[i].index,
+                              new Item(cuts[i].beg, cuts[i].end) };
+            item.kids.push_back(kid);
         }
 
-        /* get value */
-        if (fractional_length > 0 || exponential_length > 0) {    /* real */
-            static const int EXPONENT_MAX_LENGTH = static_cast<int>
-                (::log10(std::numeric_limits<double>::max_exponent10)) + 1;
+        if (!status)
+            item.tree.clear();
+        item.status = status;
+        return status;
+    }
 
-            if (fractional_length + integral_length >=
-                std::numeric_limits<double>::digits10 + 5) {
-                exception::warning(in, "`double` precision may be lost");
-            }
-            if (exponential_length > EXPONENT_MAX_LENGTH ||
-                exponential <= std::numeric_limits<double>::min_exponent10 ||
-                exponential >= std::numeric_limits<double>::max_exponent10) {
-                exception::warning(in, "too big for `double` type");
-            }
+    /************************************************************************
+     * LazyTree
+     ***********************************************************************/
 
-            double var = 0;
-            if (integral != 0)
-                var = static_cast<double>(integral);
-            if (fractional_length != 0)
-                var += static_cast<double>(fractional)
-                     / ::pow(10, fractional_length);
-            if (exponential_length != 0)
-                var *= ::pow(10.0, exponential);
-            if (is_integral_negtive)
-                var = -var;
-            builder.on_dbl(var);
-
-        } else {    /* integer */
-            static const int64_t MAX = std::numeric_limits<int64_t>::max();
-            static const int64_t MIN = std::numeric_limits<int64_t>::min();
-
-            if (integral_length > std::numeric_limits<uint64_t>::digits10) {
-                exception::warning(in, "too big for `uint64`");
-                if (is_integral_negtive)
-                    builder.on_int(MIN);
-                else
-                    builder.on_int(MAX);
-            } else if (integral & uint64_t(0x8000000000000000)) {
-                if (is_integral_negtive)
-                    builder.on_int(MIN);
-                else
-                    builder.on_int(MAX);
-            } else {
-                if (is_integral_negtive)
-                    builder.on_int(-static_cast<int64_t>(integral));
-                else
-                    builder.on_int(static_cast<int64_t>(integral));
-            }
-        }
+    LazyTree::LazyTree(Stream & stream, Settings const & settings)
+        : impl_(new Impl(stream, settings))
+    {}
 
-        in.skip(chars::isspace);
-        return true;
+    LazyTree::~LazyTree()
+    {
+        delete impl_;
     }
 
-    /* actually (comment*) */
-    template<typename InType> bool skip_comments(InType & in)
+    LazyTree::Item & LazyTree::root()
     {
-        typedef KeywordTable<typename InType::CharType> kwd;
-        if (in.ch() != kwd::COMMENT_FIRST)
-            return true;
+        return *impl_->root_;
+    }
 
-        if (in.get_settings().enable_json_comment == false)
-            return exception::opt_error(in, "ENABLE_JSON_COMMENT", "FALSE");
+    LazyTree::Node * LazyTree::expand(Item & item)
+    {
+        return impl_->expand(item) ? &item.tree.root() : NULL;
+    }
 
-        size_t pos = 0;
-        while (pos != in.pos()) {
-            pos = in.pos();
+    LazyTree::Item * LazyTree::child(Item & item, Node const & node)
+    {
+        if (item.kids.empty())
+            return NULL;
+
+        /* index of `node` in the container, as it is now */
+        Node const & root = item.tree.root();
+        Node const * beg  = NULL;
+        size_t       siz  = 0;
+        if (root.type() == ast::SEQ) {
+            beg = root.begin<ast::SEQ>();
+            siz = root.size<ast::SEQ>();
+        } else if (root.type() == ast::MAP) {
+            beg = *root.begin<ast::MAP>();
+            siz = root.size<ast::MAP>() << 1;
+        }
+        if (beg == NULL || &node < beg || &node >= beg + siz)
+            return NULL;
+
+        size_t index = static_cast<size_t>(&node - beg);
+        if (root.type() == ast::MAP) {
+            if ((index & 1U) == 0)
+                return NULL; /* a key */
+            index >>= 1;
+        }
 
-            /* try skip '/ * ... * /' */
-            if (!skip_block(in, kwd::C_COMMENT_1_BEG, kwd::C_COMMENT_1_END))
-                return exception::expect(in,kwd::C_COMMENT_1_END, "Comment");
+        for (size_t i = 0; i < item.kids.size(); ++i)
+            if (item.kids[i].index == index)
+                return item.kids[i].item;
+        return NULL;
+    }
 
-            /* try skip '/ / ...' */
-            skip_block(in, kwd::C_COMMENT_2_BEG, kwd::C_COMMENT_2_END);
+    ast::ArenaPool & LazyTree::pool(Item & item)
+    {
+        return item.tree.pool();
+    }
 
-            /* try skip 'SPACE' */
-            in.skip(chars::isspace);
-        }
-        return true;
+    Message const & LazyTree::message() const
+    {
+        return impl_->message_;
     }
 }}
 
@@ -898,15 +1393,52 @@ namespace parser { namespace json
         Message        & message,
         Settings const & settings)
     {
-        Builder<char> builder(tree);
-        In in(stream, settings, builder);
+        return parse_tree(stream, tree, message, settings);
+    }
 
-        bool status = false;
-        try {
-            status = parse_value(in);
-        } catch (exception::ParseError const & e) {
-            message.push_back(e.what(), chars::strlen(e.what()));
+    extern bool parse(
+        Stream                      & stream,
+        Tree<char, ast::ArenaPool>  & tree,
+        Message                     & message,
+        Settings const              & settings)
+    {
+        /* parts smaller than this are not worth a thread */
+        static const size_t MIN_PART_SIZE = 1U << 16;
+
+        size_t threads = count_threads(settings);
+
+        Stream::size_type length = 0;
+        char * view
+            = threads > 1 && stream.is_open()
+            ? stream.view(length)
+            : NULL
+            ;
+
+        Split split;
+        if (view != NULL) {
+            size_t total = static_cast<size_t>(length);
+            size_t part  = utility::max(total / (threads * 4U), MIN_PART_SIZE);
+            if (scan_array(view, view + total, part, settings, split))
+                return parse_parallel(
+                    view, view + total, split, threads,
+                    tree, message, settings);
         }
+
+        return parse_tree(stream, tree, message, settings);
+    }
+
+    extern bool parse(
+        Stream         & stream,
+        tape::Document & result,
+        Message        & message,
+        Settings const & settings)
+    {
+        result.clear();
+
+        tape::Builder builder(result);
+        bool status = parse_events(stream, builder, message, settings);
+        if (!status)
+            result.clear();
         return status;
     }
 }}
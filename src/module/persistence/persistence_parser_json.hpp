@@ -0,0 +1,1158 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "persistence_private.hpp"
+#include "persistence_chars.hpp"
+#include "persistence_string.hpp"
+#include "persistence_number.hpp"
+#include "persistence_parser_helper.hpp"
+#include "persistence_parser.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  exception
+ ***************************************************************************/
+
+namespace exception
+{
+    using chars::Soss;
+    using chars::fmt;
+
+    template<typename InType>
+    inline static bool opt_error(
+        InType & in,
+        char const * option,
+        char const * status)
+    {
+        parser::raise_error(in,
+            ( Soss<char, 256>()
+                * "option `"
+                | fmt<96>(option)
+                | "` is `"
+                | fmt<32>(status)
+                | "`, but got `"
+                | fmt<16>(in.eof() ? "End Of File" : in.data())
+                | "`, at("
+                | fmt<32>(in.line())
+                | ", "
+                | fmt<32>(in.col())
+                | ')'
+            )
+        );
+        /* if not throw return false */
+        return false;
+    }
+
+    template<typename InType>
+    inline static bool expect(
+        InType & in,
+        char const * expected,
+        char const * hint)
+    {
+        parser::raise_error(in,
+            ( Soss<char, 256>()
+                * "expecting `"
+                | fmt<32>(expected)
+                | "` but got `"
+                | fmt<16>(in.eof() ? "End Of File" : in.data())
+                | "` ["
+                | fmt<96>(hint)
+                | "], at("
+                | fmt<32>(in.line())
+                | ", "
+                | fmt<32>(in.col())
+                | ')'
+            )
+        );
+        /* if not throw return false */
+        return false;
+    }
+
+    template<typename InType>
+    inline static bool warning(InType & in, char const * message)
+    {
+        if (in.get_settings().enable_warning_message == false)
+            return true;
+
+        parser::raise_warning(in,
+            ( Soss<char, 256>()
+                * fmt<128>(message)
+                | ", at ("
+                | fmt<32>(in.line())
+                | ", "
+                | fmt<32>(in.col())
+                | ')'
+            )
+        );
+        return true;
+    }
+}
+
+/****************************************************************************
+ *  JSON event handler
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * Handler
+     ***********************************************************************/
+
+    /* events that the parser pushes, in the order of the input:
+     *
+     *  object  map_beg ( map_key string map_val value )* map_end
+     *  array   seq_beg ( seq_val value )* seq_end
+     *  string  str_val | str_ref | str_beg ( on_str | on_chr )* str_end
+     *  number  on_int | on_dbl
+     *  keyword on_int | on_nil
+     *
+     * A handler is any class with these members, there is no virtual call.
+     * Derive from `Handler` and hide the ones you need, the others do
+     * nothing. `str_val` passes a whole string that has no escape, and
+     * `on_str` a run of unescaped chars of a string that comes in several
+     * pieces; both are valid only during the call. With `enable_insitu`
+     * and a writable view of stream, `str_ref` passes a string that is
+     * unescaped in place and ends with '\0', it lives as long as the view.
+     */
+    template<typename CharType> class Handler
+    {
+    public:
+        inline void map_beg() {}
+        inline void map_key() {}
+        inline void map_val() {}
+        inline void map_end() {}
+
+        inline void seq_beg() {}
+        inline void seq_val() {}
+        inline void seq_end() {}
+
+        inline void str_beg() {}
+        inline void str_end() {}
+        inline void str_val(CharType const *, size_t) {}
+        inline void str_ref(CharType       *, size_t) {}
+
+    public:
+        inline void on_nil() {}
+        inline void on_int(int64_t) {}
+        inline void on_dbl(double ) {}
+        inline void on_chr(CharType) {}
+        inline void on_str(CharType const *, size_t) {}
+    };
+}}
+
+/****************************************************************************
+ *  JSON Keyword
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    template<typename CharType> struct KeywordTable
+    {
+        typedef CharType CharType;
+        typedef const Keyword<CharType> value_type;
+
+        static value_type COLON;
+        static value_type COMMA;
+        static value_type ESCAPE;
+        static value_type HEX;
+        static value_type MINUS;
+        static value_type PLUS;
+        static value_type ZERO;
+        static value_type DOT;
+        static value_type EXP_U;
+        static value_type EXP_L;
+
+        static value_type STR_BEG;
+        static value_type STR_END;
+        static value_type SEQ_BEG;
+        static value_type SEQ_END;
+        static value_type MAP_BEG;
+        static value_type MAP_END;
+
+        static value_type VAL_FALSE;
+        static value_type VAL_TRUE;
+        static value_type VAL_NULL;
+
+        /* first of {C_COMMENT_1_BEG, C_COMMENT_2_BEG} */
+        static value_type   COMMENT_FIRST;
+        static value_type C_COMMENT_1_BEG;
+        static value_type C_COMMENT_1_END;
+        static value_type C_COMMENT_2_BEG;
+        static value_type C_COMMENT_2_END;
+    };
+
+    /* defined in persistence_parser_json.cpp */
+#ifdef DECLARE_KEYWORD
+#error "conflicts!"
+#else
+#define DECLARE_KEYWORD(type, name) \
+    template<> const Keyword<type> KeywordTable<type>::name
+
+    DECLARE_KEYWORD(char, COLON);
+    DECLARE_KEYWORD(char, COMMA);
+    DECLARE_KEYWORD(char, ESCAPE);
+    DECLARE_KEYWORD(char, HEX);
+    DECLARE_KEYWORD(char, MINUS);
+    DECLARE_KEYWORD(char, PLUS);
+    DECLARE_KEYWORD(char, ZERO);
+    DECLARE_KEYWORD(char, DOT);
+    DECLARE_KEYWORD(char, EXP_U);
+    DECLARE_KEYWORD(char, EXP_L);
+    DECLARE_KEYWORD(char, STR_BEG);
+    DECLARE_KEYWORD(char, STR_END);
+    DECLARE_KEYWORD(char, SEQ_BEG);
+    DECLARE_KEYWORD(char, SEQ_END);
+    DECLARE_KEYWORD(char, MAP_BEG);
+    DECLARE_KEYWORD(char, MAP_END);
+    DECLARE_KEYWORD(char, VAL_FALSE);
+    DECLARE_KEYWORD(char, VAL_TRUE);
+    DECLARE_KEYWORD(char, VAL_NULL);
+    DECLARE_KEYWORD(char, COMMENT_FIRST);
+    DECLARE_KEYWORD(char, C_COMMENT_1_BEG);
+    DECLARE_KEYWORD(char, C_COMMENT_1_END);
+    DECLARE_KEYWORD(char, C_COMMENT_2_BEG);
+    DECLARE_KEYWORD(char, C_COMMENT_2_END);
+
+#undef DECLARE_KEYWORD
+#endif
+}}
+
+/****************************************************************************
+ *  JSON parser
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * helper
+     ***********************************************************************/
+
+    template<typename CharType> inline CharType chr_to_esc(CharType);
+
+    template<> inline char chr_to_esc(char ch)
+    {
+        switch (ch)
+        {
+        case '\\':
+        case '\'':
+        case '"' : return ch;
+        case 'n' : return '\n';
+        case 'r' : return '\r';
+        case 't' : return '\t';
+        case 'b' : return '\b';
+        case 'f' : return '\f';
+        default  : return '\0';
+        }
+    }
+}}
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * Declaration
+     ***********************************************************************/
+
+    /* references:
+     * 0. http://json.org/
+     * 1. https://tools.ietf.org/html/rfc7159
+     * 2. ECMA-404.pdf
+     */
+
+    /*
+     *  object
+     *      {}
+     *      { members }
+     *  members
+     *      pair
+     *      pair , members
+     *  pair
+     *      string : value
+     */
+    template<typename InType> inline bool parse_object(InType & in);
+
+    /*
+     *  array
+     *      []
+     *      [ elements ]
+     *  elements
+     *      value
+     *      value , elements
+     */
+    template<typename InType> inline bool parse_array(InType & in);
+
+    /*
+     *  elements
+     *      value
+     *      value , elements
+     *  (until the end of input, as a part of an array)
+     */
+    template<typename InType> inline bool parse_elements(InType & in);
+
+    /*
+     *  line
+     *      value '\n'
+     *      value (end of input)
+     *  (a record of JSON lines, spaces before it are already skipped)
+     */
+    template<typename InType> inline bool parse_line(InType & in);
+
+    /*
+     *  lines
+     *      line
+     *      line lines
+     *  (until the end of input, as a sequence of records)
+     */
+    template<typename InType> inline bool parse_lines(InType & in);
+
+    /*
+     *  value
+     *      string
+     *      number
+     *      object
+     *      array
+     *      keyword
+     */
+    template<typename InType> inline bool parse_value(InType & in);
+
+    /*
+     *  keyword
+     *      true
+     *      false
+     *      null
+     */
+    template<typename InType> inline bool parse_keyword(InType & in);
+
+    /*
+     *  string
+     *      ""
+     *      " chars "
+     *  chars
+     *      char
+     *      char chars
+     *  char
+     *      any-Unicode-character-except-"-or-\-or-control-character
+     *      \"
+     *      \\
+     *      \/
+     *      \b
+     *      \f
+     *      \n
+     *      \r
+     *      \t
+     *      \u four-hex-digits
+     */
+    template<typename InType> inline bool parse_string(InType & in);
+
+    /* the same as above, but unescaped in place, see `Handler::str_ref` */
+    template<typename InType> inline bool parse_string_insitu(InType & in);
+
+    /*
+     *  number
+     *      int
+     *      int frac
+     *      int exp
+     *      int frac exp
+     *  int
+     *      digit
+     *      digit1-9 digits
+     *      - digit
+     *      - digit1-9 digits
+     *  frac
+     *      . digits
+     *  exp
+     *      e digits
+     *  digits
+     *      digit
+     *      digit digits
+     *  e
+     *      e
+     *      e+
+     *      e-
+     *      E
+     *      E+
+     *      E-
+     */
+    template<typename InType> inline bool parse_number(InType & in);
+
+    /*
+     *  (any value, skipped without events by counting brackets and quotes,
+     *   so it is not checked except that they are balanced)
+     */
+    template<typename InType> inline bool skip_value(InType & in);
+
+    /*
+     *  (a string, skipped as above)
+     */
+    template<typename InType> inline bool skip_string(InType & in);
+
+    /*
+     *  cpp style comments
+     *      / / any-character-except-newline-or-eof (newline | eof)
+     *      / * any-character-except-*-and-/ * /
+     */
+    template<typename InType> inline bool skip_comments(InType & in);
+
+    /************************************************************************
+     * Implementation
+     ***********************************************************************/
+
+    /* note: each function must do `skip(chars::isspace)` at the end */
+
+    template<typename InType> inline bool parse_object(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        /* { */
+        if (! match(in, kwd::MAP_BEG))
+            return exception::expect(in, kwd::MAP_BEG, "JSON object");
+
+        if (! skip_comments(in.skip_space()))
+            return false;
+
+        typename InType::reference builder = in.get();
+        builder.map_beg();
+
+        /* { } */
+        if (match(in, kwd::MAP_END)) {
+            builder.map_end();
+            return skip_comments(in.skip_space());
+        }
+
+        bool is_continue = false;
+        do { /* { members } */
+
+            builder.map_key();
+            if (! parse_string(in))
+                return false;
+
+            if (! skip_comments(in))
+                return false;
+
+            if (! match(in, kwd::COLON))
+                return exception::expect(in, kwd::COLON, "JSON pair");
+
+            if (! skip_comments(in.skip_space()))
+                return false;
+
+            builder.map_val();
+            if (! parse_value(in))
+                return false;
+
+            if (     match(in, kwd::COMMA))
+                is_continue = true;
+            else if (match(in, kwd::MAP_END))
+                is_continue = false;
+            else
+                return exception::expect(in, ",` or `}", "JSON object");
+
+            if (! skip_comments(in.skip_space()))
+                return false;
+        } while(is_continue);
+
+        builder.map_end();
+        return true;
+    }
+
+    template<typename InType> inline bool parse_array(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        /* [ */
+        if (! match(in, kwd::SEQ_BEG))
+            return exception::expect(in, kwd::SEQ_BEG, "JSON array");
+
+        if (! skip_comments(in.skip_space()))
+            return false;
+
+        typename InType::reference builder = in.get();
+        builder.seq_beg();
+
+        /* [ ] */
+        if (match(in, kwd::SEQ_END)) {
+            builder.seq_end();
+            return skip_comments(in.skip_space());
+        }
+
+        /* [ elements ] */
+        bool is_continue = false;
+        do {
+            builder.seq_val();
+            if (! parse_value(in))
+                return false;
+
+            if (! skip_comments(in))
+                return false;
+
+            if (     match(in, kwd::COMMA))
+                is_continue = true;
+            else if (match(in, kwd::SEQ_END))
+                is_continue = false;
+            else
+                return exception::expect(in, ",` or `]", "JSON array");
+
+            if (! skip_comments(in.skip_space()))
+                return false;
+        } while(is_continue);
+
+        builder.seq_end();
+        return true;
+    }
+
+    template<typename InType> inline bool parse_elements(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        if (! skip_comments(in.skip_space()))
+            return false;
+
+        typename InType::reference builder = in.get();
+        builder.seq_beg();
+
+        bool is_continue = false;
+        do {
+            builder.seq_val();
+            if (! parse_value(in))
+                return false;
+
+            if (in.empty())
+                is_continue = false;
+            else if (match(in, kwd::COMMA))
+                is_continue = true;
+            else
+                return exception::expect(in, kwd::COMMA, "JSON array");
+
+            if (! skip_comments(in.skip_space()))
+                return false;
+        } while(is_continue);
+
+        builder.seq_end();
+        return true;
+    }
+
+    template<typename InType> inline bool parse_line(InType & in)
+    {
+        uint64_t line = in.line();
+        if (! parse_value(in))
+            return false;
+
+        /* the next record must start on another line */
+        if (! in.empty() && in.line() == line)
+            return exception::expect(in, "new line", "JSON lines");
+
+        return true;
+    }
+
+    template<typename InType> inline bool parse_lines(InType & in)
+    {
+        if (! skip_comments(in.skip_space()))
+            return false;
+
+        typename InType::reference builder = in.get();
+        builder.seq_beg();
+
+        while (! in.empty()) {
+            builder.seq_val();
+            if (! parse_line(in))
+                return false;
+        }
+
+        builder.seq_end();
+        return true;
+    }
+
+    template<typename InType> inline bool parse_value(InType & in)
+    {
+        typedef typename InType::CharType   CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        bool (* func)(InType &) = NULL;
+        CharType ch = in.ch();
+        if (       ch == kwd::STR_BEG) {
+            func = parse_string;
+        } else if (ch == kwd::MAP_BEG) {
+            func = parse_object;
+        } else if (ch == kwd::SEQ_BEG) {
+            func = parse_array;
+        } else if (chars::isdigit(ch) || ch == kwd::MINUS) {
+            func = parse_number;
+        } else if (chars::isalpha(ch)) {
+            func = parse_keyword;
+        } else {
+            return exception::expect(in, "value", "JSON value");
+        }
+
+        if (! func(in))
+            return false;
+
+        return skip_comments(in.skip_space());
+    }
+
+    template<typename InType> inline bool parse_keyword(InType & in)
+    {
+        typedef typename InType::CharType   CharType;
+        typedef KeywordTable<CharType> kwd;
+        using namespace ast;
+
+        typename kwd::value_type const * keyword = NULL;
+        CharType                                ch = in.ch();
+        typename InType::reference        builder = in.get();
+
+        if (     ch == kwd::VAL_TRUE)
+            keyword =& kwd::VAL_TRUE;
+        else if (ch == kwd::VAL_FALSE)
+            keyword =& kwd::VAL_FALSE;
+        else if (ch == kwd::VAL_NULL)
+            keyword =& kwd::VAL_NULL;
+
+        if (keyword != NULL && match(in, *keyword))
+        {
+            if (       ch == kwd::VAL_TRUE) {
+                exception::warning(in, "JSON value 'true' is not supported"
+                                       " and will be treated as int 1");
+                builder.on_int(int64_t(1));
+            } else if (ch == kwd::VAL_FALSE) {
+                exception::warning(in, "JSON value 'false' is not supported"
+                                       " and will be treated as int 0");
+                builder.on_int(int64_t(0));
+            } else if (ch == kwd::VAL_NULL) {
+                builder.on_nil();
+            } else {
+                keyword = NULL;
+            }
+            in.skip_space();
+        }
+
+        if (keyword == NULL)
+            return exception::expect(in, "KEYWORD", "JSON value");
+
+        return true;
+    }
+
+    template<typename InType> inline bool parse_string(InType & in)
+    {
+        typedef typename InType::CharType   CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        /* " */
+        if (! match(in, kwd::STR_BEG))
+            return exception::expect(in, kwd::STR_BEG, "JSON string");
+
+        if (in.get_settings().enable_insitu && in.insitu() != NULL)
+            return parse_string_insitu(in);
+
+        typename InType::reference builder = in.get();
+
+        /* the run of unescaped chars in buffer */
+        CharType const * beg = in.data();
+        CharType const * end = in.get_scanner().find_special
+            (beg, beg + in.size());
+
+        /* " chars ", without escape and all in buffer */
+        if (end != beg + in.size() && *end == kwd::STR_END) {
+            builder.str_val(beg, static_cast<size_t>(end - beg));
+            in.skip_plain(static_cast<size_t>(end - beg));
+            in.skip();
+            in.skip_space();
+            return true;
+        }
+
+        builder.str_beg();
+
+        /* [ chars ] */
+        for (;;) {
+            /* jump over the run of unescaped chars */
+            if (end != beg)
+                builder.on_str(beg, static_cast<size_t>(end - beg));
+            in.skip_plain(static_cast<size_t>(end - beg));
+
+            if (in.empty() && ! in.reload())
+                return exception::expect(in, kwd::STR_END, "JSON string");
+
+            if (in.ch() == kwd::ESCAPE) { /* escape */
+                in.skip();
+                CharType ch = chr_to_esc(in.ch());
+                if (ch != '\0') {
+                    builder.on_chr(ch);
+                } else if (in.ch() == kwd::HEX) {
+                    exception::warning(in, "`\\uXXXX` is not implemented and"
+                                           " will be preserved");
+                    builder.on_chr(kwd::ESCAPE);
+                    builder.on_chr(kwd::HEX);
+                    for (size_t i = 0U; i < 4U; i++) {
+                        ch = in.skip().ch();
+                        if (chars::ishexdigit(ch)) {
+                            builder.on_chr(ch);
+                        } else {
+                            return exception::expect
+                            (in, "DIGIT(HEX)", "\\uXXXX");
+                        }
+                    }
+                } else {
+                    return exception::expect
+                    (in, "ESCAPED CHARACTER", "JSON char");
+                }
+            } else if (in.ch() == kwd::STR_END) {
+                in.skip();
+                break;
+            } else { /* unescaped */
+                CharType ch = in.ch();
+                if (chars::iscntrl(ch))
+                    return exception::expect(in, "CHAR", "JSON char");
+                builder.on_chr(ch);
+            }
+
+            in.skip();
+            beg = in.data();
+            end = in.get_scanner().find_special(beg, beg + in.size());
+        }
+
+        builder.str_end();
+
+        in.skip_space();
+        return true;
+    }
+
+    template<typename InType> inline bool parse_string_insitu(InType & in)
+    {
+        typedef typename InType::CharType   CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        /* escapes never grow, so `dst` is always behind `in` */
+        CharType * const str = in.insitu();
+        CharType *       dst = str;
+        for (;;) {
+            /* move the run of unescaped chars */
+            CharType const * beg = in.data();
+            CharType const * end = in.get_scanner().find_special
+                (beg, beg + in.size());
+            size_t len = static_cast<size_t>(end - beg);
+            if (dst != beg)
+                ::memmove(dst, beg, len * sizeof(CharType));
+            dst += len;
+            in.skip_plain(len);
+
+            if (in.eof())
+                return exception::expect(in, kwd::STR_END, "JSON string");
+
+            if (in.ch() == kwd::ESCAPE) { /* escape */
+                in.skip();
+                CharType ch = chr_to_esc(in.ch());
+                if (ch != '\0') {
+                    *dst++ = ch;
+                } else if (in.ch() == kwd::HEX) {
+                    exception::warning(in, "`\\uXXXX` is not implemented and"
+                                           " will be preserved");
+                    *dst++ = kwd::ESCAPE;
+                    *dst++ = kwd::HEX;
+                    for (size_t i = 0U; i < 4U; i++) {
+                        ch = in.skip().ch();
+                        if (chars::ishexdigit(ch)) {
+                            *dst++ = ch;
+                        } else {
+                            return exception::expect
+                            (in, "DIGIT(HEX)", "\\uXXXX");
+                        }
+                    }
+                } else {
+                    return exception::expect
+                    (in, "ESCAPED CHARACTER", "JSON char");
+                }
+            } else if (in.ch() == kwd::STR_END) {
+                in.skip();
+                break;
+            } else { /* unescaped */
+                CharType ch = in.ch();
+                if (chars::iscntrl(ch))
+                    return exception::expect(in, "CHAR", "JSON char");
+                *dst++ = ch;
+            }
+
+            in.skip();
+        }
+
+        *dst = CharType();
+        in.get().str_ref(str, static_cast<size_t>(dst - str));
+
+        in.skip_space();
+        return true;
+    }
+
+    /* [0-9]*, significant digits are accumulated into `dec` */
+    template<typename InType> inline size_t parse_digits
+    (
+        InType & in, number::Decimal & dec, size_t & significant,
+        char * more, bool is_fraction
+    )
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        static const size_t W_DIGITS = 19U; /* fit in `uint64_t` */
+
+        size_t length = 0;
+        for (;;) {
+            /* scan the run of digits in buffer, then jump over it */
+            CharType const * beg = in.data();
+            CharType const * end = beg + in.size();
+            CharType const * cur = beg;
+            while (cur != end) {
+                /* 8 digits at a time, while `w` has room for them */
+                if (sizeof(CharType) == 1U
+                    && significant != 0 && significant + 8U <= W_DIGITS
+                    && end - cur >= 8) {
+                    char const * str = reinterpret_cast<char const *>(cur);
+                    if (number::is_eight_digits(str)) {
+                        dec.w = dec.w * uint64_t(100000000U)
+                              + number::parse_eight_digits(str);
+                        significant += 8U;
+                        if (is_fraction)
+                            dec.exp -= 8;
+                        cur += 8;
+                        continue;
+                    }
+                }
+
+                uint32_t digit = static_cast<uint32_t>(*cur - kwd::ZERO);
+                if (digit > 9U)
+                    break;
+
+                if (significant == 0 && digit == 0) {   /* leading zero */
+                    if (is_fraction)
+                        dec.exp--;
+                } else if (significant < W_DIGITS) {
+                    dec.w = dec.w * uint64_t(10) + digit;
+                    significant++;
+                    if (is_fraction)
+                        dec.exp--;
+                } else {                                 /* keep the rest */
+                    dec.truncated = true;
+                    if (dec.count < number::MAX_DIGITS)
+                        more[dec.count++] = static_cast<char>(*cur);
+                    else
+                        dec.sticky = dec.sticky || digit != 0;
+                    if (is_fraction == false)
+                        dec.exp++;
+                }
+                ++cur;
+            }
+
+            size_t n = static_cast<size_t>(cur - beg);
+            length += n;
+            in.skip_plain(n);
+            if (cur != end || n == 0)
+                break;
+        }
+        return length;
+    }
+
+    template<typename InType> inline bool parse_number(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+        using namespace ast;
+
+        typename InType::reference builder = in.get();
+
+        number::Decimal dec = number::Decimal();
+        char   more[number::MAX_DIGITS];
+        size_t significant = 0;
+        dec.more = more;
+
+        size_t    integral_length = 0;
+        size_t  fractional_length = 0;
+        int      exponential = 0, exponential_length = 0;
+
+        /* - */
+        if (in.ch() == kwd::MINUS) {
+            dec.negative = true;
+            in.skip();
+        }
+
+        /* 0 or [1-9]* */
+        if (in.ch() == kwd::ZERO) {
+            in.skip();
+            integral_length ++;
+        } else if (chars::isdigit(in.ch())) {
+            integral_length = parse_digits(in, dec, significant, more, false);
+        } else {
+            return exception::expect(in, "DIGIT", "JSON number");
+        }
+
+        /* .[0-9]* */
+        if (in.ch() == kwd::DOT) {
+            in.skip();
+            fractional_length = parse_digits(in, dec, significant, more, true);
+        }
+
+        /* e[+-][0-9]* */
+        if (in.ch() == kwd::EXP_U || in.ch() == kwd::EXP_L) {
+            static const int EXPONENT_LIMIT = 100000;
+
+            bool is_exponential_negtive = false;
+            in.skip();
+            if (in.ch() == kwd::MINUS || in.ch() == kwd::PLUS  ) {
+                is_exponential_negtive = (in.ch() == kwd::MINUS);
+                in.skip();
+            }
+            while (chars::isdigit(in.ch())) {
+                if (exponential < EXPONENT_LIMIT) {
+                    exponential *= 10;
+                    exponential += static_cast<int>(in.ch() - kwd::ZERO);
+                }
+                exponential_length ++;
+                in.skip();
+            }
+            if (is_exponential_negtive)
+                exponential = -exponential;
+            if (exponential_length == 0)
+                return exception::expect(in, "DIGIT", "JSON number");
+        }
+
+        /* get value */
+        if (fractional_length > 0 || exponential_length > 0) {    /* real */
+            static const int EXPONENT_MAX_LENGTH = static_cast<int>
+                (::log10(std::numeric_limits<double>::max_exponent10)) + 1;
+
+            if (fractional_length + integral_length >=
+                std::numeric_limits<double>::digits10 + 5) {
+                exception::warning(in, "`double` precision may be lost");
+            }
+            if (exponential_length > EXPONENT_MAX_LENGTH ||
+                exponential <= std::numeric_limits<double>::min_exponent10 ||
+                exponential >= std::numeric_limits<double>::max_exponent10) {
+                exception::warning(in, "too big for `double` type");
+            }
+
+            dec.exp += exponential;
+            builder.on_dbl(number::to_double(dec));
+
+        } else {    /* integer */
+            static const int64_t MAX = std::numeric_limits<int64_t>::max();
+            static const int64_t MIN = std::numeric_limits<int64_t>::min();
+
+            uint64_t integral = dec.w;
+            if (integral_length > std::numeric_limits<uint64_t>::digits10) {
+                exception::warning(in, "too big for `uint64`");
+                if (dec.negative)
+                    builder.on_int(MIN);
+                else
+                    builder.on_int(MAX);
+            } else if (integral & uint64_t(0x8000000000000000)) {
+                if (dec.negative)
+                    builder.on_int(MIN);
+                else
+                    builder.on_int(MAX);
+            } else {
+                if (dec.negative)
+                    builder.on_int(-static_cast<int64_t>(integral));
+                else
+                    builder.on_int(static_cast<int64_t>(integral));
+            }
+        }
+
+        in.skip_space();
+        return true;
+    }
+
+    template<typename InType> inline bool skip_value(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        CharType ch = in.ch();
+        if (ch == kwd::STR_BEG) {
+            if (! skip_string(in))
+                return false;
+            return skip_comments(in.skip_space());
+        }
+
+        /* number or keyword */
+        if (ch != kwd::MAP_BEG && ch != kwd::SEQ_BEG) {
+            if (! chars::isalnum(ch) && ch != kwd::MINUS)
+                return exception::expect(in, "value", "JSON value");
+            while (! in.eof() && (chars::isalnum(in.ch()) ||
+                in.ch() == kwd::MINUS || in.ch() == kwd::PLUS ||
+                in.ch() == kwd::DOT))
+                in.skip();
+            return skip_comments(in.skip_space());
+        }
+
+        /* object or array, classified block by block as `scan_array` does,
+         * and a comment out of strings is left to `skip_comments`. Only
+         * whole blocks are taken until the end, so `carry` goes on. */
+        simd::Scanner const & scanner = in.get_scanner();
+        simd::Carry           carry   = { 0U, 0U };
+        simd::Masks           masks;
+
+        size_t const width   = scanner.width;
+        bool   const comment = in.get_settings().enable_json_comment;
+        size_t       level   = 0;
+        char         tail[64];
+
+        for (;;) {
+            if (in.size() < width)
+                in.reload();
+            if (in.empty() && ! in.reload())
+                return exception::expect(in, ",` or `]` or `}", "JSON value");
+
+            CharType const * beg = in.data();
+            CharType const * end = beg + (in.size() < width
+                                 ? in.size()
+                                 : in.size() - in.size() % width);
+            CharType const * stop = NULL;
+
+            for (CharType const * blk = beg; blk < end && stop == NULL;
+                 blk += width) {
+                size_t       len = static_cast<size_t>(end - blk);
+                char const * src = blk;
+                if (len < width) {
+                    std::memset(tail, ' ', sizeof(tail));
+                    std::memcpy(tail, blk, len);
+                    src = tail;
+                } else {
+                    len = width;
+                }
+                scanner.classify(src, masks);
+                uint32_t inside = simd::in_string(masks, width, carry);
+                uint32_t bits   = masks.structural & ~inside;
+
+                /* a slash out of strings stops the block */
+                for (CharType const * slash = blk; comment; ++slash) {
+                    slash = std::find(slash, blk + len,
+                        static_cast<CharType>(kwd::COMMENT_FIRST));
+                    if (slash == blk + len)
+                        break;
+                    uint32_t at = static_cast<uint32_t>(slash - blk);
+                    if (((inside >> at) & 1U) == 0) {
+                        bits &= (1U << at) - 1U;
+                        stop  = slash;
+                        break;
+                    }
+                }
+
+                for (; bits != 0; bits &= bits - 1U) {
+                    CharType const * pos = blk + simd::lowest_bit(bits);
+                    if (*pos == kwd::MAP_BEG || *pos == kwd::SEQ_BEG) {
+                        ++level;
+                    } else if (*pos == kwd::MAP_END || *pos == kwd::SEQ_END) {
+                        if (--level == 0) {
+                            in.skip_text(static_cast<size_t>(pos + 1 - beg));
+                            return skip_comments(in.skip_space());
+                        }
+                    }
+                }
+            }
+
+            if (stop == NULL) {
+                in.skip_text(static_cast<size_t>(end - beg));
+                continue;
+            }
+
+            in.skip_text(static_cast<size_t>(stop - beg));
+            uint64_t pos = in.pos();
+            if (! skip_comments(in))
+                return false;
+            if (pos == in.pos())
+                return exception::expect(in, "comment", "JSON value");
+            carry.escaped = 0U;
+            carry.inside  = 0U;
+        }
+    }
+
+    template<typename InType> inline bool skip_string(InType & in)
+    {
+        typedef typename InType::CharType CharType;
+        typedef KeywordTable<CharType> kwd;
+
+        /* " */
+        if (! match(in, kwd::STR_BEG))
+            return exception::expect(in, kwd::STR_BEG, "JSON string");
+
+        for (;;) {
+            CharType const * beg = in.data();
+            CharType const * end = in.get_scanner().find_special
+                (beg, beg + in.size());
+            in.skip_plain(static_cast<size_t>(end - beg));
+
+            if (in.empty() && ! in.reload())
+                return exception::expect(in, kwd::STR_END, "JSON string");
+
+            CharType ch = in.ch();
+            in.skip();
+            if (ch == kwd::STR_END)
+                return true;
+            if (ch == kwd::ESCAPE)
+                in.skip();
+        }
+    }
+
+    /* actually (comment*) */
+    template<typename InType> bool skip_comments(InType & in)
+    {
+        typedef KeywordTable<typename InType::CharType> kwd;
+        if (in.ch() != kwd::COMMENT_FIRST)
+            return true;
+
+        if (in.get_settings().enable_json_comment == false)
+            return exception::opt_error(in, "ENABLE_JSON_COMMENT", "FALSE");
+
+        uint64_t pos = 0;
+        while (pos != in.pos()) {
+            pos = in.pos();
+
+            /* try skip '/ * ... * /' */
+            if (!skip_block(in, kwd::C_COMMENT_1_BEG, kwd::C_COMMENT_1_END))
+                return exception::expect(in,kwd::C_COMMENT_1_END, "Comment");
+
+            /* try skip '/ / ...' */
+            skip_block(in, kwd::C_COMMENT_2_BEG, kwd::C_COMMENT_2_END);
+
+            /* try skip 'SPACE' */
+            in.skip_space();
+        }
+        return true;
+    }
+}}
+
+/****************************************************************************
+ *  [extern]parse_events
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /* push events of a JSON value in `stream` to `handler`,
+     * see `Handler` above */
+    template<typename HandlerType> inline bool parse_events(
+        Stream         & stream,
+        HandlerType    & handler,
+        Message        & message,
+        Settings const & settings = Settings())
+    {
+        typedef StreamHelper<Stream, HandlerType> In;
+
+        In in(stream, settings, handler);
+
+        bool status = false;
+        try {
+            status = parse_value(in);
+        } catch (exception::ParseError const & e) {
+            message.push_back(e.what(), chars::strlen(e.what()));
+        }
+        return status;
+    }
+}}
+
+CV_FS_PRIVATE_END
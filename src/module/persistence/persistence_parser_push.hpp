@@ -0,0 +1,705 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include <cstring>
+
+#include "persistence_private.hpp"
+#include "persistence_chars.hpp"
+#include "persistence_string.hpp"
+#include "persistence_io.hpp"
+#include "persistence_parser_json.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  Declaration
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    /************************************************************************
+     * PushParser
+     ***********************************************************************/
+
+    /* a resumable parser for input that comes in pieces. Its state lives in
+     * an explicit stack rather than the C stack, so `feed` takes a slice of
+     * any size and returns once it is consumed. Events are the same as the
+     * ones of `parse_events`, except `str_ref`, as slices are not kept.
+     * Spaces and comments before the value are skipped, chars after it are
+     * ignored.
+     *
+     *  Builder<char, ast::ArenaPool> builder(tree);
+     *  PushParser<Builder<char, ast::ArenaPool> > push(builder);
+     *  while (...) push.feed(data, size);
+     *  push.finish();
+     */
+    template<typename HandlerType> class PushParser
+    {
+    public:
+        typedef char         CharType;
+        typedef HandlerType  Handler;
+
+    public:
+        PushParser(Handler & handler, Settings const & settings = Settings());
+
+    public:
+        /* consume a slice, false if there is an error, see `message` */
+        bool feed(CharType const * data, size_t size);
+
+        /* end of input, false if the value is incomplete */
+        bool finish();
+
+        /* parse another value with the same handler */
+        void reset();
+
+        /* true if a whole value is parsed */
+        bool done() const;
+
+        Message const & message() const;
+
+    public: /* for `exception::expect` and `exception::warning` */
+        uint64_t line() const;
+        uint64_t col () const;
+        bool     eof () const;
+        CharType const * data() const;
+
+        size_t             count_warning();
+        Settings const & get_settings() const;
+
+    private:
+        enum State
+        {
+            VALUE,        /* value                          */
+            VALUE_OR_END, /* value or `]`, after `[`        */
+            KEY_OR_END,   /* `"` or `}`, after `{`          */
+            KEY,          /* `"`, after `,` of an object    */
+            COLON,        /* `:`, after a key               */
+            NEXT,         /* `,`, `]` or `}`, after a value */
+            STRING,       /* chars of a string              */
+            ESCAPE,       /* a char after `\`               */
+            HEX,          /* 4 hex digits after `\u`        */
+            SCALAR,       /* a number or keyword            */
+            COMMENT,      /* `*` or `/` after `/`           */
+            BLOCK,        /* chars in a comment `/ * * /`   */
+            BLOCK_STAR,   /* `/` after `*` in a comment     */
+            LINE,         /* chars in a comment `/ /`       */
+            DONE,         /* after the root value           */
+            FAILED
+        };
+
+        enum { SNIPPET_SIZE = 16 };
+
+        typedef chars::Buffer<CharType, 128, std::allocator> Stack;
+        typedef chars::Buffer<CharType,  64, std::allocator> Token;
+
+    private:
+        void step();
+        void advance(CharType const * pos);
+
+        void structural();
+        void value     (CharType ch);
+        void close     ();
+        void after_value();
+
+        void string_begin();
+        void string_end();
+        void string();
+        void escape();
+        void hex();
+
+        void scalar();
+        void scalar_end(CharType * beg, CharType * end);
+
+        void comment();
+
+    private:
+        PushParser            (PushParser const &);
+        PushParser & operator=(PushParser const &);
+
+    private:
+        Handler                  & handler_;
+        Settings                   settings_;
+        simd::Scanner const      & scanner_;
+
+        State                      state_;
+        State                      resume_;  /* state after a comment  */
+        Stack                      stack_;   /* `{` or `[` of each one */
+        Token                      token_;   /* a scalar across slices */
+        bool                       is_key_;
+        size_t                     hex_;
+
+        CharType const           * cur_;
+        CharType const           * end_;
+        uint64_t                   line_;
+        uint64_t                   col_;
+        uint64_t                   token_line_;
+        uint64_t                   token_col_;
+        size_t                     warnings_;
+
+        Message                    message_;
+        mutable CharType           snippet_[SNIPPET_SIZE];
+    };
+}}
+
+/****************************************************************************
+ *  Implementation
+ ***************************************************************************/
+
+namespace parser { namespace json
+{
+    template<typename HandlerType>
+    inline PushParser<HandlerType>::
+        PushParser(Handler & handler, Settings const & settings)
+        : handler_(handler)
+        , settings_(settings)
+        , scanner_(simd::scanner())
+        , state_(VALUE)
+        , resume_(VALUE)
+        , stack_()
+        , token_()
+        , is_key_(false)
+        , hex_(0U)
+        , cur_(NULL)
+        , end_(NULL)
+        , line_(1U)
+        , col_(1U)
+        , token_line_(1U)
+        , token_col_(1U)
+        , warnings_(0U)
+        , message_()
+    {
+        /* slices are not kept, strings can never refer to them */
+        settings_.enable_insitu = false;
+    }
+
+    template<typename HandlerType>
+    inline bool PushParser<HandlerType>::
+        feed(CharType const * data, size_t size)
+    {
+        if (state_ == FAILED)
+            return false;
+
+        cur_ = data;
+        end_ = data + size;
+        try {
+            while (cur_ != end_) {
+                switch (state_)
+                {
+                case STRING:     { string();     break; }
+                case ESCAPE:     { escape();     break; }
+                case HEX:        { hex();        break; }
+                case SCALAR:     { scalar();     break; }
+                case COMMENT:
+                case BLOCK:
+                case BLOCK_STAR:
+                case LINE:       { comment();    break; }
+                case DONE:       { cur_ = end_;  break; }
+                default:         { structural(); break; }
+                }
+            }
+        } catch (exception::ParseError const & e) {
+            message_.push_back(e.what(), chars::strlen(e.what()));
+            state_ = FAILED;
+        }
+
+        cur_ = NULL;
+        end_ = NULL;
+        return state_ != FAILED;
+    }
+
+    template<typename HandlerType>
+    inline bool PushParser<HandlerType>::
+        finish()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        if (state_ == FAILED)
+            return false;
+
+        try {
+            if (state_ == SCALAR) {
+                token_.push_back(CharType('\0'));
+                scalar_end(token_.begin(), token_.end() - 1);
+            }
+
+            if (state_ == LINE)
+                state_ = resume_;
+
+            if (state_ == COMMENT || state_ == BLOCK || state_ == BLOCK_STAR)
+                exception::expect(*this, kwd::C_COMMENT_1_END, "Comment");
+            else if (state_ == STRING || state_ == ESCAPE || state_ == HEX)
+                exception::expect(*this, kwd::STR_END, "JSON string");
+            else if (state_ != DONE)
+                exception::expect(*this, "value", "JSON value");
+        } catch (exception::ParseError const & e) {
+            message_.push_back(e.what(), chars::strlen(e.what()));
+            state_ = FAILED;
+        }
+        return state_ != FAILED;
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        reset()
+    {
+        state_    = VALUE;
+        resume_   = VALUE;
+        is_key_   = false;
+        hex_      = 0U;
+        line_     = 1U;
+        col_      = 1U;
+        warnings_ = 0U;
+        stack_  .clear();
+        token_  .clear();
+        message_.clear();
+    }
+
+    template<typename HandlerType>
+    inline bool PushParser<HandlerType>::
+        done() const
+    {
+        return state_ == DONE;
+    }
+
+    template<typename HandlerType>
+    inline Message const & PushParser<HandlerType>::
+        message() const
+    {
+        return message_;
+    }
+
+    template<typename HandlerType>
+    inline uint64_t PushParser<HandlerType>::
+        line() const
+    {
+        return line_;
+    }
+
+    template<typename HandlerType>
+    inline uint64_t PushParser<HandlerType>::
+        col() const
+    {
+        return col_;
+    }
+
+    template<typename HandlerType>
+    inline bool PushParser<HandlerType>::
+        eof() const
+    {
+        return cur_ == end_;
+    }
+
+    template<typename HandlerType>
+    inline typename PushParser<HandlerType>::CharType const *
+        PushParser<HandlerType>::
+        data() const
+    {
+        /* a slice is not terminated by '\0', copy a few chars of it */
+        size_t size = static_cast<size_t>(end_ - cur_);
+        if (size > SNIPPET_SIZE - 1U)
+            size = SNIPPET_SIZE - 1U;
+        for (size_t i = 0; i < size; ++i)
+            snippet_[i] = cur_[i];
+        snippet_[size] = CharType('\0');
+        return snippet_;
+    }
+
+    template<typename HandlerType>
+    inline size_t PushParser<HandlerType>::
+        count_warning()
+    {
+        return ++warnings_;
+    }
+
+    template<typename HandlerType>
+    inline Settings const & PushParser<HandlerType>::
+        get_settings() const
+    {
+        return settings_;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        step()
+    {
+        ++cur_;
+        ++col_;
+    }
+
+    /* chars in [cur_, pos) may contain line breaks */
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        advance(CharType const * pos)
+    {
+        static const CharType LF  = CharType(0xa); /* \n */
+        static const CharType TAB = CharType(0x9); /* \t */
+
+        for (; cur_ != pos; ++cur_) {
+            if (*cur_ == LF) {
+                line_ += 1U;
+                col_   = 1U;
+            } else if (*cur_ == TAB) {
+                col_  += settings_.indent_width;
+            } else {
+                col_  += 1U;
+            }
+        }
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        structural()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        advance(scanner_.find_nonspace(cur_, end_));
+        if (cur_ == end_)
+            return;
+
+        CharType ch = *cur_;
+        if (chars::isspace(ch)) {
+            advance(cur_ + 1);
+            return;
+        }
+
+        if (ch == kwd::COMMENT_FIRST) {
+            if (settings_.enable_json_comment == false)
+                exception::opt_error(*this, "ENABLE_JSON_COMMENT", "FALSE");
+            resume_ = state_;
+            state_  = COMMENT;
+            step();
+            return;
+        }
+
+        switch (state_)
+        {
+        case VALUE_OR_END:
+            if (ch == kwd::SEQ_END) {
+                close();
+                break;
+            }
+            handler_.seq_val();
+            value(ch);
+            break;
+
+        case VALUE:
+            value(ch);
+            break;
+
+        case KEY_OR_END:
+            if (ch == kwd::MAP_END) {
+                close();
+                break;
+            }
+            /* [[fallthrough]] */
+        case KEY:
+            handler_.map_key();
+            if (ch != kwd::STR_BEG)
+                exception::expect(*this, kwd::STR_BEG, "JSON string");
+            is_key_ = true;
+            step();
+            string_begin();
+            break;
+
+        case COLON:
+            if (ch != kwd::COLON)
+                exception::expect(*this, kwd::COLON, "JSON pair");
+            step();
+            handler_.map_val();
+            state_ = VALUE;
+            break;
+
+        case NEXT:
+            if (ch == kwd::COMMA) {
+                step();
+                if (stack_.back() == kwd::MAP_BEG) {
+                    state_ = KEY;
+                } else {
+                    handler_.seq_val();
+                    state_ = VALUE;
+                }
+            } else if (stack_.back() == kwd::MAP_BEG) {
+                if (ch != kwd::MAP_END)
+                    exception::expect(*this, ",` or `}", "JSON object");
+                close();
+            } else {
+                if (ch != kwd::SEQ_END)
+                    exception::expect(*this, ",` or `]", "JSON array");
+                close();
+            }
+            break;
+
+        default:
+            ASSERT_DBG(false);
+            break;
+        }
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        value(CharType ch)
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        if (       ch == kwd::STR_BEG) {
+            is_key_ = false;
+            step();
+            string_begin();
+        } else if (ch == kwd::MAP_BEG) {
+            step();
+            handler_.map_beg();
+            stack_.push_back(ch);
+            state_ = KEY_OR_END;
+        } else if (ch == kwd::SEQ_BEG) {
+            step();
+            handler_.seq_beg();
+            stack_.push_back(ch);
+            state_ = VALUE_OR_END;
+        } else if (chars::isdigit(ch) || ch == kwd::MINUS ||
+                   chars::isalpha(ch)) {
+            token_.clear();
+            token_line_ = line_;
+            token_col_  = col_;
+            state_ = SCALAR;
+        } else {
+            exception::expect(*this, "value", "JSON value");
+        }
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        close()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        step();
+        if (stack_.back() == kwd::MAP_BEG)
+            handler_.map_end();
+        else
+            handler_.seq_end();
+        stack_.pop_back();
+        after_value();
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        after_value()
+    {
+        state_ = stack_.empty() ? DONE : NEXT;
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        string_begin()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        /* " chars ", without escape and all in this slice */
+        CharType const * end = scanner_.find_special(cur_, end_);
+        if (end != end_ && *end == kwd::STR_END) {
+            handler_.str_val(cur_, static_cast<size_t>(end - cur_));
+            col_ += static_cast<size_t>(end - cur_);
+            cur_  = end;
+            step();
+            string_end();
+            return;
+        }
+
+        handler_.str_beg();
+        state_ = STRING;
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        string_end()
+    {
+        if (is_key_)
+            state_ = COLON;
+        else
+            after_value();
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        string()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        /* jump over the run of unescaped chars */
+        CharType const * end = scanner_.find_special(cur_, end_);
+        if (end != cur_) {
+            handler_.on_str(cur_, static_cast<size_t>(end - cur_));
+            col_ += static_cast<size_t>(end - cur_);
+            cur_  = end;
+        }
+        if (cur_ == end_)
+            return;
+
+        CharType ch = *cur_;
+        if (ch == kwd::ESCAPE) {
+            step();
+            state_ = ESCAPE;
+        } else if (ch == kwd::STR_END) {
+            step();
+            handler_.str_end();
+            string_end();
+        } else {
+            exception::expect(*this, "CHAR", "JSON char");
+        }
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        escape()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        CharType ch = chr_to_esc(*cur_);
+        if (ch != '\0') {
+            handler_.on_chr(ch);
+            step();
+            state_ = STRING;
+        } else if (*cur_ == kwd::HEX) {
+            exception::warning(*this, "`\\uXXXX` is not implemented and"
+                                      " will be preserved");
+            handler_.on_chr(kwd::ESCAPE);
+            handler_.on_chr(kwd::HEX);
+            step();
+            hex_   = 0U;
+            state_ = HEX;
+        } else {
+            exception::expect(*this, "ESCAPED CHARACTER", "JSON char");
+        }
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        hex()
+    {
+        CharType ch = *cur_;
+        if (chars::ishexdigit(ch) == false)
+            exception::expect(*this, "DIGIT(HEX)", "\\uXXXX");
+        handler_.on_chr(ch);
+        step();
+        if (++hex_ == 4U)
+            state_ = STRING;
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        scalar()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        CharType const * end = cur_;
+        while (end != end_ && (chars::isalnum(*end) ||
+            *end == kwd::MINUS || *end == kwd::PLUS || *end == kwd::DOT))
+            ++end;
+
+        CharType const * beg = cur_;
+        col_ += static_cast<size_t>(end - cur_);
+        cur_  = end;
+
+        if (end == end_) {
+            token_.push_back(beg, static_cast<size_t>(end - beg));
+        } else if (token_.empty()) {
+            /* all in this slice, and `*end` ends it */
+            scalar_end(
+                const_cast<CharType *>(beg), const_cast<CharType *>(end));
+        } else {
+            token_.push_back(beg, static_cast<size_t>(end - beg));
+            token_.push_back(CharType('\0'));
+            scalar_end(token_.begin(), token_.end() - 1);
+        }
+    }
+
+    /* numbers and keywords are left to the grammar of `parse_events` */
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        scalar_end(CharType * beg, CharType * end)
+    {
+        typedef StreamHelper<io::Stream, Handler> In;
+
+        io::Span span(beg, end);
+        In in(span, settings_, handler_);
+        in.resume(token_line_, token_col_, warnings_);
+
+        parse_value(in);
+        warnings_ = in.warnings();
+        if (in.empty() == false)
+            exception::expect(in, "SEPARATOR", "JSON value");
+
+        token_.clear();
+        after_value();
+    }
+
+    template<typename HandlerType>
+    inline void PushParser<HandlerType>::
+        comment()
+    {
+        typedef KeywordTable<CharType> kwd;
+
+        static const CharType STAR = CharType('*');
+        static const CharType LF   = CharType(0xa); /* \n */
+
+        CharType const * pos = NULL;
+        switch (state_)
+        {
+        case COMMENT:
+            if (*cur_ == STAR)
+                state_ = BLOCK;
+            else if (*cur_ == kwd::COMMENT_FIRST)
+                state_ = LINE;
+            else
+                exception::expect(*this, "/*` or `//", "Comment");
+            step();
+            break;
+
+        case BLOCK:
+            pos = static_cast<CharType const *>(std::memchr(
+                cur_, STAR, static_cast<size_t>(end_ - cur_)));
+            if (pos == NULL) {
+                advance(end_);
+            } else {
+                advance(pos);
+                step();
+                state_ = BLOCK_STAR;
+            }
+            break;
+
+        case BLOCK_STAR:
+            if (*cur_ == kwd::COMMENT_FIRST) {
+                step();
+                state_ = resume_;
+            } else if (*cur_ == STAR) {
+                step();
+            } else {
+                state_ = BLOCK;
+            }
+            break;
+
+        case LINE:
+            pos = static_cast<CharType const *>(std::memchr(
+                cur_, LF, static_cast<size_t>(end_ - cur_)));
+            if (pos == NULL) {
+                advance(end_);
+            } else {
+                advance(pos + 1);
+                state_ = resume_;
+            }
+            break;
+
+        default:
+            ASSERT_DBG(false);
+            break;
+        }
+    }
+}}
+
+CV_FS_PRIVATE_END
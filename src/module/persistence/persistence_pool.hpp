@@ -145,6 +145,7 @@ namespace storage
     public:
         pointer allocate(             size_t size);
         void  deallocate(pointer mem, size_t size);
+        void  release();
 
     public:
         void report() const;
@@ -257,22 +258,8 @@ namespace storage
     template<typename T>
     FAllocator<T>::~FAllocator()
     {
-        Chunk * iter = clist_.fst_;
-        while (iter != NULL) {
-
-            if (iter->cod_ != make_code(iter, iter->exp_))
-                /* may cause memory leak if ignored */
-                exception::invalid_x2chunk(POS_);
-
-            Chunk * next = iter->nxt_;
-            pointer mem = reinterpret_cast<pointer>(iter);
-            size_t  siz = HEAD_SIZE + MIN_SIZE + rt_cap::at(iter->exp_);
-            base_alloc_.deallocate(mem, siz);
-            iter = next;
-        }
-
+        release();
         list_alloc_.deallocate(flist_, MAX_EXP);
-        ::memset(&clist_, 0, sizeof(clist_));
     }
 
     template<typename T> inline
@@ -303,6 +290,28 @@ namespace storage
         free_space(mem, exp);
     }
 
+    template<typename T> inline
+    void FAllocator<T>::release()
+    {
+        /* all blocks are gone, no matter they are in use or not */
+        Chunk * iter = clist_.fst_;
+        while (iter != NULL) {
+
+            if (iter->cod_ != make_code(iter, iter->exp_))
+                /* may cause memory leak if ignored */
+                exception::invalid_x2chunk(POS_);
+
+            Chunk * next = iter->nxt_;
+            pointer mem = reinterpret_cast<pointer>(iter);
+            size_t  siz = HEAD_SIZE + MIN_SIZE + rt_cap::at(iter->exp_);
+            base_alloc_.deallocate(mem, siz);
+            iter = next;
+        }
+
+        ::memset( flist_, 0, sizeof(*flist_) * MAX_EXP);
+        ::memset(&clist_, 0, sizeof( clist_));
+    }
+
     template<typename T> inline
     void FAllocator<T>::report() const
     {
@@ -537,6 +546,7 @@ namespace storage
     public:
         pointer allocate(             size_t size);
         void  deallocate(pointer mem, size_t size);
+        void  release();
 
     public:
         void report() const;
@@ -629,17 +639,8 @@ namespace storage
     template<typename T>
     FFAllocator<T>::~FFAllocator()
     {
-        Chunk * iter = clist_.fst_;
-        while (iter != NULL) {
-            Chunk * next = iter->nxt_;
-            pointer mem = reinterpret_cast<pointer>(iter);
-            size_t  siz = HEAD_SIZE + rt_cap::at(iter->exp_);
-            base_alloc_.deallocate(mem, siz);
-            iter = next;
-        }
-
+        release();
         list_alloc_.deallocate(flist_, MAX_EXP);
-        ::memset(&clist_, 0, sizeof(clist_));
     }
 
     template<typename T> inline
@@ -670,6 +671,23 @@ namespace storage
         free_space(mem, exp);
     }
 
+    template<typename T> inline
+    void FFAllocator<T>::release()
+    {
+        /* all blocks are gone, no matter they are in use or not */
+        Chunk * iter = clist_.fst_;
+        while (iter != NULL) {
+            Chunk * next = iter->nxt_;
+            pointer mem = reinterpret_cast<pointer>(iter);
+            size_t  siz = HEAD_SIZE + rt_cap::at(iter->exp_);
+            base_alloc_.deallocate(mem, siz);
+            iter = next;
+        }
+
+        ::memset( flist_, 0, sizeof(*flist_) * MAX_EXP);
+        ::memset(&clist_, 0, sizeof( clist_));
+    }
+
     template<typename T> inline
     void FFAllocator<T>::report() const
     {
@@ -824,6 +842,314 @@ namespace storage
     }
 }
 
+namespace storage
+{
+    /************************************************************************
+     * arena, bump allocation into large chunks.
+     * `deallocate` gives back the memory only if it is the last block,
+     * others are kept until `release` or `reset`.
+     ***********************************************************************/
+
+    template<typename T> class Arena
+    {
+    public:
+        typedef T                  value_type;
+        typedef value_type       *       pointer;
+        typedef value_type const * const_pointer;
+        typedef value_type       &       reference;
+        typedef value_type const * const_reference;
+
+    public:
+        Arena();
+        ~Arena();
+
+    public:
+        pointer allocate(             size_t size);
+        void  deallocate(pointer mem, size_t size);
+        void  release();
+
+        /* drop all blocks, but keep chunks for later `allocate` */
+        void  reset();
+
+        /* take over all chunks of `other`, which becomes empty */
+        void  splice(Arena & other);
+
+    public:
+        void report() const;
+
+    private:
+        Arena            (Arena const &);
+        Arena & operator=(Arena const &);
+
+    private:
+        struct Chunk
+        {
+            Chunk * nxt_;
+            size_t  siz_;
+        };
+
+        typedef std::allocator<value_type> BaseAtor;
+
+    private:
+        enum
+        {
+            VALUE_BYTE = sizeof(value_type),
+            ALIGN_BYTE = sizeof(Chunk *),
+            ALIGN_MASK = ALIGN_BYTE - size_t(1),
+            HEAD_BYTE  = ((sizeof(Chunk) + ALIGN_MASK) & ~ALIGN_MASK),
+            HEAD_SIZE  = ( HEAD_BYTE + VALUE_BYTE - 1) / VALUE_BYTE,
+            MIN_BYTE   = 1U << 12,
+            MAX_BYTE   = 1U << 22,
+            MIN_SIZE   = ( MIN_BYTE + VALUE_BYTE - 1) / VALUE_BYTE,
+            MAX_SIZE   = ( MAX_BYTE + VALUE_BYTE - 1) / VALUE_BYTE
+        };
+
+        typedef typename utility::Assert
+        <
+            (VALUE_BYTE % ALIGN_BYTE == 0) || (ALIGN_BYTE % VALUE_BYTE == 0)
+        >::type must_satisfy_the_alignment_condition_t;
+        /* if you see this error,
+         * it means Arena cannot solve alignment problem with type T
+         * sizeof(T) may be 1,2,4,8...
+         */
+
+    private:
+        static size_t   align      (size_t size);
+        static pointer  data       (Chunk * chunk);
+
+        Chunk *         make_chunk (size_t size);
+        void            free_chunks(Chunk * list);
+
+    private:
+        BaseAtor base_alloc_;
+        Chunk *  fst_; /* current chunk, the others follow */
+        Chunk *  spr_; /* chunks kept by `reset`           */
+        size_t   use_; /* used size of current chunk       */
+        size_t   nxt_; /* size of next chunk               */
+        pointer  top_; /* last block, or NULL              */
+    };
+
+    /////////////////////////////////////////////////////////////////////////
+
+    template<typename T> inline
+        Arena<T>::Arena()
+        : base_alloc_()
+        , fst_(NULL)
+        , spr_(NULL)
+        , use_(0)
+        , nxt_(MIN_SIZE)
+        , top_(NULL)
+    {}
+
+    template<typename T>
+    Arena<T>::~Arena()
+    {
+        release();
+    }
+
+    template<typename T> inline
+    typename Arena<T>::pointer Arena<T>::
+        allocate(size_t size)
+    {
+        size_t need = align(size == 0 ? 1 : size);
+
+        /* large blocks own a chunk, which is put behind the current one */
+        if (need > MAX_SIZE / 4) {
+            Chunk * own = make_chunk(need);
+            if (fst_ == NULL) {
+                fst_ = own;
+                use_ = need;
+            } else {
+                own->nxt_  = fst_->nxt_;
+                fst_->nxt_ = own;
+            }
+            top_ = NULL;
+            return data(own);
+        }
+
+        if (fst_ == NULL || fst_->siz_ - use_ < need) {
+            Chunk * mem = make_chunk(utility::max(need, nxt_));
+            mem->nxt_ = fst_;
+            fst_ = mem;
+            use_ = 0;
+            if (nxt_ < MAX_SIZE)
+                nxt_ <<= 1;
+        }
+
+        top_  = data(fst_) + use_;
+        use_ += need;
+        return top_;
+    }
+
+    template<typename T> inline
+    void Arena<T>::deallocate(pointer mem, size_t /*size*/)
+    {
+        if (mem == NULL || mem != top_)
+            return;
+
+        use_ = static_cast<size_t>(top_ - data(fst_));
+        top_ = NULL;
+    }
+
+    template<typename T> inline
+    void Arena<T>::release()
+    {
+        free_chunks(fst_);
+        free_chunks(spr_);
+
+        fst_ = NULL;
+        spr_ = NULL;
+        use_ = 0;
+        nxt_ = MIN_SIZE;
+        top_ = NULL;
+    }
+
+    template<typename T> inline
+    void Arena<T>::reset()
+    {
+        /* `nxt_` is kept, chunks of the same size are made if needed */
+        while (fst_ != NULL) {
+            Chunk * next = fst_->nxt_;
+            fst_->nxt_ = spr_;
+            spr_ = fst_;
+            fst_ = next;
+        }
+
+        use_ = 0;
+        top_ = NULL;
+    }
+
+    template<typename T> inline
+    void Arena<T>::splice(Arena & other)
+    {
+        if (&other == this || other.fst_ == NULL)
+            return;
+
+        if (fst_ == NULL) {
+            fst_ = other.fst_;
+            use_ = other.use_;
+            nxt_ = other.nxt_;
+            top_ = other.top_;
+        } else {
+            /* keep the current chunk, others are put behind it */
+            Chunk * last = other.fst_;
+            while (last->nxt_ != NULL)
+                last = last->nxt_;
+            last->nxt_ = fst_->nxt_;
+            fst_->nxt_ = other.fst_;
+        }
+
+        other.fst_ = NULL;
+        other.use_ = 0;
+        other.nxt_ = MIN_SIZE;
+        other.top_ = NULL;
+    }
+
+    template<typename T> inline
+    void Arena<T>::report() const
+    {
+        ::printf("=== report begin ===\n");
+        {
+            size_t cnt = 0;
+            size_t siz = 0;
+            Chunk * iter = fst_;
+            while (iter != NULL) {
+                siz += iter->siz_ * sizeof(value_type);
+                ++cnt;
+                iter = iter->nxt_;
+            }
+            ::printf("total %d allocated: %f MB\n",cnt,siz/1024.0/1024.0);
+            if (fst_ != NULL)
+                ::printf
+                    ( "current chunk unused: %f MB\n"
+                    , (fst_->siz_ - use_) * sizeof(value_type) / 1024.0 / 1024.0
+                    );
+        }
+        ::printf("=== report end ===\n");
+    }
+
+    template<typename T> inline
+    typename Arena<T>::Chunk * Arena<T>::make_chunk(size_t size)
+    {
+        /* the first spare chunk that is large enough */
+        for (Chunk ** iter = &spr_; *iter != NULL; iter = &(*iter)->nxt_) {
+            if ((*iter)->siz_ >= size) {
+                Chunk * mem = *iter;
+                *iter = mem->nxt_;
+                mem->nxt_ = NULL;
+                return mem;
+            }
+        }
+
+        Chunk * mem = reinterpret_cast<Chunk*>(
+            base_alloc_.allocate(HEAD_SIZE + size)
+        );
+
+        /* do some check */
+        if (mem == NULL)
+            exception::alloc_failure(
+                (HEAD_SIZE + size) * sizeof(value_type), POS_);
+        if ((reinterpret_cast<size_t>(mem) & ALIGN_MASK) != 0)
+            exception::invalid_aligned(mem, POS_);
+
+        mem->nxt_ = NULL;
+        mem->siz_ = size;
+        return mem;
+    }
+
+    template<typename T> inline
+    void Arena<T>::free_chunks(Chunk * list)
+    {
+        while (list != NULL) {
+            Chunk * next = list->nxt_;
+            pointer mem = reinterpret_cast<pointer>(list);
+            base_alloc_.deallocate(mem, HEAD_SIZE + list->siz_);
+            list = next;
+        }
+    }
+
+    template<typename T> inline
+    typename Arena<T>::pointer Arena<T>::data(Chunk * chunk)
+    {
+        return reinterpret_cast<pointer>(chunk) + HEAD_SIZE;
+    }
+
+    template<typename T> inline
+    size_t Arena<T>::align(size_t size)
+    {
+        return ((size * VALUE_BYTE + ALIGN_MASK) & ~ALIGN_MASK) / VALUE_BYTE;
+    }
+}
+
+namespace storage
+{
+    /************************************************************************
+     * allocator traits
+     ***********************************************************************/
+
+    /* `releasable` allocators drop all memory in `release()` at once,
+     * so that owners don't need to deallocate block by block. */
+    template<template<typename> class AtorType> struct AtorTraits
+    {
+        enum { releasable = false };
+    };
+
+    template<> struct AtorTraits<Arena>
+    {
+        enum { releasable = true };
+    };
+
+    template<> struct AtorTraits<FFAllocator>
+    {
+        enum { releasable = true };
+    };
+
+    template<> struct AtorTraits<FAllocator>
+    {
+        enum { releasable = true };
+    };
+}
+
 namespace storage { namespace internal
 {
     /************************************************************************
@@ -838,11 +1164,20 @@ namespace storage { namespace internal
     {
     protected:
         inline Base() : alloc_() {};
+        inline void release() { alloc_.release(); }
+        inline void reset() { alloc_.reset(); }
+        inline void splice(Base & other) { alloc_.splice(other.alloc_); }
         Alloc<Type> alloc_;
     };
 
     template<template<typename> class Alloc>
-    class Base<End, Alloc> {};
+    class Base<End, Alloc>
+    {
+    protected:
+        inline void release() {}
+        inline void reset() {}
+        inline void splice(Base &) {}
+    };
 
     template<
         typename Type,
@@ -852,7 +1187,24 @@ namespace storage { namespace internal
     class Base<Iter<Type, Next>, Alloc>
         : public Base<Type, Alloc>
         , public Base<Next, Alloc>
-    {};
+    {
+    protected:
+        inline void release()
+        {
+            Base<Type, Alloc>::release();
+            Base<Next, Alloc>::release();
+        }
+        inline void reset()
+        {
+            Base<Type, Alloc>::reset();
+            Base<Next, Alloc>::reset();
+        }
+        inline void splice(Base & other)
+        {
+            Base<Type, Alloc>::splice(other);
+            Base<Next, Alloc>::splice(other);
+        }
+    };
 
 }}
 
@@ -876,6 +1228,27 @@ namespace storage
     {
         typedef internal::Iter<TypeType, NextType> List;
     public:
+        enum { releasable = AtorTraits<AtorType>::releasable };
+
+        /* drop all memory, only for `releasable` allocators */
+        inline void release()
+        {
+            internal::Base<List, AtorType>::release();
+        }
+
+        /* drop all memory but keep it for reuse, only for allocators with
+         * `reset`, e.g. `Arena` */
+        inline void reset()
+        {
+            internal::Base<List, AtorType>::reset();
+        }
+
+        /* take over all memory of `other`, so blocks allocated from it
+         * live as long as this pool. only for allocators with `splice`. */
+        inline void splice(Pool & other)
+        {
+            internal::Base<List, AtorType>::splice(other);
+        }
 
         template<typename T> inline
         typename internal::EnableIf<
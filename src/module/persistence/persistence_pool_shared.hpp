@@ -0,0 +1,403 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "persistence_private.hpp"
+#include "persistence_pool.hpp"
+#include "persistence_ast.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+namespace storage
+{
+    /************************************************************************
+     * shared allocator, for several threads building one tree.
+     * size classes are the same as `FFAllocator`, but each thread has a
+     * cache of its own: free lists and the rest of a chunk. chunks come
+     * from a source shared under a lock. a block freed by another thread
+     * is pushed back to the cache that made it, without lock.
+     * `release` must not run with other calls at the same time.
+     ***********************************************************************/
+
+    template<typename T> class SharedAllocator
+    {
+    public:
+        typedef T                  value_type;
+        typedef value_type       *       pointer;
+        typedef value_type const * const_pointer;
+        typedef value_type       &       reference;
+        typedef value_type const * const_reference;
+
+    public:
+        SharedAllocator();
+        ~SharedAllocator();
+
+    public:
+        pointer allocate(             size_t size);
+        void  deallocate(pointer mem, size_t size);
+        void  release();
+
+    public:
+        void report() const;
+
+    private:
+        SharedAllocator            (SharedAllocator const &);
+        SharedAllocator & operator=(SharedAllocator const &);
+
+    private:
+        struct Cache;
+
+        struct Chunk
+        {
+            Chunk * nxt_;
+            size_t  siz_;
+        };
+
+        struct Free
+        {
+            Free  * nxt_;
+        };
+
+        /* before each block, it is kept after the block is freed */
+        struct Head
+        {
+            Cache *  own_;
+            exp_type exp_;
+        };
+
+        /* last caches found by a thread, `id_` of allocators start from 1 */
+        struct Hint
+        {
+            size_t  id_;
+            Cache * own_;
+        };
+
+        typedef std::allocator<value_type> BaseAtor;
+        typedef     RuntimeFibonacci<exp_type, size_t> rt_cap;
+        typedef CompiletimeFibonacci<exp_type, size_t> ct_cap;
+
+    private:
+        enum
+        {
+            VALUE_BYTE = sizeof(value_type),
+            ALIGN_BYTE = sizeof(Head),
+            ALIGN_MASK = ALIGN_BYTE - size_t(1),
+            HEAD_BYTE  = ((sizeof(Chunk) + ALIGN_MASK) & ~ALIGN_MASK),
+            HEAD_SIZE  = ( HEAD_BYTE + VALUE_BYTE - 1) / VALUE_BYTE,
+            MIN_SIZE   = (ALIGN_BYTE + VALUE_BYTE - 1) / VALUE_BYTE,
+            DEF_SIZE   = 8192U,
+            MAX_EXP    = ct_cap::Array::size,
+            MIN_EXP    = ct_cap::right<
+                (sizeof(Free) + VALUE_BYTE - 1) / VALUE_BYTE>::value,
+            HINT_SIZE  = 4U
+        };
+
+        typedef typename utility::Assert
+        <
+            (VALUE_BYTE % ALIGN_BYTE == 0) || (ALIGN_BYTE % VALUE_BYTE == 0)
+        >::type must_satisfy_the_alignment_condition_t;
+        /* if you see this error,
+         * it means SharedAllocator cannot solve alignment problem with type T
+         * sizeof(T) may be 1,2,4,8...
+         */
+
+        struct Cache
+        {
+            Free *              flist_[MAX_EXP];
+            pointer             cur_;  /* rest of the current chunk */
+            size_t              use_;
+            std::atomic<Free *> back_; /* freed by other threads    */
+            std::thread::id     tid_;
+            Cache *             nxt_;
+        };
+
+    private:
+        static exp_type test_exp   (exp_type exp);
+        static size_t   align      (size_t size);
+        static Head *   head       (pointer mem);
+        static Hint *   hints      ();
+
+        Cache *         find_cache ();
+        pointer         make_chunk (size_t size);
+        pointer         chunk_alloc(Cache & own, exp_type exp);
+        void            collect    (Cache & own);
+        static void     clear      (Cache & own);
+
+    private:
+        BaseAtor           base_alloc_;
+        size_t             id_;
+        Chunk *            clist_;  /* shared source, with `mutex_` */
+        Cache *            caches_; /* one for each thread          */
+        mutable std::mutex mutex_;
+    };
+
+    /////////////////////////////////////////////////////////////////////////
+
+    template<typename T> inline
+        SharedAllocator<T>::SharedAllocator()
+        : base_alloc_()
+        , id_(0)
+        , clist_(NULL)
+        , caches_(NULL)
+        , mutex_()
+    {
+        static std::atomic<size_t> serial(0);
+        id_ = ++serial;
+    }
+
+    template<typename T>
+    SharedAllocator<T>::~SharedAllocator()
+    {
+        release();
+        while (caches_ != NULL) {
+            Cache * next = caches_->nxt_;
+            delete caches_;
+            caches_ = next;
+        }
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::pointer SharedAllocator<T>::
+        allocate(size_t size)
+    {
+        exp_type exp = test_exp(rt_cap::right(size));
+        Cache  & own = *find_cache();
+
+        Free * & first = own.flist_[exp];
+        if (first == NULL && own.back_.load(std::memory_order_relaxed))
+            collect(own);
+        if (first == NULL)
+            return chunk_alloc(own, exp);
+
+        pointer mem = reinterpret_cast<pointer>(first);
+        first = first->nxt_;
+        return mem;
+    }
+
+    template<typename T> inline
+        void SharedAllocator<T>::deallocate(pointer mem, size_t size)
+    {
+        if (mem == NULL)
+            return;
+        if ((reinterpret_cast<size_t>(mem) & ALIGN_MASK) != 0)
+            exception::invalid_aligned(mem, POS_);
+
+        exp_type exp = test_exp(rt_cap::right(size));
+        Head   * hdr = head(mem);
+        if (hdr->exp_ != exp || hdr->own_ == NULL)
+            exception::invalid_x2memory(POS_);
+
+        Cache * own  = hdr->own_;
+        Free  * free = reinterpret_cast<Free *>(mem);
+        if (own == find_cache()) {
+            free->nxt_ = own->flist_[exp];
+            own->flist_[exp] = free;
+            return;
+        }
+
+        /* only the owner takes them, all at once, so there is no ABA */
+        Free * top = own->back_.load(std::memory_order_relaxed);
+        do {
+            free->nxt_ = top;
+        } while (!own->back_.compare_exchange_weak(
+            top, free, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    template<typename T> inline
+    void SharedAllocator<T>::release()
+    {
+        /* all blocks are gone, no matter they are in use or not */
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (clist_ != NULL) {
+            Chunk * next = clist_->nxt_;
+            pointer mem = reinterpret_cast<pointer>(clist_);
+            base_alloc_.deallocate(mem, HEAD_SIZE + clist_->siz_);
+            clist_ = next;
+        }
+
+        /* caches are kept, threads may still find them by hints */
+        for (Cache * iter = caches_; iter != NULL; iter = iter->nxt_)
+            clear(*iter);
+    }
+
+    template<typename T> inline
+    void SharedAllocator<T>::report() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ::printf("=== report begin ===\n");
+        {
+            size_t cnt = 0;
+            size_t siz = 0;
+            for (Cache * iter = caches_; iter != NULL; iter = iter->nxt_) {
+                for (exp_type i = MIN_EXP; i < MAX_EXP; ++i)
+                    for (Free * f = iter->flist_[i]; f != NULL; f = f->nxt_)
+                        siz += rt_cap::at(i) * sizeof(value_type);
+                ++cnt;
+            }
+            ::printf("total %d caches unused: %f MB\n",cnt,siz/1024.0/1024.0);
+        }
+        {
+            size_t cnt = 0;
+            size_t siz = 0;
+            for (Chunk * iter = clist_; iter != NULL; iter = iter->nxt_) {
+                siz += iter->siz_ * sizeof(value_type);
+                ++cnt;
+            }
+            ::printf("total %d allocated: %f MB\n",cnt,siz/1024.0/1024.0);
+        }
+        ::printf("=== report end ===\n");
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::Cache * SharedAllocator<T>::
+        find_cache()
+    {
+        Hint * hint = hints();
+        for (size_t i = 0; i < HINT_SIZE; ++i)
+            if (hint[i].id_ == id_)
+                return hint[i].own_;
+
+        std::thread::id tid = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        Cache * own = caches_;
+        while (own != NULL && own->tid_ != tid)
+            own = own->nxt_;
+        if (own == NULL) {
+            own = new Cache;
+            clear(*own);
+            own->tid_ = tid;
+            own->nxt_ = caches_;
+            caches_   = own;
+        }
+
+        /* the oldest hint is dropped */
+        for (size_t i = HINT_SIZE - 1; i > 0; --i)
+            hint[i] = hint[i - 1];
+        hint[0].id_  = id_;
+        hint[0].own_ = own;
+        return own;
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::pointer SharedAllocator<T>::
+        make_chunk(size_t size)
+    {
+        Chunk * mem = reinterpret_cast<Chunk*>(
+            base_alloc_.allocate(HEAD_SIZE + size)
+        );
+
+        /* do some check */
+        if (mem == NULL)
+            exception::alloc_failure(
+                (HEAD_SIZE + size) * sizeof(value_type), POS_);
+        if ((reinterpret_cast<size_t>(mem) & ALIGN_MASK) != 0)
+            exception::invalid_aligned(mem, POS_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        mem->nxt_ = clist_;
+        mem->siz_ = size;
+        clist_ = mem;
+        return reinterpret_cast<pointer>(mem) + HEAD_SIZE;
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::pointer SharedAllocator<T>::
+        chunk_alloc(Cache & own, exp_type exp)
+    {
+        /* the rest of the last chunk is dropped, it is less than a block */
+        size_t need = MIN_SIZE + align(rt_cap::at(exp));
+        if (own.cur_ == NULL || own.use_ < need) {
+            own.use_ = utility::max(need, static_cast<size_t>(DEF_SIZE));
+            own.cur_ = make_chunk(own.use_);
+        }
+
+        pointer mem = own.cur_ + MIN_SIZE;
+        own.cur_ += need;
+        own.use_ -= need;
+
+        Head * hdr = head(mem);
+        hdr->own_ = &own;
+        hdr->exp_ = exp;
+        return mem;
+    }
+
+    template<typename T> inline
+    void SharedAllocator<T>::collect(Cache & own)
+    {
+        Free * iter = own.back_.exchange(NULL, std::memory_order_acquire);
+        while (iter != NULL) {
+            Free * next = iter->nxt_;
+            exp_type exp = head(reinterpret_cast<pointer>(iter))->exp_;
+            iter->nxt_ = own.flist_[exp];
+            own.flist_[exp] = iter;
+            iter = next;
+        }
+    }
+
+    template<typename T> inline
+    void SharedAllocator<T>::clear(Cache & own)
+    {
+        ::memset(own.flist_, 0, sizeof(own.flist_));
+        own.cur_ = NULL;
+        own.use_ = 0;
+        own.back_.store(NULL, std::memory_order_relaxed);
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::Head * SharedAllocator<T>::
+        head(pointer mem)
+    {
+        return reinterpret_cast<Head *>(mem - MIN_SIZE);
+    }
+
+    template<typename T> inline
+    typename SharedAllocator<T>::Hint * SharedAllocator<T>::hints()
+    {
+        static thread_local Hint hint[HINT_SIZE];
+        return hint;
+    }
+
+    template<typename T> inline
+    exp_type SharedAllocator<T>::test_exp(exp_type exp)
+    {
+        /* assure exp is valid */
+        if (exp >= MAX_EXP)
+            exception::size_not_allowed(rt_cap::at(exp), POS_);
+        if (exp < MIN_EXP)
+            exp = MIN_EXP;
+        return exp;
+    }
+
+    template<typename T> inline
+    size_t SharedAllocator<T>::align(size_t size)
+    {
+        return ((size * VALUE_BYTE + ALIGN_MASK) & ~ALIGN_MASK) / VALUE_BYTE;
+    }
+}
+
+namespace storage
+{
+    template<> struct AtorTraits<SharedAllocator>
+    {
+        enum { releasable = true };
+    };
+}
+
+namespace ast
+{
+    /* for trees that are built by several threads at the same time */
+    typedef storage::Pool<
+        typename utility::tl::MakeList<
+            Node<char>, char
+        >::type,
+        storage::SharedAllocator
+    > SharedPool;
+}
+
+CV_FS_PRIVATE_END
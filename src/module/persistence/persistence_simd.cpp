@@ -0,0 +1,414 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include "persistence_private.hpp"
+#include "persistence_simd.hpp"
+
+/****************************************************************************
+ *  Compiler differences
+ ***************************************************************************/
+
+#if (defined _M_X64) || (defined _M_IX86) || \
+    (defined __x86_64__) || (defined __i386__)
+#define SIMD_X86_
+#endif
+
+#ifdef SIMD_X86_
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIMD_TARGET_(isa)
+#else
+#define SIMD_TARGET_(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  helper
+ ***************************************************************************/
+
+namespace simd { namespace
+{
+    enum Class
+    {
+        QUOTE      = 1 << 0,
+        ESCAPE     = 1 << 1,
+        CONTROL    = 1 << 2,
+        SPACE      = 1 << 3,
+        STRUCTURAL = 1 << 4
+    };
+
+    struct Table
+    {
+        Table()
+        {
+            for (int i = 0; i < 256; ++i)
+                cls[i] = uint8_t((i < 0x20 || i == 0x7F) ? CONTROL : 0);
+
+            cls[uint8_t('"' )] |= QUOTE;
+            cls[uint8_t('\\')] |= ESCAPE;
+            cls[uint8_t(' ' )] |= SPACE;
+            cls[uint8_t('\t')] |= SPACE;
+            cls[uint8_t('\n')] |= SPACE;
+            cls[uint8_t('\r')] |= SPACE;
+            cls[uint8_t('{' )] |= STRUCTURAL;
+            cls[uint8_t('}' )] |= STRUCTURAL;
+            cls[uint8_t('[' )] |= STRUCTURAL;
+            cls[uint8_t(']' )] |= STRUCTURAL;
+            cls[uint8_t(':' )] |= STRUCTURAL;
+            cls[uint8_t(',' )] |= STRUCTURAL;
+        }
+
+        inline uint8_t operator[](char c) const
+        {
+            return cls[static_cast<uint8_t>(c)];
+        }
+
+        uint8_t cls[256];
+    };
+
+    static Table const & table()
+    {
+        static Table const t;
+        return t;
+    }
+
+    /* must be ready before any scanner is used by other threads */
+    static Table const & table_initializer = table();
+}}
+
+/****************************************************************************
+ *  scalar
+ ***************************************************************************/
+
+namespace simd { namespace
+{
+    template<int CLASS, bool EXPECT> inline
+        char const * scalar_find(char const * beg, char const * end)
+    {
+        Table const & t = table();
+        while (beg != end && ((t[*beg] & CLASS) != 0) != EXPECT)
+            ++beg;
+        return beg;
+    }
+
+    static void scalar_classify(char const * blk, Masks & out)
+    {
+        Table const & t = table();
+        out.quote = out.escape = out.control = out.space = out.structural = 0;
+        for (uint32_t i = 0; i < 32U; ++i) {
+            uint8_t c = t[blk[i]];
+            out.quote      |= uint32_t((c & QUOTE     ) != 0) << i;
+            out.escape     |= uint32_t((c & ESCAPE    ) != 0) << i;
+            out.control    |= uint32_t((c & CONTROL   ) != 0) << i;
+            out.space      |= uint32_t((c & SPACE     ) != 0) << i;
+            out.structural |= uint32_t((c & STRUCTURAL) != 0) << i;
+        }
+    }
+
+    static char const * scalar_find_special(char const * b, char const * e)
+    {
+        return scalar_find<QUOTE | ESCAPE | CONTROL, true>(b, e);
+    }
+
+    static char const * scalar_find_nonspace(char const * b, char const * e)
+    {
+        return scalar_find<SPACE, false>(b, e);
+    }
+}}
+
+/****************************************************************************
+ *  SSE2
+ ***************************************************************************/
+
+#ifdef SIMD_X86_
+namespace simd { namespace
+{
+    SIMD_TARGET_("sse2")
+    inline static __m128i sse2_le(__m128i x, char c)
+    {
+        /* unsigned `x <= c` */
+        __m128i v = _mm_set1_epi8(c);
+        return _mm_cmpeq_epi8(_mm_max_epu8(x, v), v);
+    }
+
+    SIMD_TARGET_("sse2")
+    inline static __m128i sse2_eq(__m128i x, char c)
+    {
+        return _mm_cmpeq_epi8(x, _mm_set1_epi8(c));
+    }
+
+    SIMD_TARGET_("sse2")
+    inline static uint32_t sse2_mask(__m128i x)
+    {
+        return static_cast<uint32_t>(_mm_movemask_epi8(x)) & 0xFFFFU;
+    }
+
+    SIMD_TARGET_("sse2")
+    inline static uint32_t sse2_special(__m128i x)
+    {
+        return sse2_mask(_mm_or_si128(
+            _mm_or_si128(sse2_eq(x, '"'), sse2_eq(x, '\\')),
+            _mm_or_si128(sse2_le(x, 0x1F), sse2_eq(x, 0x7F))));
+    }
+
+    SIMD_TARGET_("sse2")
+    inline static uint32_t sse2_space(__m128i x)
+    {
+        return sse2_mask(_mm_or_si128(
+            _mm_or_si128(sse2_eq(x, ' ' ), sse2_eq(x, '\t')),
+            _mm_or_si128(sse2_eq(x, '\n'), sse2_eq(x, '\r'))));
+    }
+
+    SIMD_TARGET_("sse2")
+    inline static uint32_t sse2_structural(__m128i x)
+    {
+        return sse2_mask(_mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(sse2_eq(x, '{'), sse2_eq(x, '}')),
+                _mm_or_si128(sse2_eq(x, '['), sse2_eq(x, ']'))),
+            _mm_or_si128(sse2_eq(x, ':'), sse2_eq(x, ','))));
+    }
+
+    SIMD_TARGET_("sse2")
+    static void sse2_classify(char const * blk, Masks & out)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(blk));
+        out.quote      = sse2_mask(sse2_eq(x, '"'));
+        out.escape     = sse2_mask(sse2_eq(x, '\\'));
+        out.control    = sse2_mask(_mm_or_si128(
+                            sse2_le(x, 0x1F), sse2_eq(x, 0x7F)));
+        out.space      = sse2_space(x);
+        out.structural = sse2_structural(x);
+    }
+
+    SIMD_TARGET_("sse2")
+    static char const * sse2_find_special(char const * b, char const * e)
+    {
+        for (; e - b >= 16; b += 16) {
+            __m128i  x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b));
+            uint32_t m = sse2_special(x);
+            if (m != 0)
+                return b + lowest_bit(m);
+        }
+        return scalar_find_special(b, e);
+    }
+
+    SIMD_TARGET_("sse2")
+    static char const * sse2_find_nonspace(char const * b, char const * e)
+    {
+        for (; e - b >= 16; b += 16) {
+            __m128i  x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b));
+            uint32_t m = ~sse2_space(x) & 0xFFFFU;
+            if (m != 0)
+                return b + lowest_bit(m);
+        }
+        return scalar_find_nonspace(b, e);
+    }
+}}
+#endif
+
+/****************************************************************************
+ *  AVX2
+ ***************************************************************************/
+
+#ifdef SIMD_X86_
+namespace simd { namespace
+{
+    SIMD_TARGET_("avx2")
+    inline static __m256i avx2_le(__m256i x, char c)
+    {
+        __m256i v = _mm256_set1_epi8(c);
+        return _mm256_cmpeq_epi8(_mm256_max_epu8(x, v), v);
+    }
+
+    SIMD_TARGET_("avx2")
+    inline static __m256i avx2_eq(__m256i x, char c)
+    {
+        return _mm256_cmpeq_epi8(x, _mm256_set1_epi8(c));
+    }
+
+    SIMD_TARGET_("avx2")
+    inline static uint32_t avx2_mask(__m256i x)
+    {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(x));
+    }
+
+    SIMD_TARGET_("avx2")
+    inline static uint32_t avx2_special(__m256i x)
+    {
+        return avx2_mask(_mm256_or_si256(
+            _mm256_or_si256(avx2_eq(x, '"'), avx2_eq(x, '\\')),
+            _mm256_or_si256(avx2_le(x, 0x1F), avx2_eq(x, 0x7F))));
+    }
+
+    SIMD_TARGET_("avx2")
+    inline static uint32_t avx2_space(__m256i x)
+    {
+        return avx2_mask(_mm256_or_si256(
+            _mm256_or_si256(avx2_eq(x, ' ' ), avx2_eq(x, '\t')),
+            _mm256_or_si256(avx2_eq(x, '\n'), avx2_eq(x, '\r'))));
+    }
+
+    SIMD_TARGET_("avx2")
+    inline static uint32_t avx2_structural(__m256i x)
+    {
+        return avx2_mask(_mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(avx2_eq(x, '{'), avx2_eq(x, '}')),
+                _mm256_or_si256(avx2_eq(x, '['), avx2_eq(x, ']'))),
+            _mm256_or_si256(avx2_eq(x, ':'), avx2_eq(x, ','))));
+    }
+
+    SIMD_TARGET_("avx2")
+    static void avx2_classify(char const * blk, Masks & out)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(blk));
+        out.quote      = avx2_mask(avx2_eq(x, '"'));
+        out.escape     = avx2_mask(avx2_eq(x, '\\'));
+        out.control    = avx2_mask(_mm256_or_si256(
+                            avx2_le(x, 0x1F), avx2_eq(x, 0x7F)));
+        out.space      = avx2_space(x);
+        out.structural = avx2_structural(x);
+    }
+
+    SIMD_TARGET_("avx2")
+    static char const * avx2_find_special(char const * b, char const * e)
+    {
+        for (; e - b >= 32; b += 32) {
+            __m256i  x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+            uint32_t m = avx2_special(x);
+            if (m != 0)
+                return b + lowest_bit(m);
+        }
+        return sse2_find_special(b, e);
+    }
+
+    SIMD_TARGET_("avx2")
+    static char const * avx2_find_nonspace(char const * b, char const * e)
+    {
+        for (; e - b >= 32; b += 32) {
+            __m256i  x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+            uint32_t m = ~avx2_space(x);
+            if (m != 0)
+                return b + lowest_bit(m);
+        }
+        return sse2_find_nonspace(b, e);
+    }
+}}
+#endif
+
+/****************************************************************************
+ *  dispatch
+ ***************************************************************************/
+
+namespace simd
+{
+    Isa detect()
+    {
+#if (defined SIMD_X86_) && (defined _MSC_VER)
+        int info[4] = { 0 };
+        __cpuid(info, 0);
+        int const leaves = info[0];
+
+        __cpuid(info, 1);
+        bool const sse2    = (info[3] & (1 << 26)) != 0;
+        bool const osxsave = (info[2] & (1 << 27)) != 0;
+        bool const avx     = (info[2] & (1 << 28)) != 0;
+
+        bool avx2 = false;
+        if (leaves >= 7 && osxsave && avx &&
+            (_xgetbv(0) & 0x6) == 0x6 /* XMM and YMM state saved by OS */) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        return avx2 ? AVX2 : sse2 ? SSE2 : SCALAR;
+#elif (defined SIMD_X86_) && (defined __GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return SSE2;
+        return SCALAR;
+#else
+        return SCALAR;
+#endif
+    }
+
+    uint32_t in_string(Masks const & masks, size_t width, Carry & carry)
+    {
+        uint32_t const full
+            = width < 32U
+            ? (uint32_t(1) << width) - 1U
+            : ~uint32_t(0)
+            ;
+
+        /* backslashes are rare, walk them one by one */
+        uint32_t escaped = carry.escaped;
+        carry.escaped = 0;
+        for (uint32_t esc = masks.escape; esc != 0; esc &= esc - 1U) {
+            uint32_t idx = lowest_bit(esc);
+            if ((escaped >> idx) & 1U)
+                continue;
+            if (idx + 1U == width)
+                carry.escaped = 1U;
+            else
+                escaped |= uint32_t(2) << idx;
+        }
+
+        /* prefix xor of quotes, set from an opening quote to the char
+         * before the closing one */
+        uint32_t inside = masks.quote & ~escaped;
+        inside ^= inside << 1;
+        inside ^= inside << 2;
+        inside ^= inside << 4;
+        inside ^= inside << 8;
+        inside ^= inside << 16;
+        inside  = (inside ^ carry.inside) & full;
+
+        carry.inside = ((inside >> (width - 1U)) & 1U) ? ~uint32_t(0) : 0U;
+        return inside;
+    }
+
+    Scanner const & scanner(Isa isa)
+    {
+        static Scanner const SCANNERS[] =
+        {
+            {
+                SCALAR, 32U, scalar_classify,
+                scalar_find_special,
+                scalar_find_nonspace
+            },
+#ifdef SIMD_X86_
+            {
+                SSE2, 16U, sse2_classify,
+                sse2_find_special,
+                sse2_find_nonspace
+            },
+            {
+                AVX2, 32U, avx2_classify,
+                avx2_find_special,
+                avx2_find_nonspace
+            },
+#endif
+        };
+        static size_t const COUNT = sizeof(SCANNERS) / sizeof(SCANNERS[0]);
+        static Isa    const BEST  = detect();
+
+        size_t idx = static_cast<size_t>(isa < BEST ? isa : BEST);
+        return SCANNERS[idx < COUNT ? idx : COUNT - 1U];
+    }
+
+    Scanner const & scanner()
+    {
+        static Scanner const & best = scanner(AVX2);
+        return best;
+    }
+}
+
+CV_FS_PRIVATE_END
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include "persistence_private.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ * Declaration
+ ***************************************************************************/
+
+namespace simd
+{
+    /* instruction sets, from the weakest to the strongest */
+    enum Isa
+    {
+        SCALAR = 0,
+        SSE2   = 1,
+        AVX2   = 2
+    };
+
+    /* classification of a block, bit `i` stands for the `i`th byte */
+    struct Masks
+    {
+        uint32_t quote;      /* "                         */
+        uint32_t escape;     /* \                         */
+        uint32_t control;    /* [0x00, 0x20) and 0x7F     */
+        uint32_t space;      /* ' ', \t, \n, \r           */
+        uint32_t structural; /* { } [ ] : ,               */
+    };
+
+    /* returns the first position in [beg, end) that satisfies a predicate,
+     * or `end` if there is none. */
+    typedef char const * (*Finder)(char const * beg, char const * end);
+
+    /* classifies `width` bytes starting from `blk` */
+    typedef void (*Classifier)(char const * blk, Masks & out);
+
+    /* the parser uses it to jump over runs inside strings and spaces only;
+     * numbers and keywords are still read char by char, and `structural`
+     * of `Masks` is not used to drive the parser. */
+    struct Scanner
+    {
+        Isa        isa;
+        size_t     width;           /* block size of `classify` */
+        Classifier classify;
+
+        Finder     find_special;    /* quote, escape or control */
+        Finder     find_nonspace;   /* not ' ', \t, \n, \r      */
+    };
+
+    /* the best instruction set supported by both compiler and cpu */
+    Isa detect();
+
+    /* scanner of the best instruction set, selected once at runtime */
+    Scanner const & scanner();
+
+    /* scanner of `isa`, falls back to a weaker one if not supported */
+    Scanner const & scanner(Isa isa);
+
+    /* strings across blocks, all zero at the beginning of a text */
+    struct Carry
+    {
+        uint32_t escaped; /* the first char of next block is escaped */
+        uint32_t inside;  /* all ones if next block begins in a string */
+    };
+
+    /* chars in strings of a classified block, including opening quotes
+     * but not closing ones, so that `structural & ~inside` are outside */
+    uint32_t in_string(Masks const & masks, size_t width, Carry & carry);
+
+    /* index of the lowest set bit, `mask` must not be 0 */
+    inline uint32_t lowest_bit(uint32_t mask);
+}
+
+/****************************************************************************
+ * Implementation
+ ***************************************************************************/
+
+namespace simd
+{
+    inline uint32_t lowest_bit(uint32_t mask)
+    {
+#if (defined _MSC_VER)
+        unsigned long idx;
+        _BitScanForward(&idx, mask);
+        return static_cast<uint32_t>(idx);
+#elif (defined __GNUC__)
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+        uint32_t idx = 0;
+        for (; (mask & 1U) == 0; mask >>= 1)
+            ++idx;
+        return idx;
+#endif
+    }
+}
+
+CV_FS_PRIVATE_END
@@ -0,0 +1,617 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include <cstring>
+#include <limits>
+#include "persistence_private.hpp"
+#include "persistence_utility.hpp"
+#include "persistence_snapshot.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  exception
+ ***************************************************************************/
+
+namespace exception
+{
+    using chars::Soss;
+    using chars::fmt;
+
+    static inline void broken_image(uint64_t offset, POS_TYPE_)
+    {
+        error(0,
+            ( Soss<char, 64>()
+                * "image is broken at offset `" | fmt<24>(offset) | '`'
+            ), POS_ARGS_
+        );
+    }
+}
+
+/****************************************************************************
+ *  helper
+ ***************************************************************************/
+
+namespace snapshot { namespace
+{
+    typedef ast::Node<char> Node;
+
+    const char     MAGIC[8]  = { 'C', 'V', 'F', 'S', 'S', 'N', 'A', 'P' };
+    const uint32_t ORDER     = 0x01020304U;
+    const uint32_t VERSION   = 1U;
+    const uint8_t  LONG      = 0xffU;
+    const size_t   SMALL     = sizeof(((Slot *)0)->sht.raw); /* with '\0' */
+    const uint32_t THRESHOLD = 16U; /* maps of this size get a table */
+
+    typedef utility::Assert<sizeof(Slot) == 16U>::type slot_is_16_bytes_t;
+    typedef utility::Assert<sizeof(Head) % 8U == 0U>::type head_is_aligned_t;
+
+    inline uint64_t align(uint64_t bytes)
+    {
+        return (bytes + 7U) & ~uint64_t(7U);
+    }
+
+    inline uint32_t hash(char const * str, size_t len)
+    {
+        /* FNV-1a */
+        uint32_t h = 2166136261U;
+        for (char const * end = str + len; str != end; ++str) {
+            h ^= static_cast<uint8_t>(*str);
+            h *= 16777619U;
+        }
+        return h;
+    }
+
+    /* log2 of slots of the table of a map, or 0 for none */
+    inline uint8_t table_exp(uint32_t size)
+    {
+        if (size < THRESHOLD)
+            return 0;
+        uint8_t exp = 5;
+        while ((uint64_t(1) << exp) < (uint64_t(size) << 1))
+            ++exp;
+        return exp;
+    }
+}}
+
+/****************************************************************************
+ *  Writer
+ ***************************************************************************/
+
+namespace snapshot { namespace
+{
+    /* containers are given offsets when their slots are made, then their
+     * blobs are written in the same order, so the stream is written
+     * forward except for the size in head. */
+    class Writer
+    {
+    public:
+        explicit Writer(io::Stream & stream)
+            : stream_(stream)
+            , ok_(true)
+            , pos_(0)
+            , next_(sizeof(Head))
+            , queue_()
+            , first_(0)
+        {}
+
+        bool save(Node const & root)
+        {
+            Head head;
+            ::memset(&head, 0, sizeof(head));
+            ::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+            head.order   = ORDER;
+            head.version = VERSION;
+            head.root    = slot(root);
+            put(&head, sizeof(head));
+
+            while (ok_ && first_ < queue_.size())
+                blob(*queue_[first_++]);
+
+            if (ok_ && pos_ != next_)
+                ok_ = false;
+            if (ok_) {
+                head.size = pos_;
+                stream_.seek(0, io::BEG);
+                put(&head, sizeof(head));
+                stream_.seek(0, io::END);
+            }
+            return ok_;
+        }
+
+    private:
+        Slot slot(Node const & node)
+        {
+            Slot rv;
+            ::memset(&rv, 0, sizeof(rv));
+            rv.tag = static_cast<uint8_t>(node.type());
+
+            uint64_t bytes = 0;
+            switch (node.type())
+            {
+            case ast::NIL:
+            {
+                return rv;
+            }
+            case ast::I64:
+            {
+                rv.i64.val = node.val<ast::I64>();
+                return rv;
+            }
+            case ast::DBL:
+            {
+                rv.dbl.val = node.val<ast::DBL>();
+                return rv;
+            }
+            case ast::STR:
+            {
+                size_t siz = node.size<ast::STR>();
+                if (siz < SMALL) {
+                    rv.sht.siz = static_cast<uint8_t>(siz + 1U);
+                    ::memcpy(rv.sht.raw, node.raw<ast::STR>(), siz);
+                    return rv;
+                }
+                rv.box.lng = LONG;
+                rv.box.siz = static_cast<uint32_t>(siz);
+                bytes = align(siz + 1U);
+                break;
+            }
+            case ast::SEQ:
+            {
+                rv.box.siz = node.size<ast::SEQ>();
+                bytes = uint64_t(rv.box.siz) * sizeof(Slot);
+                break;
+            }
+            case ast::MAP:
+            {
+                rv.box.siz = node.size<ast::MAP>();
+                rv.box.exp = table_exp(rv.box.siz);
+                bytes = uint64_t(rv.box.siz) * sizeof(Slot) * 2U;
+                if (rv.box.exp != 0)
+                    bytes += align(sizeof(uint32_t) << rv.box.exp);
+                break;
+            }
+            case ast::I64_ARR:
+            {
+                rv.box.siz = node.size<ast::I64_ARR>();
+                bytes = uint64_t(rv.box.siz) * sizeof(int64_t);
+                break;
+            }
+            case ast::DBL_ARR:
+            {
+                rv.box.siz = node.size<ast::DBL_ARR>();
+                bytes = uint64_t(rv.box.siz) * sizeof(double);
+                break;
+            }
+            default:
+            {
+                exception::node_type_out_of_range(node.type(), POS_);
+                break;
+            }
+            }
+
+            if (bytes != 0) {
+                rv.box.off = next_;
+                next_     += bytes;
+                queue_.push_back(&node);
+            }
+            return rv;
+        }
+
+        void blob(Node const & node)
+        {
+            switch (node.type())
+            {
+            case ast::STR:
+            {
+                size_t siz = node.size<ast::STR>() + 1U; /* '\0' at end */
+                put(node.raw<ast::STR>(), siz);
+                pad(siz);
+                break;
+            }
+            case ast::SEQ:
+            {
+                Node const * beg = node.begin<ast::SEQ>();
+                Node const * end = node.end  <ast::SEQ>();
+                for (; beg != end; ++beg)
+                    put(slot(*beg));
+                break;
+            }
+            case ast::MAP:
+            {
+                Node::Pair const * beg = node.begin<ast::MAP>();
+                Node::Pair const * end = node.end  <ast::MAP>();
+                for (Node::Pair const * cur = beg; cur != end; ++cur) {
+                    put(slot((*cur)[0]));
+                    put(slot((*cur)[1]));
+                }
+                uint8_t exp = table_exp(node.size<ast::MAP>());
+                if (exp != 0)
+                    table(beg, end, exp);
+                break;
+            }
+            case ast::I64_ARR:
+            {
+                put(node.raw<ast::I64_ARR>(),
+                    node.size<ast::I64_ARR>() * sizeof(int64_t));
+                break;
+            }
+            case ast::DBL_ARR:
+            {
+                put(node.raw<ast::DBL_ARR>(),
+                    node.size<ast::DBL_ARR>() * sizeof(double));
+                break;
+            }
+            default:
+            {
+                break;
+            }
+            }
+        }
+
+        void table(Node::Pair const * beg, Node::Pair const * end, uint8_t exp)
+        {
+            uint32_t msk = (uint32_t(1) << exp) - 1U;
+            chars::Buffer<uint32_t, 64, std::allocator> tab(msk + 1U);
+            ::memset(tab.begin(), 0, tab.size() * sizeof(uint32_t));
+
+            for (Node::Pair const * cur = beg; cur != end; ++cur) {
+                Node const & key = (*cur)[0];
+                if (key.type() != ast::STR)
+                    continue;
+
+                char const * str = key.raw<ast::STR>();
+                size_t       len = key.size<ast::STR>();
+                uint32_t     i   = hash(str, len) & msk;
+                for (uint32_t pos; (pos = tab[i]) != 0; i = (i + 1U) & msk)
+                    if (beg[pos - 1][0].equal(key))
+                        break; /* keep the first one */
+                if (tab[i] == 0)
+                    tab[i] = static_cast<uint32_t>(cur - beg) + 1U;
+            }
+
+            size_t bytes = tab.size() * sizeof(uint32_t);
+            put(tab.begin(), bytes);
+            pad(bytes);
+        }
+
+        void put(Slot const & slot)
+        {
+            put(&slot, sizeof(slot));
+        }
+
+        void put(void const * mem, size_t bytes)
+        {
+            if (!ok_ || bytes == 0)
+                return;
+            io::Stream::size_type n = stream_.write(
+                static_cast<char const *>(mem), bytes);
+            ok_   = n == bytes;
+            pos_ += bytes;
+        }
+
+        void pad(size_t bytes)
+        {
+            static const char zeros[8] = { 0 };
+            put(zeros, static_cast<size_t>(align(bytes) - bytes));
+        }
+
+    private:
+        Writer            (Writer const &) /* = delete */;
+        Writer & operator=(Writer const &) /* = delete */;
+
+    private:
+        typedef chars::Buffer<Node const *, 64, std::allocator> Queue;
+
+        io::Stream & stream_;
+        bool         ok_;
+        uint64_t     pos_;   /* bytes written               */
+        uint64_t     next_;  /* offset of the next blob     */
+        Queue        queue_; /* containers to write blobs   */
+        size_t       first_; /* of `queue_`, not written    */
+    };
+}}
+
+namespace snapshot
+{
+    bool save(ast::Node<char> const & root, io::Stream & stream)
+    {
+        if (!stream.is_open())
+            return false;
+        return Writer(stream).save(root);
+    }
+}
+
+/****************************************************************************
+ *  Ref
+ ***************************************************************************/
+
+namespace snapshot
+{
+    Ref::Ref()
+        : image_(NULL)
+        , slot_(NULL)
+    {}
+
+    Ref::Ref(Image const * image, Slot const * slot)
+        : image_(image)
+        , slot_(slot)
+    {}
+
+    bool Ref::empty() const
+    {
+        return slot_ == NULL;
+    }
+
+    ast::Tag Ref::type() const
+    {
+        return slot_ == NULL ? ast::NIL : static_cast<ast::Tag>(slot_->tag);
+    }
+
+    size_t Ref::size() const
+    {
+        switch (type())
+        {
+        case ast::STR:
+            return slot_->sht.siz != LONG
+                ? small()
+                : size_t(slot_->box.siz);
+        case ast::SEQ:
+        case ast::MAP:
+        case ast::I64_ARR:
+        case ast::DBL_ARR:
+            return slot_->box.siz;
+        default:
+            return 0;
+        }
+    }
+
+    int64_t Ref::i64() const
+    {
+        check(ast::I64);
+        return slot_->i64.val;
+    }
+
+    double Ref::dbl() const
+    {
+        check(ast::DBL);
+        return slot_->dbl.val;
+    }
+
+    char const * Ref::str() const
+    {
+        check(ast::STR);
+        if (slot_->sht.siz != LONG) {
+            small();
+            return slot_->sht.raw;
+        }
+
+        uint32_t     siz = slot_->box.siz;
+        char const * raw = static_cast<char const *>(blob(siz + 1ULL));
+        if (raw[siz] != '\0')
+            exception::broken_image(slot_->box.off, POS_);
+        return raw;
+    }
+
+    int64_t const * Ref::i64s() const
+    {
+        check(ast::I64_ARR);
+        return static_cast<int64_t const *>
+            (blob(uint64_t(slot_->box.siz) * sizeof(int64_t)));
+    }
+
+    double const * Ref::dbls() const
+    {
+        check(ast::DBL_ARR);
+        return static_cast<double const *>
+            (blob(uint64_t(slot_->box.siz) * sizeof(double)));
+    }
+
+    Ref Ref::at(size_t index) const
+    {
+        ast::Tag tag = type();
+        if ((tag != ast::SEQ && tag != ast::MAP) || index >= size())
+            return Ref();
+
+        size_t       per   = tag == ast::MAP ? 2U : 1U;
+        Slot const * slots = static_cast<Slot const *>
+            (blob(uint64_t(slot_->box.siz) * sizeof(Slot) * per));
+        return Ref(image_, slots + index * per + (per - 1U));
+    }
+
+    Ref Ref::key(size_t index) const
+    {
+        if (type() != ast::MAP || index >= size())
+            return Ref();
+
+        Slot const * slots = static_cast<Slot const *>
+            (blob(uint64_t(slot_->box.siz) * sizeof(Slot) * 2U));
+        return Ref(image_, slots + index * 2U);
+    }
+
+    Ref Ref::find(char const * key) const
+    {
+        return key == NULL ? Ref() : find(key, ::strlen(key));
+    }
+
+    Ref Ref::find(char const * key, size_t len) const
+    {
+        if (type() != ast::MAP || key == NULL)
+            return Ref();
+
+        uint32_t siz = slot_->box.siz;
+        uint8_t  exp = slot_->box.exp;
+        uint64_t pairs = uint64_t(siz) * sizeof(Slot) * 2U;
+        uint64_t bytes = pairs + (exp == 0 ? 0 : sizeof(uint32_t) << exp);
+        Slot const * slots = static_cast<Slot const *>(blob(bytes));
+
+        if (exp == 0) {
+            for (uint32_t i = 0; i < siz; ++i) {
+                Ref name(image_, slots + i * 2U);
+                if (name.type() == ast::STR && name.size() == len &&
+                    ::memcmp(name.str(), key, len) == 0)
+                    return Ref(image_, slots + i * 2U + 1U);
+            }
+            return Ref();
+        }
+
+        uint32_t const * tab = reinterpret_cast<uint32_t const *>
+            (reinterpret_cast<char const *>(slots) + pairs);
+        uint32_t msk = (uint32_t(1) << exp) - 1U;
+        uint32_t i   = hash(key, len) & msk;
+        for (uint32_t pos; (pos = tab[i]) != 0; i = (i + 1U) & msk) {
+            if (pos > siz)
+                exception::broken_image(slot_->box.off, POS_);
+            Ref name(image_, slots + (pos - 1U) * 2U);
+            if (name.type() == ast::STR && name.size() == len &&
+                ::memcmp(name.str(), key, len) == 0)
+                return Ref(image_, slots + (pos - 1U) * 2U + 1U);
+        }
+        return Ref();
+    }
+
+    void const * Ref::blob(uint64_t bytes) const
+    {
+        /* offsets are checked on every visit instead of all at open */
+        uint64_t off  = slot_->box.off;
+        uint64_t size = image_->size_;
+        if (bytes == 0)
+            return image_->base_;
+        if (off < sizeof(Head) || off % 8U != 0 || off > size ||
+            bytes > size - off)
+            exception::broken_image(off, POS_);
+        return image_->base_ + off;
+    }
+
+    size_t Ref::small() const
+    {
+        /* the length byte is checked as offsets are, a broken one would
+         * make a string run out of its slot */
+        size_t siz = slot_->sht.siz;
+        if (siz < 1U || siz > SMALL || slot_->sht.raw[siz - 1U] != '\0')
+            exception::broken_image(
+                uint64_t(reinterpret_cast<char const *>(slot_) -
+                         image_->base_), POS_);
+        return siz - 1U;
+    }
+
+    void Ref::check(ast::Tag tag) const
+    {
+        if (type() != tag)
+            exception::node_type_not_match(type(), tag, POS_);
+    }
+}
+
+/****************************************************************************
+ *  Image
+ ***************************************************************************/
+
+namespace snapshot
+{
+    Image::Image()
+        : stream_(NULL)
+        , copy_(NULL)
+        , base_(NULL)
+        , size_(0)
+    {}
+
+    Image::~Image()
+    {
+        close();
+    }
+
+    bool Image::open(char const * path)
+    {
+        close();
+        if (path == NULL)
+            return false;
+
+        io::Stream::size_type size = 0;
+        stream_ = io::Stream::build(io::MMAP);
+        if (stream_->open(path, io::READ))
+            base_ = stream_->view(size);
+
+        if (base_ == NULL) {
+            /* e.g. it ends at a page boundary on windows */
+            delete stream_;
+            stream_ = io::Stream::build(io::FILE);
+            if (stream_->open(path, io::READ)) {
+                stream_->seek(0, io::END);
+                io::Stream::Pos end = stream_->tell();
+                stream_->seek(0, io::BEG);
+                if (end >= 0 && uint64_t(end) <
+                    uint64_t(std::numeric_limits<size_t>::max()) - 8U) {
+                    size  = static_cast<io::Stream::size_type>(end);
+                    copy_ = new uint64_t[static_cast<size_t>(size) / 8U + 1U];
+                    char * mem = reinterpret_cast<char *>(copy_);
+                    if (stream_->read(mem, size) == size)
+                        base_ = mem;
+                }
+            }
+            delete stream_;
+            stream_ = NULL;
+        }
+
+        size_ = static_cast<size_t>(size);
+        if (base_ == NULL || !check()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool Image::open(char const * data, size_t size)
+    {
+        close();
+        base_ = data;
+        size_ = size;
+        if (base_ == NULL || !check()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void Image::close()
+    {
+        delete stream_;
+        delete [] copy_;
+        stream_ = NULL;
+        copy_   = NULL;
+        base_   = NULL;
+        size_   = 0;
+    }
+
+    bool Image::is_open() const
+    {
+        return base_ != NULL;
+    }
+
+    Ref Image::root() const
+    {
+        if (!is_open())
+            return Ref();
+        return Ref(this, &reinterpret_cast<Head const *>(base_)->root);
+    }
+
+    size_t Image::size() const
+    {
+        return size_;
+    }
+
+    bool Image::check() const
+    {
+        if (size_ < sizeof(Head) || reinterpret_cast<size_t>(base_) % 8U)
+            return false;
+
+        Head const & head = *reinterpret_cast<Head const *>(base_);
+        return ::memcmp(head.magic, MAGIC, sizeof(MAGIC)) == 0
+            && head.order   == ORDER
+            && head.version == VERSION
+            && head.size    == uint64_t(size_)
+            ;
+    }
+}
+
+CV_FS_PRIVATE_END
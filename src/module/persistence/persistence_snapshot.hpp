@@ -0,0 +1,174 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include "persistence_private.hpp"
+#include "persistence_string.hpp"
+#include "persistence_ast.hpp"
+#include "persistence_io.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ * image
+ ***************************************************************************/
+
+namespace snapshot
+{
+    /************************************************************************
+     * Format
+    ************************************************************************/
+
+    /* an image is a position independent copy of a tree,
+     *
+     *     [Head][blob][blob]...
+     *
+     * and `Head` ends with the slot of root. A slot is 16 bytes as a node,
+     * with the same tag, size and small string, but `raw.ptr` is replaced
+     * by the offset of a blob from the beginning of image:
+     *  - STR, chars with '\0' at end,
+     *  - SEQ, slots of elements,
+     *  - MAP, slots of pairs, followed by a hash table of string keys if
+     *         `exp` is not 0, which is `1 << exp` of `1 + index of pair`,
+     *  - I64_ARR and DBL_ARR, values.
+     * blobs are 8 bytes aligned and in breadth first order. an image is
+     * in the byte order of the machine that writes it. */
+    union Slot
+    {
+        uint8_t tag;
+
+        struct
+        {
+            uint8_t  tag;
+            uint8_t  siz; /* 1 + size */
+            char     raw[14];
+        } sht;            /* small string */
+
+        struct
+        {
+            uint8_t  tag;
+            uint8_t  lng; /* LONG for a string that is not small */
+            uint8_t  pad;
+            uint8_t  exp;
+            uint32_t siz;
+            uint64_t off;
+        } box;            /* long string, containers */
+
+        struct
+        {
+            uint8_t  tag;
+            uint8_t  pad[7];
+            int64_t  val;
+        } i64;
+
+        struct
+        {
+            uint8_t  tag;
+            uint8_t  pad[7];
+            double   val;
+        } dbl;
+    };
+
+    struct Head
+    {
+        char     magic[8];
+        uint32_t order;   /* 0x01020304 in the byte order of image */
+        uint32_t version;
+        uint64_t size;    /* bytes of the whole image              */
+        Slot     root;
+    };
+
+    /************************************************************************
+     * Writer
+    ************************************************************************/
+
+    /* writes `root` as an image to a stream that is open for writing and
+     * can seek. returns false if the stream failed. */
+    extern bool save(ast::Node<char> const & root, io::Stream & stream);
+
+    /************************************************************************
+     * Reader
+    ************************************************************************/
+
+    class Image;
+
+    /* a read only node in an image, a handle, copy it by value.
+     * accessors of values are errors if the type does not match, as those
+     * of `ast::Node`; navigation returns an empty one if there is no such
+     * node. */
+    class Ref
+    {
+    public:
+        Ref();
+
+    public:
+        bool            empty() const;
+        ast::Tag        type () const; /* NIL if empty                    */
+        size_t          size () const; /* of a container, or of a string */
+
+        int64_t         i64  () const;
+        double          dbl  () const;
+        char const    * str  () const; /* ends with '\0'                  */
+        int64_t const * i64s () const; /* values of I64_ARR               */
+        double  const * dbls () const; /* values of DBL_ARR               */
+
+        Ref at  (size_t index) const;  /* of SEQ, or value of MAP         */
+        Ref key (size_t index) const;  /* of MAP                          */
+        Ref find(char const * key) const;
+        Ref find(char const * key, size_t len) const;
+
+    private:
+        friend class Image;
+        Ref(Image const * image, Slot const * slot);
+
+        void const * blob(uint64_t bytes) const;
+        void         check(ast::Tag tag) const;
+        size_t       small() const; /* checked size of a small string */
+
+    private:
+        Image const * image_;
+        Slot  const * slot_;
+    };
+
+    /* a mapped image, which is read in place: nothing is parsed or built,
+     * pages are loaded when nodes on them are visited. */
+    class Image
+    {
+    public:
+        Image();
+        ~Image();
+
+    public:
+        /* maps a file, or reads it if it cannot be mapped */
+        bool open(char const * path);
+
+        /* refers to an image in memory, which is 8 bytes aligned and must
+         * live as long as this */
+        bool open(char const * data, size_t size);
+
+        void close();
+        bool is_open() const;
+
+        Ref    root() const;
+        size_t size() const;
+
+    private:
+        Image            (Image const &) /* = delete */;
+        Image & operator=(Image const &) /* = delete */;
+
+    private:
+        friend class Ref;
+        bool check() const;
+
+    private:
+        io::Stream * stream_; /* of a mapped file             */
+        uint64_t   * copy_;   /* of a file that is not mapped */
+        char const * base_;
+        size_t       size_;
+    };
+}
+
+CV_FS_PRIVATE_END
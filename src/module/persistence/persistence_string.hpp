@@ -496,11 +496,9 @@ namespace chars
     inline void Buffer<T, N, AtorType>::
         push_back(const_reference val)
     {
-        size_t old_siz = siz_;
-        siz_ += size_t(1);
-        reserve(siz_);
-
-        ptr_[old_siz] = val;
+        ValueType tmp = val; /* `val` may be in this buffer */
+        reserve(siz_ + size_t(1));
+        ptr_[siz_++] = tmp;
     }
 
     template<typename T, size_t N, template<typename> class AtorType>
@@ -0,0 +1,287 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include <cstring>
+#include "persistence_private.hpp"
+#include "persistence_utility.hpp"
+#include "persistence_tape.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ *  exception
+ ***************************************************************************/
+
+namespace exception
+{
+    using chars::Soss;
+    using chars::fmt;
+
+    inline static void index_out_of_range(size_t index, POS_TYPE_)
+    {
+        error(0,
+            ( Soss<char, 256>()
+                * "index `"
+                | fmt<32>(index)
+                | "` is out of range"
+            ), POS_ARGS_
+        );
+    }
+    inline static void invalid_key(const char * key, POS_TYPE_)
+    {
+        error(0,
+            ( Soss<char, 256>()
+                * "key `"
+                | fmt<128>(key)
+                | "` is invalid"
+            ), POS_ARGS_
+        );
+    }
+    inline static void type_not_match(
+        ast::Tag expected, ast::Tag get, POS_TYPE_)
+    {
+        error(0,
+            ( Soss<char, 256>()
+                * "expect filenode type `"
+                | fmt<64>(ast::to_string(expected))
+                | "`,  but get `"
+                | fmt<64>(ast::to_string(get))
+                | "`"
+            ), POS_ARGS_
+        );
+    }
+}
+
+/****************************************************************************
+ *  Document
+ ***************************************************************************/
+
+namespace tape
+{
+    const size_t   Document::MAX_SIZE;
+    const uint64_t Document::MAX_INDEX;
+
+    Document::Document()
+        : words_()
+        , chars_()
+    {}
+
+    Cursor Document::root() const
+    {
+        return empty() ? Cursor() : Cursor(*this, 0U);
+    }
+
+    bool Document::empty() const
+    {
+        return words_.empty();
+    }
+
+    void Document::clear()
+    {
+        words_.clear();
+        chars_.clear();
+    }
+
+    Document::Words const & Document::words() const
+    {
+        return words_;
+    }
+
+    Document::Chars const & Document::chars() const
+    {
+        return chars_;
+    }
+
+    ast::Tag Document::tag(uint64_t word)
+    {
+        return static_cast<ast::Tag>(word >> 56);
+    }
+
+    uint64_t Document::data(uint64_t word)
+    {
+        return word & ((uint64_t(1) << 56) - 1U);
+    }
+}
+
+/****************************************************************************
+ *  Builder
+ ***************************************************************************/
+
+namespace tape
+{
+    Builder::Builder(Document & document)
+        : doc_(document)
+        , open_()
+        , size_()
+        , str_(0)
+    {}
+}
+
+/****************************************************************************
+ *  Cursor
+ ***************************************************************************/
+
+namespace tape
+{
+    Cursor::Cursor()
+        : doc_(NULL)
+        , idx_(0)
+    {}
+
+    Cursor::Cursor(Document const & document, size_t index)
+        : doc_(&document)
+        , idx_(index)
+    {}
+
+    Cursor Cursor::operator[](size_t index) const
+    {
+        check(ast::SEQ);
+
+        size_t end = static_cast<size_t>(word(idx_) & Document::MAX_INDEX);
+        Cursor cur = first();
+        for (size_t i = index; i > 0 && cur.idx_ < end; --i)
+            cur = cur.next();
+        if (cur.idx_ >= end)
+            exception::index_out_of_range(index, POS_);
+        return cur;
+    }
+
+    Cursor Cursor::operator[](const char * key) const
+    {
+        if (key == NULL)
+            exception::null_argument("const char * key", POS_);
+
+        check(ast::MAP);
+        Cursor rv = find(key, ::strlen(key));
+        if (rv.doc_ == NULL)
+            exception::invalid_key(key, POS_);
+        return rv;
+    }
+
+    Cursor::operator int() const
+    {
+        check(ast::I64);
+        return static_cast<int>(static_cast<int64_t>(word(idx_ + 1U)));
+    }
+
+    Cursor::operator double() const
+    {
+        check(ast::DBL);
+        uint64_t bits = word(idx_ + 1U);
+        double   val  = 0.0;
+        ::memcpy(&val, &bits, sizeof(val));
+        return val;
+    }
+
+    Cursor::operator const char *() const
+    {
+        check(ast::STR);
+        size_t off = static_cast<size_t>(Document::data(word(idx_)));
+        return doc_->chars() + off + sizeof(uint32_t);
+    }
+
+    bool Cursor::empty() const
+    {
+        return type() == ast::NIL;
+    }
+
+    ast::Tag Cursor::type() const
+    {
+        return doc_ == NULL ? ast::NIL : Document::tag(word(idx_));
+    }
+
+    size_t Cursor::size() const
+    {
+        uint64_t w = doc_ == NULL ? 0U : word(idx_);
+        switch (type())
+        {
+        case ast::STR:
+        {
+            uint32_t siz = 0;
+            size_t   off = static_cast<size_t>(Document::data(w));
+            ::memcpy(&siz, doc_->chars() + off, sizeof(siz));
+            return siz;
+        }
+        case ast::SEQ:
+        case ast::MAP:
+        {
+            size_t siz = static_cast<size_t>(w >> 32 & Document::MAX_SIZE);
+            if (siz < Document::MAX_SIZE)
+                return siz;
+
+            /* too many to keep in the word */
+            size_t end = static_cast<size_t>(w & Document::MAX_INDEX);
+            siz = 0;
+            for (Cursor cur = first(); cur.idx_ < end; cur = cur.next())
+                ++siz;
+            return type() == ast::MAP ? siz >> 1 : siz;
+        }
+        default:
+        {
+            return 0;
+        }
+        }
+    }
+
+    Cursor Cursor::find(char const * key, size_t len) const
+    {
+        if (type() != ast::MAP || key == NULL)
+            return Cursor();
+
+        /* a linear walk, values are skipped by their words */
+        size_t end = static_cast<size_t>(word(idx_) & Document::MAX_INDEX);
+        for (Cursor cur = first(); cur.idx_ < end; ) {
+            Cursor val = cur.next();
+            if (cur.type() == ast::STR && cur.size() == len &&
+                ::memcmp(static_cast<char const *>(cur), key, len) == 0)
+                return val;
+            cur = val.next();
+        }
+        return Cursor();
+    }
+
+    Cursor Cursor::next() const
+    {
+        uint64_t w = word(idx_);
+        switch (Document::tag(w))
+        {
+        case ast::I64:
+        case ast::DBL:
+            return Cursor(*doc_, idx_ + 2U);
+        case ast::SEQ:
+        case ast::MAP:
+            return Cursor(*doc_, static_cast<size_t>(w & Document::MAX_INDEX));
+        default:
+            return Cursor(*doc_, idx_ + 1U);
+        }
+    }
+
+    Document const * Cursor::document() const
+    {
+        return doc_;
+    }
+
+    size_t Cursor::index() const
+    {
+        return idx_;
+    }
+
+    uint64_t Cursor::word(size_t index) const
+    {
+        return doc_->words()[index];
+    }
+
+    Cursor Cursor::first() const
+    {
+        return Cursor(*doc_, idx_ + 1U);
+    }
+
+    void Cursor::check(ast::Tag tag) const
+    {
+        if (type() != tag)
+            exception::type_not_match(tag, type(), POS_);
+    }
+}
+
+CV_FS_PRIVATE_END
@@ -0,0 +1,270 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+// TODO: define _HPP_
+#pragma once
+
+#include <cstring>
+#include "persistence_private.hpp"
+#include "persistence_string.hpp"
+#include "persistence_ast.hpp"
+#include "persistence_parser_json.hpp"
+
+CV_FS_PRIVATE_BEGIN
+
+/****************************************************************************
+ * tape
+ ***************************************************************************/
+
+namespace tape
+{
+    class Cursor;
+
+    /************************************************************************
+     * Document
+    ************************************************************************/
+
+    /* a read only document as one array of words in the order of input,
+     * and chars of strings aside. No pool is needed, the document is
+     * two buffers. A word is 8 bytes with tag in the highest byte:
+     *
+     *  NIL        [NIL]
+     *  I64, DBL   [tag][value]
+     *  STR        [STR | offset of chars], where chars are preceded by a
+     *             `uint32_t` of size and end with '\0'
+     *  SEQ, MAP   [tag | size << 32 | index of the word after the last
+     *             element], so a container is skipped in one step. Size
+     *             is of pairs for MAP, it is at most `MAX_SIZE`, or the
+     *             elements are counted.
+     *
+     * elements of MAP are key, value, key, value... */
+    class Document
+    {
+    public:
+        typedef chars::Buffer<uint64_t, 1, std::allocator> Words;
+        typedef chars::Buffer<char,     1, std::allocator> Chars;
+
+        static const size_t   MAX_SIZE  = 0xffffffU;
+        static const uint64_t MAX_INDEX = 0xffffffffU;
+
+    public:
+        Document();
+
+    public:
+        Cursor root() const;
+        bool   empty() const;
+        void   clear();
+
+        Words const & words() const;
+        Chars const & chars() const;
+
+        static ast::Tag tag (uint64_t word);
+        static uint64_t data(uint64_t word); /* lower 56 bits */
+
+    private:
+        Document            (Document const &) /* = delete */;
+        Document & operator=(Document const &) /* = delete */;
+
+    private:
+        friend class Builder;
+        Words words_;
+        Chars chars_;
+    };
+
+    /************************************************************************
+     * Builder
+    ************************************************************************/
+
+    /* makes a document from events of `parser::json::parse_events` */
+    class Builder : public parser::json::Handler<char>
+    {
+    public:
+        explicit Builder(Document & document);
+
+    public:
+        inline void map_beg() { open(ast::MAP); }
+        inline void map_end() { close(); }
+        inline void seq_beg() { open(ast::SEQ); }
+        inline void seq_end() { close(); }
+
+        inline void str_beg();
+        inline void str_end();
+        inline void str_val(char const * str, size_t len);
+        inline void str_ref(char       * str, size_t len);
+
+    public:
+        inline void on_nil();
+        inline void on_int(int64_t val);
+        inline void on_dbl(double  val);
+        inline void on_chr(char    ch);
+        inline void on_str(char const * str, size_t len);
+
+    private:
+        inline void open(ast::Tag tag);
+        inline void close();
+        inline void element();
+        inline void put(ast::Tag tag, uint64_t data);
+
+    private:
+        Builder            (Builder const &) /* = delete */;
+        Builder & operator=(Builder const &) /* = delete */;
+
+    private:
+        typedef chars::Buffer<size_t, 64, std::allocator> Stack;
+
+        Document & doc_;
+        Stack      open_;  /* words of containers not closed */
+        Stack      size_;  /* elements of them               */
+        size_t     str_;   /* size of the string being built */
+    };
+
+    /************************************************************************
+     * Cursor
+    ************************************************************************/
+
+    /* a word of a document, with the interface of `FileNode`. `operator[]`
+     * is an error if there is no such element, `find` is not. */
+    class Cursor
+    {
+    public:
+        Cursor();
+        Cursor(Document const & document, size_t index);
+
+    public:
+        Cursor operator [] (      size_t index) const;
+        Cursor operator [] (const char * key  ) const;
+
+        operator          int() const;
+        operator       double() const;
+        operator const char *() const;
+
+    public:
+        bool     empty() const; /* no word, or NIL */
+        ast::Tag type () const;
+        size_t   size () const; /* of SEQ, pairs of MAP, or chars of STR */
+
+        Cursor   find (char const * key, size_t len) const;
+        Cursor   next () const; /* the word after this value */
+
+        Document const * document() const;
+        size_t           index   () const;
+
+    private:
+        uint64_t word(size_t index) const;
+        Cursor   first() const;
+        void     check(ast::Tag tag) const;
+
+    private:
+        Document const * doc_;
+        size_t           idx_;
+    };
+
+    /************************************************************************
+     * Builder, inline
+    ************************************************************************/
+
+    inline void Builder::str_beg()
+    {
+        element();
+        uint32_t siz = 0;
+        put(ast::STR, doc_.chars_.size());
+        doc_.chars_.push_back(reinterpret_cast<char const *>(&siz),
+                              sizeof(siz));
+        str_ = 0;
+    }
+
+    inline void Builder::str_end()
+    {
+        /* size in front of chars */
+        uint32_t siz = static_cast<uint32_t>(str_);
+        char   * end = doc_.chars_.end();
+        ::memcpy(end - str_ - sizeof(siz), &siz, sizeof(siz));
+        doc_.chars_.push_back('\0');
+    }
+
+    inline void Builder::str_val(char const * str, size_t len)
+    {
+        str_beg();
+        on_str(str, len);
+        str_end();
+    }
+
+    inline void Builder::str_ref(char * str, size_t len)
+    {
+        str_val(str, len);
+    }
+
+    inline void Builder::on_nil()
+    {
+        element();
+        put(ast::NIL, 0);
+    }
+
+    inline void Builder::on_int(int64_t val)
+    {
+        element();
+        put(ast::I64, 0);
+        doc_.words_.push_back(static_cast<uint64_t>(val));
+    }
+
+    inline void Builder::on_dbl(double val)
+    {
+        uint64_t bits = 0;
+        ::memcpy(&bits, &val, sizeof(bits));
+        element();
+        put(ast::DBL, 0);
+        doc_.words_.push_back(bits);
+    }
+
+    inline void Builder::on_chr(char ch)
+    {
+        doc_.chars_.push_back(ch);
+        ++str_;
+    }
+
+    inline void Builder::on_str(char const * str, size_t len)
+    {
+        doc_.chars_.push_back(str, len);
+        str_ += len;
+    }
+
+    inline void Builder::open(ast::Tag tag)
+    {
+        element();
+        open_.push_back(doc_.words_.size());
+        size_.push_back(0);
+        put(tag, 0);
+    }
+
+    inline void Builder::close()
+    {
+        size_t   idx = open_.back();
+        uint64_t siz = size_.back();
+        uint64_t end = doc_.words_.size();
+        open_.pop_back();
+        size_.pop_back();
+
+        if (Document::tag(doc_.words_[idx]) == ast::MAP)
+            siz >>= 1; /* of pairs */
+        if (siz > Document::MAX_SIZE)
+            siz = Document::MAX_SIZE;
+        if (end > Document::MAX_INDEX)
+            exception::size_not_allowed(static_cast<size_t>(end), POS_);
+
+        doc_.words_[idx] |= siz << 32 | end;
+    }
+
+    inline void Builder::element()
+    {
+        if (!size_.empty())
+            ++size_.back();
+    }
+
+    inline void Builder::put(ast::Tag tag, uint64_t data)
+    {
+        doc_.words_.push_back(uint64_t(tag) << 56 | data);
+    }
+}
+
+CV_FS_PRIVATE_END
@@ -2,9 +2,15 @@
  *  license
  ***************************************************************************/
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 #include <type_traits>
 #include <gtest/gtest.h>
 #include "../persistence/persistence_ast.hpp"
+#include "../persistence/persistence_pool_shared.hpp"
 
 TEST(ast, basic)
 {
@@ -281,3 +287,300 @@ TEST(ast, map)
         str.destruct(pool);
     }
 }
+
+TEST(ast, map_index)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    /* FAllocator checks sizes of deallocation */
+    typedef storage::Pool<
+        utility::tl::MakeList<Node<char>, char>::type, storage::FAllocator
+    > Pool;
+
+    Pool pool;
+    Node<char> node;
+    node.construct<MAP>(pool);
+
+    const int count = 1000;
+    char buf[32];
+    for (int i = 0; i <= count; ++i) {
+        Node<char>::Pair pair;
+        int len = std::sprintf(buf, "key_%d", i % count);
+        pair[0].construct<STR>(pool);
+        pair[0].set<STR>(buf, buf + len, pool);
+        pair[1].construct<I64>(pool);
+        pair[1].set<I64>(i, pool);
+        node.move_back<MAP>(pair, pool);
+
+        if (i == count / 2) { /* search in the middle of building */
+            Node<char> key;
+            key.construct<STR>(pool);
+            key.set<STR>("key_7", "key_7" + 5, pool);
+            EXPECT_EQ((*node.find<MAP>(key, pool))[1].val<I64>(), 7);
+            key.destruct(pool);
+        }
+    }
+
+    Node<char> key;
+    key.construct<STR>(pool);
+    for (int i = 0; i < count; ++i) {
+        int len = std::sprintf(buf, "key_%d", i);
+        key.set<STR>(buf, buf + len, pool);
+        Node<char>::Pair * pair = node.find<MAP>(key, pool);
+        ASSERT_NE(pair, node.end<MAP>());
+        EXPECT_EQ((*pair)[1].val<I64>(), i); /* the first one of duplicates */
+    }
+
+    {   /* a number key */
+        Node<char>::Pair pair;
+        pair[0].construct<DBL>(pool);
+        pair[0].set<DBL>(-0.0, pool);
+        pair[1].construct<I64>(pool);
+        pair[1].set<I64>(-1, pool);
+        node.move_back<MAP>(pair, pool);
+
+        Node<char> num;
+        num.construct<DBL>(pool);
+        num.set<DBL>(0.0, pool);
+        EXPECT_EQ((*node.find<MAP>(num, pool))[1].val<I64>(), -1);
+        num.destruct(pool);
+    }
+
+    /* erase invalidates the index */
+    node.erase<MAP>(node.begin<MAP>(), node.begin<MAP>() + 10, pool);
+    key.set<STR>("key_0", "key_0" + 5, pool);
+    EXPECT_EQ((*node.find<MAP>(key, pool))[1].val<I64>(), count);
+    key.set<STR>("key_10", "key_10" + 6, pool);
+    EXPECT_EQ((*node.find<MAP>(key, pool))[1].val<I64>(), 10);
+    EXPECT_EQ((*node.find<MAP>(key))[1].val<I64>(), 10);
+    key.set<STR>("key_1", "key_1" + 5, pool);
+    EXPECT_EQ(node.find<MAP>(key, pool), node.end<MAP>());
+
+    {   /* copies are not indexed, but equal */
+        Node<char> other;
+        other.construct(pool);
+        other.copy(node, pool);
+        EXPECT_EQ(other.equal(node), true);
+        other.destruct(pool);
+    }
+
+    key.destruct(pool);
+    node.destruct(pool);
+}
+
+TEST(ast, arena)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    {   /* only the last block is given back */
+        storage::Arena<Node<char> > arena;
+        Node<char> * a = arena.allocate(3);
+        Node<char> * b = arena.allocate(5);
+        arena.deallocate(a, 3);
+        EXPECT_EQ(arena.allocate(1), b + 5);
+        Node<char> * c = arena.allocate(7);
+        arena.deallocate(c, 7);
+        EXPECT_EQ(arena.allocate(2), c);
+
+        /* large blocks don't break the current chunk */
+        Node<char> * d = arena.allocate(1U << 20);
+        EXPECT_TRUE(d != NULL);
+        EXPECT_EQ(arena.allocate(1), c + 2);
+
+        /* chunks are kept by reset */
+        arena.reset();
+        Node<char> * e = arena.allocate(1U << 20);
+        EXPECT_EQ(e, d);
+        arena.release();
+    }
+
+    Tree<char, ArenaPool> tree;
+    for (int round = 0; round < 3; ++round) {
+        Node<char> & root = tree.root();
+        root.construct<SEQ>(tree.pool());
+        char buf[32];
+        for (int i = 0; i < 10000; ++i) {
+            Node<char> node;
+            int len = std::sprintf(buf, "value_%d", i);
+            node.construct<STR>(tree.pool());
+            node.set<STR>(buf, buf + len, tree.pool());
+            root.move_back<SEQ>(node, tree.pool());
+        }
+        ASSERT_EQ(root.size<SEQ>(), 10000U);
+        EXPECT_EQ(std::string(root.at<SEQ>(9999)->raw<STR>()), "value_9999");
+
+        if (round == 0) {
+            tree.reset();
+        } else {
+            tree.clear();
+        }
+        EXPECT_EQ(tree.empty(), true);
+    }
+}
+
+TEST(ast, string_refer)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    /* FAllocator checks that nothing outside is deallocated */
+    typedef storage::Pool<
+        utility::tl::MakeList<Node<char>, char>::type, storage::FAllocator
+    > Pool;
+
+    Pool pool;
+    char text[] = "a string that is not in pool";
+    char * end = text + sizeof(text) - 1;
+
+    Node<char> node;
+    node.construct(pool);
+    node.refer(text, end, pool);
+    EXPECT_EQ(node.raw<STR>(), text);
+    EXPECT_EQ(node.size<STR>(), sizeof(text) - 1);
+
+    Node<char> copy;
+    copy.construct(pool);
+    copy.copy(node, pool);
+    EXPECT_NE(copy.raw<STR>(), text);
+    EXPECT_EQ(copy.equal(node), true);
+
+    /* growth moves it into pool */
+    node.push_back<STR>('!', pool);
+    EXPECT_NE(node.raw<STR>(), text);
+    EXPECT_EQ(std::string(node.raw<STR>()), std::string(text) + "!");
+
+    node.refer(text, text + 5, pool); /* short ones are copied */
+    EXPECT_EQ(std::string(node.raw<STR>()), "a str");
+    EXPECT_NE(node.raw<STR>(), text);
+
+    node.refer(text, end, pool);
+    node.destruct(pool);
+    copy.destruct(pool);
+    EXPECT_EQ(std::string(text), "a string that is not in pool");
+}
+
+TEST(ast, interner)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    Tree<char, ArenaPool> tree;
+    Interner<char> & keys = tree.keys();
+
+    std::string a = "coordinates_of_feature";
+    std::string b = a;
+    char * one = keys.intern(a.c_str(), a.size());
+    char * two = keys.intern(b.c_str(), b.size());
+    ASSERT_TRUE(one != NULL);
+    EXPECT_EQ(one, two);
+    EXPECT_NE(one, a.c_str());
+    EXPECT_EQ(std::string(one), a);
+    EXPECT_TRUE(keys.intern("short", 5) == NULL);
+    EXPECT_EQ(keys.saved(), a.size() + 1);
+
+    /* grows and keeps the shared copies */
+    char buf[64];
+    for (int i = 0; i < 1000; ++i) {
+        std::sprintf(buf, "a long key number %d", i);
+        keys.intern(buf, std::strlen(buf));
+    }
+    EXPECT_EQ(keys.size(), 1001U);
+    EXPECT_EQ(keys.intern(a.c_str(), a.size()), one);
+
+    /* keys that refer to one copy */
+    Node<char> & root = tree.root();
+    Node<char>::Pair pair;
+    for (int i = 0; i < 2; ++i) {
+        pair[0].construct(tree.pool());
+        pair[0].refer(one, one + a.size(), tree.pool());
+        pair[1].construct(tree.pool());
+        pair[1].set<I64>(i, tree.pool());
+        root.move_back<MAP>(pair, tree.pool());
+    }
+    EXPECT_EQ(root.at<MAP>(0)[0][0].raw<STR>(), one);
+    EXPECT_TRUE(root.find<MAP>(one, a.size()) == root.at<MAP>(0));
+    EXPECT_TRUE(root.find<MAP>(a.c_str(), a.size()) == root.at<MAP>(0));
+
+    tree.reset(); /* keys are kept */
+    EXPECT_EQ(keys.size(), 1001U);
+    tree.clear();
+    EXPECT_EQ(keys.size(), 0U);
+}
+
+namespace
+{
+    using CV_FS_PRIVATE_NS::ast::Node;
+    using CV_FS_PRIVATE_NS::ast::SharedPool;
+
+    /* builds a sequence of strings into `node`, which is freed first */
+    class Builder
+    {
+    public:
+        Builder(Node<char> & node, SharedPool & pool, int seed)
+            : node_(node), pool_(pool), seed_(seed)
+        {}
+
+        void operator()() const
+        {
+            using namespace CV_FS_PRIVATE_NS::ast;
+
+            node_.destruct(pool_);
+            node_.construct<SEQ>(pool_);
+            char buf[64];
+            for (int i = 0; i < 20000; ++i) {
+                Node<char> item;
+                int len = std::sprintf(buf, "shared_value_%d_%d", seed_, i);
+                item.construct<STR>(pool_);
+                item.set<STR>(buf, buf + len, pool_);
+                node_.move_back<SEQ>(item, pool_);
+            }
+        }
+
+    private:
+        Node<char> & node_;
+        SharedPool & pool_;
+        int          seed_;
+    };
+}
+
+TEST(ast, shared)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    const int threads = 4;
+    Tree<char, SharedPool> tree;
+    Node<char> & root = tree.root();
+    root.construct<SEQ>(tree.pool());
+    for (int i = 0; i < threads; ++i) {
+        Node<char> node;
+        node.construct(tree.pool());
+        root.move_back<SEQ>(node, tree.pool());
+    }
+
+    /* round 1 builds its own subtree, round 2 frees subtrees of others,
+     * round 3 takes the blocks back */
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            int which = (i + (round == 1 ? 1 : 0)) % threads;
+            workers.push_back(std::thread(Builder(
+                *root.at<SEQ>(which), tree.pool(), round * threads + which)));
+        }
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+
+        char buf[64];
+        for (int i = 0; i < threads; ++i) {
+            Node<char> & node = *root.at<SEQ>(i);
+            ASSERT_EQ(node.size<SEQ>(), 20000U);
+            std::sprintf(buf, "shared_value_%d_%d", round * threads + i, 19999);
+            EXPECT_EQ(std::string(node.at<SEQ>(19999)->raw<STR>()), buf);
+        }
+    }
+
+    tree.clear();
+    EXPECT_EQ(tree.empty(), true);
+}
@@ -0,0 +1,842 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../persistence/persistence_number.hpp"
+#include "../persistence/persistence_string.hpp"
+#include "../persistence/persistence_parser.hpp"
+#include "../persistence/persistence_parser_push.hpp"
+#include "../persistence/persistence_parser_builder.hpp"
+#include "../persistence/persistence_snapshot.hpp"
+#include "../persistence/persistence_tape.hpp"
+#include "../persistence/persistence.hpp"
+
+/* benchmarks take seconds and only print timings, so they are disabled.
+ * Run them with --gtest_also_run_disabled_tests --gtest_filter=benchmark.* */
+
+/****************************************************************************
+ * helper
+ ***************************************************************************/
+
+namespace
+{
+    /* wall time, as parsing may run on several threads */
+    class Timer
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+        Timer() : beg_(Clock::now()) {}
+        double ms() const
+        {
+            return std::chrono::duration<double, std::milli>
+                (Clock::now() - beg_).count();
+        }
+    private:
+        Clock::time_point beg_;
+    };
+
+    /* GeoJSON-like coordinates as in citylots, separated by ' ' */
+    std::string make_doubles(size_t count, std::vector<size_t> & offsets)
+    {
+        std::string rv;
+        std::srand(4399);
+        char buf[64];
+        for (size_t i = 0; i < count; ++i) {
+            double val = (std::rand() % 2 ? -1.0 : 1.0)
+                       * std::rand() / double(RAND_MAX) * 180.0;
+            std::sprintf(buf, "%.*f ", 1 + std::rand() % 15, val);
+            offsets.push_back(rv.size());
+            rv += buf;
+        }
+        rv.append(8, '\0'); /* room for SWAR loads */
+        return rv;
+    }
+}
+
+/****************************************************************************
+ * number
+ ***************************************************************************/
+
+namespace
+{
+    /* the former path of parse_number */
+    double legacy_number(char const * str)
+    {
+        uint64_t integral = 0, fractional = 0, fractional_length = 0;
+        bool negative = (*str == '-');
+        if (negative)
+            ++str;
+        for (; *str >= '0' && *str <= '9'; ++str)
+            integral = integral * 10 + uint64_t(*str - '0');
+        if (*str == '.')
+            for (++str; *str >= '0' && *str <= '9'; ++str, ++fractional_length)
+                fractional = fractional * 10 + uint64_t(*str - '0');
+        double var = static_cast<double>(integral);
+        if (fractional_length != 0)
+            var += static_cast<double>(fractional)
+                 / ::pow(10, static_cast<double>(fractional_length));
+        return negative ? -var : var;
+    }
+
+    /* the current path of parse_number, without the stream.
+     * Note: inputs have at most 19 significant digits. */
+    double decimal_number(char const * str)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        number::Decimal dec = number::Decimal();
+        dec.negative = (*str == '-');
+        if (dec.negative)
+            ++str;
+        for (; *str >= '0' && *str <= '9'; ++str)
+            dec.w = dec.w * 10 + uint64_t(*str - '0');
+        if (*str == '.') {
+            char const * beg = ++str;
+            for (; number::is_eight_digits(str); str += 8)
+                dec.w = dec.w * 100000000U + number::parse_eight_digits(str);
+            for (; *str >= '0' && *str <= '9'; ++str)
+                dec.w = dec.w * 10 + uint64_t(*str - '0');
+            dec.exp = -static_cast<int64_t>(str - beg);
+        }
+        return number::to_double(dec);
+    }
+}
+
+TEST(benchmark, DISABLED_number)
+{
+    std::vector<size_t> offsets;
+    std::string const input = make_doubles(1000000, offsets);
+    char const * const data = input.c_str();
+
+    double sum[2] = { 0.0, 0.0 };
+    double cost[2];
+    {
+        Timer timer;
+        for (size_t i = 0; i < offsets.size(); ++i)
+            sum[0] += legacy_number(data + offsets[i]);
+        cost[0] = timer.ms();
+    }
+    {
+        Timer timer;
+        for (size_t i = 0; i < offsets.size(); ++i)
+            sum[1] += decimal_number(data + offsets[i]);
+        cost[1] = timer.ms();
+    }
+
+    size_t wrong[2] = { 0, 0 };
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        double expect = std::strtod(data + offsets[i], NULL);
+        wrong[0] += legacy_number (data + offsets[i]) != expect ? 1 : 0;
+        wrong[1] += decimal_number(data + offsets[i]) != expect ? 1 : 0;
+    }
+
+    std::printf("number: %u doubles\n", unsigned(offsets.size()));
+    std::printf("  legacy : %8.2f ms, %u not correctly rounded\n",
+                cost[0], unsigned(wrong[0]));
+    std::printf("  current: %8.2f ms, %u not correctly rounded\n",
+                cost[1], unsigned(wrong[1]));
+    EXPECT_EQ(wrong[1], 0U);
+    EXPECT_NE(sum[0] + sum[1], 1.0); /* keep the loops */
+}
+
+TEST(benchmark, DISABLED_parse_number)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::vector<size_t> offsets;
+    std::string json = make_doubles(1000000, offsets);
+    json.resize(json.size() - 8);
+    for (size_t i = 1; i < offsets.size(); ++i)
+        json[offsets[i] - 1] = ',';
+    json = "[" + json + "]";
+
+    io::Stream * stream = io::Stream::build(io::STRING);
+    stream->open(json.c_str(), io::READ);
+
+    ast::Tree<char> tree;
+    parser::Message message;
+    Timer timer;
+    EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+    double cost = timer.ms();
+    delete stream;
+
+    std::printf("parse_number: %u doubles, %.2f MB in %.2f ms\n",
+                unsigned(offsets.size()), json.size() / 1048576.0, cost);
+    EXPECT_EQ(tree.root().size<ast::SEQ>(), offsets.size());
+}
+
+TEST(benchmark, DISABLED_parse_packed)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* points of polygons as in citylots, [[x, y], ...] */
+    std::vector<size_t> offsets;
+    std::string doubles = make_doubles(1000000, offsets);
+    std::string json = "[";
+    for (size_t i = 0; i + 1 < offsets.size(); i += 2) {
+        json += i == 0 ? "[" : ", [";
+        json.append(doubles, offsets[i], offsets[i + 1] - offsets[i] - 1);
+        json += ", ";
+        json.append(doubles.c_str() + offsets[i + 1],
+            std::strchr(doubles.c_str() + offsets[i + 1], ' '));
+        json += "]";
+    }
+    json += "]";
+
+    std::printf("parse_packed: %u points, %.2f MB\n",
+                unsigned(offsets.size() / 2), json.size() / 1048576.0);
+    for (int packed = 0; packed < 2; ++packed) {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        parser::Settings settings;
+        settings.enable_packed_array = packed != 0;
+
+        Timer timer;
+        {
+            ast::Tree<char, ast::ArenaPool> tree;
+            parser::Message message;
+            EXPECT_EQ(parser::json::parse(*stream, tree, message, settings),
+                      true);
+            EXPECT_EQ(tree.root().at<ast::SEQ>(0)->type(),
+                      packed ? ast::DBL_ARR : ast::SEQ);
+        }
+        double cost = timer.ms();
+        delete stream;
+
+        std::printf("  %s: %8.2f ms\n", packed ? "packed" : "nodes ", cost);
+    }
+}
+
+TEST(benchmark, DISABLED_parse_interning)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* GeoJSON-like features, keys repeat in every record */
+    std::string json = "[";
+    char buf[256];
+    size_t const count = 200000;
+    for (size_t i = 0; i < count; ++i) {
+        std::sprintf(buf,
+            "%s{\"type\": \"Feature\", \"properties\": {\"BLOCK_NUMBER\": "
+            "%u, \"STREET_NAME_AND_SUFFIX\": \"MARKET ST\", "
+            "\"LAST_MODIFIED_DATE\": \"2015-01-01\"}, \"geometry_type\": "
+            "\"Polygon\"}", i == 0 ? "" : ",\n", unsigned(i));
+        json += buf;
+    }
+    json += "]";
+
+    std::printf("parse_interning: %u features, %.2f MB\n",
+                unsigned(count), json.size() / 1048576.0);
+    for (int intern = 0; intern < 2; ++intern) {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        parser::Settings settings;
+        settings.enable_key_interning = intern != 0;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message, settings), true);
+        double cost = timer.ms();
+        delete stream;
+
+        std::printf("  %s: %8.2f ms\n", intern ? "interned" : "copied  ", cost);
+        if (intern)
+            tree.keys().report();
+    }
+}
+
+TEST(benchmark, DISABLED_parse_node_stack)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* arrays of all sizes, and maps that grow one pair at a time */
+    std::string json = "[";
+    char buf[64];
+    std::srand(4399);
+    for (size_t i = 0; i < 20000; ++i) {
+        json += i == 0 ? "{" : ", {";
+        size_t pairs = 1 + std::rand() % 24;
+        for (size_t k = 0; k < pairs; ++k) {
+            std::sprintf(buf, "%s\"k%u\": [", k == 0 ? "" : ", ", unsigned(k));
+            json += buf;
+            size_t items = std::rand() % 64;
+            for (size_t n = 0; n < items; ++n)
+                json += n == 0 ? "\"v\"" : ", \"v\"";
+            json += "]";
+        }
+        json += "}";
+    }
+    json += "]";
+
+    std::printf("parse_node_stack: %.2f MB\n", json.size() / 1048576.0);
+    for (int on = 0; on < 2; ++on) {
+        for (int arena = 0; arena < 2; ++arena) {
+            io::Stream * stream = io::Stream::build(io::STRING);
+            stream->open(json.c_str(), io::READ);
+
+            parser::Settings settings;
+            settings.enable_node_stack = on != 0;
+
+            parser::Message message;
+            Timer timer;
+            if (arena) {
+                ast::Tree<char, ast::ArenaPool> tree;
+                EXPECT_EQ(parser::json::parse(*stream, tree, message,
+                          settings), true);
+            } else {
+                ast::Tree<char> tree;
+                EXPECT_EQ(parser::json::parse(*stream, tree, message,
+                          settings), true);
+            }
+            double cost = timer.ms();
+            delete stream;
+
+            std::printf("  %s %s: %8.2f ms\n", on ? "stack " : "append",
+                        arena ? "arena" : "pool ", cost);
+        }
+    }
+}
+
+TEST(benchmark, DISABLED_parse_string)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* names and short texts, one in 16 has an escape */
+    std::string json = "[";
+    char buf[64];
+    size_t const count = 1000000;
+    for (size_t i = 0; i < count; ++i) {
+        std::sprintf(buf, "%s\"name_%u%s\"", i == 0 ? "" : ",",
+                     unsigned(i), i % 16 == 0 ? "\\n" : " of the string");
+        json += buf;
+    }
+    json += "]";
+
+    std::printf("parse_string: %u strings, %.2f MB\n",
+                unsigned(count), json.size() / 1048576.0);
+    for (int insitu = 0; insitu < 2; ++insitu) {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        parser::Settings settings;
+        settings.enable_insitu = insitu != 0;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message, settings), true);
+        double cost = timer.ms();
+        EXPECT_EQ(tree.root().size<ast::SEQ>(), count);
+        tree.clear();
+        delete stream;
+
+        std::printf("  %s: %8.2f ms\n", insitu ? "insitu" : "copied", cost);
+    }
+}
+
+TEST(benchmark, DISABLED_parse_parallel)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* citylots-like, a large array in the root object */
+    std::string json = "{\"type\": \"FeatureCollection\", \"features\": [";
+    char buf[256];
+    size_t const count = 200000;
+    std::srand(4399);
+    for (size_t i = 0; i < count; ++i) {
+        std::sprintf(buf,
+            "%s{\"type\": \"Feature\", \"properties\": {\"BLKLOT\": "
+            "\"%04u%03u\", \"STREET\": \"UNKNOWN\"}, \"geometry\": "
+            "{\"type\": \"Polygon\", \"coordinates\": "
+            "[[[-122.%06d, 37.%06d, 0.0], [-122.%06d, 37.%06d, 0.0]]]}}",
+            i == 0 ? "" : ",\n", unsigned(i % 10000), unsigned(i % 1000),
+            std::rand() % 1000000, std::rand() % 1000000,
+            std::rand() % 1000000, std::rand() % 1000000);
+        json += buf;
+    }
+    json += "]}";
+
+    std::printf("parse_parallel: %u features, %.2f MB\n",
+                unsigned(count), json.size() / 1048576.0);
+    size_t const threads[] = { 1, 2, 4, 0 };
+    for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); ++k) {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        parser::Settings settings;
+        settings.parallel_threads = threads[k];
+        settings.parallel_depth   = 1U;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message, settings), true);
+        double cost = timer.ms();
+        EXPECT_EQ(tree.root().at<ast::MAP>(1U)[0][1].size<ast::SEQ>(), count);
+        tree.clear();
+        delete stream;
+
+        std::printf("  threads %3s: %8.2f ms\n", threads[k] == 0 ? "all"
+                    : std::to_string(threads[k]).c_str(), cost);
+    }
+}
+
+TEST(benchmark, DISABLED_parse_records)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* log-like JSON lines, small records */
+    std::string json;
+    char buf[256];
+    size_t const count = 500000;
+    std::srand(4399);
+    for (size_t i = 0; i < count; ++i) {
+        std::sprintf(buf,
+            "{\"type\": \"event\", \"id\": %u, \"level\": \"info\", "
+            "\"took\": %d.%03d, \"tags\": [\"a\", \"b\"]}\n",
+            unsigned(i), std::rand() % 1000, std::rand() % 1000);
+        json += buf;
+    }
+
+    std::printf("parse_records: %u records, %.2f MB\n",
+                unsigned(count), json.size() / 1048576.0);
+    size_t const threads[] = { 1, 2, 4, 0 };
+    for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); ++k) {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        parser::Settings settings;
+        settings.parallel_threads = threads[k];
+
+        Timer timer;
+        size_t n = 0;
+        {
+            parser::json::RecordReader reader(*stream, settings);
+            while (reader.next())
+                ++n;
+        }
+        double cost = timer.ms();
+        EXPECT_EQ(n, count);
+        delete stream;
+
+        std::printf("  threads %3s: %8.2f ms\n", threads[k] == 0 ? "all"
+                    : std::to_string(threads[k]).c_str(), cost);
+    }
+}
+
+/****************************************************************************
+ * emitter
+ ***************************************************************************/
+
+TEST(benchmark, DISABLED_format)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::vector<size_t> offsets;
+    std::string const input = make_doubles(1000000, offsets);
+    std::vector<double> values;
+    for (size_t i = 0; i < offsets.size(); ++i)
+        values.push_back(std::strtod(input.c_str() + offsets[i], NULL));
+
+    size_t total[2] = { 0, 0 };
+    double cost [2];
+    {   /* the former formatter */
+        Timer timer;
+        char buf[30];
+        for (size_t i = 0; i < values.size(); ++i) {
+            chars::make_string(values[i], buf);
+            total[0] += chars::strlen(buf);
+        }
+        cost[0] = timer.ms();
+    }
+    {
+        Timer timer;
+        char buf[number::MAX_FORMAT_LENGTH];
+        for (size_t i = 0; i < values.size(); ++i)
+            total[1] += number::format(values[i], buf);
+        cost[1] = timer.ms();
+    }
+
+    std::printf("format: %u doubles\n", unsigned(values.size()));
+    std::printf("  legacy : %8.2f ms, %u chars\n", cost[0], unsigned(total[0]));
+    std::printf("  current: %8.2f ms, %u chars\n", cost[1], unsigned(total[1]));
+    EXPECT_LE(total[1], total[0]);
+}
+
+TEST(benchmark, DISABLED_emit_string)
+{
+    using namespace experimental;
+
+    /* mostly plain text with an escape now and then */
+    std::string text;
+    for (int i = 0; i < 64; ++i)
+        text += "plain text for the emitter, ";
+    text += "\"quoted\"\n";
+
+    size_t const count = 10000;
+    Timer timer;
+    {
+        FileStorage fs("benchmark_emit.json", FileStorage::WRITE);
+        fs << "[";
+        for (size_t i = 0; i < count; ++i)
+            fs << text.c_str();
+        fs << "]";
+        fs.release();
+    }
+    double cost = timer.ms();
+    std::remove("benchmark_emit.json");
+
+    std::printf("emit_string: %.2f MB in %.2f ms\n",
+                double(text.size() * count) / 1048576.0, cost);
+}
+
+TEST(benchmark, DISABLED_base64)
+{
+    using namespace experimental;
+
+    /* a matrix of 1000 x 1000 doubles, as text and as a block */
+    std::vector<double> mat(1000000);
+    std::srand(4399);
+    for (size_t i = 0; i < mat.size(); ++i)
+        mat[i] = std::rand() / double(RAND_MAX) * 180.0;
+
+    const char * queries[] = { "benchmark.json", "benchmark.json?base64" };
+    const char * names  [] = { "text", "base64" };
+    for (size_t q = 0; q < 2; ++q) {
+        Timer write;
+        {
+            FileStorage fs(queries[q], FileStorage::WRITE);
+            fs << "{" << "mat";
+            fs.write(&mat[0], mat.size());
+            fs << "}";
+            fs.release();
+        }
+        double cost = write.ms();
+
+        std::FILE * file = std::fopen("benchmark.json", "rb");
+        ASSERT_TRUE(file != NULL);
+        std::fseek(file, 0, SEEK_END);
+        long bytes = std::ftell(file);
+        std::fclose(file);
+
+        Timer read;
+        size_t size = 0U;
+        {
+            FileStorage fs("benchmark.json", FileStorage::READ);
+            EXPECT_TRUE(fs.root()["mat"].raw_dbl(size) != NULL);
+            fs.release();
+        }
+        EXPECT_EQ(size, mat.size());
+        std::printf("base64: %-6s %6.2f MB, write %8.2f ms, read %8.2f ms\n",
+                    names[q], bytes / 1048576.0, cost, read.ms());
+    }
+    std::remove("benchmark.json");
+}
+
+/****************************************************************************
+ * ast
+ ***************************************************************************/
+
+namespace
+{
+    /* `count` objects, 7 nodes each */
+    std::string make_objects(size_t count)
+    {
+        std::string rv = "[";
+        char buf[96];
+        for (size_t i = 0; i < count; ++i) {
+            std::sprintf(buf, "%s{\"id\":%u,\"tags\":[%u.5,\"name_%u\"]}",
+                         i == 0 ? "" : ",", unsigned(i), unsigned(i),
+                         unsigned(i));
+            rv += buf;
+        }
+        rv += "]";
+        return rv;
+    }
+}
+
+TEST(benchmark, DISABLED_release)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    size_t const counts[] = { 10000, 100000, 1000000 };
+    std::printf("release: %10s %12s %12s %12s\n",
+                "nodes", "walk (ms)", "pool (ms)", "arena (ms)");
+    for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); ++k) {
+        std::string const json = make_objects(counts[k]);
+        double cost[3];
+
+        /* [0] destruct node by node, [1] drop all chunks of the pool */
+        for (int way = 0; way < 2; ++way) {
+            io::Stream * stream = io::Stream::build(io::STRING);
+            stream->open(json.c_str(), io::READ);
+            ast::Tree<char> tree;
+            parser::Message message;
+            EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+            delete stream;
+
+            Timer timer;
+            if (way == 0)
+                tree.root().destruct(tree.pool());
+            tree.clear();
+            cost[way] = timer.ms();
+            EXPECT_EQ(tree.empty(), true);
+        }
+
+        {   /* the way FileStorage does */
+            experimental::FileStorage fs
+                ( json.c_str()
+                , experimental::FileStorage::READ
+                | experimental::FileStorage::MEMORY
+                , experimental::FileStorage::JSON
+                );
+            Timer timer;
+            fs.release();
+            cost[2] = timer.ms();
+            EXPECT_EQ(fs.isOpen(), false);
+        }
+
+        std::printf("         %10u %12.2f %12.2f %12.2f\n",
+                    unsigned(counts[k] * 7 + 1), cost[0], cost[1], cost[2]);
+    }
+}
+
+TEST(benchmark, DISABLED_parse_push)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    typedef parser::json::Builder<char, ast::ArenaPool> Builder;
+
+    std::string const json = make_objects(1000000);
+    std::printf("parse_push: %.2f MB\n", json.size() / 1048576.0);
+
+    {   /* the whole text at once */
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+        std::printf("  %-12s %8.2f ms\n", "parse", timer.ms());
+        delete stream;
+    }
+
+    size_t const slices[] = { 1024U, 4096U, 65536U };
+    for (size_t k = 0; k < sizeof(slices) / sizeof(slices[0]); ++k) {
+        ast::Tree<char, ast::ArenaPool> tree;
+        Builder builder(tree);
+        parser::json::PushParser<Builder> push(builder);
+        Timer timer;
+        for (size_t i = 0; i < json.size(); i += slices[k]) {
+            size_t size = json.size() - i;
+            push.feed(json.data() + i, size < slices[k] ? size : slices[k]);
+        }
+        EXPECT_EQ(push.finish(), true);
+        std::printf("  push %-7u %8.2f ms\n", unsigned(slices[k]), timer.ms());
+    }
+}
+
+/****************************************************************************
+ * snapshot
+ ***************************************************************************/
+
+namespace
+{
+    /* visits all nodes of an image, and sums up ids */
+    int64_t walk(CV_FS_PRIVATE_NS::snapshot::Ref ref)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        int64_t sum = 0;
+        switch (ref.type())
+        {
+        case ast::I64: return ref.i64();
+        case ast::SEQ:
+        case ast::MAP:
+            for (size_t i = 0; i < ref.size(); ++i)
+                sum += walk(ref.at(i));
+            return sum;
+        default:
+            return 0;
+        }
+    }
+}
+
+TEST(benchmark, DISABLED_snapshot)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    size_t const count = 1000000;
+    std::string const json = make_objects(count);
+    std::printf("snapshot: %.2f MB\n", json.size() / 1048576.0);
+
+    {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+        std::printf("  %-12s %8.2f ms\n", "parse", timer.ms());
+        delete stream;
+
+        stream = io::Stream::build(io::FILE);
+        stream->open("snapshot.bin", io::WRITE);
+        timer = Timer();
+        EXPECT_EQ(snapshot::save(tree.root(), *stream), true);
+        delete stream;
+        std::printf("  %-12s %8.2f ms\n", "save", timer.ms());
+    }
+
+    Timer timer;
+    snapshot::Image image;
+    EXPECT_EQ(image.open("snapshot.bin"), true);
+    std::printf("  %-12s %8.2f ms, %.2f MB\n", "open", timer.ms(),
+                image.size() / 1048576.0);
+    timer = Timer();
+    int64_t sum = walk(image.root());
+    std::printf("  %-12s %8.2f ms\n", "walk", timer.ms());
+    EXPECT_EQ(sum, int64_t(count) * int64_t(count - 1) / 2);
+    image.close();
+    std::remove("snapshot.bin");
+}
+
+/****************************************************************************
+ * tape
+ ***************************************************************************/
+
+namespace
+{
+    /* visits all words of a tape, and sums up ids */
+    int64_t walk(CV_FS_PRIVATE_NS::tape::Cursor cur)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        int64_t sum = 0;
+        switch (cur.type())
+        {
+        case ast::I64: return (int)cur;
+        case ast::SEQ:
+        case ast::MAP:
+        {
+            tape::Cursor end = cur.next();
+            for (cur = tape::Cursor(*cur.document(), cur.index() + 1U);
+                 cur.index() < end.index(); cur = cur.next())
+                sum += walk(cur);
+            return sum;
+        }
+        default:
+            return 0;
+        }
+    }
+}
+
+TEST(benchmark, DISABLED_tape)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    size_t const count = 1000000;
+    std::string const json = make_objects(count);
+    std::printf("tape: %.2f MB\n", json.size() / 1048576.0);
+
+    io::Stream * stream = io::Stream::build(io::STRING);
+    parser::Message message;
+    {
+        stream->open(json.c_str(), io::READ);
+        ast::Tree<char, ast::ArenaPool> tree;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+        std::printf("  %-12s %8.2f ms\n", "tree", timer.ms());
+        timer = Timer();
+        tree.clear();
+        std::printf("  %-12s %8.2f ms\n", "tree clear", timer.ms());
+    }
+    {
+        stream->open(json.c_str(), io::READ);
+        tape::Document doc;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, doc, message), true);
+        std::printf("  %-12s %8.2f ms, %.2f MB\n", "tape", timer.ms(),
+                    (doc.words().size() * 8U + doc.chars().size())
+                    / 1048576.0);
+        timer = Timer();
+        int64_t sum = walk(doc.root());
+        std::printf("  %-12s %8.2f ms\n", "tape walk", timer.ms());
+        EXPECT_EQ(sum, int64_t(count) * int64_t(count - 1) / 2);
+        timer = Timer();
+        doc.clear();
+        std::printf("  %-12s %8.2f ms\n", "tape clear", timer.ms());
+    }
+    delete stream;
+}
+
+/****************************************************************************
+ * lazy
+ ***************************************************************************/
+
+TEST(benchmark, DISABLED_lazy)
+{
+    using namespace experimental;
+
+    /* a model file, of which only a few paths are read */
+    {
+        std::string const json = make_objects(1000000);
+        std::FILE * file = std::fopen("lazy.json", "wb");
+        ASSERT_TRUE(file != NULL);
+        std::fprintf(file, "{\"meta\": {\"version\": 3}, \"layers\": [");
+        for (int i = 0; i < 4; ++i)
+            std::fprintf(file, "%s%s", i ? ", " : "", json.c_str());
+        std::fprintf(file, "]}");
+        std::printf("lazy: %.2f MB\n", json.size() * 4 / 1048576.0);
+        std::fclose(file);
+    }
+
+    const char * queries[] = { "lazy.json", "lazy.json?lazy" };
+    for (size_t i = 0; i < 2; ++i) {
+        Timer timer;
+        FileStorage fs(queries[i], FileStorage::READ);
+        EXPECT_EQ((int)fs.root()["meta"]["version"], 3);
+        std::printf("  %-16s %8.2f ms\n", queries[i], timer.ms());
+        EXPECT_EQ((int)fs.root()["layers"][2][size_t(7)]["id"], 7);
+        std::printf("  %-16s %8.2f ms\n", "  and a layer", timer.ms());
+    }
+    std::remove("lazy.json");
+}
+
+/****************************************************************************
+ * query
+ ***************************************************************************/
+
+TEST(benchmark, DISABLED_query)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string const json = make_objects(1000000);
+    std::printf("query: %.2f MB\n", json.size() / 1048576.0);
+
+    const char * paths[] = { "", "/*/id", "/*/tags/1", "/500000" };
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+        parser::json::Query query;
+        query.add(paths[i]);
+
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        ast::Tree<char, ast::ArenaPool> tree;
+        parser::Message message;
+        Timer timer;
+        EXPECT_EQ(parser::json::parse(*stream, tree, query, message), true);
+        std::printf("  %-12s %8.2f ms\n", *paths[i] ? paths[i] : "\"\"",
+                    timer.ms());
+        delete stream;
+    }
+}
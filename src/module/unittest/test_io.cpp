@@ -2,8 +2,15 @@
  *  license
  ***************************************************************************/
 
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include "../persistence/persistence.hpp"
+#include "../persistence/persistence_io.hpp"
+#include "../persistence/persistence_parser.hpp"
+#include "../persistence/persistence_snapshot.hpp"
 
 TEST(io, input)
 {
@@ -61,4 +68,605 @@ TEST(io, memory)
 
     EXPECT_EQ((int)root["12345678901234"], 1);
     fs.release();
+
+    /* the copy of input is a view, which ends right after a value */
+    char const * const cases[] =
+    {
+        "{\"a\":1}", "{\"a\": \"text\"}", "{\"a\": [1, 2.5]}  \n",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        FileStorage view
+        (
+            cases[i],
+            FileStorage::READ | FileStorage::MEMORY,
+            FileStorage::AUTO
+        );
+        EXPECT_EQ(view.root()["a"].empty(), false) << cases[i];
+        view.release();
+    }
+}
+
+TEST(io, filenode)
+{
+    using namespace experimental;
+
+    /* enough keys to build an index of map */
+    std::string json = "{\"list\": [1, 2.5, \"three\"]";
+    for (int i = 0; i < 64; ++i) {
+        char buf[64];
+        std::sprintf(buf, ", \"key_%d\": %d", i, i);
+        json += buf;
+    }
+    json += ", \"key_0\": -1}";
+
+    FileStorage fs
+    (
+        json.c_str(),
+        FileStorage::READ | FileStorage::MEMORY,
+        FileStorage::AUTO
+    );
+    FileNode root = fs.root();
+    FileNode list = root["list"];
+    FileNode copy;
+    copy = list;
+
+    EXPECT_EQ(list.empty(), false);
+    EXPECT_EQ(FileNode().empty(), true);
+    EXPECT_EQ((int)copy[size_t(0)], 1);
+    EXPECT_EQ((double)list[1], 2.5);
+    EXPECT_EQ(std::string((const char *)list[2]), "three");
+    for (int i = 0; i < 64; ++i) {
+        char buf[64];
+        std::sprintf(buf, "key_%d", i);
+        EXPECT_EQ((int)root[buf], i);
+    }
+    fs.release();
+}
+
+TEST(io, packed)
+{
+    using namespace experimental;
+
+    FileStorage fs
+    (
+        "{\"i\": [1, 2, 3], \"d\": [0.5, 1.5], \"s\": [1, \"2\"]}",
+        FileStorage::READ | FileStorage::MEMORY,
+        FileStorage::AUTO
+    );
+    FileNode root = fs.root();
+
+    size_t size = 0U;
+    const int64_t * i = root["i"].raw_i64(size);
+    ASSERT_TRUE(i != NULL);
+    EXPECT_EQ(size, 3U);
+    EXPECT_EQ(i[2], 3);
+    EXPECT_EQ((int)root["i"][2], 3);
+    EXPECT_TRUE(root["i"].raw_dbl(size) == NULL);
+    EXPECT_EQ(size, 0U);
+
+    const double * d = root["d"].raw_dbl(size);
+    ASSERT_TRUE(d != NULL);
+    EXPECT_EQ(size, 2U);
+    EXPECT_EQ(d[1], 1.5);
+    EXPECT_EQ((double)root["d"][size_t(0)], 0.5);
+    EXPECT_EQ(root["d"][1].empty(), false);
+    EXPECT_TRUE(root["d"][1].raw_dbl(size) == NULL);
+
+    EXPECT_TRUE(root["s"].raw_i64(size) == NULL);
+    EXPECT_EQ((int)root["s"][size_t(0)], 1);
+    fs.release();
+}
+
+TEST(io, base64)
+{
+    using namespace experimental;
+
+    /* sizes of 0, 1, 2, 3 values leave 0, 2, 1, 0 bytes of padding */
+    std::vector<int64_t> i64s;
+    std::vector<double>  dbls;
+    for (int i = 0; i < 1000; ++i) {
+        i64s.push_back((int64_t(i) << 40) - i * 7);
+        dbls.push_back(i % 3 ? 1.0 / (i + 1) : -1e300 * i);
+    }
+
+    const char * queries[] = { "base64.json", "base64.json?base64" };
+    size_t       sizes  [2];
+    for (size_t q = 0; q < 2; ++q) {
+        {
+            FileStorage fs(queries[q], FileStorage::WRITE);
+            fs << "{";
+            for (size_t n = 0; n < 4; ++n) {
+                char key[16];
+                std::sprintf(key, "i%u", unsigned(n));
+                fs << key;
+                fs.write(&i64s[0], n);
+                std::sprintf(key, "d%u", unsigned(n));
+                fs << key;
+                fs.write(&dbls[0], n);
+            }
+            fs << "i" ; fs.write(&i64s[0], i64s.size());
+            fs << "d" ; fs.write(&dbls[0], dbls.size());
+            fs << "s" << "$base64$ is only a string";
+            fs << "}";
+            fs.release();
+        }
+
+        std::FILE * file = std::fopen("base64.json", "rb");
+        ASSERT_TRUE(file != NULL);
+        std::fseek(file, 0, SEEK_END);
+        sizes[q] = static_cast<size_t>(std::ftell(file));
+        std::fclose(file);
+
+        FileStorage fs("base64.json", FileStorage::READ);
+        FileNode root = fs.root();
+        for (size_t n = 0; n < 4; ++n) {
+            char key[16];
+            size_t size = 0U;
+            std::sprintf(key, "i%u", unsigned(n));
+            const int64_t * i = root[key].raw_i64(size);
+            if (n != 0) { /* no values, no buffer */
+                ASSERT_TRUE(i != NULL);
+                EXPECT_EQ(size, n);
+                EXPECT_TRUE(std::equal(i, i + n, i64s.begin()));
+            }
+            std::sprintf(key, "d%u", unsigned(n));
+            const double * d = root[key].raw_dbl(size);
+            if (n != 0) {
+                ASSERT_TRUE(d != NULL);
+                EXPECT_EQ(size, n);
+                EXPECT_TRUE(std::equal(d, d + n, dbls.begin()));
+            }
+        }
+
+        size_t size = 0U;
+        const int64_t * i = root["i"].raw_i64(size);
+        ASSERT_TRUE(i != NULL);
+        EXPECT_EQ(size, i64s.size());
+        EXPECT_TRUE(std::equal(i, i + size, i64s.begin()));
+        EXPECT_EQ((int)root["i"][2], (int)i64s[2]);
+
+        const double * d = root["d"].raw_dbl(size);
+        ASSERT_TRUE(d != NULL);
+        EXPECT_EQ(size, dbls.size());
+        EXPECT_TRUE(std::equal(d, d + size, dbls.begin()));
+
+        EXPECT_EQ(std::string((const char *)root["s"]),
+                  "$base64$ is only a string");
+        fs.release();
+    }
+    EXPECT_LT(sizes[1], sizes[0]);
+
+    /* a broken block is kept as a string */
+    FileStorage fs
+    (
+        "{\"a\": \"$base64$bAABAAAA\","
+        " \"b\": \"$base64$bAABAAAAAQ*AAAAAAAA=\"}",
+        FileStorage::READ | FileStorage::MEMORY
+    );
+    EXPECT_EQ(std::string((const char *)fs.root()["a"]), "$base64$bAABAAAA");
+    EXPECT_EQ(std::string((const char *)fs.root()["b"]),
+              "$base64$bAABAAAAAQ*AAAAAAAA=");
+    fs.release();
+    std::remove("base64.json");
+}
+
+TEST(io, output_escape)
+{
+    using namespace experimental;
+
+    std::string plain(100000, 'x');       /* larger than the buffer */
+    std::string special = "a\"b\\c\nd\te\rf\bg\fh/";
+    {
+        FileStorage fs("escape.json", FileStorage::WRITE);
+        fs << "[" << plain.c_str() << special.c_str() << "\x01\x7f" << "]";
+        fs.release();
+    }
+
+    std::string json;
+    {
+        std::FILE * file = std::fopen("escape.json", "rb");
+        ASSERT_TRUE(file != NULL);
+        char buf[4096];
+        for (size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) != 0;)
+            json.append(buf, n);
+        std::fclose(file);
+    }
+    EXPECT_EQ(json.size(), plain.size() + 45U);
+    EXPECT_NE(json.find("\"a\\\"b\\\\c\\nd\\te\\rf\\bg\\fh/\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"\\u0001\\u007f\""), std::string::npos);
+
+    /* copied, and unescaped in place */
+    const char * queries[] = { "escape.json", "escape.json?insitu" };
+    for (size_t i = 0; i < 2; ++i) {
+        FileStorage fs(queries[i], FileStorage::READ);
+        FileNode root = fs.root();
+        EXPECT_EQ(std::string((const char *)root[size_t(0)]), plain);
+        EXPECT_EQ(std::string((const char *)root[size_t(1)]), special);
+        fs.release();
+    }
+    std::remove("escape.json");
+}
+
+TEST(io, insitu)
+{
+    using namespace experimental;
+
+    /* memory mode refers to its own copy of input */
+    std::string json = "{\"short\": \"s\", \"long\": \"";
+    std::string text;
+    for (int i = 0; i < 100; ++i)
+        text += i % 10 ? "abcdefgh" : "\n\"\t";
+    for (size_t i = 0; i < text.size(); ++i)
+        json += text[i] == '\n' ? "\\n" : text[i] == '"'  ? "\\\""
+              : text[i] == '\t' ? "\\t" : std::string(1, text[i]);
+    json += "\", \"keys are strings too, long enough\": 1}";
+
+    FileStorage fs(json.c_str(), FileStorage::READ | FileStorage::MEMORY);
+    FileNode root = fs.root();
+    EXPECT_EQ(std::string((const char *)root["short"]), "s");
+    EXPECT_EQ(std::string((const char *)root["long"]), text);
+    EXPECT_EQ((int)root["keys are strings too, long enough"], 1);
+    fs.release();
+}
+
+TEST(io, records)
+{
+    using namespace experimental;
+
+    {
+        std::FILE * file = std::fopen("records.json", "wb");
+        ASSERT_TRUE(file != NULL);
+        for (int i = 0; i < 1000; ++i)
+            std::fprintf(file, "{\"id\": %d, \"tag\": \"t%d\"}\n", i, i);
+        std::fclose(file);
+    }
+
+    const char * queries[] = { "records.json?records",
+                               "records.json?records&threads=2" };
+    for (size_t i = 0; i < 2; ++i) {
+        FileStorage fs(queries[i], FileStorage::READ);
+        EXPECT_EQ(fs.isOpen(), true);
+        EXPECT_EQ((int)fs.root()["id"], 0);
+        for (int k = 1; k < 1000; k += 3) {
+            FileNode record = fs.root(k);
+            char tag[16];
+            std::sprintf(tag, "t%d", k);
+            EXPECT_EQ((int)record["id"], k);
+            EXPECT_EQ(std::string((const char *)record["tag"]), tag);
+        }
+        EXPECT_EQ(fs.root(1000).empty(), true);
+        fs.release();
+    }
+    std::remove("records.json");
+}
+
+TEST(io, tape)
+{
+    using namespace experimental;
+
+    {
+        std::FILE * file = std::fopen("tape.json", "wb");
+        ASSERT_TRUE(file != NULL);
+        std::fprintf(file, "{\"list\": [1, 2.5, \"three\", null, []]");
+        for (int i = 0; i < 64; ++i)
+            std::fprintf(file, ", \"key_%d\": {\"id\": %d}", i, i);
+        std::fprintf(file, "}");
+        std::fclose(file);
+    }
+
+    FileStorage fs("tape.json?tape", FileStorage::READ);
+    EXPECT_EQ(fs.isOpen(), true);
+    FileNode root = fs.root();
+    FileNode list = root["list"];
+    EXPECT_EQ((int)list[size_t(0)], 1);
+    EXPECT_EQ((double)list[1], 2.5);
+    EXPECT_EQ(std::string((const char *)list[2]), "three");
+    EXPECT_EQ(list[3].empty(), true);
+    EXPECT_EQ(list[4].empty(), false);
+    for (int i = 0; i < 64; ++i) {
+        char buf[64];
+        std::sprintf(buf, "key_%d", i);
+        EXPECT_EQ((int)root[buf]["id"], i);
+    }
+    size_t size = 1;
+    EXPECT_TRUE(list.raw_i64(size) == NULL);
+    EXPECT_EQ(size, 0U);
+    fs.release();
+    EXPECT_EQ(fs.isOpen(), false);
+    std::remove("tape.json");
+}
+
+TEST(io, lazy)
+{
+    using namespace experimental;
+
+    {
+        std::FILE * file = std::fopen("lazy.json", "wb");
+        ASSERT_TRUE(file != NULL);
+        std::fprintf(file, "{\"list\": [1, 2.5, \"three\"], \"big\": [");
+        for (int i = 0; i < 2000; ++i)
+            std::fprintf(file, "%s{\"id\": %d, \"v\": [%d, %d]}",
+                         i ? ", " : "", i, i, -i);
+        std::fprintf(file, "], \"numbers\": [");
+        for (int i = 0; i < 2000; ++i)
+            std::fprintf(file, "%s%d", i ? ", " : "", i);
+        std::fprintf(file, "]}");
+        std::fclose(file);
+    }
+
+    FileStorage fs("lazy.json?lazy", FileStorage::READ);
+    EXPECT_EQ(fs.isOpen(), true);
+    FileNode root = fs.root();
+    EXPECT_EQ(root.empty(), false);
+    EXPECT_EQ((double)root["list"][1], 2.5);
+    EXPECT_EQ(std::string((const char *)root["list"][2]), "three");
+
+    FileNode big = root["big"];
+    EXPECT_EQ(big.empty(), false);
+    for (int i = 0; i < 2000; i += 7) {
+        EXPECT_EQ((int)big[i]["id"], i);
+        EXPECT_EQ((int)big[i]["v"][1], -i);
+    }
+
+    size_t size = 0;
+    const int64_t * numbers = root["numbers"].raw_i64(size);
+    ASSERT_TRUE(numbers != NULL);
+    EXPECT_EQ(size, 2000U);
+    EXPECT_EQ(numbers[1999], 1999);
+    fs.release();
+    EXPECT_EQ(fs.isOpen(), false);
+    std::remove("lazy.json");
+}
+
+TEST(io, lazy_indexed)
+{
+    using namespace experimental;
+
+    /* maps of 16 pairs or more are indexed by the first lookup of a key,
+     * and their pairs move then */
+    {
+        std::FILE * file = std::fopen("lazy_indexed.json", "wb");
+        ASSERT_TRUE(file != NULL);
+        std::fprintf(file, "{");
+        for (int k = 0; k < 20; ++k) {
+            std::fprintf(file, "%s\"k%d\": ", k ? ", " : "", k);
+            if (k % 6 != 5) {
+                std::fprintf(file, "%d", k);
+                continue;
+            }
+            std::fprintf(file, "[");
+            for (int i = 0; i < 500; ++i)
+                std::fprintf(file, "%s{\"id\": %d}", i ? ", " : "", i + k);
+            std::fprintf(file, "]");
+        }
+        std::fprintf(file, "}");
+        std::fclose(file);
+    }
+
+    {
+        FileStorage fs("lazy_indexed.json?lazy", FileStorage::READ);
+        FileNode root = fs.root();
+        EXPECT_EQ((int)root["k0"], 0);
+        EXPECT_EQ((int)root["k19"], 19);
+        for (int k = 5; k < 20; k += 6) {
+            char key[8];
+            std::sprintf(key, "k%d", k);
+            EXPECT_EQ((int)root[key][499]["id"], 499 + k);
+            EXPECT_EQ((int)root[key][10]["id"], 10 + k);
+        }
+        fs.release();
+    }
+    std::remove("lazy_indexed.json");
+}
+
+namespace
+{
+    /* closes a stream and removes its file on every path, even if an
+     * assertion returns early */
+    struct Cleanup
+    {
+        const char * name;
+        CV_FS_PRIVATE_NS::io::Stream * stream;
+        ~Cleanup() { delete stream; std::remove(name); }
+    };
+}
+
+/* the gap of a file is filled with zeros on NTFS unless the file is
+ * marked sparse, so 4.5G would be written by every run. Run it with
+ * --gtest_also_run_disabled_tests there. */
+#ifdef _WIN32
+#define IO_LARGE_FILE DISABLED_large_file
+#else
+#define IO_LARGE_FILE large_file
+#endif
+
+TEST(io, IO_LARGE_FILE)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* a sparse file of more than 4G, only the tail is written */
+    const io::Stream::Pos size = (io::Stream::Pos(9) << 29) + 7;
+    Cleanup guard = { "large.json", NULL };
+    {
+        guard.stream = io::Stream::build(io::FILE);
+        ASSERT_TRUE(guard.stream->open("large.json", io::WRITE));
+        io::Stream * stream = guard.stream;
+        stream->seek(size - 7, io::BEG);
+        EXPECT_EQ(stream->tell(), size - 7);
+        EXPECT_EQ(stream->write("[1, 2]\n", 7), 7U);
+        EXPECT_EQ(stream->tell(), size);
+        stream->close();
+    }
+    {
+        ASSERT_TRUE(guard.stream->open("large.json", io::READ));
+        io::Stream * stream = guard.stream;
+        stream->seek(0, io::END);
+        EXPECT_EQ(stream->tell(), size);
+        stream->seek(-7, io::END);
+        char buf[8] = { 0 };
+        EXPECT_EQ(stream->read(buf, 7), 7U);
+        EXPECT_EQ(std::string(buf), "[1, 2]\n");
+    }
+}
+
+TEST(io, dump)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* dump reads the whole file, and keeps the position */
+    Cleanup guard = { "dump.json", io::Stream::build(io::FILE) };
+    io::Stream * stream = guard.stream;
+    ASSERT_TRUE(stream->open("dump.json", io::WRITE));
+    stream->write("[1, 2]\n", 7);
+    stream->close();
+    ASSERT_TRUE(stream->open("dump.json", io::READ));
+    stream->seek(3, io::BEG);
+    io::Buffer buffer = stream->dump();
+    EXPECT_EQ(std::string(buffer.begin(), buffer.size()), "[1, 2]\n");
+    EXPECT_EQ(stream->tell(), 3);
+}
+
+namespace
+{
+    using CV_FS_PRIVATE_NS::ast::Node;
+    using CV_FS_PRIVATE_NS::snapshot::Ref;
+
+    /* a node of tree and the one in image are the same */
+    bool same(Node<char> const & node, Ref ref)
+    {
+        using namespace CV_FS_PRIVATE_NS::ast;
+
+        if (ref.type() != node.type())
+            return false;
+        switch (node.type())
+        {
+        case I64: return ref.i64() == node.val<I64>();
+        case DBL: return ref.dbl() == node.val<DBL>();
+        case STR: return ref.size() == node.size<STR>()
+                      && std::string(ref.str()) == node.raw<STR>();
+        case SEQ:
+            if (ref.size() != node.size<SEQ>())
+                return false;
+            for (size_t i = 0; i < ref.size(); ++i)
+                if (!same(*node.at<SEQ>(Node<char>::size_type(i)), ref.at(i)))
+                    return false;
+            return true;
+        case MAP:
+            if (ref.size() != node.size<MAP>())
+                return false;
+            for (size_t i = 0; i < ref.size(); ++i) {
+                Node<char>::Pair const & pair
+                    = *node.at<MAP>(Node<char>::size_type(i));
+                if (!same(pair[0], ref.key(i)) || !same(pair[1], ref.at(i)))
+                    return false;
+                if (ref.find(pair[0].raw<STR>()).type() != pair[1].type())
+                    return false;
+            }
+            return true;
+        case I64_ARR:
+            return ref.size() == node.size<I64_ARR>()
+                && std::equal(ref.i64s(), ref.i64s() + ref.size(),
+                              node.raw<I64_ARR>());
+        case DBL_ARR:
+            return ref.size() == node.size<DBL_ARR>()
+                && std::equal(ref.dbls(), ref.dbls() + ref.size(),
+                              node.raw<DBL_ARR>());
+        default:
+            return true;
+        }
+    }
+}
+
+TEST(io, snapshot)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string json = "{\"name\": \"a string longer than a small one\", "
+        "\"short\": \"abc\", \"nil\": null, \"pi\": 3.25, \"n\": -7, "
+        "\"ints\": [1, 2, 3], \"dbls\": [0.5, 1.5], \"mixed\": [1, \"x\", "
+        "{\"deep\": [[], {}]}], \"many\": {";
+    char buf[64];
+    for (int i = 0; i < 100; ++i) {
+        std::sprintf(buf, "%s\"key_%d\": %d", i == 0 ? "" : ", ", i, i);
+        json += buf;
+    }
+    json += "}}";
+
+    parser::Settings settings;
+    settings.enable_packed_array = true;
+    ast::Tree<char> tree;
+    parser::Message message;
+    {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        ASSERT_TRUE(parser::json::parse(*stream, tree, message, settings));
+        delete stream;
+    }
+    {
+        io::Stream * stream = io::Stream::build(io::FILE);
+        ASSERT_TRUE(stream->open("snapshot.bin", io::WRITE));
+        EXPECT_TRUE(snapshot::save(tree.root(), *stream));
+        delete stream;
+    }
+
+    snapshot::Image image;
+    ASSERT_TRUE(image.open("snapshot.bin"));
+    snapshot::Ref root = image.root();
+    EXPECT_TRUE(same(tree.root(), root));
+
+    EXPECT_EQ(root.find("ints").type(), ast::I64_ARR);
+    EXPECT_EQ(root.find("many").find("key_42").i64(), 42);
+    EXPECT_TRUE(root.find("many").find("key_100").empty());
+    EXPECT_TRUE(root.find("missing").empty());
+    EXPECT_TRUE(root.at(100).empty());
+    EXPECT_EQ(std::string(root.find("name").str()),
+              "a string longer than a small one");
+    image.close();
+
+    /* not an image */
+    {
+        io::Stream * stream = io::Stream::build(io::FILE);
+        ASSERT_TRUE(stream->open("snapshot.bin", io::WRITE));
+        stream->write(json.c_str(), json.size());
+        delete stream;
+    }
+    EXPECT_FALSE(image.open("snapshot.bin"));
+
+    /* a small string with a broken length byte */
+    {
+        ast::Tree<char> small;
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open("\"abc\"", io::READ);
+        ASSERT_TRUE(parser::json::parse(*stream, small, message));
+        delete stream;
+
+        stream = io::Stream::build(io::FILE);
+        ASSERT_TRUE(stream->open("snapshot.bin", io::WRITE));
+        EXPECT_TRUE(snapshot::save(small.root(), *stream));
+        delete stream;
+    }
+    std::vector<uint64_t> data(sizeof(snapshot::Head) / 8U);
+    {
+        std::FILE * file = std::fopen("snapshot.bin", "rb");
+        ASSERT_TRUE(file != NULL);
+        EXPECT_EQ(std::fread(&data[0], 8U, data.size(), file), data.size());
+        std::fclose(file);
+    }
+    std::remove("snapshot.bin");
+
+    char const * base = reinterpret_cast<char const *>(&data[0]);
+    snapshot::Head & head = reinterpret_cast<snapshot::Head &>(data[0]);
+    ASSERT_EQ(head.size, sizeof(snapshot::Head));
+    ASSERT_TRUE(image.open(base, data.size() * 8U));
+    EXPECT_EQ(image.root().size(), 3U);
+    EXPECT_EQ(std::string(image.root().str()), "abc");
+
+    uint8_t broken[] = { 0U, 3U, 15U, 0xfeU };
+    for (size_t i = 0; i < sizeof(broken); ++i) {
+        head.root.sht.siz = broken[i];
+        EXPECT_ANY_THROW(image.root().size());
+        EXPECT_ANY_THROW(image.root().str());
+    }
+    image.close();
 }
@@ -0,0 +1,1238 @@
+/****************************************************************************
+ *  license
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <gtest/gtest.h>
+#include "../persistence/persistence_simd.hpp"
+#include "../persistence/persistence_number.hpp"
+#include "../persistence/persistence_parser.hpp"
+#include "../persistence/persistence_parser_json.hpp"
+#include "../persistence/persistence_parser_push.hpp"
+#include "../persistence/persistence_parser_builder.hpp"
+#include "../persistence/persistence_tape.hpp"
+
+TEST(parser, scanner)
+{
+    using namespace CV_FS_PRIVATE_NS::simd;
+
+    Scanner const & ref = scanner(SCALAR);
+    Scanner const & fst = scanner();
+    EXPECT_EQ(fst.isa, detect());
+
+    const char alphabet[] = "ab \t\n\r\"\\{}[]:,\x01\x7f\xe4\xb8\xad";
+    char buffer[256];
+    std::srand(233);
+    for (int round = 0; round < 2000; ++round) {
+        size_t len = static_cast<size_t>(std::rand()) % sizeof(buffer);
+        for (size_t i = 0; i < len; ++i) {
+            /* mostly plain chars, so that long runs appear */
+            int r = std::rand() % 64;
+            buffer[i] = r < int(sizeof(alphabet) - 1) && r % 3 == 0
+                      ? alphabet[r] : char('a' + r % 26);
+        }
+        char const * beg = buffer;
+        char const * end = buffer + len;
+        for (Isa isa = SCALAR; isa <= detect(); isa = Isa(isa + 1)) {
+            Scanner const & s = scanner(isa);
+            EXPECT_EQ(s.find_special (beg, end), ref.find_special (beg, end));
+            EXPECT_EQ(s.find_nonspace(beg, end), ref.find_nonspace(beg, end));
+        }
+    }
+
+    {   /* classify */
+        const char blk[] = "{\"k\\\" : [1,\t2]}\n\x01      abcdefghijklmn";
+        Masks a, b;
+        ref.classify(blk, a);
+        fst.classify(blk, b);
+        uint32_t const m = fst.width == 32U ? 0xFFFFFFFFU : 0xFFFFU;
+        EXPECT_EQ(a.quote      & m, b.quote     );
+        EXPECT_EQ(a.escape     & m, b.escape    );
+        EXPECT_EQ(a.control    & m, b.control   );
+        EXPECT_EQ(a.space      & m, b.space     );
+        EXPECT_EQ(a.structural & m, b.structural);
+        EXPECT_EQ(a.quote,      0x12U);
+        EXPECT_EQ(a.escape,     0x08U);
+        EXPECT_EQ(a.structural, 0x6541U);
+    }
+
+    {   /* strings across blocks */
+        const char text[] = "{\"a\\\\\": \"[,]\", \"b\\\"c\": [1, \"\"], "
+                            "\"long string that crosses a block\\\\\": 2}   ";
+        size_t const len = sizeof(text) - 1U;
+        size_t const w   = fst.width;
+
+        std::string expected, actual;
+        bool inside = false, escaped = false;
+        for (size_t i = 0; i < len / w * w; ++i) {
+            if (escaped)
+                escaped = false;
+            else if (text[i] == '\\')
+                escaped = true;
+            else if (text[i] == '"')
+                inside = !inside;
+            expected += inside ? 'S' : '.';
+        }
+
+        Carry carry = { 0U, 0U };
+        for (size_t i = 0; i + w <= len; i += w) {
+            Masks masks;
+            fst.classify(text + i, masks);
+            uint32_t bits = in_string(masks, w, carry);
+            for (size_t j = 0; j < w; ++j)
+                actual += ((bits >> j) & 1U) ? 'S' : '.';
+        }
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+namespace
+{
+    /* a file stream, which is read buffer by buffer */
+    CV_FS_PRIVATE_NS::io::Stream * open_file(
+        std::string const & content, const char filename[])
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        std::FILE * file = std::fopen(filename, "wb");
+        if (file == NULL)
+            return NULL;
+        std::fwrite(content.data(), 1U, content.size(), file);
+        std::fclose(file);
+
+        io::Stream * stream = io::Stream::build(io::FILE);
+        stream->open(filename, io::READ);
+        return stream;
+    }
+}
+
+TEST(parser, string)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* long strings with escapes that cross the boundary of a tiny buffer */
+    std::string expect;
+    std::string json = "[\"";
+    for (int i = 0; i < 200; ++i) {
+        json   += "abcdefghijklmnopqrstuvwxyz";
+        expect += "abcdefghijklmnopqrstuvwxyz";
+        json   += i % 7 == 0 ? "\\n" : i % 5 == 0 ? "\\\"" : "";
+        expect += i % 7 == 0 ? "\n"  : i % 5 == 0 ? "\""   : "";
+    }
+    json += "\" ,\n\t \"\", \"tail\"]";
+
+    parser::Settings settings;
+    settings.stream_buffer_size = 0;
+
+    io::Stream * stream = open_file(json, "test_parser_string.json");
+    ASSERT_TRUE(stream != NULL);
+
+    ast::Tree<char>  tree;
+    parser::Message  message;
+    EXPECT_EQ(parser::json::parse(*stream, tree, message, settings), true);
+    delete stream;
+    std::remove("test_parser_string.json");
+
+    ast::Node<char> const & root = tree.root();
+    ASSERT_EQ(root.type(), ast::SEQ);
+    ASSERT_EQ(root.size<ast::SEQ>(), 3U);
+    EXPECT_EQ(std::string(root.at<ast::SEQ>(0)->raw<ast::STR>()), expect);
+    EXPECT_EQ(std::string(root.at<ast::SEQ>(1)->raw<ast::STR>()), "");
+    EXPECT_EQ(std::string(root.at<ast::SEQ>(2)->raw<ast::STR>()), "tail");
+}
+
+TEST(parser, line)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* CR LF is one line, even if a reload of a tiny buffer splits it */
+    parser::Settings settings;
+    settings.stream_buffer_size = 0;
+
+    for (size_t pad = 0; pad < 8; ++pad) {
+        std::string json = "[" + std::string(pad, ' ');
+        for (int i = 0; i < 40; ++i)
+            json += "1,\r\n";
+        json += "\r\n\rx]";
+
+        io::Stream * stream = open_file(json, "test_parser_line.json");
+        ASSERT_TRUE(stream != NULL);
+
+        ast::Tree<char>  tree;
+        parser::Message  message;
+        EXPECT_EQ(parser::json::parse(*stream, tree, message, settings),
+                  false);
+        delete stream;
+        std::remove("test_parser_line.json");
+
+        std::string what = static_cast<char const *>(message);
+        EXPECT_NE(what.find("at(43, 1)"), std::string::npos) << what;
+    }
+}
+
+TEST(parser, view_end)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* a view ends right after a value, or after spaces of it */
+    char const * const cases[] =
+    {
+        "123", "-2.5e3", "true", "null", "\"abc\"", "[1, 2]", "{}",
+        "[1]  \n ", " 7\r\n",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        std::string json = cases[i];
+        io::Span span(&json[0], &json[0] + json.size());
+
+        ast::Tree<char>  tree;
+        parser::Message  message;
+        EXPECT_EQ(parser::json::parse(span, tree, message), true) << json;
+    }
+}
+
+TEST(parser, mapped)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* closed and removed on every path, even if an assertion returns */
+    struct Cleanup
+    {
+        const char * name;
+        io::Stream * stream;
+        ~Cleanup() { delete stream; std::remove(name); }
+    };
+
+    /* a file ends at a page boundary, the view must still end with '\0' */
+    const char filename[] = "test_parser_mapped.json";
+    Cleanup    guard    = { filename, NULL };
+    std::string json = "[\"mapped\", 1, 2.5, {\"key\": \"value\"}]";
+    json.resize(4096U, ' ');
+    {
+        std::FILE * file = std::fopen(filename, "wb");
+        ASSERT_TRUE(file != NULL);
+        std::fwrite(json.data(), 1U, json.size(), file);
+        std::fclose(file);
+    }
+
+    io::Stream * & stream = guard.stream;
+    stream = io::Stream::build(io::MMAP);
+    ASSERT_TRUE(stream != NULL);
+#ifdef _WIN32
+    /* a view cannot be padded on windows, such a file is not mapped and
+     * is read as a file instead */
+    ASSERT_EQ(stream->open(filename, io::READ), false);
+    delete stream;
+    stream = io::Stream::build(io::FILE);
+    ASSERT_TRUE(stream != NULL);
+    ASSERT_EQ(stream->open(filename, io::READ), true);
+#else
+    ASSERT_EQ(stream->open(filename, io::READ), true);
+
+    io::Stream::size_type size = 0;
+    char const * view = stream->view(size);
+    ASSERT_TRUE(view != NULL);
+    EXPECT_EQ(size, json.size());
+    EXPECT_EQ(view[size], '\0');
+    EXPECT_EQ(std::memcmp(view, json.data(), json.size()), 0);
+#endif
+
+    ast::Tree<char>  tree;
+    parser::Message  message;
+    EXPECT_EQ(parser::json::parse(*stream, tree, message), true);
+
+    ast::Node<char> const & root = tree.root();
+    ASSERT_EQ(root.type(), ast::SEQ);
+    ASSERT_EQ(root.size<ast::SEQ>(), 4U);
+    EXPECT_EQ(std::string(root.at<ast::SEQ>(0)->raw<ast::STR>()), "mapped");
+    EXPECT_EQ(root.at<ast::SEQ>(2)->val<ast::DBL>(), 2.5);
+    EXPECT_EQ(root.at<ast::SEQ>(3)->size<ast::MAP>(), 1U);
+}
+
+namespace
+{
+    /* counts values and joins strings, no node is built */
+    class Counter : public CV_FS_PRIVATE_NS::parser::json::Handler<char>
+    {
+    public:
+        Counter()
+            : ints(0), dbls(0), nils(0), maps(0), seqs(0), strs(0), vals(0)
+        {}
+
+        void map_beg() { ++maps; }
+        void seq_beg() { ++seqs; }
+        void str_end() { ++strs; text += '|'; }
+        void str_val(char const * str, size_t len)
+        {
+            ++vals;
+            text.append(str, len);
+            str_end();
+        }
+        void on_nil()  { ++nils; }
+        void on_int(int64_t) { ++ints; }
+        void on_dbl(double ) { ++dbls; }
+        void on_chr(char ch) { text += ch; }
+        void on_str(char const * str, size_t len) { text.append(str, len); }
+
+        size_t ints, dbls, nils, maps, seqs, strs, vals;
+        std::string text;
+    };
+}
+
+TEST(parser, events)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string json = "{\"key\": [1, 2.5, null, \"a\\tb\"], \"long\": \"";
+    std::string tail;
+    for (int i = 0; i < 100; ++i)
+        tail += "0123456789";
+    json += tail + "\", \"map\": {}}";
+
+    parser::Settings settings;
+    settings.stream_buffer_size = 0; /* strings cross the buffer */
+
+    io::Stream * stream = open_file(json, "test_parser_events.json");
+    ASSERT_TRUE(stream != NULL);
+
+    Counter counter;
+    parser::Message message;
+    EXPECT_EQ(parser::json::parse_events(*stream, counter, message, settings),
+              true);
+    delete stream;
+    std::remove("test_parser_events.json");
+
+    EXPECT_EQ(counter.ints, 1U);
+    EXPECT_EQ(counter.dbls, 1U);
+    EXPECT_EQ(counter.nils, 1U);
+    EXPECT_EQ(counter.maps, 2U);
+    EXPECT_EQ(counter.seqs, 1U);
+    EXPECT_EQ(counter.strs, 5U);
+    EXPECT_EQ(counter.vals, 3U); /* "key", "long" and "map" are whole */
+    EXPECT_EQ(counter.text, "key|a\tb|long|" + tail + "|map|");
+}
+
+TEST(parser, view_eof)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* a view behaves as a buffer at its end: eof, EOF and no more skip */
+    typedef parser::StreamHelper<io::Stream, void> In;
+
+    char json[] = "[1]";
+    io::Span span(json, json + sizeof(json) - 1);
+    parser::Settings settings;
+    In in(span, settings);
+
+    EXPECT_FALSE(in.eof());
+    in.skip(3U);
+    EXPECT_TRUE(in.empty());
+    EXPECT_TRUE(in.eof());
+    EXPECT_EQ(in.ch(), char(EOF));
+    EXPECT_EQ(in.pos(), 4U);
+
+    in.skip().skip();
+    EXPECT_TRUE(in.eof());
+    EXPECT_EQ(in.size(), 0U);
+    EXPECT_EQ(in.pos(), 4U);
+}
+
+TEST(parser, large_counter)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    /* counters go on past 2^32 as if the input were a part of a 4G file */
+    typedef parser::StreamHelper<io::Stream, Counter> In;
+
+    char json[] = "[1,\n  2.5,\r\n\t\"a\"\n]";
+    io::Span span(json, json + sizeof(json) - 1);
+    parser::Settings settings;
+    Counter counter;
+    In in(span, settings, counter);
+
+    const uint64_t base = uint64_t(1) << 32;
+    in.resume(base, 1U, 0U, base);
+    EXPECT_EQ(parser::json::parse_value(in), true);
+    EXPECT_TRUE(in.empty());
+
+    EXPECT_EQ(counter.ints, 1U);
+    EXPECT_EQ(counter.strs, 1U);
+    EXPECT_GT(in.line(), uint64_t(std::numeric_limits<uint32_t>::max()));
+    EXPECT_GT(in.pos(),  uint64_t(std::numeric_limits<uint32_t>::max()));
+    EXPECT_EQ(in.line(), base + 3U);
+    EXPECT_EQ(in.col(),  2U);
+    EXPECT_EQ(in.pos(),  base + sizeof(json) - 1);
+}
+
+namespace
+{
+    /* a feature collection, with structural chars in strings */
+    std::string make_features(size_t count)
+    {
+        std::string json = "{\"type\": \"FeatureCollection\", "
+                           "\"features\": [\n";
+        char buf[160];
+        for (size_t i = 0; i < count; ++i) {
+            std::sprintf(buf,
+                "%s{\"id\": %u, \"name\": \"f[%u],{\\\"x\\\"}\", "
+                "\"coordinates\": [%u, 1.5, -2], \"ok\": null}",
+                i == 0 ? "  " : ",\n  ", unsigned(i), unsigned(i), unsigned(i));
+            json += buf;
+        }
+        json += "\n], \"count\": [1, 2]}";
+        return json;
+    }
+
+    /* parse `json`, strings may refer to `stream` if in-situ */
+    bool parse_arena(
+        CV_FS_PRIVATE_NS::io::Stream & stream,
+        std::string const & json,
+        CV_FS_PRIVATE_NS::ast::Tree<char, CV_FS_PRIVATE_NS::ast::ArenaPool>
+                          & tree,
+        CV_FS_PRIVATE_NS::parser::Settings const & settings)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        parser::Message message;
+        stream.open(json.c_str(), io::READ);
+        return parser::json::parse(stream, tree, message, settings);
+    }
+}
+
+TEST(parser, parallel)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string json = make_features(20000U);
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    ast::Tree<char, ast::ArenaPool> expected;
+    ASSERT_EQ(parse_arena(*stream, json, expected, parser::Settings()), true);
+
+    for (size_t depth = 0; depth < 2; ++depth) {
+        parser::Settings settings;
+        settings.parallel_threads = 4U;
+        settings.parallel_depth   = depth;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        ASSERT_EQ(parse_arena(*stream, json, tree, settings), true);
+        EXPECT_TRUE(tree.root().equal(expected.root()));
+        tree.clear();
+
+        settings.enable_insitu = true;
+        ASSERT_EQ(parse_arena(*stream, json, tree, settings), true);
+        EXPECT_TRUE(tree.root().equal(expected.root()));
+        tree.clear();
+    }
+
+    {   /* an error in the middle */
+        std::string broken = json;
+        size_t pos = broken.find("null", broken.size() / 2);
+        ASSERT_NE(pos, std::string::npos);
+        broken[pos + 3] = ',';
+
+        parser::Settings settings;
+        settings.parallel_threads = 4U;
+        settings.parallel_depth   = 1U;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        EXPECT_EQ(parse_arena(*stream, broken, tree, settings), false);
+    }
+    delete stream;
+}
+
+TEST(parser, packed)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace ast;
+
+    std::string json =
+        "{\"i\": [1, -2, 3], \"d\": [0.5, -1.5], \"mixed\": [1, 2.5],"
+        " \"late\": [1, 2, 3, \"x\"], \"nil\": [1, null], \"none\": [],"
+        " \"nested\": [1, [2.5, 3.5], [[4]], {\"k\": [5]}]}";
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    parser::Settings settings;
+    settings.enable_packed_array = true;
+    ast::Tree<char, ast::ArenaPool> tree;
+    ASSERT_EQ(parse_arena(*stream, json, tree, settings), true);
+
+    Node<char> & root = tree.root();
+    Node<char> & i = (*root.find<MAP>("i", 1, tree.pool()))[1];
+    ASSERT_EQ(i.type(), I64_ARR);
+    ASSERT_EQ(i.size<I64_ARR>(), 3U);
+    EXPECT_EQ(i.raw<I64_ARR>()[1], -2);
+
+    Node<char> & d = (*root.find<MAP>("d", 1, tree.pool()))[1];
+    ASSERT_EQ(d.type(), DBL_ARR);
+    EXPECT_EQ(d.raw<DBL_ARR>()[1], -1.5);
+
+    char const * seqs[] = { "mixed", "late", "nil", "none", "nested" };
+    size_t const size[] = { 2U, 4U, 2U, 0U, 4U };
+    for (size_t k = 0; k < sizeof(seqs) / sizeof(seqs[0]); ++k) {
+        Node<char> & seq = (*root.find<MAP>(
+            seqs[k], std::strlen(seqs[k]), tree.pool()))[1];
+        ASSERT_EQ(seq.type(), SEQ);
+        EXPECT_EQ(seq.size<SEQ>(), size[k]);
+    }
+
+    Node<char> & nested = (*root.find<MAP>("nested", 6, tree.pool()))[1];
+    EXPECT_EQ(nested.at<SEQ>(0)->val<I64>(), 1);
+    EXPECT_EQ(nested.at<SEQ>(1)->type(), DBL_ARR);
+    EXPECT_EQ(nested.at<SEQ>(2)->at<SEQ>(0)->type(), I64_ARR);
+    EXPECT_EQ((*nested.at<SEQ>(3)->at<MAP>(0))[1].type(), I64_ARR);
+
+    /* the same as a tree of nodes apart from packing */
+    ast::Tree<char, ast::ArenaPool> plain;
+    ASSERT_EQ(parse_arena(*stream, json, plain, parser::Settings()), true);
+    Node<char> & late = (*root.find<MAP>("late", 4, tree.pool()))[1];
+    EXPECT_TRUE(late.equal(
+        (*plain.root().find<MAP>("late", 4, plain.pool()))[1]));
+
+    {   /* a large array in parallel, packed after stitching */
+        std::string numbers = "[0";
+        for (int k = 1; k < 100000; ++k) {
+            char buf[32];
+            std::sprintf(buf, ", %d.5", k);
+            numbers += buf;
+        }
+        numbers += "]";
+
+        ast::Tree<char, ast::ArenaPool> expected;
+        ASSERT_EQ(parse_arena(*stream, numbers, expected, settings), true);
+
+        settings.parallel_threads = 4U;
+        ast::Tree<char, ast::ArenaPool> result;
+        ASSERT_EQ(parse_arena(*stream, numbers, result, settings), true);
+        EXPECT_EQ(result.root().type(), SEQ); /* "0" is an int */
+        EXPECT_TRUE(result.root().equal(expected.root()));
+
+        numbers[1] = '1';
+        numbers.insert(2, ".5");
+        result.clear();
+        expected.clear();
+        settings.parallel_threads = 1U;
+        ASSERT_EQ(parse_arena(*stream, numbers, expected, settings), true);
+        settings.parallel_threads = 4U;
+        ASSERT_EQ(parse_arena(*stream, numbers, result, settings), true);
+        ASSERT_EQ(result.root().type(), DBL_ARR);
+        EXPECT_EQ(result.root().size<DBL_ARR>(), 100000U);
+        EXPECT_TRUE(result.root().equal(expected.root()));
+    }
+    delete stream;
+}
+
+TEST(parser, interning)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace ast;
+
+    /* keys of 14 chars or more are not small strings */
+    std::string json = "[";
+    char buf[128];
+    for (unsigned i = 0; i < 20000U; ++i) {
+        std::sprintf(buf, "%s{\"feature_identifier\": %u, \"short\": %u}",
+                     i == 0 ? "" : ",\n", i, i);
+        json += buf;
+    }
+    json += "]";
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    ast::Tree<char, ast::ArenaPool> expected;
+    ASSERT_EQ(parse_arena(*stream, json, expected, parser::Settings()), true);
+
+    for (size_t threads = 1; threads < 5; threads += 3) {
+        parser::Settings settings;
+        settings.enable_key_interning = true;
+        settings.parallel_threads     = threads;
+
+        ast::Tree<char, ast::ArenaPool> tree;
+        ASSERT_EQ(parse_arena(*stream, json, tree, settings), true);
+        EXPECT_TRUE(tree.root().equal(expected.root()));
+
+        Node<char> & fst = (*tree.root().at<SEQ>(0)->at<MAP>(0))[0];
+        Node<char> & lst = (*tree.root().at<SEQ>(19999)->at<MAP>(0))[0];
+        EXPECT_EQ(std::string(fst.raw<STR>()), "feature_identifier");
+        EXPECT_TRUE(fst.equal(lst));
+        if (threads == 1) {
+            EXPECT_EQ(fst.raw<STR>(), lst.raw<STR>());
+            EXPECT_EQ(tree.keys().size(), 1U);
+            EXPECT_EQ(tree.keys().saved(), 19999U * 19U);
+        }
+        EXPECT_GT(tree.keys().saved(), 0U);
+    }
+    delete stream;
+}
+
+TEST(parser, index)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+
+    /* large maps are indexed by the builder, so a lookup writes nothing */
+    std::string json = "{";
+    char buf[32];
+    for (int i = 0; i < 64; ++i) {
+        std::sprintf(buf, "%s\"key_%d\": %d", i == 0 ? "" : ", ", i, i);
+        json += buf;
+    }
+    json += ", \"small\": {\"a\": 1}}";
+
+    parser::Settings settings;
+    for (int stack = 0; stack < 2; ++stack) {
+        settings.enable_node_stack = stack != 0;
+
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        Tree<char> tree;
+        parser::Message message;
+        ASSERT_EQ(parser::json::parse(*stream, tree, message, settings), true);
+        delete stream;
+
+        Node<char> & root = tree.root();
+        char before[sizeof(Node<char>)];
+        std::memcpy(before, &root, sizeof(before));
+
+        Node<char>::Pair * pair = root.find<MAP>("key_42", 6, tree.pool());
+        ASSERT_NE(pair, root.end<MAP>());
+        EXPECT_EQ((*pair)[1].val<I64>(), 42);
+        EXPECT_EQ(std::memcmp(before, &root, sizeof(before)), 0);
+
+        Node<char> const & view = root;
+        EXPECT_EQ((*view.find<MAP>("small", 5))[1].size<MAP>(), 1U);
+    }
+}
+
+TEST(parser, node_stack)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string json = make_features(3000U);
+    json.insert(json.size() - 1,
+        ", \"nested\": [[], {}, [[1, 2], [3.5]], {\"a\": [1, \"b\", {}]}],"
+        " \"numbers\": [1, 2, 3, [4]], \"empty\": {}");
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    for (int options = 0; options < 4; ++options) {
+        parser::Settings settings;
+        settings.enable_packed_array  = (options & 1) != 0;
+        settings.enable_key_interning = (options & 2) != 0;
+
+        settings.enable_node_stack = false;
+        ast::Tree<char, ast::ArenaPool> expected;
+        ASSERT_EQ(parse_arena(*stream, json, expected, settings), true);
+
+        settings.enable_node_stack = true;
+        ast::Tree<char, ast::ArenaPool> tree;
+        ASSERT_EQ(parse_arena(*stream, json, tree, settings), true);
+        EXPECT_TRUE(tree.root().equal(expected.root()));
+
+        /* containers are allocated once, at the right size */
+        ast::Node<char> & features = (*tree.root().at<ast::MAP>(1))[1];
+        EXPECT_EQ(features.capacity<ast::SEQ>(),
+                  ast::Node<char>::Cap::at(ast::Node<char>::Cap::right(
+                      features.size<ast::SEQ>())));
+    }
+    delete stream;
+}
+
+namespace
+{
+    /* a tape is equal to a tree that is not packed */
+    bool equal(CV_FS_PRIVATE_NS::tape::Cursor cur,
+               CV_FS_PRIVATE_NS::ast::Node<char> const & node)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+        using namespace CV_FS_PRIVATE_NS::ast;
+
+        if (cur.type() != node.type())
+            return false;
+        switch (node.type())
+        {
+        case NIL: return cur.empty();
+        case I64: return (int)cur == node.val<I64>();
+        case DBL: return (double)cur == node.val<DBL>();
+        case STR:
+            return cur.size() == node.size<STR>()
+                && std::memcmp((const char *)cur, node.raw<STR>(),
+                               cur.size() + 1U) == 0;
+        case SEQ:
+            if (cur.size() != node.size<SEQ>())
+                return false;
+            for (uint32_t i = 0; i < node.size<SEQ>(); ++i)
+                if (!equal(cur[i], *node.at<SEQ>(i)))
+                    return false;
+            return true;
+        case MAP:
+        {
+            if (cur.size() != node.size<MAP>())
+                return false;
+            Node<char>::Pair const * beg = node.begin<MAP>();
+            Node<char>::Pair const * end = node.  end<MAP>();
+            for (Node<char>::Pair const * it = beg; it != end; ++it) {
+                tape::Cursor val = cur.find(
+                    (*it)[0].raw<STR>(), (*it)[0].size<STR>());
+                if (!equal(val, (*it)[1]))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+TEST(parser, tape)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    std::string json = make_features(3000U);
+    json.insert(json.size() - 1,
+        ", \"nested\": [[], {}, [[1, 2], [3.5]], {\"a\": [1, \"b\", {}]}],"
+        " \"long\": \"" + std::string(300U, 'x') + "\\n\","
+        " \"empty\": {}, \"\": \"\"");
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    ast::Tree<char, ast::ArenaPool> expected;
+    ASSERT_EQ(parse_arena(*stream, json, expected, parser::Settings()), true);
+
+    tape::Document doc;
+    parser::Message message;
+    stream->open(json.c_str(), io::READ);
+    ASSERT_EQ(parser::json::parse(*stream, doc, message), true);
+    EXPECT_TRUE(equal(doc.root(), expected.root()));
+
+    /* containers are skipped in one step */
+    tape::Cursor root = doc.root();
+    tape::Cursor features = root["features"];
+    EXPECT_EQ(features.size(), 3000U);
+    EXPECT_EQ(features.next().index(), root.find("count", 5).index() - 1U);
+    EXPECT_EQ((int)features[2999]["id"], 2999);
+    EXPECT_EQ(std::string((const char *)features[7]["name"]),
+              "f[7],{\"x\"}");
+    EXPECT_EQ(root.find("none", 4).empty(), true);
+    EXPECT_EQ(root["nested"][size_t(0)].size(), 0U);
+    EXPECT_EQ(root["nested"][1].type(), ast::MAP);
+
+    /* a broken one leaves nothing */
+    stream->open("[1, {\"a\": 2]", io::READ);
+    EXPECT_EQ(parser::json::parse(*stream, doc, message), false);
+    EXPECT_EQ(doc.empty(), true);
+    EXPECT_EQ(doc.root().empty(), true);
+    delete stream;
+}
+
+namespace
+{
+    /* an item of a lazy tree is equal to a node that is parsed as usual */
+    bool equal(CV_FS_PRIVATE_NS::parser::json::LazyTree & tree,
+               CV_FS_PRIVATE_NS::parser::json::LazyTree::Item & item,
+               CV_FS_PRIVATE_NS::ast::Node<char> const & expected)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+        using namespace CV_FS_PRIVATE_NS::ast;
+        typedef parser::json::LazyTree LazyTree;
+
+        Node<char> * node = tree.expand(item);
+        if (node == NULL || node->type() != expected.type())
+            return false;
+
+        size_t size
+            = node->type() == SEQ ? node->size<SEQ>()
+            : node->type() == MAP ? node->size<MAP>()
+            : 0U;
+        if (size == 0U)
+            return node->equal(expected);
+        if (node->type() == SEQ && size != expected.size<SEQ>() ||
+            node->type() == MAP && size != expected.size<MAP>())
+            return false;
+
+        for (uint32_t i = 0; i < size; ++i) {
+            Node<char> const * lhs = node->type() == SEQ
+                ? node->at<SEQ>(i) : &(*node->at<MAP>(i))[1];
+            Node<char> const * rhs = node->type() == SEQ
+                ? expected.at<SEQ>(i) : &(*expected.at<MAP>(i))[1];
+            if (node->type() == MAP &&
+                !(*node->at<MAP>(i))[0].equal((*expected.at<MAP>(i))[0]))
+                return false;
+
+            LazyTree::Item * kid = tree.child(item, *lhs);
+            if (kid != NULL ? !equal(tree, *kid, *rhs) : !lhs->equal(*rhs))
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST(parser, lazy)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    typedef parser::json::LazyTree LazyTree;
+
+    std::string json = make_features(3000U);
+    json.insert(json.size() - 1,
+        ", \"large\": {\"a\": " + make_features(200U) +
+        ", \"b\": [" + make_features(100U) + ", 1, {}, []]}"
+        ", \"small\": {\"x\": [1, 2], \"y\": \"[{\"}");
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    for (int options = 0; options < 2; ++options) {
+        parser::Settings settings;
+        settings.enable_packed_array = options != 0;
+
+        ast::Tree<char, ast::ArenaPool> expected;
+        ASSERT_EQ(parse_arena(*stream, json, expected, settings), true);
+
+        LazyTree tree(*stream, settings);
+        LazyTree::Item & root = tree.root();
+        ast::Node<char> * node = tree.expand(root);
+        ASSERT_TRUE(node != NULL);
+        ASSERT_EQ(node->type(), ast::MAP);
+
+        /* only large containers are left as text */
+        for (uint32_t i = 0; i < node->size<ast::MAP>(); ++i) {
+            std::string key = (*node->at<ast::MAP>(i))[0].raw<ast::STR>();
+            bool lazy = tree.child(root, (*node->at<ast::MAP>(i))[1]) != NULL;
+            EXPECT_EQ(lazy, key == "features" || key == "large") << key;
+        }
+        EXPECT_TRUE(equal(tree, root, expected.root()));
+    }
+
+    {   /* errors are found when a container is expanded */
+        std::string broken = "{\"ok\": 1, \"bad\": [" +
+            make_features(100U) + ", 1 2]}";
+        stream->open(broken.c_str(), io::READ);
+        LazyTree tree(*stream);
+        ast::Node<char> * node = tree.expand(tree.root());
+        ASSERT_TRUE(node != NULL);
+        LazyTree::Item * bad = tree.child(
+            tree.root(), (*node->at<ast::MAP>(1))[1]);
+        ASSERT_TRUE(bad != NULL);
+        EXPECT_TRUE(tree.expand(*bad) == NULL);
+        EXPECT_EQ(tree.message().empty(), false);
+    }
+    delete stream;
+}
+
+TEST(parser, query)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    using namespace CV_FS_PRIVATE_NS::ast;
+    typedef Node<char>::Pair Pair;
+
+    std::string json = make_features(300U);
+    json.insert(json.size() - 1,
+        ", \"skipped\": {\"a\": [1, /* ] } \" */ 2.5e3, null],"
+        " \"b\": \"\\\"}]\", \"c\": {}}, \"tail\": [[0], 1]");
+    io::Stream * stream = io::Stream::build(io::STRING);
+
+    Tree<char, ArenaPool> expected;
+    ASSERT_EQ(parse_arena(*stream, json, expected, parser::Settings()), true);
+    Node<char> const & features = (*expected.root().at<MAP>(1))[1];
+
+    /* "" is the whole value */
+    {
+        parser::json::Query query;
+        ASSERT_EQ(query.add(""), true);
+        EXPECT_EQ(query.add("no slash"), false);
+
+        Tree<char, ArenaPool> tree;
+        parser::Message message;
+        stream->open(json.c_str(), io::READ);
+        ASSERT_EQ(parser::json::parse(*stream, tree, query, message), true);
+        EXPECT_TRUE(tree.root().equal(expected.root()));
+    }
+
+    /* a wildcard, and another path */
+    {
+        parser::json::Query query;
+        query.add("/features/*/name");
+        query.add("/tail/1");
+
+        Tree<char, ArenaPool> tree;
+        parser::Message message;
+        stream->open(json.c_str(), io::READ);
+        ASSERT_EQ(parser::json::parse(*stream, tree, query, message), true);
+
+        Node<char> & root = tree.root();
+        ASSERT_EQ(root.type(), MAP);
+        ASSERT_EQ(root.size<MAP>(), 2U);
+        EXPECT_EQ(std::string((*root.at<MAP>(0))[0].raw<STR>()), "features");
+        EXPECT_EQ(std::string((*root.at<MAP>(1))[0].raw<STR>()), "tail");
+
+        Node<char> & list = (*root.at<MAP>(0))[1];
+        ASSERT_EQ(list.size<SEQ>(), 300U);
+        for (uint32_t i = 0; i < 300U; ++i) {
+            Node<char> & item = *list.at<SEQ>(i);
+            ASSERT_EQ(item.size<MAP>(), 1U);
+            Pair const & lhs = *item.at<MAP>(0);
+            Pair const & rhs = *features.at<SEQ>(i)->at<MAP>(1);
+            EXPECT_TRUE(lhs[0].equal(rhs[0]));
+            EXPECT_TRUE(lhs[1].equal(rhs[1]));
+        }
+
+        /* skipped elements are NIL */
+        Node<char> & tail = (*root.at<MAP>(1))[1];
+        ASSERT_EQ(tail.size<SEQ>(), 2U);
+        EXPECT_EQ(tail.at<SEQ>(0)->type(), NIL);
+        EXPECT_EQ(tail.at<SEQ>(1)->val<I64>(), 1);
+    }
+
+    /* an index, with escaped keys */
+    {
+        parser::json::Query query;
+        query.add("/features/42/coordinates/1");
+        query.add("/features/007");
+        query.add("/a~1b~0");
+
+        Tree<char, ArenaPool> tree;
+        parser::Message message;
+        std::string text = json;
+        text.insert(1, "\"a/b~\": 1, ");
+        stream->open(text.c_str(), io::READ);
+        ASSERT_EQ(parser::json::parse(*stream, tree, query, message), true);
+
+        Node<char> & root = tree.root();
+        ASSERT_EQ(root.size<MAP>(), 2U);
+        EXPECT_EQ((*root.at<MAP>(0))[1].val<I64>(), 1);
+        Node<char> & list = (*root.at<MAP>(1))[1];
+        ASSERT_EQ(list.size<SEQ>(), 300U);
+        for (uint32_t i = 0; i < 300U; ++i)
+            EXPECT_EQ(list.at<SEQ>(i)->type(), i == 42 ? MAP : NIL);
+        Node<char> & coordinates = (*list.at<SEQ>(42)->at<MAP>(0))[1];
+        ASSERT_EQ(coordinates.size<SEQ>(), 3U);
+        EXPECT_EQ(coordinates.at<SEQ>(0)->type(), NIL);
+        EXPECT_EQ(coordinates.at<SEQ>(1)->val<DBL>(), 1.5);
+        EXPECT_EQ(coordinates.at<SEQ>(2)->type(), NIL);
+    }
+
+    /* skipped values must be balanced, and a view may end in them */
+    {
+        parser::json::Query query;
+        query.add("/b");
+        const char * broken[] = { "{\"a\": [1, 2}", "{\"a\": \"1}",
+                                  "{\"a\": [1 /* ] */ , \"b\": 1}",
+                                  "{\"a\":[1,2", "{\"a\": \"abc",
+                                  "{\"a\": \"abc\\", "{\"a\": {\"c\": " };
+        for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i) {
+            Tree<char, ArenaPool> tree;
+            parser::Message message;
+            stream->open(broken[i], io::READ);
+            EXPECT_EQ(parser::json::parse(*stream, tree, query, message),
+                      false) << broken[i];
+
+            std::string text = broken[i];
+            io::Span span(&text[0], &text[0] + text.size());
+            Tree<char, ArenaPool> other;
+            EXPECT_EQ(parser::json::parse(span, other, query, message),
+                      false) << broken[i];
+        }
+    }
+    delete stream;
+}
+
+TEST(parser, push)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    typedef parser::json::Builder<char, ast::Pool> Builder;
+    typedef parser::json::PushParser<Builder>     PushParser;
+
+    std::string json =
+        "{\"name\": \"push\\t\\\"parser\\\"\", /* comment */\n"
+        " \"empty\": {}, \"none\": [], \"hex\": \"\\u00e4\",\n"
+        " \"numbers\": [0, -1, 12345678901234, 2.5e-3, -0.125, 1E+2],\n"
+        " \"nested\": [[[null]], {\"a\": {\"b\": [1, \"2\"]}}],"
+        " // line comment\n"
+        " \"long\": \"" + std::string(300U, 'x') + "\"}";
+
+    ast::Tree<char> expected;
+    {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+        parser::Message message;
+        ASSERT_EQ(parser::json::parse(*stream, expected, message), true);
+        delete stream;
+    }
+
+    size_t const slices[] = { 1U, 2U, 3U, 7U, 64U, json.size() };
+    for (size_t k = 0; k < sizeof(slices) / sizeof(slices[0]); ++k) {
+        ast::Tree<char> tree;
+        Builder    builder(tree);
+        PushParser push(builder);
+        for (size_t i = 0; i < json.size(); i += slices[k]) {
+            size_t size = std::min(slices[k], json.size() - i);
+            ASSERT_EQ(push.feed(json.data() + i, size), true);
+        }
+        EXPECT_EQ(push.finish(), true);
+        EXPECT_EQ(push.done(), true);
+        EXPECT_TRUE(tree.root().equal(expected.root())) << slices[k];
+    }
+
+    {   /* a number at the end */
+        ast::Tree<char> tree;
+        Builder    builder(tree);
+        PushParser push(builder);
+        EXPECT_EQ(push.feed("  12", 4U), true);
+        EXPECT_EQ(push.feed("34", 2U), true);
+        EXPECT_EQ(push.done(), false);
+        EXPECT_EQ(push.finish(), true);
+        ASSERT_EQ(tree.root().type(), ast::I64);
+        EXPECT_EQ(tree.root().val<ast::I64>(), 1234);
+    }
+
+    {   /* slices that end exactly at a number or a keyword */
+        ast::Tree<char> tree;
+        Builder    builder(tree);
+        PushParser push(builder);
+        const char * slices[] = { "[12", "3", ",-4.5", ", tru", "e", "]" };
+        for (size_t i = 0; i < sizeof(slices) / sizeof(slices[0]); ++i)
+            ASSERT_EQ(push.feed(slices[i], std::strlen(slices[i])), true)
+                << slices[i];
+        EXPECT_EQ(push.finish(), true);
+        ast::Node<char> const & root = tree.root();
+        ASSERT_EQ(root.type(), ast::SEQ);
+        ASSERT_EQ(root.size<ast::SEQ>(), 3U);
+        EXPECT_EQ(root.at<ast::SEQ>(0)->val<ast::I64>(), 123);
+        EXPECT_EQ(root.at<ast::SEQ>(1)->val<ast::DBL>(), -4.5);
+        EXPECT_EQ(root.at<ast::SEQ>(2)->val<ast::I64>(), 1); /* true */
+    }
+
+    {   /* errors */
+        const char * broken[] = { "[1, 2", "[1 2]", "{\"a\" 1}", "[1,]",
+                                  "[\"a\x01\"]", "[nul]", "{\"a\": 1]" };
+        for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i) {
+            ast::Tree<char> tree;
+            Builder    builder(tree);
+            PushParser push(builder);
+            bool status = push.feed(broken[i], std::strlen(broken[i]));
+            status = push.finish() && status;
+            EXPECT_EQ(status, false) << broken[i];
+            EXPECT_EQ(push.message().empty(), false) << broken[i];
+        }
+    }
+}
+
+TEST(parser, records)
+{
+    using namespace CV_FS_PRIVATE_NS;
+    typedef parser::json::RecordReader RecordReader;
+
+    /* a few MB of records, with blank lines and comments between */
+    std::string json = "\n";
+    char buf[160];
+    size_t const count = 40000U;
+    for (size_t i = 0; i < count; ++i) {
+        std::sprintf(buf,
+            "{\"id\": %u, \"name\": \"r[%u]\\n\", \"list\": [%u, 0.5]}%s\n",
+            unsigned(i), unsigned(i), unsigned(i),
+            i % 7 == 0 ? "\r" : i % 11 == 0 ? " // comment\n" : "");
+        json += buf;
+    }
+
+    ast::Tree<char> expected;
+    {
+        io::Stream * stream = io::Stream::build(io::STRING);
+        std::sprintf(buf,
+            "{\"id\": %u, \"name\": \"r[%u]\\n\", \"list\": [%u, 0.5]}",
+            123U, 123U, 123U);
+        stream->open(buf, io::READ);
+        parser::Message message;
+        ASSERT_EQ(parser::json::parse(*stream, expected, message), true);
+        delete stream;
+    }
+
+    io::Stream * stream = io::Stream::build(io::STRING);
+    for (size_t threads = 1; threads < 3; ++threads) {
+        parser::Settings settings;
+        settings.parallel_threads = threads;
+
+        stream->open(json.c_str(), io::READ);
+        RecordReader reader(*stream, settings);
+        size_t n = 0;
+        for (; reader.next(); ++n) {
+            ASSERT_EQ(reader.index(), n);
+            ast::Node<char> & record = reader.record();
+            ASSERT_EQ(record.type(), ast::MAP);
+            ASSERT_EQ((*record.at<ast::MAP>(0))[1].val<ast::I64>(),
+                      int64_t(n));
+            if (n == 123U)
+                EXPECT_TRUE(record.equal(expected.root()));
+        }
+        EXPECT_EQ(n, count) << threads;
+        EXPECT_EQ(reader.done(), true);
+        EXPECT_EQ(reader.message().empty(), true);
+        EXPECT_EQ(reader.next(), false);
+    }
+
+    {   /* records before an error are read, so is the line of it */
+        std::string broken = json;
+        size_t pos = broken.find("\"id\": 30000,");
+        ASSERT_NE(pos, std::string::npos);
+        broken[pos + 13] = ' ';
+        std::sprintf(buf, "at(%u, ", unsigned(1U + std::count(
+            broken.begin(), broken.begin() + pos, '\n')));
+
+        for (size_t threads = 1; threads < 3; ++threads) {
+            parser::Settings settings;
+            settings.parallel_threads = threads;
+
+            stream->open(broken.c_str(), io::READ);
+            RecordReader reader(*stream, settings);
+            while (reader.next());
+            EXPECT_EQ(reader.index(), 29999U) << threads;
+            EXPECT_NE(std::string(reader.message()).find(buf),
+                      std::string::npos) << reader.message();
+        }
+    }
+
+    {   /* one record a line */
+        stream->open("[1]\n2 3\n", io::READ);
+        RecordReader reader(*stream);
+        EXPECT_EQ(reader.next(), true);
+        EXPECT_EQ(reader.next(), false);
+        EXPECT_EQ(reader.message().empty(), false);
+    }
+    delete stream;
+}
+
+namespace
+{
+    double parse_double(std::string const & json)
+    {
+        using namespace CV_FS_PRIVATE_NS;
+
+        io::Stream * stream = io::Stream::build(io::STRING);
+        stream->open(json.c_str(), io::READ);
+
+        ast::Tree<char>  tree;
+        parser::Message  message;
+        parser::json::parse(*stream, tree, message);
+        delete stream;
+
+        ast::Node<char> const & root = tree.root();
+        if (root.type() != ast::SEQ || root.size<ast::SEQ>() != 1U)
+            return 0.0;
+        if (root.at<ast::SEQ>(0)->type() != ast::DBL)
+            return 0.0;
+        return root.at<ast::SEQ>(0)->val<ast::DBL>();
+    }
+}
+
+TEST(parser, number)
+{
+    /* the C library is correctly rounded on all tested platforms */
+    const char * cases[] =
+    {
+        "0.0", "-0.0", "1.5", "3.14159", "1e23", "8.589973e9", "1e-7",
+        "2.2250738585072011e-308", "2.2250738585072014e-308",
+        "4.9406564584124654e-324", "2.4703282292062328e-324",
+        "2.4703282292062327e-324", "1.7976931348623157e308",
+        "1.7976931348623158e308", "1e309", "1e-400", "9007199254740993.0",
+        "9007199254740992.000000000000000000000000001",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "0.1000000000000000055511151231257827021181583404541015624",
+        "0.1000000000000000055511151231257827021181583404541015626",
+        "7.2057594037927933e16", "123456789012345678901234567890e-10",
+        "-122.41923293678234", "37.80866302643798", "0.000000000000001",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "100000000000000016777215.0", "100000000000000016777216.0",
+        "9007199254740993.00000000000000000000000",
+        "9007199254740993.00000000000000000000001",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        double expect = std::strtod(cases[i], NULL);
+        double actual = parse_double(std::string("[") + cases[i] + "]");
+        EXPECT_EQ(std::memcmp(&expect, &actual, sizeof(double)), 0)
+            << cases[i];
+    }
+
+    /* long mantissas cross the threshold of fallback */
+    std::string digits = "1.";
+    for (int i = 0; i < 1000; ++i)
+        digits += char('0' + i % 10);
+    EXPECT_EQ(parse_double("[" + digits + "]"),
+              std::strtod(digits.c_str(), NULL));
+
+    std::srand(2333);
+    for (int round = 0; round < 20000; ++round) {
+        /* [1-9][0-9]*, a dot somewhere, and an exponent */
+        std::string str(1, char('1' + std::rand() % 9));
+        int length = std::rand() % 24;
+        for (int i = 0; i < length; ++i)
+            str += char('0' + std::rand() % 10);
+        str.insert(1 + std::rand() % str.size(), ".0", 1);
+        if (str[str.size() - 1] == '.')
+            str += '0';
+        char exp[16];
+        std::sprintf(exp, "e%d", std::rand() % 660 - 340);
+        str += exp;
+
+        double expect = std::strtod(str.c_str(), NULL);
+        double actual = parse_double("[" + str + "]");
+        ASSERT_EQ(std::memcmp(&expect, &actual, sizeof(double)), 0) << str;
+    }
+}
+
+TEST(parser, format)
+{
+    using namespace CV_FS_PRIVATE_NS;
+
+    char buf[number::MAX_FORMAT_LENGTH + 1];
+    struct { double val; char const * str; } const cases[] =
+    {
+        {  0.0,    "0.0"   }, { -0.0,   "-0.0"    }, { 1.0,   "1.0"    },
+        { -5.0,   "-5.0"   }, {  0.1,    "0.1"    }, { 1e21,  "1e21"   },
+        {  1e20, "100000000000000000000.0"         }, { 1.5e-7, "1.5e-7" },
+        {  0.001, "0.001"  }, { -122.41923293678234, "-122.41923293678234" },
+        {  5e-324, "5e-324" }, { 1.7976931348623157e308,
+                                 "1.7976931348623157e308"                 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        buf[number::format(cases[i].val, buf)] = '\0';
+        EXPECT_EQ(std::string(buf), cases[i].str);
+    }
+
+    double inf = std::numeric_limits<double>::infinity();
+    buf[number::format( inf, buf)] = '\0';
+    EXPECT_EQ(std::string(buf), ".Inf");
+    buf[number::format(-inf, buf)] = '\0';
+    EXPECT_EQ(std::string(buf), "-.Inf");
+    buf[number::format(std::numeric_limits<double>::quiet_NaN(), buf)] = 0;
+    EXPECT_EQ(std::string(buf), ".Nan");
+
+    buf[number::format(std::numeric_limits<int64_t>::min(), buf)] = '\0';
+    EXPECT_EQ(std::string(buf), "-9223372036854775808");
+    buf[number::format(int64_t(0), buf)] = '\0';
+    EXPECT_EQ(std::string(buf), "0");
+
+    /* round trip through the parser, random bit patterns */
+    std::srand(1234);
+    for (int round = 0; round < 20000; ++round) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 4; ++k)
+            bits = (bits << 16) ^ static_cast<uint64_t>(std::rand());
+        double val;
+        std::memcpy(&val, &bits, sizeof(val));
+        if (val != val || val - val != 0.0)
+            continue; /* nan or inf */
+
+        size_t len = number::format(val, buf);
+        ASSERT_LE(len, number::MAX_FORMAT_LENGTH);
+        buf[len] = '\0';
+        double back = parse_double(std::string("[") + buf + "]");
+        ASSERT_EQ(std::memcmp(&val, &back, sizeof(val)), 0) << buf;
+
+        int64_t i64 = static_cast<int64_t>(bits);
+        char expect[32];
+        std::sprintf(expect, "%lld", static_cast<long long>(i64));
+        buf[number::format(i64, buf)] = '\0';
+        ASSERT_EQ(std::string(buf), expect);
+    }
+}